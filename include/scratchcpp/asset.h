@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include "entity.h"
 #include "spimpl.h"
 #include "global.h"
@@ -15,6 +18,8 @@ class AssetPrivate;
 class LIBSCRATCHCPP_EXPORT Asset : public Entity
 {
     public:
+        using DataLoader = std::function<std::shared_ptr<const void>()>;
+
         Asset(const std::string &name, const std::string &id, const std::string &format);
         Asset(const Asset &) = delete;
 
@@ -32,8 +37,12 @@ class LIBSCRATCHCPP_EXPORT Asset : public Entity
         unsigned int dataSize() const;
         void setData(unsigned int size, void *data);
 
+        void setDataLoader(unsigned int size, const DataLoader &loader);
+        bool isDataLoaded() const;
+        void releaseData();
+
     protected:
-        virtual void processData(unsigned int size, void *data) { }
+        virtual void processData(unsigned int size, const void *data) { }
 
     private:
         spimpl::unique_impl_ptr<AssetPrivate> impl;
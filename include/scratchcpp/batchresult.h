@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <map>
+
+#include "global.h"
+#include "spimpl.h"
+#include "value.h"
+
+namespace libscratchcpp
+{
+
+class BatchResultPrivate;
+
+/*! \brief The BatchResult class represents the result of a project run by BatchRunner. */
+class LIBSCRATCHCPP_EXPORT BatchResult
+{
+    public:
+        /*! Final variable values (target name -> variable name -> value). */
+        using VariableMap = std::map<std::string, std::map<std::string, Value>>;
+
+        BatchResult(const std::string &fileName = "");
+
+        const std::string &fileName() const;
+        void setFileName(const std::string &fileName);
+
+        bool loaded() const;
+        void setLoaded(bool loaded);
+
+        unsigned int frames() const;
+        void setFrames(unsigned int frames);
+
+        double loadTime() const;
+        void setLoadTime(double time);
+
+        double runTime() const;
+        void setRunTime(double time);
+
+        const VariableMap &variables() const;
+        void setVariables(const VariableMap &variables);
+
+        Value variableValue(const std::string &targetName, const std::string &variableName) const;
+
+    private:
+        spimpl::impl_ptr<BatchResultPrivate> impl;
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "spimpl.h"
+#include "batchresult.h"
+
+namespace libscratchcpp
+{
+
+class BatchRunnerPrivate;
+
+/*!
+ * \brief The BatchRunner class loads and runs multiple projects in parallel.
+ *
+ * Projects are distributed between worker threads which steal work from each other,
+ * so all cores are used until the last project finishes.\n
+ * Every project runs headlessly in the fixed timestep mode, see IEngine::setFixedTimestepEnabled().
+ */
+class LIBSCRATCHCPP_EXPORT BatchRunner
+{
+    public:
+        BatchRunner();
+        BatchRunner(const BatchRunner &) = delete;
+
+        const std::vector<std::string> &projects() const;
+        void addProject(const std::string &fileName);
+        void clearProjects();
+
+        unsigned int threadCount() const;
+        void setThreadCount(unsigned int count);
+
+        unsigned int frameLimit() const;
+        void setFrameLimit(unsigned int limit);
+
+        double timeLimit() const;
+        void setTimeLimit(double limit);
+
+        std::vector<BatchResult> run() const;
+
+    private:
+        spimpl::unique_impl_ptr<BatchRunnerPrivate> impl;
+};
+
+} // namespace libscratchcpp
@@ -28,6 +28,8 @@ class CompilerPrivate;
 class LIBSCRATCHCPP_EXPORT Compiler
 {
     public:
+        friend class Engine;
+
         enum class SubstackType
         {
             Loop,
@@ -59,6 +61,7 @@ class LIBSCRATCHCPP_EXPORT Compiler
         void addInput(int id);
         void addConstValue(const Value &value);
         void addFunctionCall(BlockFunc f);
+        void addFunctionCallWithInlineCache(BlockFunc f);
         void addProcedureArg(const std::string &procCode, const std::string &argName);
         void moveToSubstack(std::shared_ptr<Block> substack1, std::shared_ptr<Block> substack2, SubstackType type);
         void moveToSubstack(std::shared_ptr<Block> substack, SubstackType type);
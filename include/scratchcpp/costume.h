@@ -10,12 +10,15 @@ namespace libscratchcpp
 {
 
 class Broadcast;
+class AlphaMask;
 class CostumePrivate;
 
 /*! \brief The Costume class represents a Scratch costume. */
 class LIBSCRATCHCPP_EXPORT Costume : public Asset
 {
     public:
+        friend class SpatialIndex;
+
         Costume(const std::string &name, const std::string &id, const std::string &format);
         Costume(const Costume &) = delete;
 
@@ -28,9 +31,18 @@ class LIBSCRATCHCPP_EXPORT Costume : public Asset
         int rotationCenterY() const;
         void setRotationCenterY(int newRotationCenterY);
 
+        double width() const;
+        double height() const;
+
         Broadcast *broadcast();
 
+    protected:
+        void processData(unsigned int size, const void *data) override;
+
     private:
+        void readImageSize() const;
+        const AlphaMask *alphaMask() const;
+
         spimpl::unique_impl_ptr<CostumePrivate> impl;
 };
 
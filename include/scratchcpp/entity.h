@@ -11,6 +11,7 @@ namespace libscratchcpp
 {
 
 class EntityPrivate;
+class NameIndexGroup;
 
 /*! \brief The Entity class is the base class of everything that is identified by an ID (Target, Variable, List, etc.). */
 class LIBSCRATCHCPP_EXPORT Entity
@@ -27,6 +28,8 @@ class LIBSCRATCHCPP_EXPORT Entity
 
     private:
         spimpl::unique_impl_ptr<EntityPrivate> impl;
+
+        friend class NameIndexGroup;
 };
 
 } // namespace libscratchcpp
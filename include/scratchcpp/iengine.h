@@ -22,6 +22,8 @@ class Variable;
 class List;
 class Script;
 class ITimer;
+class IClock;
+class IRandomGenerator;
 class KeyEvent;
 
 /*!
@@ -29,6 +31,11 @@ class KeyEvent;
  *
  * This interface can be used to manipulate loaded Scratch projects.\n
  * To load a Scratch project, use the Project class.
+ *
+ * \note If the event loop is running in another thread, start(), stop(), the key and mouse setters,
+ * setParallelExecutionEnabled() and stopEventLoop() can be called from one host thread (e.g. the UI thread) without locking.
+ * These calls are queued and processed by the event loop on the next frame.
+ * Calls made while the event loop is stopping are processed before it returns.
  */
 class LIBSCRATCHCPP_EXPORT IEngine
 {
@@ -44,6 +51,15 @@ class LIBSCRATCHCPP_EXPORT IEngine
          */
         virtual void compile() = 0;
 
+        /*!
+         * Recompiles only the scripts which contain the given blocks of the target (use this after editing a compiled project).
+         * \param[in] target The target which owns the blocks.
+         * \param[in] changedBlocks Blocks which were added (see Target::addBlock()) or changed. This includes blocks whose next, parent or input block changed.
+         * \param[in] removedBlocks Blocks which were removed from the target (see Target::removeBlock()).
+         * \note Running instances of the recompiled scripts and of scripts which call recompiled custom blocks are stopped.
+         */
+        virtual void recompile(Target *target, const std::vector<std::shared_ptr<Block>> &changedBlocks, const std::vector<std::shared_ptr<Block>> &removedBlocks = {}) = 0;
+
         /*!
          * Calls all "when green flag clicked" blocks.
          * \note Nothing will happen until the event loop is started.
@@ -95,12 +111,22 @@ class LIBSCRATCHCPP_EXPORT IEngine
         /*! Stops the event loop which is running in another thread. */
         virtual void stopEventLoop() = 0;
 
+        /*!
+         * Runs the given number of frames and returns immediately (without sleeping).
+         * \note Use this with the fixed timestep mode to run projects headlessly and deterministically.
+         * \see setFixedTimestepEnabled()
+         */
+        virtual void step(unsigned int frames = 1) = 0;
+
         /*! Sets the function which is called on every frame. */
         virtual void setRedrawHandler(const std::function<void()> &handler) = 0;
 
         /*! Returns true if the project is currently running. */
         virtual bool isRunning() const = 0;
 
+        /*! Returns true if there are any running scripts. */
+        virtual bool hasRunningScripts() const = 0;
+
         /*! Returns the framerate of the project. */
         virtual double fps() const = 0;
 
@@ -113,6 +139,34 @@ class LIBSCRATCHCPP_EXPORT IEngine
         /*! Sets whether turbo mode is enabled. */
         virtual void setTurboModeEnabled(bool turboMode) = 0;
 
+        /*! Returns true if the fixed timestep mode is enabled. */
+        virtual bool fixedTimestepEnabled() const = 0;
+
+        /*!
+         * Toggles the fixed timestep mode.\n
+         * In this mode, the engine uses a virtual clock which is advanced by exactly one frame (1 / fps seconds)
+         * after every frame, the event loop doesn't sleep and the wall clock is never read.
+         * \note This should be called before the project starts.
+         */
+        virtual void setFixedTimestepEnabled(bool enable) = 0;
+
+        /*! Returns true if the parallel execution mode is enabled. */
+        virtual bool parallelExecutionEnabled() const = 0;
+
+        /*!
+         * Toggles the parallel execution mode.\n
+         * In this mode, scripts which only use their own target (see Script::isTargetLocal()) run
+         * on multiple threads. The result is the same as if the scripts ran one after another.
+         * \note Sprite handlers might be called from multiple threads (for different sprites) in this mode.
+         */
+        virtual void setParallelExecutionEnabled(bool enable) = 0;
+
+        /*! Returns true if the engine and the compiler print progress messages and warnings. */
+        virtual bool loggingEnabled() const = 0;
+
+        /*! Toggles progress messages and warnings (enabled by default). Disable it to load projects quietly. */
+        virtual void setLoggingEnabled(bool enable) = 0;
+
         /*! Returns true if the given key is pressed. */
         virtual bool keyPressed(const std::string &name) const = 0;
 
@@ -167,12 +221,51 @@ class LIBSCRATCHCPP_EXPORT IEngine
         /*! Returns the current number of clones. */
         virtual int cloneCount() const = 0;
 
+        /*!
+         * Returns a deleted clone of the given sprite which can be reused by Sprite::clone(),
+         * or nullptr if the clone pool doesn't have any.
+         */
+        virtual std::shared_ptr<Sprite> takeClone(Sprite *sprite) = 0;
+
+        /*! Returns the maximum number of deleted clones kept for reuse. */
+        virtual int clonePoolLimit() const = 0;
+
+        /*! Sets the maximum number of deleted clones kept for reuse (use 0 to disable the clone pool). */
+        virtual void setClonePoolLimit(int limit) = 0;
+
+        /*! Returns the number of clones which were created by reusing a deleted clone. */
+        virtual unsigned int clonePoolHits() const = 0;
+
+        /*! Returns the number of clones which had to be allocated because the clone pool didn't have any. */
+        virtual unsigned int clonePoolMisses() const = 0;
+
         /*! Returns true if sprite fencing is enabled. */
         virtual bool spriteFencingEnabled() const = 0;
 
         /*! Toggles sprite fencing. */
         virtual void setSpriteFencingEnabled(bool enable) = 0;
 
+        /*! Returns true if sprite transforms are stored in the engine (see setSpriteTransformStoreEnabled()). */
+        virtual bool spriteTransformStoreEnabled() const = 0;
+
+        /*!
+         * Toggles the sprite transform store.
+         * In this mode, the position, size, direction, costume and flags of sprites and clones are stored
+         * in contiguous arrays owned by the engine instead of in each sprite, which is faster for projects with many clones.
+         * The Sprite getters and setters work the same way in both modes.
+         */
+        virtual void setSpriteTransformStoreEnabled(bool enable) = 0;
+
+        /*! Returns true if sprite change notifications are batched (see setBatchedSpriteNotificationsEnabled()). */
+        virtual bool batchedSpriteNotificationsEnabled() const = 0;
+
+        /*!
+         * Toggles batched sprite change notifications.
+         * In this mode, sprites record their changes instead of notifying the sprite handler after each change.
+         * All changes of a sprite are sent to ISpriteHandler#onChanged() once per frame, right before the redraw handler is called.
+         */
+        virtual void setBatchedSpriteNotificationsEnabled(bool enable) = 0;
+
         /*! Returns true if there are any running script of the broadcast with the given index. */
         virtual bool broadcastRunning(unsigned int index, VirtualMachine *sourceScript) = 0;
 
@@ -188,12 +281,31 @@ class LIBSCRATCHCPP_EXPORT IEngine
         /*! Returns the timer of the project. */
         virtual ITimer *timer() const = 0;
 
+        /*! Returns the clock used by the engine and the blocks. */
+        virtual IClock *clock() const = 0;
+
+        /*! Returns the random number generator used by the engine and the blocks. */
+        virtual IRandomGenerator *randomGenerator() const = 0;
+
+        /*! Seeds the random number generator (use this to make random blocks deterministic). */
+        virtual void setRandomSeed(unsigned int seed) = 0;
+
         /*!
          * Registers the given block section.
          * \see <a href="blockSections.html">Block sections</a>
          */
         virtual void registerSection(std::shared_ptr<IBlockSection> section) = 0;
 
+        /*!
+         * Returns the index of the registered block section with the given name, or -1 if there isn't any.
+         * \note Block sections are registered separately in every engine, so they can be used to store per-engine state.
+         * Add the index to the bytecode at compile time and use sectionAt() in block functions to get the section.
+         */
+        virtual int findSection(const std::string &name) const = 0;
+
+        /*! Returns the registered block section at index. */
+        virtual IBlockSection *sectionAt(int index) const = 0;
+
         /*! Returns the index of the given block function. */
         virtual unsigned int functionIndex(BlockFunc f) = 0;
 
@@ -227,6 +339,20 @@ class LIBSCRATCHCPP_EXPORT IEngine
          */
         virtual void addFieldValue(IBlockSection *section, const std::string &value, int id) = 0;
 
+        /*!
+         * Call this from IBlockSection#registerBlocks() to add a block implementation function to a block section.
+         * Functions are stored in the project cache by their section and order of registration,
+         * so projects which call functions that aren't registered are compiled on every load.
+         */
+        virtual void addFunction(IBlockSection *section, BlockFunc f) = 0;
+
+        /*!
+         * Call this from IBlockSection#registerBlocks() to mark a block implementation function as target-local.
+         * Target-local functions only read and modify the target of the script (and don't use the random number generator).
+         * \see setParallelExecutionEnabled()
+         */
+        virtual void addTargetLocalFunction(BlockFunc f) = 0;
+
         /*! Returns the list of broadcasts. */
         virtual const std::vector<std::shared_ptr<Broadcast>> &broadcasts() const = 0;
 
@@ -282,6 +408,15 @@ class LIBSCRATCHCPP_EXPORT IEngine
         /*! Moves the given sprite behind some other sprite. */
         virtual void moveSpriteBehindOther(Sprite *sprite, Sprite *other) = 0;
 
+        /*!
+         * Call this when the bounding rectangle of the given sprite might have changed.
+         * \note The bounding rectangle is read again by the next touching check, so this is cheap to call often.
+         */
+        virtual void invalidateSpriteBounds(const Sprite *sprite) = 0;
+
+        /*! Returns true if the given sprite touches the other sprite or any of its visible clones. */
+        virtual bool touchingSprite(const Sprite *sprite, const Sprite *other) = 0;
+
         /*! Returns the Stage. */
         virtual Stage *stage() const = 0;
 
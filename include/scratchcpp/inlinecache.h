@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+#include "global.h"
+#include "spimpl.h"
+
+namespace libscratchcpp
+{
+
+class Target;
+class Variable;
+class InlineCachePrivate;
+class VirtualMachine;
+
+/*!
+ * \brief The InlineCache class stores the last name resolution of a block function call site.
+ *
+ * Use VirtualMachine::inlineCache() to get the cache of the block function call which is being executed.
+ */
+class LIBSCRATCHCPP_EXPORT InlineCache
+{
+    public:
+        InlineCache();
+
+        bool matches(const std::string &name) const;
+        bool matches(const std::string &name, const std::string &targetName) const;
+
+        void store(const std::string &name, Target *target);
+        void store(const std::string &name, const std::string &targetName, Target *target, Variable *variable);
+
+        void clear();
+
+        Target *target() const;
+        Variable *variable() const;
+
+    private:
+        spimpl::impl_ptr<InlineCachePrivate> impl;
+
+        friend class VirtualMachine;
+};
+
+} // namespace libscratchcpp
@@ -4,6 +4,7 @@
 
 #include "global.h"
 #include "sprite.h"
+#include "spritechanges.h"
 
 namespace libscratchcpp
 {
@@ -53,9 +54,54 @@ class LIBSCRATCHCPP_EXPORT ISpriteHandler
         /*! Called when all graphics effects are cleared. */
         virtual void onGraphicsEffectsCleared() = 0;
 
+        /*!
+         * Called right before the redraw handler of the engine with all changes of the sprite since the last redraw
+         * if batched notifications are enabled (see IEngine::setBatchedSpriteNotificationsEnabled()).
+         * \note The default implementation calls the other change methods with the current values of the sprite.
+         */
+        virtual void onChanged(const SpriteChanges &changes)
+        {
+            Sprite *sprite = changes.sprite();
+
+            if (!sprite)
+                return;
+
+            if (changes.changed(SpriteChanges::Property::Costume)) {
+                auto costume = sprite->currentCostume();
+
+                if (costume)
+                    onCostumeChanged(costume.get());
+            }
+
+            if (changes.changed(SpriteChanges::Property::Visible))
+                onVisibleChanged(sprite->visible());
+
+            if (changes.changed(SpriteChanges::Property::X))
+                onXChanged(sprite->x());
+
+            if (changes.changed(SpriteChanges::Property::Y))
+                onYChanged(sprite->y());
+
+            if (changes.changed(SpriteChanges::Property::Size))
+                onSizeChanged(sprite->size());
+
+            if (changes.changed(SpriteChanges::Property::Direction))
+                onDirectionChanged(sprite->direction());
+
+            if (changes.changed(SpriteChanges::Property::RotationStyle))
+                onRotationStyleChanged(sprite->rotationStyle());
+
+            if (changes.graphicsEffectsCleared())
+                onGraphicsEffectsCleared();
+
+            for (const auto &[effect, value] : changes.graphicsEffects())
+                onGraphicsEffectChanged(effect, value);
+        }
+
         /*!
          * Used to get the bounding rectangle of the sprite.
          * \note The rectangle must be relative to the stage, so make sure to use the sprite's coordinates.
+         * \note This is only used if the size of the costume image is unknown, see Costume#width().
          */
         virtual Rect boundingRect() const = 0;
 };
@@ -23,7 +23,7 @@ class LIBSCRATCHCPP_EXPORT List
         List(const std::string &id, const std::string &name);
         List(const List &) = delete;
 
-        const std::string &name();
+        const std::string &name() const;
         void setName(const std::string &name);
 
         Target *target() const;
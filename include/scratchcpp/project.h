@@ -42,6 +42,12 @@ class LIBSCRATCHCPP_EXPORT Project
 
         std::shared_ptr<IEngine> engine() const;
 
+        bool assetPreloadingEnabled() const;
+        void setAssetPreloadingEnabled(bool enabled);
+
+        const std::string &cacheDirectory() const;
+        void setCacheDirectory(const std::string &directory);
+
         void setDownloadProgressCallback(const std::function<void(unsigned int, unsigned int)> &&f);
 
     private:
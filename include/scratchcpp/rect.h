@@ -32,6 +32,9 @@ class LIBSCRATCHCPP_EXPORT Rect
         double width() const;
         double height() const;
 
+        bool intersects(const Rect &rect) const;
+        bool contains(double x, double y) const;
+
     private:
         spimpl::impl_ptr<RectPrivate> impl;
 };
@@ -39,6 +39,9 @@ class LIBSCRATCHCPP_EXPORT ScratchConfiguration
         static void registerGraphicsEffect(std::shared_ptr<IGraphicsEffect> effect);
         static void removeGraphicsEffect(const std::string &name);
         static IGraphicsEffect *getGraphicsEffect(const std::string &name);
+        static int findGraphicsEffect(const std::string &name);
+        static IGraphicsEffect *graphicsEffectAt(int index);
+        static int graphicsEffectCount();
 
     private:
         static const std::vector<std::shared_ptr<IExtension>> getExtensions();
@@ -35,9 +35,13 @@ class LIBSCRATCHCPP_EXPORT Script
         void setProcedures(const std::vector<unsigned int *> &procedures);
         void setFunctions(const std::vector<BlockFunc> &functions);
         void setConstValues(const std::vector<Value> &values);
+        const std::vector<Variable *> &variables() const;
         void setVariables(const std::vector<Variable *> &variables);
         void setLists(const std::vector<List *> &lists);
 
+        bool isTargetLocal() const;
+        void setTargetLocal(bool targetLocal);
+
         std::shared_ptr<VirtualMachine> start();
         std::shared_ptr<VirtualMachine> start(Target *target);
 
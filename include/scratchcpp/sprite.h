@@ -11,6 +11,9 @@ class ISpriteHandler;
 class Rect;
 class IGraphicsEffect;
 class SpritePrivate;
+class Script;
+struct TransformStore;
+struct CloneScriptData;
 
 /*! \brief The Sprite class represents a Scratch sprite. */
 class LIBSCRATCHCPP_EXPORT Sprite
@@ -67,6 +70,10 @@ class LIBSCRATCHCPP_EXPORT Sprite
         Rect boundingRect() const;
         void keepInFence(double newX, double newY, double *fencedX, double *fencedY) const;
 
+        bool touchingSprite(const Sprite *sprite) const;
+        bool touchingEdge() const;
+        bool touchingPoint(double x, double y) const;
+
         void setGraphicsEffectValue(IGraphicsEffect *effect, double value) override;
 
         void clearGraphicsEffects() override;
@@ -74,8 +81,13 @@ class LIBSCRATCHCPP_EXPORT Sprite
     private:
         Target *dataSource() const override;
         void setXY(double x, double y);
+        CloneScriptData &scriptData(const Script *script);
 
         spimpl::unique_impl_ptr<SpritePrivate> impl;
+
+        friend class Engine;
+        friend class Script;
+        friend struct TransformStore;
 };
 
 } // namespace libscratchcpp
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <unordered_map>
+
+#include "global.h"
+#include "spimpl.h"
+
+namespace libscratchcpp
+{
+
+class Sprite;
+class IGraphicsEffect;
+class SpriteChangesPrivate;
+
+/*! \brief The SpriteChanges class holds the changes of a sprite since the last redraw (see IEngine::setBatchedSpriteNotificationsEnabled()). */
+class LIBSCRATCHCPP_EXPORT SpriteChanges
+{
+    public:
+        enum class Property
+        {
+            Costume = 1 << 0,
+            Visible = 1 << 1,
+            X = 1 << 2,
+            Y = 1 << 3,
+            Size = 1 << 4,
+            Direction = 1 << 5,
+            RotationStyle = 1 << 6
+        };
+
+        SpriteChanges(Sprite *sprite = nullptr);
+
+        Sprite *sprite() const;
+
+        bool empty() const;
+        void clear();
+
+        bool changed(Property property) const;
+        void setChanged(Property property);
+
+        bool graphicsEffectsCleared() const;
+        void setGraphicsEffectsCleared();
+
+        const std::unordered_map<IGraphicsEffect *, double> &graphicsEffects() const;
+        void setGraphicsEffectValue(IGraphicsEffect *effect, double value);
+
+    private:
+        spimpl::impl_ptr<SpriteChangesPrivate> impl;
+};
+
+} // namespace libscratchcpp
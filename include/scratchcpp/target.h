@@ -19,6 +19,8 @@ class Costume;
 class Sound;
 class IGraphicsEffect;
 class TargetPrivate;
+class LayerList;
+class NameIndexGroup;
 
 /*! \brief The Target class is the Stage or a Sprite. */
 class LIBSCRATCHCPP_EXPORT Target
@@ -26,7 +28,7 @@ class LIBSCRATCHCPP_EXPORT Target
     public:
         Target();
         Target(const Target &) = delete;
-        virtual ~Target() { }
+        virtual ~Target();
 
         /*! Returns true if this Target is the stage. */
         virtual bool isStage() const { return false; }
@@ -48,6 +50,7 @@ class LIBSCRATCHCPP_EXPORT Target
 
         const std::vector<std::shared_ptr<Block>> &blocks() const;
         int addBlock(std::shared_ptr<Block> block);
+        bool removeBlock(std::shared_ptr<Block> block);
         std::shared_ptr<Block> blockAt(int index) const;
         int findBlock(const std::string &id) const;
         std::vector<std::shared_ptr<Block>> greenFlagBlocks() const;
@@ -92,6 +95,9 @@ class LIBSCRATCHCPP_EXPORT Target
 
     private:
         spimpl::unique_impl_ptr<TargetPrivate> impl;
+
+        friend class LayerList;
+        friend class NameIndexGroup;
 };
 
 } // namespace libscratchcpp
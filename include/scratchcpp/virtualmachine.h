@@ -80,7 +80,8 @@ enum Opcode
     OP_ADD_ARG,        /*!< Adds a procedure (custom block) argument with the value from the last register. */
     OP_READ_ARG,       /*!< Reads the procedure (custom block) argument with the index in the argument and stores the value in the last register. */
     OP_BREAK_FRAME,    /*!< Breaks current frame at the end of the loop. */
-    OP_WARP            /*! Runs the script without screen refresh. */
+    OP_WARP,           /*! Runs the script without screen refresh. */
+    OP_EXEC_CACHED     /*!< Calls the function with the index in the first argument. The second argument is the inline cache slot of the call (see VirtualMachine::inlineCache()). */
 };
 
 }
@@ -89,6 +90,7 @@ class Target;
 class IEngine;
 class Script;
 class List;
+class InlineCache;
 
 /*! \brief The VirtualMachine class is a virtual machine for compiled Scratch scripts. */
 class LIBSCRATCHCPP_EXPORT VirtualMachine
@@ -127,6 +129,8 @@ class LIBSCRATCHCPP_EXPORT VirtualMachine
         void addReturnValue(const Value &v);
         void replaceReturnValue(const Value &v, unsigned int offset);
 
+        InlineCache &inlineCache();
+
         void run();
         void reset();
         void moveToLastCheckpoint();
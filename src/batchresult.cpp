@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/batchresult.h>
+
+#include "batchresult_p.h"
+
+using namespace libscratchcpp;
+
+/*! Constructs BatchResult. */
+BatchResult::BatchResult(const std::string &fileName) :
+    impl(spimpl::make_impl<BatchResultPrivate>(fileName))
+{
+}
+
+/*! Returns the file name of the project. */
+const std::string &BatchResult::fileName() const
+{
+    return impl->fileName;
+}
+
+/*! Sets the file name of the project. */
+void BatchResult::setFileName(const std::string &fileName)
+{
+    impl->fileName = fileName;
+}
+
+/*! Returns true if the project was loaded successfully. */
+bool BatchResult::loaded() const
+{
+    return impl->loaded;
+}
+
+/*! Sets whether the project was loaded successfully. */
+void BatchResult::setLoaded(bool loaded)
+{
+    impl->loaded = loaded;
+}
+
+/*! Returns the number of frames the project ran for. */
+unsigned int BatchResult::frames() const
+{
+    return impl->frames;
+}
+
+/*! Sets the number of frames the project ran for. */
+void BatchResult::setFrames(unsigned int frames)
+{
+    impl->frames = frames;
+}
+
+/*! Returns the time it took to load the project (in seconds). */
+double BatchResult::loadTime() const
+{
+    return impl->loadTime;
+}
+
+/*! Sets the time it took to load the project (in seconds). */
+void BatchResult::setLoadTime(double time)
+{
+    impl->loadTime = time;
+}
+
+/*! Returns the time the project ran for (in seconds). */
+double BatchResult::runTime() const
+{
+    return impl->runTime;
+}
+
+/*! Sets the time the project ran for (in seconds). */
+void BatchResult::setRunTime(double time)
+{
+    impl->runTime = time;
+}
+
+/*! Returns the final values of all variables. */
+const BatchResult::VariableMap &BatchResult::variables() const
+{
+    return impl->variables;
+}
+
+/*! Sets the final values of all variables. */
+void BatchResult::setVariables(const VariableMap &variables)
+{
+    impl->variables = variables;
+}
+
+/*! Returns the final value of the given variable (0 if it doesn't exist). */
+Value BatchResult::variableValue(const std::string &targetName, const std::string &variableName) const
+{
+    auto targetIt = impl->variables.find(targetName);
+
+    if (targetIt == impl->variables.cend())
+        return Value();
+
+    auto it = targetIt->second.find(variableName);
+
+    if (it == targetIt->second.cend())
+        return Value();
+
+    return it->second;
+}
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "batchresult_p.h"
+
+namespace libscratchcpp
+{
+
+BatchResultPrivate::BatchResultPrivate(const std::string &fileName) :
+    fileName(fileName)
+{
+}
+
+} // namespace libscratchcpp
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <scratchcpp/batchresult.h>
+
+namespace libscratchcpp
+{
+
+struct BatchResultPrivate
+{
+        BatchResultPrivate(const std::string &fileName);
+
+        std::string fileName;
+        bool loaded = false;
+        unsigned int frames = 0;
+        double loadTime = 0;
+        double runTime = 0;
+        BatchResult::VariableMap variables;
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/batchrunner.h>
+
+#include "batchrunner_p.h"
+#include "internal/workstealingpool.h"
+
+using namespace libscratchcpp;
+
+/*! Constructs BatchRunner. */
+BatchRunner::BatchRunner() :
+    impl(spimpl::make_unique_impl<BatchRunnerPrivate>())
+{
+}
+
+/*! Returns the list of project file names. */
+const std::vector<std::string> &BatchRunner::projects() const
+{
+    return impl->projects;
+}
+
+/*! Adds a project (file name or URL) to the batch. */
+void BatchRunner::addProject(const std::string &fileName)
+{
+    impl->projects.push_back(fileName);
+}
+
+/*! Removes all projects from the batch. */
+void BatchRunner::clearProjects()
+{
+    impl->projects.clear();
+}
+
+/*! Returns the number of worker threads (0 means one thread per core). */
+unsigned int BatchRunner::threadCount() const
+{
+    return impl->threadCount;
+}
+
+/*! Sets the number of worker threads (0 means one thread per core). */
+void BatchRunner::setThreadCount(unsigned int count)
+{
+    impl->threadCount = count;
+}
+
+/*! Returns the maximum number of frames each project can run for (0 means unlimited). */
+unsigned int BatchRunner::frameLimit() const
+{
+    return impl->frameLimit;
+}
+
+/*! Sets the maximum number of frames each project can run for (0 means unlimited). */
+void BatchRunner::setFrameLimit(unsigned int limit)
+{
+    impl->frameLimit = limit;
+}
+
+/*! Returns the maximum time (in seconds) each project can run for (0 means unlimited). */
+double BatchRunner::timeLimit() const
+{
+    return impl->timeLimit;
+}
+
+/*!
+ * Sets the maximum time (in seconds) each project can run for (0 means unlimited).
+ * \note This is the real time, not the project time.
+ */
+void BatchRunner::setTimeLimit(double limit)
+{
+    impl->timeLimit = limit;
+}
+
+/*!
+ * Loads and runs all projects and returns their results in the same order as projects().
+ * Each project runs until all of its scripts finish or until the frame or time limit is reached.
+ * Logging of the engines is disabled and their scripts are compiled on the worker threads one target after another.
+ * \note Projects with forever loops never finish, so set a frame or time limit for them.
+ */
+std::vector<BatchResult> BatchRunner::run() const
+{
+    const auto &projects = impl->projects;
+    std::vector<BatchResult> results(projects.size());
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (size_t i = 0; i < projects.size(); i++)
+        tasks.push_back([this, i, &projects, &results]() { results[i] = impl->runProject(projects[i]); });
+
+    WorkStealingPool pool(impl->threadCount);
+    pool.run(tasks);
+
+    return results;
+}
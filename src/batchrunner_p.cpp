@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/project.h>
+#include <scratchcpp/iengine.h>
+#include <scratchcpp/target.h>
+#include <scratchcpp/variable.h>
+#include <chrono>
+
+#include "batchrunner_p.h"
+
+using namespace libscratchcpp;
+
+BatchRunnerPrivate::BatchRunnerPrivate()
+{
+}
+
+BatchResult BatchRunnerPrivate::runProject(const std::string &fileName) const
+{
+    BatchResult result(fileName);
+    Project project(fileName);
+
+    // Projects run in parallel, so the output of the engines would be interleaved
+    project.engine()->setLoggingEnabled(false);
+
+    auto loadStart = std::chrono::steady_clock::now();
+    bool loaded = project.load();
+    auto runStart = std::chrono::steady_clock::now();
+    result.setLoaded(loaded);
+    result.setLoadTime(std::chrono::duration<double>(runStart - loadStart).count());
+
+    if (!loaded)
+        return result;
+
+    auto engine = project.engine();
+    engine->setFixedTimestepEnabled(true);
+    engine->start();
+
+    unsigned int frames = 0;
+    std::chrono::duration<double> elapsed(0);
+
+    while (engine->hasRunningScripts() && (frameLimit == 0 || frames < frameLimit) && (timeLimit <= 0 || elapsed.count() < timeLimit)) {
+        engine->step();
+        frames++;
+        elapsed = std::chrono::steady_clock::now() - runStart;
+    }
+
+    engine->stop();
+    result.setFrames(frames);
+    result.setRunTime(elapsed.count());
+
+    // Clones are deleted when the project stops, so only the original targets remain
+    BatchResult::VariableMap variables;
+
+    for (auto target : engine->targets()) {
+        auto &values = variables[target->name()];
+
+        for (auto variable : target->variables())
+            values[variable->name()] = variable->value();
+    }
+
+    result.setVariables(variables);
+    return result;
+}
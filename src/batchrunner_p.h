@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <scratchcpp/batchrunner.h>
+
+namespace libscratchcpp
+{
+
+struct BatchRunnerPrivate
+{
+        BatchRunnerPrivate();
+        BatchRunnerPrivate(const BatchRunnerPrivate &) = delete;
+
+        BatchResult runProject(const std::string &fileName) const;
+
+        std::vector<std::string> projects;
+        unsigned int threadCount = 0;
+        unsigned int frameLimit = 0;
+        double timeLimit = 0;
+};
+
+} // namespace libscratchcpp
@@ -6,15 +6,15 @@
 #include <scratchcpp/input.h>
 #include <scratchcpp/field.h>
 #include <scratchcpp/block.h>
+#include <scratchcpp/inlinecache.h>
 #include <cassert>
 
 #include "controlblocks.h"
-#include "../engine/internal/clock.h"
+#include "sectionindex.h"
+#include "../engine/internal/iclock.h"
 
 using namespace libscratchcpp;
 
-IClock *ControlBlocks::clock = nullptr;
-
 std::string ControlBlocks::name() const
 {
     return "Control";
@@ -54,6 +54,17 @@ void ControlBlocks::registerBlocks(IEngine *engine)
     engine->addFieldValue(this, "all", StopAll);
     engine->addFieldValue(this, "this script", StopThisScript);
     engine->addFieldValue(this, "other scripts in sprite", StopOtherScriptsInSprite);
+
+    // Functions
+    engine->addFunction(this, &stopAll);
+    engine->addFunction(this, &stopOtherScriptsInSprite);
+    engine->addFunction(this, &startWait);
+    engine->addFunction(this, &wait);
+    engine->addFunction(this, &waitUntil);
+    engine->addFunction(this, &createCloneOfMyself);
+    engine->addFunction(this, &createCloneByIndex);
+    engine->addFunction(this, &createClone);
+    engine->addFunction(this, &deleteThisClone);
 }
 
 void ControlBlocks::compileRepeatForever(Compiler *compiler)
@@ -155,7 +166,9 @@ void ControlBlocks::compileStop(Compiler *compiler)
 void ControlBlocks::compileWait(Compiler *compiler)
 {
     compiler->addInput(DURATION);
+    addSectionIndex(compiler, "Control");
     compiler->addFunctionCall(&startWait);
+    addSectionIndex(compiler, "Control");
     compiler->addFunctionCall(&wait);
 }
 
@@ -188,7 +201,7 @@ void ControlBlocks::compileCreateClone(Compiler *compiler)
         }
     } else {
         compiler->addInput(input);
-        compiler->addFunctionCall(&createClone);
+        compiler->addFunctionCallWithInlineCache(&createClone);
     }
 }
 
@@ -211,29 +224,25 @@ unsigned int ControlBlocks::stopOtherScriptsInSprite(VirtualMachine *vm)
 
 unsigned int ControlBlocks::startWait(VirtualMachine *vm)
 {
-    if (!clock)
-        clock = Clock::instance().get();
-
-    auto currentTime = clock->currentSteadyTime();
-    m_timeMap[vm] = { currentTime, vm->getInput(0, 1)->toDouble() * 1000 };
+    auto currentTime = vm->engine()->clock()->currentSteadyTime();
+    sectionInput<ControlBlocks>(vm, 2)->m_timeMap[vm] = { currentTime, vm->getInput(0, 2)->toDouble() * 1000 };
     vm->engine()->requestRedraw();
 
-    return 1;
+    return 2;
 }
 
 unsigned int ControlBlocks::wait(VirtualMachine *vm)
 {
-    if (!clock)
-        clock = Clock::instance().get();
-
-    auto currentTime = clock->currentSteadyTime();
-    assert(m_timeMap.count(vm) == 1);
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - m_timeMap[vm].first).count() >= m_timeMap[vm].second) {
-        m_timeMap.erase(vm);
+    auto currentTime = vm->engine()->clock()->currentSteadyTime();
+    auto &timeMap = sectionInput<ControlBlocks>(vm, 1)->m_timeMap;
+    auto it = timeMap.find(vm);
+    assert(it != timeMap.end());
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - it->second.first).count() >= it->second.second) {
+        timeMap.erase(it);
         vm->stop(true, true, false);
     } else
         vm->stop(true, true, true);
-    return 0;
+    return 1;
 }
 
 unsigned int ControlBlocks::waitUntil(VirtualMachine *vm)
@@ -252,8 +261,14 @@ unsigned int ControlBlocks::createClone(VirtualMachine *vm)
 
     if (spriteName == "_myself_")
         target = vm->target();
-    else
-        target = vm->engine()->targetAt(vm->engine()->findTarget(spriteName));
+    else {
+        InlineCache &cache = vm->inlineCache();
+
+        if (!cache.matches(spriteName))
+            cache.store(spriteName, vm->engine()->targetAt(vm->engine()->findTarget(spriteName)));
+
+        target = cache.target();
+    }
 
     Sprite *sprite = dynamic_cast<Sprite *>(target);
 
@@ -11,7 +11,6 @@ namespace libscratchcpp
 
 class Compiler;
 class VirtualMachine;
-class IClock;
 
 /*! \brief The ControlBlocks class contains the implementation of control blocks. */
 class ControlBlocks : public IBlockSection
@@ -69,9 +68,7 @@ class ControlBlocks : public IBlockSection
         static unsigned int createCloneOfMyself(VirtualMachine *vm);
         static unsigned int deleteThisClone(VirtualMachine *vm);
 
-        static inline std::unordered_map<VirtualMachine *, std::pair<std::chrono::steady_clock::time_point, int>> m_timeMap;
-
-        static IClock *clock;
+        std::unordered_map<VirtualMachine *, std::pair<std::chrono::steady_clock::time_point, int>> m_timeMap;
 };
 
 } // namespace libscratchcpp
@@ -35,6 +35,14 @@ void EventBlocks::registerBlocks(IEngine *engine)
     engine->addField(this, "BROADCAST_OPTION", BROADCAST_OPTION);
     engine->addField(this, "BACKDROP", BACKDROP);
     engine->addField(this, "KEY_OPTION", KEY_OPTION);
+
+    // Functions
+    engine->addFunction(this, &broadcastByIndex);
+    engine->addFunction(this, &broadcast);
+    engine->addFunction(this, &broadcastByIndexAndWait);
+    engine->addFunction(this, &checkBroadcastByIndex);
+    engine->addFunction(this, &broadcastAndWait);
+    engine->addFunction(this, &checkBroadcast);
 }
 
 void EventBlocks::compileBroadcast(Compiler *compiler)
@@ -10,12 +10,10 @@
 #include <scratchcpp/scratchconfiguration.h>
 
 #include "looksblocks.h"
-#include "../engine/internal/randomgenerator.h"
+#include "../engine/internal/irandomgenerator.h"
 
 using namespace libscratchcpp;
 
-IRandomGenerator *LooksBlocks::rng = nullptr;
-
 std::string LooksBlocks::name() const
 {
     return "Looks";
@@ -69,6 +67,55 @@ void LooksBlocks::registerBlocks(IEngine *engine)
     engine->addFieldValue(this, "back", Back);
     engine->addFieldValue(this, "forward", Forward);
     engine->addFieldValue(this, "backward", Backward);
+
+    // Functions
+    engine->addFunction(this, &show);
+    engine->addFunction(this, &hide);
+    engine->addFunction(this, &changeEffectBy);
+    engine->addFunction(this, &setEffectTo);
+    engine->addFunction(this, &clearGraphicEffects);
+    engine->addFunction(this, &changeSizeBy);
+    engine->addFunction(this, &setSizeTo);
+    engine->addFunction(this, &size);
+    engine->addFunction(this, &nextCostume);
+    engine->addFunction(this, &previousCostume);
+    engine->addFunction(this, &switchCostumeToByIndex);
+    engine->addFunction(this, &switchCostumeTo);
+    engine->addFunction(this, &nextBackdrop);
+    engine->addFunction(this, &previousBackdrop);
+    engine->addFunction(this, &randomBackdrop);
+    engine->addFunction(this, &switchBackdropToByIndex);
+    engine->addFunction(this, &switchBackdropTo);
+    engine->addFunction(this, &nextBackdropAndWait);
+    engine->addFunction(this, &previousBackdropAndWait);
+    engine->addFunction(this, &randomBackdropAndWait);
+    engine->addFunction(this, &switchBackdropToByIndexAndWait);
+    engine->addFunction(this, &switchBackdropToAndWait);
+    engine->addFunction(this, &checkBackdropScripts);
+    engine->addFunction(this, &goToFront);
+    engine->addFunction(this, &goToBack);
+    engine->addFunction(this, &goForwardLayers);
+    engine->addFunction(this, &goBackwardLayers);
+    engine->addFunction(this, &costumeNumber);
+    engine->addFunction(this, &costumeName);
+    engine->addFunction(this, &backdropNumber);
+    engine->addFunction(this, &backdropName);
+
+    // Target-local functions
+    engine->addTargetLocalFunction(&show);
+    engine->addTargetLocalFunction(&hide);
+    engine->addTargetLocalFunction(&changeEffectBy);
+    engine->addTargetLocalFunction(&setEffectTo);
+    engine->addTargetLocalFunction(&clearGraphicEffects);
+    engine->addTargetLocalFunction(&changeSizeBy);
+    engine->addTargetLocalFunction(&setSizeTo);
+    engine->addTargetLocalFunction(&size);
+    engine->addTargetLocalFunction(&switchCostumeToByIndex);
+    engine->addTargetLocalFunction(&switchCostumeTo);
+    engine->addTargetLocalFunction(&nextCostume);
+    engine->addTargetLocalFunction(&previousCostume);
+    engine->addTargetLocalFunction(&costumeNumber);
+    engine->addTargetLocalFunction(&costumeName);
 }
 
 void LooksBlocks::compileShow(Compiler *compiler)
@@ -83,167 +130,23 @@ void LooksBlocks::compileHide(Compiler *compiler)
 
 void LooksBlocks::compileChangeEffectBy(Compiler *compiler)
 {
-    int option = compiler->field(EFFECT)->specialValueId();
-
-    switch (option) {
-        case ColorEffect:
-            if (!m_colorEffect)
-                m_colorEffect = ScratchConfiguration::getGraphicsEffect("color");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeColorEffectBy);
-            break;
-
-        case FisheyeEffect:
-            if (!m_fisheyeEffect)
-                m_fisheyeEffect = ScratchConfiguration::getGraphicsEffect("fisheye");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeFisheyeEffectBy);
-            break;
-
-        case WhirlEffect:
-            if (!m_whirlEffect)
-                m_whirlEffect = ScratchConfiguration::getGraphicsEffect("whirl");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeWhirlEffectBy);
-            break;
-
-        case PixelateEffect:
-            if (!m_pixelateEffect)
-                m_pixelateEffect = ScratchConfiguration::getGraphicsEffect("pixelate");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changePixelateEffectBy);
-            break;
-
-        case MosaicEffect:
-            if (!m_mosaicEffect)
-                m_mosaicEffect = ScratchConfiguration::getGraphicsEffect("mosaic");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeMosaicEffectBy);
-            break;
-
-        case BrightnessEffect:
-            if (!m_brightnessEffect)
-                m_brightnessEffect = ScratchConfiguration::getGraphicsEffect("brightness");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeBrightnessEffectBy);
-            break;
+    int index = effectIndex(compiler);
 
-        case GhostEffect:
-            if (!m_ghostEffect)
-                m_ghostEffect = ScratchConfiguration::getGraphicsEffect("ghost");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&changeGhostEffectBy);
-            break;
-
-        default:
-            IGraphicsEffect *effect = ScratchConfiguration::getGraphicsEffect(compiler->field(EFFECT)->value().toString());
-
-            if (effect) {
-                auto it = std::find(m_customGraphicsEffects.begin(), m_customGraphicsEffects.end(), effect);
-                size_t index;
-
-                if (it == m_customGraphicsEffects.end()) {
-                    index = m_customGraphicsEffects.size();
-                    m_customGraphicsEffects.push_back(effect);
-                } else
-                    index = it - m_customGraphicsEffects.begin();
-
-                compiler->addConstValue(index);
-                compiler->addInput(CHANGE);
-                compiler->addFunctionCall(&changeEffectBy);
-            }
-
-            break;
+    if (index != -1) {
+        compiler->addConstValue(index);
+        compiler->addInput(CHANGE);
+        compiler->addFunctionCall(&changeEffectBy);
     }
 }
 
 void LooksBlocks::compileSetEffectTo(Compiler *compiler)
 {
-    int option = compiler->field(EFFECT)->specialValueId();
-
-    switch (option) {
-        case ColorEffect:
-            if (!m_colorEffect)
-                m_colorEffect = ScratchConfiguration::getGraphicsEffect("color");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setColorEffectTo);
-            break;
-
-        case FisheyeEffect:
-            if (!m_fisheyeEffect)
-                m_fisheyeEffect = ScratchConfiguration::getGraphicsEffect("fisheye");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setFisheyeEffectTo);
-            break;
-
-        case WhirlEffect:
-            if (!m_whirlEffect)
-                m_whirlEffect = ScratchConfiguration::getGraphicsEffect("whirl");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setWhirlEffectTo);
-            break;
-
-        case PixelateEffect:
-            if (!m_pixelateEffect)
-                m_pixelateEffect = ScratchConfiguration::getGraphicsEffect("pixelate");
+    int index = effectIndex(compiler);
 
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setPixelateEffectTo);
-            break;
-
-        case MosaicEffect:
-            if (!m_mosaicEffect)
-                m_mosaicEffect = ScratchConfiguration::getGraphicsEffect("mosaic");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setMosaicEffectTo);
-            break;
-
-        case BrightnessEffect:
-            if (!m_brightnessEffect)
-                m_brightnessEffect = ScratchConfiguration::getGraphicsEffect("brightness");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setBrightnessEffectTo);
-            break;
-
-        case GhostEffect:
-            if (!m_ghostEffect)
-                m_ghostEffect = ScratchConfiguration::getGraphicsEffect("ghost");
-
-            compiler->addInput(CHANGE);
-            compiler->addFunctionCall(&setGhostEffectTo);
-            break;
-
-        default:
-            IGraphicsEffect *effect = ScratchConfiguration::getGraphicsEffect(compiler->field(EFFECT)->value().toString());
-
-            if (effect) {
-                auto it = std::find(m_customGraphicsEffects.begin(), m_customGraphicsEffects.end(), effect);
-                size_t index;
-
-                if (it == m_customGraphicsEffects.end()) {
-                    index = m_customGraphicsEffects.size();
-                    m_customGraphicsEffects.push_back(effect);
-                } else
-                    index = it - m_customGraphicsEffects.begin();
-
-                compiler->addConstValue(index);
-                compiler->addInput(CHANGE);
-                compiler->addFunctionCall(&setEffectTo);
-            }
-
-            break;
+    if (index != -1) {
+        compiler->addConstValue(index);
+        compiler->addInput(CHANGE);
+        compiler->addFunctionCall(&setEffectTo);
     }
 }
 
@@ -483,161 +386,27 @@ unsigned int LooksBlocks::changeEffectBy(VirtualMachine *vm)
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
 
     if (sprite) {
-        IGraphicsEffect *effect = m_customGraphicsEffects[vm->getInput(0, 2)->toLong()];
-        sprite->setGraphicsEffectValue(effect, sprite->graphicsEffectValue(effect) + vm->getInput(1, 2)->toDouble());
+        IGraphicsEffect *effect = ScratchConfiguration::graphicsEffectAt(vm->getInput(0, 2)->toInt());
+
+        if (effect)
+            sprite->setGraphicsEffectValue(effect, sprite->graphicsEffectValue(effect) + vm->getInput(1, 2)->toDouble());
     }
 
     return 2;
 }
 
-unsigned int LooksBlocks::changeColorEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_colorEffect, sprite->graphicsEffectValue(m_colorEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changeFisheyeEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_fisheyeEffect, sprite->graphicsEffectValue(m_fisheyeEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changeWhirlEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_whirlEffect, sprite->graphicsEffectValue(m_whirlEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changePixelateEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_pixelateEffect, sprite->graphicsEffectValue(m_pixelateEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changeMosaicEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_mosaicEffect, sprite->graphicsEffectValue(m_mosaicEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changeBrightnessEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_brightnessEffect, sprite->graphicsEffectValue(m_brightnessEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::changeGhostEffectBy(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_ghostEffect, sprite->graphicsEffectValue(m_ghostEffect) + vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
 unsigned int LooksBlocks::setEffectTo(VirtualMachine *vm)
 {
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
 
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_customGraphicsEffects[vm->getInput(0, 2)->toLong()], vm->getInput(1, 2)->toDouble());
-
-    return 2;
-}
-
-unsigned int LooksBlocks::setColorEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_colorEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setFisheyeEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_fisheyeEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setWhirlEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_whirlEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setPixelateEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_pixelateEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setMosaicEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_mosaicEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setBrightnessEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_brightnessEffect, vm->getInput(0, 1)->toDouble());
-
-    return 1;
-}
-
-unsigned int LooksBlocks::setGhostEffectTo(VirtualMachine *vm)
-{
-    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
+    if (sprite) {
+        IGraphicsEffect *effect = ScratchConfiguration::graphicsEffectAt(vm->getInput(0, 2)->toInt());
 
-    if (sprite)
-        sprite->setGraphicsEffectValue(m_ghostEffect, vm->getInput(0, 1)->toDouble());
+        if (effect)
+            sprite->setGraphicsEffectValue(effect, vm->getInput(1, 2)->toDouble());
+    }
 
-    return 1;
+    return 2;
 }
 
 unsigned int LooksBlocks::clearGraphicEffects(VirtualMachine *vm)
@@ -800,14 +569,11 @@ void LooksBlocks::previousBackdropImpl(VirtualMachine *vm)
 
 void LooksBlocks::randomBackdropImpl(VirtualMachine *vm)
 {
-    if (!rng)
-        rng = RandomGenerator::instance().get();
-
     if (Stage *stage = vm->engine()->stage()) {
         std::size_t count = stage->costumes().size();
 
         if (count > 0)
-            stage->setCostumeIndex(rng->randint(0, count - 1));
+            stage->setCostumeIndex(vm->engine()->randomGenerator()->randint(0, count - 1));
     }
 }
 
@@ -990,3 +756,33 @@ unsigned int LooksBlocks::backdropName(VirtualMachine *vm)
 
     return 0;
 }
+
+// Returns the index of the graphics effect selected in the EFFECT field (see ScratchConfiguration::findGraphicsEffect())
+int LooksBlocks::effectIndex(Compiler *compiler)
+{
+    switch (compiler->field(EFFECT)->specialValueId()) {
+        case ColorEffect:
+            return ScratchConfiguration::findGraphicsEffect("color");
+
+        case FisheyeEffect:
+            return ScratchConfiguration::findGraphicsEffect("fisheye");
+
+        case WhirlEffect:
+            return ScratchConfiguration::findGraphicsEffect("whirl");
+
+        case PixelateEffect:
+            return ScratchConfiguration::findGraphicsEffect("pixelate");
+
+        case MosaicEffect:
+            return ScratchConfiguration::findGraphicsEffect("mosaic");
+
+        case BrightnessEffect:
+            return ScratchConfiguration::findGraphicsEffect("brightness");
+
+        case GhostEffect:
+            return ScratchConfiguration::findGraphicsEffect("ghost");
+
+        default:
+            return ScratchConfiguration::findGraphicsEffect(compiler->field(EFFECT)->value().toString());
+    }
+}
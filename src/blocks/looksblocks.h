@@ -3,7 +3,6 @@
 #pragma once
 
 #include <scratchcpp/iblocksection.h>
-#include <vector>
 
 namespace libscratchcpp
 {
@@ -11,8 +10,6 @@ namespace libscratchcpp
 class Target;
 class Stage;
 class Value;
-class IGraphicsEffect;
-class IRandomGenerator;
 
 /*! \brief The LooksBlocks class contains the implementation of looks blocks. */
 class LooksBlocks : public IBlockSection
@@ -79,22 +76,7 @@ class LooksBlocks : public IBlockSection
         static unsigned int hide(VirtualMachine *vm);
 
         static unsigned int changeEffectBy(VirtualMachine *vm);
-        static unsigned int changeColorEffectBy(VirtualMachine *vm);
-        static unsigned int changeFisheyeEffectBy(VirtualMachine *vm);
-        static unsigned int changeWhirlEffectBy(VirtualMachine *vm);
-        static unsigned int changePixelateEffectBy(VirtualMachine *vm);
-        static unsigned int changeMosaicEffectBy(VirtualMachine *vm);
-        static unsigned int changeBrightnessEffectBy(VirtualMachine *vm);
-        static unsigned int changeGhostEffectBy(VirtualMachine *vm);
-
         static unsigned int setEffectTo(VirtualMachine *vm);
-        static unsigned int setColorEffectTo(VirtualMachine *vm);
-        static unsigned int setFisheyeEffectTo(VirtualMachine *vm);
-        static unsigned int setWhirlEffectTo(VirtualMachine *vm);
-        static unsigned int setPixelateEffectTo(VirtualMachine *vm);
-        static unsigned int setMosaicEffectTo(VirtualMachine *vm);
-        static unsigned int setBrightnessEffectTo(VirtualMachine *vm);
-        static unsigned int setGhostEffectTo(VirtualMachine *vm);
 
         static unsigned int clearGraphicEffects(VirtualMachine *vm);
         static unsigned int changeSizeBy(VirtualMachine *vm);
@@ -137,16 +119,8 @@ class LooksBlocks : public IBlockSection
         static unsigned int backdropNumber(VirtualMachine *vm);
         static unsigned int backdropName(VirtualMachine *vm);
 
-        static inline std::vector<IGraphicsEffect *> m_customGraphicsEffects;
-        static inline IGraphicsEffect *m_colorEffect = nullptr;
-        static inline IGraphicsEffect *m_fisheyeEffect = nullptr;
-        static inline IGraphicsEffect *m_whirlEffect = nullptr;
-        static inline IGraphicsEffect *m_pixelateEffect = nullptr;
-        static inline IGraphicsEffect *m_mosaicEffect = nullptr;
-        static inline IGraphicsEffect *m_brightnessEffect = nullptr;
-        static inline IGraphicsEffect *m_ghostEffect = nullptr;
-
-        static IRandomGenerator *rng;
+    private:
+        static int effectIndex(Compiler *compiler);
 };
 
 } // namespace libscratchcpp
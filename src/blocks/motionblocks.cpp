@@ -8,16 +8,14 @@
 #include <scratchcpp/rect.h>
 
 #include "motionblocks.h"
-#include "../engine/internal/randomgenerator.h"
-#include "../engine/internal/clock.h"
+#include "sectionindex.h"
+#include "../engine/internal/irandomgenerator.h"
+#include "../engine/internal/iclock.h"
 
 using namespace libscratchcpp;
 
 static const double pi = std::acos(-1); // TODO: Use std::numbers::pi in C++20
 
-IRandomGenerator *MotionBlocks::rng = nullptr;
-IClock *MotionBlocks::clock = nullptr;
-
 std::string MotionBlocks::name() const
 {
     return "Motion";
@@ -64,6 +62,56 @@ void MotionBlocks::registerBlocks(IEngine *engine)
     engine->addFieldValue(this, "left-right", LeftRight);
     engine->addFieldValue(this, "don't rotate", DoNotRotate);
     engine->addFieldValue(this, "all around", AllAround);
+
+    // Functions
+    engine->addFunction(this, &moveSteps);
+    engine->addFunction(this, &turnRight);
+    engine->addFunction(this, &turnLeft);
+    engine->addFunction(this, &pointInDirection);
+    engine->addFunction(this, &pointTowardsMousePointer);
+    engine->addFunction(this, &pointTowardsRandomPosition);
+    engine->addFunction(this, &pointTowardsByIndex);
+    engine->addFunction(this, &pointTowards);
+    engine->addFunction(this, &goToXY);
+    engine->addFunction(this, &goToMousePointer);
+    engine->addFunction(this, &goToRandomPosition);
+    engine->addFunction(this, &goToByIndex);
+    engine->addFunction(this, &goTo);
+    engine->addFunction(this, &startGlideSecsTo);
+    engine->addFunction(this, &glideSecsTo);
+    engine->addFunction(this, &startGlideToMousePointer);
+    engine->addFunction(this, &startGlideToRandomPosition);
+    engine->addFunction(this, &startGlideToByIndex);
+    engine->addFunction(this, &startGlideTo);
+    engine->addFunction(this, &changeXBy);
+    engine->addFunction(this, &setX);
+    engine->addFunction(this, &changeYBy);
+    engine->addFunction(this, &setY);
+    engine->addFunction(this, &ifOnEdgeBounce);
+    engine->addFunction(this, &setLeftRightRotationStyle);
+    engine->addFunction(this, &setDoNotRotateRotationStyle);
+    engine->addFunction(this, &setAllAroundRotationStyle);
+    engine->addFunction(this, &xPosition);
+    engine->addFunction(this, &yPosition);
+    engine->addFunction(this, &direction);
+
+    // Target-local functions
+    engine->addTargetLocalFunction(&moveSteps);
+    engine->addTargetLocalFunction(&turnRight);
+    engine->addTargetLocalFunction(&turnLeft);
+    engine->addTargetLocalFunction(&pointInDirection);
+    engine->addTargetLocalFunction(&goToXY);
+    engine->addTargetLocalFunction(&changeXBy);
+    engine->addTargetLocalFunction(&setX);
+    engine->addTargetLocalFunction(&changeYBy);
+    engine->addTargetLocalFunction(&setY);
+    engine->addTargetLocalFunction(&ifOnEdgeBounce);
+    engine->addTargetLocalFunction(&setLeftRightRotationStyle);
+    engine->addTargetLocalFunction(&setDoNotRotateRotationStyle);
+    engine->addTargetLocalFunction(&setAllAroundRotationStyle);
+    engine->addTargetLocalFunction(&xPosition);
+    engine->addTargetLocalFunction(&yPosition);
+    engine->addTargetLocalFunction(&direction);
 }
 
 void MotionBlocks::compileMoveSteps(Compiler *compiler)
@@ -148,7 +196,9 @@ void MotionBlocks::compileGlideSecsToXY(Compiler *compiler)
     compiler->addInput(SECS);
     compiler->addInput(X);
     compiler->addInput(Y);
+    addSectionIndex(compiler, "Motion");
     compiler->addFunctionCall(&startGlideSecsTo);
+    addSectionIndex(compiler, "Motion");
     compiler->addFunctionCall(&glideSecsTo);
 }
 
@@ -162,20 +212,25 @@ void MotionBlocks::compileGlideTo(Compiler *compiler)
         assert(input->pointsToDropdownMenu());
         std::string value = input->selectedMenuItem();
 
-        if (value == "_mouse_")
+        if (value == "_mouse_") {
+            addSectionIndex(compiler, "Motion");
             compiler->addFunctionCall(&startGlideToMousePointer);
-        else if (value == "_random_")
+        } else if (value == "_random_") {
+            addSectionIndex(compiler, "Motion");
             compiler->addFunctionCall(&startGlideToRandomPosition);
-        else {
+        } else {
             int index = compiler->engine()->findTarget(value);
             compiler->addConstValue(index);
+            addSectionIndex(compiler, "Motion");
             compiler->addFunctionCall(&startGlideToByIndex);
         }
     } else {
         compiler->addInput(input);
+        addSectionIndex(compiler, "Motion");
         compiler->addFunctionCall(&startGlideTo);
     }
 
+    addSectionIndex(compiler, "Motion");
     compiler->addFunctionCall(&glideSecsTo);
 }
 
@@ -319,8 +374,7 @@ unsigned int MotionBlocks::pointTowards(VirtualMachine *vm)
         const unsigned int stageWidth = vm->engine()->stageWidth();
         const unsigned int stageHeight = vm->engine()->stageHeight();
 
-        if (!rng)
-            rng = RandomGenerator::instance().get();
+        IRandomGenerator *rng = vm->engine()->randomGenerator();
 
         pointTowardsPos(dynamic_cast<Sprite *>(vm->target()), rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2));
     } else {
@@ -356,8 +410,7 @@ unsigned int MotionBlocks::pointTowardsRandomPosition(VirtualMachine *vm)
     const unsigned int stageWidth = vm->engine()->stageWidth();
     const unsigned int stageHeight = vm->engine()->stageHeight();
 
-    if (!rng)
-        rng = RandomGenerator::instance().get();
+    IRandomGenerator *rng = vm->engine()->randomGenerator();
 
     pointTowardsPos(dynamic_cast<Sprite *>(vm->target()), rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2));
 
@@ -392,8 +445,7 @@ unsigned int MotionBlocks::goTo(VirtualMachine *vm)
         const unsigned int stageWidth = vm->engine()->stageWidth();
         const unsigned int stageHeight = vm->engine()->stageHeight();
 
-        if (!rng)
-            rng = RandomGenerator::instance().get();
+        IRandomGenerator *rng = vm->engine()->randomGenerator();
 
         sprite->setX(rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2));
         sprite->setY(rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2));
@@ -444,8 +496,7 @@ unsigned int MotionBlocks::goToRandomPosition(VirtualMachine *vm)
         const unsigned int stageWidth = vm->engine()->stageWidth();
         const unsigned int stageHeight = vm->engine()->stageHeight();
 
-        if (!rng)
-            rng = RandomGenerator::instance().get();
+        IRandomGenerator *rng = vm->engine()->randomGenerator();
 
         sprite->setX(rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2));
         sprite->setY(rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2));
@@ -470,27 +521,25 @@ void MotionBlocks::startGlidingToPos(VirtualMachine *vm, double x, double y, dou
         return;
     }
 
-    if (!clock)
-        clock = Clock::instance().get();
-
-    auto currentTime = clock->currentSteadyTime();
+    auto currentTime = vm->engine()->clock()->currentSteadyTime();
     m_timeMap[vm] = { currentTime, secs * 1000 };
     m_glideMap[vm] = { { sprite->x(), sprite->y() }, { x, y } };
 }
 
 void MotionBlocks::continueGliding(VirtualMachine *vm)
 {
-    if (!clock)
-        clock = Clock::instance().get();
+    auto timeIt = m_timeMap.find(vm);
+    auto glideIt = m_glideMap.find(vm);
+    assert(timeIt != m_timeMap.end());
+    assert(glideIt != m_glideMap.end());
 
-    auto currentTime = clock->currentSteadyTime();
-    auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - m_timeMap[vm].first).count();
-    auto maxTime = m_timeMap[vm].second;
-    assert(m_timeMap.count(vm) == 1);
+    auto currentTime = vm->engine()->clock()->currentSteadyTime();
+    auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - timeIt->second.first).count();
+    auto maxTime = timeIt->second.second;
 
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-    double x = m_glideMap[vm].second.first;
-    double y = m_glideMap[vm].second.second;
+    double x = glideIt->second.second.first;
+    double y = glideIt->second.second.second;
 
     if (elapsedTime >= maxTime) {
         if (sprite) {
@@ -498,12 +547,12 @@ void MotionBlocks::continueGliding(VirtualMachine *vm)
             sprite->setY(y);
         }
 
-        m_timeMap.erase(vm);
-        m_glideMap.erase(vm);
+        m_timeMap.erase(timeIt);
+        m_glideMap.erase(glideIt);
     } else {
         if (sprite) {
-            double startX = m_glideMap[vm].first.first;
-            double startY = m_glideMap[vm].first.second;
+            double startX = glideIt->second.first.first;
+            double startY = glideIt->second.first.second;
             double factor = elapsedTime / static_cast<double>(maxTime);
             assert(factor >= 0 && factor < 1);
 
@@ -517,18 +566,20 @@ void MotionBlocks::continueGliding(VirtualMachine *vm)
 
 unsigned int MotionBlocks::startGlideSecsTo(VirtualMachine *vm)
 {
-    startGlidingToPos(vm, vm->getInput(1, 3)->toDouble(), vm->getInput(2, 3)->toDouble(), vm->getInput(0, 3)->toDouble());
-    return 3;
+    sectionInput<MotionBlocks>(vm, 4)->startGlidingToPos(vm, vm->getInput(1, 4)->toDouble(), vm->getInput(2, 4)->toDouble(), vm->getInput(0, 4)->toDouble());
+    return 4;
 }
 
 unsigned int MotionBlocks::glideSecsTo(VirtualMachine *vm)
 {
-    if (m_timeMap.find(vm) != m_timeMap.cend()) {
-        assert(m_glideMap.find(vm) != m_glideMap.cend());
-        continueGliding(vm);
+    MotionBlocks *motion = sectionInput<MotionBlocks>(vm, 1);
+
+    if (motion->m_timeMap.find(vm) != motion->m_timeMap.cend()) {
+        assert(motion->m_glideMap.find(vm) != motion->m_glideMap.cend());
+        motion->continueGliding(vm);
     }
 
-    return 0;
+    return 1;
 }
 
 unsigned int MotionBlocks::startGlideTo(VirtualMachine *vm)
@@ -536,41 +587,41 @@ unsigned int MotionBlocks::startGlideTo(VirtualMachine *vm)
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
 
     if (!sprite)
-        return 1;
+        return 3;
 
-    std::string value = vm->getInput(1, 2)->toString();
+    MotionBlocks *motion = sectionInput<MotionBlocks>(vm, 3);
+    std::string value = vm->getInput(1, 3)->toString();
 
     if (value == "_mouse_")
-        startGlidingToPos(vm, vm->engine()->mouseX(), vm->engine()->mouseY(), vm->getInput(0, 2)->toDouble());
+        motion->startGlidingToPos(vm, vm->engine()->mouseX(), vm->engine()->mouseY(), vm->getInput(0, 3)->toDouble());
     else if (value == "_random_") {
         const unsigned int stageWidth = vm->engine()->stageWidth();
         const unsigned int stageHeight = vm->engine()->stageHeight();
 
-        if (!rng)
-            rng = RandomGenerator::instance().get();
+        IRandomGenerator *rng = vm->engine()->randomGenerator();
 
-        startGlidingToPos(vm, rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2), vm->getInput(0, 2)->toDouble());
+        motion->startGlidingToPos(vm, rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2), vm->getInput(0, 3)->toDouble());
     } else {
         Target *target = vm->engine()->targetAt(vm->engine()->findTarget(value));
         Sprite *targetSprite = dynamic_cast<Sprite *>(target);
 
         if (targetSprite)
-            startGlidingToPos(vm, targetSprite->x(), targetSprite->y(), vm->getInput(0, 2)->toDouble());
+            motion->startGlidingToPos(vm, targetSprite->x(), targetSprite->y(), vm->getInput(0, 3)->toDouble());
     }
 
-    return 2;
+    return 3;
 }
 
 unsigned int MotionBlocks::startGlideToByIndex(VirtualMachine *vm)
 {
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
-    Target *target = vm->engine()->targetAt(vm->getInput(1, 2)->toInt());
+    Target *target = vm->engine()->targetAt(vm->getInput(1, 3)->toInt());
     Sprite *targetSprite = dynamic_cast<Sprite *>(target);
 
     if (sprite && targetSprite)
-        startGlidingToPos(vm, targetSprite->x(), targetSprite->y(), vm->getInput(0, 2)->toDouble());
+        sectionInput<MotionBlocks>(vm, 3)->startGlidingToPos(vm, targetSprite->x(), targetSprite->y(), vm->getInput(0, 3)->toDouble());
 
-    return 2;
+    return 3;
 }
 
 unsigned int MotionBlocks::startGlideToMousePointer(VirtualMachine *vm)
@@ -578,9 +629,9 @@ unsigned int MotionBlocks::startGlideToMousePointer(VirtualMachine *vm)
     Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
 
     if (sprite)
-        startGlidingToPos(vm, vm->engine()->mouseX(), vm->engine()->mouseY(), vm->getInput(0, 1)->toDouble());
+        sectionInput<MotionBlocks>(vm, 2)->startGlidingToPos(vm, vm->engine()->mouseX(), vm->engine()->mouseY(), vm->getInput(0, 2)->toDouble());
 
-    return 1;
+    return 2;
 }
 
 unsigned int MotionBlocks::startGlideToRandomPosition(VirtualMachine *vm)
@@ -591,13 +642,12 @@ unsigned int MotionBlocks::startGlideToRandomPosition(VirtualMachine *vm)
         const unsigned int stageWidth = vm->engine()->stageWidth();
         const unsigned int stageHeight = vm->engine()->stageHeight();
 
-        if (!rng)
-            rng = RandomGenerator::instance().get();
+        IRandomGenerator *rng = vm->engine()->randomGenerator();
 
-        startGlidingToPos(vm, rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2), vm->getInput(0, 1)->toDouble());
+        sectionInput<MotionBlocks>(vm, 2)->startGlidingToPos(vm, rng->randint(-static_cast<int>(stageWidth / 2), stageWidth / 2), rng->randint(-static_cast<int>(stageHeight / 2), stageHeight / 2), vm->getInput(0, 2)->toDouble());
     }
 
-    return 1;
+    return 2;
 }
 
 unsigned int MotionBlocks::changeXBy(VirtualMachine *vm)
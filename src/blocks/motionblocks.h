@@ -11,8 +11,6 @@ namespace libscratchcpp
 {
 
 class Sprite;
-class IRandomGenerator;
-class IClock;
 
 /*! \brief The MotionBlocks class contains the implementation of motion blocks. */
 class MotionBlocks : public IBlockSection
@@ -85,8 +83,8 @@ class MotionBlocks : public IBlockSection
         static unsigned int goToMousePointer(VirtualMachine *vm);
         static unsigned int goToRandomPosition(VirtualMachine *vm);
 
-        static void startGlidingToPos(VirtualMachine *vm, double x, double y, double secs);
-        static void continueGliding(VirtualMachine *vm);
+        void startGlidingToPos(VirtualMachine *vm, double x, double y, double secs);
+        void continueGliding(VirtualMachine *vm);
 
         static unsigned int startGlideSecsTo(VirtualMachine *vm);
         static unsigned int glideSecsTo(VirtualMachine *vm);
@@ -110,11 +108,8 @@ class MotionBlocks : public IBlockSection
         static unsigned int yPosition(VirtualMachine *vm);
         static unsigned int direction(VirtualMachine *vm);
 
-        static IRandomGenerator *rng;
-        static IClock *clock;
-
-        static inline std::unordered_map<VirtualMachine *, std::pair<std::chrono::steady_clock::time_point, int>> m_timeMap;
-        static inline std::unordered_map<VirtualMachine *, std::pair<std::pair<double, double>, std::pair<double, double>>> m_glideMap; // start pos, end pos
+        std::unordered_map<VirtualMachine *, std::pair<std::chrono::steady_clock::time_point, int>> m_timeMap;
+        std::unordered_map<VirtualMachine *, std::pair<std::pair<double, double>, std::pair<double, double>>> m_glideMap; // start pos, end pos
 };
 
 } // namespace libscratchcpp
@@ -67,6 +67,18 @@ void OperatorBlocks::registerBlocks(IEngine *engine)
     engine->addFieldValue(this, "log", Log);
     engine->addFieldValue(this, "e ^", Eexp);
     engine->addFieldValue(this, "10 ^", Op_10exp);
+
+    // Functions
+    engine->addFunction(this, &op_ln);
+    engine->addFunction(this, &op_log);
+    engine->addFunction(this, &op_eexp);
+    engine->addFunction(this, &op_10exp);
+
+    // Target-local functions
+    engine->addTargetLocalFunction(&op_ln);
+    engine->addTargetLocalFunction(&op_log);
+    engine->addTargetLocalFunction(&op_eexp);
+    engine->addTargetLocalFunction(&op_10exp);
 }
 
 void OperatorBlocks::compileAdd(Compiler *compiler)
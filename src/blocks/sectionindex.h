@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <scratchcpp/iengine.h>
+#include <scratchcpp/compiler.h>
+#include <cassert>
+
+namespace libscratchcpp
+{
+
+// Block sections which keep per-engine state are resolved at compile time:
+// the index of the section in the engine is added as the last input of the block function.
+
+inline void addSectionIndex(Compiler *compiler, const std::string &name)
+{
+    int index = compiler->engine()->findSection(name);
+    assert(index != -1);
+    compiler->addConstValue(index);
+}
+
+template<class T>
+T *sectionInput(VirtualMachine *vm, unsigned int argCount)
+{
+    IBlockSection *section = vm->engine()->sectionAt(vm->getInput(argCount - 1, argCount)->toInt());
+    assert(dynamic_cast<T *>(section));
+    return static_cast<T *>(section);
+}
+
+} // namespace libscratchcpp
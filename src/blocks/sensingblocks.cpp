@@ -10,14 +10,13 @@
 #include <scratchcpp/stage.h>
 #include <scratchcpp/costume.h>
 #include <scratchcpp/variable.h>
+#include <scratchcpp/inlinecache.h>
 #include "sensingblocks.h"
 
-#include "../engine/internal/clock.h"
+#include "../engine/internal/iclock.h"
 
 using namespace libscratchcpp;
 
-IClock *SensingBlocks::clock = nullptr;
-
 std::string SensingBlocks::name() const
 {
     return "Sensing";
@@ -26,6 +25,7 @@ std::string SensingBlocks::name() const
 void SensingBlocks::registerBlocks(IEngine *engine)
 {
     // Blocks
+    engine->addCompileFunction(this, "sensing_touchingobject", &compileTouchingObject);
     engine->addCompileFunction(this, "sensing_distanceto", &compileDistanceTo);
     engine->addCompileFunction(this, "sensing_keypressed", &compileKeyPressed);
     engine->addCompileFunction(this, "sensing_mousedown", &compileMouseDown);
@@ -39,6 +39,7 @@ void SensingBlocks::registerBlocks(IEngine *engine)
     engine->addCompileFunction(this, "sensing_dayssince2000", &compileDaysSince2000);
 
     // Inputs
+    engine->addInput(this, "TOUCHINGOBJECTMENU", TOUCHINGOBJECTMENU);
     engine->addInput(this, "DISTANCETOMENU", DISTANCETOMENU);
     engine->addInput(this, "KEY_OPTION", KEY_OPTION);
     engine->addInput(this, "OBJECT", OBJECT);
@@ -68,6 +69,73 @@ void SensingBlocks::registerBlocks(IEngine *engine)
     engine->addFieldValue(this, "background #", BackdropNumber); // Scratch 1.4 support
     engine->addFieldValue(this, "backdrop #", BackdropNumber);
     engine->addFieldValue(this, "backdrop name", BackdropName);
+
+    // Functions
+    engine->addFunction(this, &touchingMousePointer);
+    engine->addFunction(this, &touchingEdge);
+    engine->addFunction(this, &touchingObjectByIndex);
+    engine->addFunction(this, &touchingObject);
+    engine->addFunction(this, &distanceToMousePointer);
+    engine->addFunction(this, &distanceToByIndex);
+    engine->addFunction(this, &distanceTo);
+    engine->addFunction(this, &keyPressed);
+    engine->addFunction(this, &mouseDown);
+    engine->addFunction(this, &mouseX);
+    engine->addFunction(this, &mouseY);
+    engine->addFunction(this, &setDraggableMode);
+    engine->addFunction(this, &setNotDraggableMode);
+    engine->addFunction(this, &timer);
+    engine->addFunction(this, &resetTimer);
+    engine->addFunction(this, &xPositionOfSpriteByIndex);
+    engine->addFunction(this, &yPositionOfSpriteByIndex);
+    engine->addFunction(this, &directionOfSpriteByIndex);
+    engine->addFunction(this, &costumeNumberOfSpriteByIndex);
+    engine->addFunction(this, &costumeNameOfSpriteByIndex);
+    engine->addFunction(this, &sizeOfSpriteByIndex);
+    engine->addFunction(this, &volumeOfTargetByIndex);
+    engine->addFunction(this, &backdropNumberOfStageByIndex);
+    engine->addFunction(this, &backdropNameOfStageByIndex);
+    engine->addFunction(this, &xPositionOfSprite);
+    engine->addFunction(this, &yPositionOfSprite);
+    engine->addFunction(this, &directionOfSprite);
+    engine->addFunction(this, &costumeNumberOfSprite);
+    engine->addFunction(this, &costumeNameOfSprite);
+    engine->addFunction(this, &sizeOfSprite);
+    engine->addFunction(this, &volumeOfTarget);
+    engine->addFunction(this, &backdropNumberOfStage);
+    engine->addFunction(this, &backdropNameOfStage);
+    engine->addFunction(this, &variableOfTarget);
+    engine->addFunction(this, &currentYear);
+    engine->addFunction(this, &currentMonth);
+    engine->addFunction(this, &currentDate);
+    engine->addFunction(this, &currentDayOfWeek);
+    engine->addFunction(this, &currentHour);
+    engine->addFunction(this, &currentMinute);
+    engine->addFunction(this, &currentSecond);
+    engine->addFunction(this, &daysSince2000);
+}
+
+void SensingBlocks::compileTouchingObject(Compiler *compiler)
+{
+    Input *input = compiler->input(TOUCHINGOBJECTMENU);
+
+    if (input->type() != Input::Type::ObscuredShadow) {
+        assert(input->pointsToDropdownMenu());
+        std::string value = input->selectedMenuItem();
+
+        if (value == "_mouse_")
+            compiler->addFunctionCall(&touchingMousePointer);
+        else if (value == "_edge_")
+            compiler->addFunctionCall(&touchingEdge);
+        else {
+            int index = compiler->engine()->findTarget(value);
+            compiler->addConstValue(index);
+            compiler->addFunctionCall(&touchingObjectByIndex);
+        }
+    } else {
+        compiler->addInput(input);
+        compiler->addFunctionCall(&touchingObject);
+    }
 }
 
 void SensingBlocks::compileDistanceTo(Compiler *compiler)
@@ -87,7 +155,7 @@ void SensingBlocks::compileDistanceTo(Compiler *compiler)
         }
     } else {
         compiler->addInput(input);
-        compiler->addFunctionCall(&distanceTo);
+        compiler->addFunctionCallWithInlineCache(&distanceTo);
     }
 }
 
@@ -148,6 +216,7 @@ void SensingBlocks::compileOf(Compiler *compiler)
     Input *input = compiler->input(OBJECT);
     assert(input);
     BlockFunc f = nullptr;
+    bool inlineCache = false; // whether the function resolves the target name using the inline cache
 
     if (input->type() != Input::Type::ObscuredShadow) {
         assert(input->pointsToDropdownMenu());
@@ -219,6 +288,7 @@ void SensingBlocks::compileOf(Compiler *compiler)
         switch (option) {
             case XPosition:
                 f = &xPositionOfSprite;
+                inlineCache = true;
                 break;
 
             case YPosition:
@@ -255,6 +325,7 @@ void SensingBlocks::compileOf(Compiler *compiler)
 
             default:
                 f = &variableOfTarget;
+                inlineCache = true;
                 compiler->addConstValue(property->value().toString());
                 break;
         }
@@ -263,7 +334,9 @@ void SensingBlocks::compileOf(Compiler *compiler)
             compiler->addInput(input);
     }
 
-    if (f)
+    if (f && inlineCache)
+        compiler->addFunctionCallWithInlineCache(f);
+    else if (f)
         compiler->addFunctionCall(f);
 }
 
@@ -310,6 +383,52 @@ void SensingBlocks::compileDaysSince2000(Compiler *compiler)
     compiler->addFunctionCall(&daysSince2000);
 }
 
+unsigned int SensingBlocks::touchingObject(VirtualMachine *vm)
+{
+    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
+    std::string value = vm->getInput(0, 1)->toString();
+    bool touching = false;
+
+    if (sprite) {
+        if (value == "_mouse_")
+            touching = sprite->touchingPoint(vm->engine()->mouseX(), vm->engine()->mouseY());
+        else if (value == "_edge_")
+            touching = sprite->touchingEdge();
+        else {
+            Target *target = vm->engine()->targetAt(vm->engine()->findTarget(value));
+            Sprite *targetSprite = dynamic_cast<Sprite *>(target);
+            touching = targetSprite && sprite->touchingSprite(targetSprite);
+        }
+    }
+
+    vm->replaceReturnValue(touching, 1);
+    return 0;
+}
+
+unsigned int SensingBlocks::touchingObjectByIndex(VirtualMachine *vm)
+{
+    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
+    Target *target = vm->engine()->targetAt(vm->getInput(0, 1)->toInt());
+    Sprite *targetSprite = dynamic_cast<Sprite *>(target);
+
+    vm->replaceReturnValue(sprite && targetSprite && sprite->touchingSprite(targetSprite), 1);
+    return 0;
+}
+
+unsigned int SensingBlocks::touchingMousePointer(VirtualMachine *vm)
+{
+    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
+    vm->addReturnValue(sprite && sprite->touchingPoint(vm->engine()->mouseX(), vm->engine()->mouseY()));
+    return 0;
+}
+
+unsigned int SensingBlocks::touchingEdge(VirtualMachine *vm)
+{
+    Sprite *sprite = dynamic_cast<Sprite *>(vm->target());
+    vm->addReturnValue(sprite && sprite->touchingEdge());
+    return 0;
+}
+
 unsigned int SensingBlocks::keyPressed(VirtualMachine *vm)
 {
     vm->replaceReturnValue(vm->engine()->keyPressed(vm->getInput(0, 1)->toString()), 1);
@@ -364,8 +483,12 @@ unsigned int SensingBlocks::distanceTo(VirtualMachine *vm)
     if (value == "_mouse_")
         vm->replaceReturnValue(std::sqrt(std::pow(sprite->x() - vm->engine()->mouseX(), 2) + std::pow(sprite->y() - vm->engine()->mouseY(), 2)), 1);
     else {
-        Target *target = vm->engine()->targetAt(vm->engine()->findTarget(value));
-        Sprite *targetSprite = dynamic_cast<Sprite *>(target);
+        InlineCache &cache = vm->inlineCache();
+
+        if (!cache.matches(value))
+            cache.store(value, vm->engine()->targetAt(vm->engine()->findTarget(value)));
+
+        Sprite *targetSprite = dynamic_cast<Sprite *>(cache.target());
 
         if (targetSprite)
             vm->replaceReturnValue(std::sqrt(std::pow(sprite->x() - targetSprite->x(), 2) + std::pow(sprite->y() - targetSprite->y(), 2)), 1);
@@ -416,8 +539,13 @@ unsigned int SensingBlocks::resetTimer(VirtualMachine *vm)
 
 unsigned int SensingBlocks::xPositionOfSprite(VirtualMachine *vm)
 {
-    Target *target = vm->engine()->targetAt(vm->engine()->findTarget(vm->getInput(0, 1)->toString()));
-    Sprite *sprite = dynamic_cast<Sprite *>(target);
+    std::string name = vm->getInput(0, 1)->toString();
+    InlineCache &cache = vm->inlineCache();
+
+    if (!cache.matches(name))
+        cache.store(name, vm->engine()->targetAt(vm->engine()->findTarget(name)));
+
+    Sprite *sprite = dynamic_cast<Sprite *>(cache.target());
 
     if (sprite)
         vm->replaceReturnValue(sprite->x(), 1);
@@ -596,16 +724,27 @@ unsigned int SensingBlocks::volumeOfTargetByIndex(VirtualMachine *vm)
 
 unsigned int SensingBlocks::variableOfTarget(VirtualMachine *vm)
 {
-    Target *target = vm->engine()->targetAt(vm->engine()->findTarget(vm->getInput(1, 2)->toString()));
+    std::string varName = vm->getInput(0, 2)->toString();
+    std::string targetName = vm->getInput(1, 2)->toString();
+    InlineCache &cache = vm->inlineCache();
 
-    if (target) {
-        auto varIndex = target->findVariable(vm->getInput(0, 2)->toString());
+    if (!cache.matches(varName, targetName)) {
+        Target *target = vm->engine()->targetAt(vm->engine()->findTarget(targetName));
+        Variable *variable = nullptr;
 
-        if (varIndex == -1)
-            vm->replaceReturnValue(0, 2);
-        else
-            vm->replaceReturnValue(target->variableAt(varIndex)->value(), 2);
-    } else
+        if (target) {
+            auto varIndex = target->findVariable(varName);
+
+            if (varIndex != -1)
+                variable = target->variableAt(varIndex).get();
+        }
+
+        cache.store(varName, targetName, target, variable);
+    }
+
+    if (Variable *variable = cache.variable())
+        vm->replaceReturnValue(variable->value(), 2);
+    else
         vm->replaceReturnValue(0, 2);
 
     return 1;
@@ -665,74 +804,77 @@ unsigned int SensingBlocks::backdropNameOfStageByIndex(VirtualMachine *vm)
 
 unsigned int SensingBlocks::currentYear(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_year + 1900);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_year + 1900);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentMonth(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_mon + 1);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_mon + 1);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentDate(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_mday);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_mday);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentDayOfWeek(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_wday + 1);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_wday + 1);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentHour(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_hour);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_hour);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentMinute(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_min);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_min);
 
     return 0;
 }
 
 unsigned int SensingBlocks::currentSecond(VirtualMachine *vm)
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    vm->addReturnValue(ltm->tm_sec);
+    tm ltm = currentLocalTime(vm);
+    vm->addReturnValue(ltm.tm_sec);
 
     return 0;
 }
 
 unsigned int SensingBlocks::daysSince2000(VirtualMachine *vm)
 {
-    if (!clock)
-        clock = Clock::instance().get();
-
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock->currentSystemTime().time_since_epoch()).count();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(vm->engine()->clock()->currentSystemTime().time_since_epoch()).count();
     vm->addReturnValue(ms / 86400000.0 - 10957);
 
     return 0;
 }
+
+tm SensingBlocks::currentLocalTime(VirtualMachine *vm)
+{
+    // localtime() returns a shared buffer, so use the reentrant variants (scripts of other engines may run in parallel)
+    time_t now = std::chrono::system_clock::to_time_t(vm->engine()->clock()->currentSystemTime());
+    tm ret;
+#ifdef _WIN32
+    localtime_s(&ret, &now);
+#else
+    localtime_r(&now, &ret);
+#endif
+    return ret;
+}
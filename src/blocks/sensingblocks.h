@@ -3,7 +3,7 @@
 #pragma once
 
 #include <scratchcpp/iblocksection.h>
-#include "../engine/internal/clock.h"
+#include <ctime>
 
 namespace libscratchcpp
 {
@@ -14,6 +14,7 @@ class SensingBlocks : public IBlockSection
     public:
         enum Inputs
         {
+            TOUCHINGOBJECTMENU,
             DISTANCETOMENU,
             KEY_OPTION,
             OBJECT
@@ -52,6 +53,7 @@ class SensingBlocks : public IBlockSection
 
         void registerBlocks(IEngine *engine) override;
 
+        static void compileTouchingObject(Compiler *compiler);
         static void compileDistanceTo(Compiler *compiler);
         static void compileKeyPressed(Compiler *compiler);
         static void compileMouseDown(Compiler *compiler);
@@ -64,6 +66,11 @@ class SensingBlocks : public IBlockSection
         static void compileCurrent(Compiler *compiler);
         static void compileDaysSince2000(Compiler *compiler);
 
+        static unsigned int touchingObject(VirtualMachine *vm);
+        static unsigned int touchingObjectByIndex(VirtualMachine *vm);
+        static unsigned int touchingMousePointer(VirtualMachine *vm);
+        static unsigned int touchingEdge(VirtualMachine *vm);
+
         static unsigned int keyPressed(VirtualMachine *vm);
         static unsigned int mouseDown(VirtualMachine *vm);
         static unsigned int mouseX(VirtualMachine *vm);
@@ -108,7 +115,8 @@ class SensingBlocks : public IBlockSection
         static unsigned int currentSecond(VirtualMachine *vm);
         static unsigned int daysSince2000(VirtualMachine *vm);
 
-        static IClock *clock;
+    private:
+        static tm currentLocalTime(VirtualMachine *vm);
 };
 
 } // namespace libscratchcpp
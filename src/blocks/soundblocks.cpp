@@ -22,6 +22,11 @@ void SoundBlocks::registerBlocks(IEngine *engine)
 
     // Inputs
     engine->addInput(this, "VOLUME", VOLUME);
+
+    // Functions
+    engine->addFunction(this, &changeVolumeBy);
+    engine->addFunction(this, &setVolumeTo);
+    engine->addFunction(this, &volume);
 }
 
 void SoundBlocks::compileChangeVolumeBy(Compiler *compiler)
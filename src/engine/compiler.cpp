@@ -6,7 +6,6 @@
 #include <scratchcpp/block.h>
 #include <scratchcpp/variable.h>
 #include <scratchcpp/list.h>
-#include <iostream>
 
 #include "compiler_p.h"
 
@@ -47,7 +46,7 @@ void Compiler::compile(std::shared_ptr<Block> topLevelBlock)
         if (impl->block->compileFunction())
             impl->block->compile(this);
         else
-            std::cout << "warning: unsupported block: " << impl->block->opcode() << std::endl;
+            impl->warn("unsupported block: " + impl->block->opcode());
 
         if (substacks != impl->substackTree.size())
             continue;
@@ -161,7 +160,7 @@ void Compiler::addInput(Input *input)
             if (impl->block->compileFunction())
                 impl->block->compile(this);
             else {
-                std::cout << "warning: unsupported reporter block: " << impl->block->opcode() << std::endl;
+                impl->warn("unsupported reporter block: " + impl->block->opcode());
                 addInstruction(OP_NULL);
             }
             impl->block = previousBlock;
@@ -175,7 +174,7 @@ void Compiler::addInput(Input *input)
                 if (impl->block->compileFunction())
                     impl->block->compile(this);
                 else {
-                    std::cout << "warning: unsupported reporter block: " << impl->block->opcode() << std::endl;
+                    impl->warn("unsupported reporter block: " + impl->block->opcode());
                     addInstruction(OP_NULL);
                 }
             } else
@@ -206,6 +205,16 @@ void Compiler::addFunctionCall(BlockFunc f)
     addInstruction(OP_EXEC, { impl->engine->functionIndex(f) });
 }
 
+/*!
+ * Adds a function call with its own inline cache to the bytecode (the OP_EXEC_CACHED instruction).
+ * Use this for functions which resolve names using VirtualMachine::inlineCache().
+ * \note The cache slots are unique among the scripts compiled by one compiler (e.g. all scripts of a target).
+ */
+void Compiler::addFunctionCallWithInlineCache(BlockFunc f)
+{
+    addInstruction(OP_EXEC_CACHED, { impl->engine->functionIndex(f), impl->inlineCacheCount++ });
+}
+
 /*! Adds an argument to a procedure (custom block). */
 void Compiler::addProcedureArg(const std::string &procCode, const std::string &argName)
 {
@@ -302,14 +311,14 @@ unsigned int Compiler::procedureIndex(const std::string &proc)
 long Compiler::procedureArgIndex(const std::string &procCode, const std::string &argName)
 {
     if (impl->procedureArgs.count(procCode) == 0) {
-        std::cout << "warning: could not find custom block '" << procCode << "'" << std::endl;
+        impl->warn("could not find custom block '" + procCode + "'");
         return -1;
     }
     const std::vector<std::string> args = impl->procedureArgs[procCode];
     auto it = std::find(args.begin(), args.end(), argName);
     if (it != args.end())
         return it - args.begin();
-    std::cout << "warning: could not find argument '" << argName << "' in custom block '" << procCode << "'" << std::endl;
+    impl->warn("could not find argument '" + argName + "' in custom block '" + procCode + "'");
     return -1;
 }
 
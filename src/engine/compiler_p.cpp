@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <scratchcpp/iengine.h>
 #include <scratchcpp/block.h>
+#include <iostream>
 
 #include "compiler_p.h"
 
@@ -64,3 +66,11 @@ void CompilerPrivate::substackEnd()
     if (!block && !substackTree.empty())
         substackEnd();
 }
+
+void CompilerPrivate::warn(const std::string &message) const
+{
+    if (log)
+        *log += "warning: " + message + "\n";
+    else if (engine->loggingEnabled())
+        std::cout << "warning: " << message << std::endl;
+}
@@ -20,6 +20,8 @@ struct CompilerPrivate
 
         void substackEnd();
 
+        void warn(const std::string &message) const;
+
         IEngine *engine = nullptr;
         Target *target = nullptr;
         std::shared_ptr<Block> block;
@@ -33,10 +35,12 @@ struct CompilerPrivate
         std::unordered_map<InputValue *, std::pair<bool, std::string>> constValueMenuInfo; // input value, <whether the input points to a dropdown menu, selected menu item>
         std::vector<Variable *> variables;
         std::vector<List *> lists;
+        unsigned int inlineCacheCount = 0;
         std::vector<std::string> procedures;
         std::unordered_map<std::string, std::vector<std::string>> procedureArgs;
         BlockPrototype *procedurePrototype = nullptr;
         bool warp = false;
+        std::string *log = nullptr; // if set, warnings are added to it instead of being printed
 };
 
 } // namespace libscratchcpp
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/inlinecache.h>
+
+#include "inlinecache_p.h"
+#include "../internal/nameindex.h"
+
+using namespace libscratchcpp;
+
+/*! Constructs InlineCache. */
+InlineCache::InlineCache() :
+    impl(spimpl::make_impl<InlineCachePrivate>())
+{
+}
+
+/*!
+ * Returns true if the cache holds a resolution of the given name which is still valid.
+ * \note Resolutions become invalid when targets, variables, lists, costumes, sounds or broadcasts of the engine are added or renamed.
+ */
+bool InlineCache::matches(const std::string &name) const
+{
+    return impl->group && impl->epoch == impl->group->epoch() && impl->name == name && impl->targetName.empty();
+}
+
+/*! Returns true if the cache holds a valid resolution of the given name in the target with the given name. */
+bool InlineCache::matches(const std::string &name, const std::string &targetName) const
+{
+    return impl->group && impl->epoch == impl->group->epoch() && impl->name == name && impl->targetName == targetName;
+}
+
+/*! Stores the target resolved from the given name (can be nullptr if there isn't any target with the name). */
+void InlineCache::store(const std::string &name, Target *target)
+{
+    impl->name = name;
+    impl->targetName.clear();
+    impl->target = target;
+    impl->variable = nullptr;
+    impl->epoch = impl->group ? impl->group->epoch() : 0;
+}
+
+/*! Stores the target and the variable resolved from the given variable name and target name (both can be nullptr). */
+void InlineCache::store(const std::string &name, const std::string &targetName, Target *target, Variable *variable)
+{
+    impl->name = name;
+    impl->targetName = targetName;
+    impl->target = target;
+    impl->variable = variable;
+    impl->epoch = impl->group ? impl->group->epoch() : 0;
+}
+
+/*! Removes the stored resolution. */
+void InlineCache::clear()
+{
+    impl->name.clear();
+    impl->targetName.clear();
+    impl->target = nullptr;
+    impl->variable = nullptr;
+    impl->epoch = 0;
+}
+
+/*! Returns the stored target. */
+Target *InlineCache::target() const
+{
+    return impl->target;
+}
+
+/*! Returns the stored variable. */
+Variable *InlineCache::variable() const
+{
+    return impl->variable;
+}
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+namespace libscratchcpp
+{
+
+class Target;
+class Variable;
+class NameIndexGroup;
+
+struct InlineCachePrivate
+{
+        std::string name;
+        std::string targetName;
+        Target *target = nullptr;
+        Variable *variable = nullptr;
+        const NameIndexGroup *group = nullptr; // the resolutions are valid while the epoch of the group doesn't change
+        unsigned int epoch = 0;                // 0 means the cache is empty
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/costume.h>
+#include <cassert>
+
+#include "alphamask.h"
+#include "internal/pngdecoder.h"
+
+using namespace libscratchcpp;
+
+static const unsigned int MAX_LEVELS = 4;
+
+AlphaMask::AlphaMask(unsigned int width, unsigned int height, const std::vector<unsigned char> &alpha)
+{
+    assert(alpha.size() == static_cast<size_t>(width) * height);
+
+    Level base;
+    base.width = width;
+    base.height = height;
+    base.wordsPerRow = (width + 63) / 64;
+    base.words.resize(static_cast<size_t>(base.wordsPerRow) * height, 0);
+
+    for (unsigned int y = 0; y < height; y++) {
+        const unsigned char *row = alpha.data() + static_cast<size_t>(y) * width;
+        uint64_t *words = base.words.data() + static_cast<size_t>(y) * base.wordsPerRow;
+
+        for (unsigned int x = 0; x < width; x++) {
+            if (row[x] > 0)
+                words[x / 64] |= uint64_t(1) << (x % 64);
+        }
+    }
+
+    m_levels.push_back(std::move(base));
+
+    // Downsample (2x2 pixels are merged into one)
+    while (m_levels.size() < MAX_LEVELS && (m_levels.back().width > 1 || m_levels.back().height > 1)) {
+        const Level &prev = m_levels.back();
+        Level level;
+        level.width = (prev.width + 1) / 2;
+        level.height = (prev.height + 1) / 2;
+        level.wordsPerRow = (level.width + 63) / 64;
+        level.words.resize(static_cast<size_t>(level.wordsPerRow) * level.height, 0);
+
+        for (unsigned int y = 0; y < prev.height; y++) {
+            const uint64_t *src = prev.words.data() + static_cast<size_t>(y) * prev.wordsPerRow;
+            uint64_t *dst = level.words.data() + static_cast<size_t>(y / 2) * level.wordsPerRow;
+
+            for (unsigned int i = 0; i < prev.wordsPerRow; i++) {
+                uint64_t word = src[i];
+
+                if (word == 0)
+                    continue;
+
+                // Merge pairs of bits: bit 2k and 2k + 1 become bit k
+                uint64_t pairs = (word | (word >> 1)) & 0x5555555555555555;
+                uint64_t packed = 0;
+
+                for (unsigned int bit = 0; bit < 32; bit++)
+                    packed |= ((pairs >> (bit * 2)) & 1) << bit;
+
+                dst[i / 2] |= packed << ((i % 2) * 32);
+            }
+        }
+
+        m_levels.push_back(std::move(level));
+    }
+}
+
+// Decodes the mask of the given costume. Returns nullptr if the costume image is opaque or if it can't be decoded.
+std::shared_ptr<AlphaMask> AlphaMask::fromCostume(const Costume *costume)
+{
+    if (!costume)
+        return nullptr;
+
+    const void *data = costume->data();
+    unsigned int width, height;
+    std::vector<unsigned char> alpha;
+
+    if (!data || !PngDecoder::readAlpha(data, costume->dataSize(), &width, &height, &alpha))
+        return nullptr;
+
+    return std::make_shared<AlphaMask>(width, height, alpha);
+}
+
+unsigned int AlphaMask::levelCount() const
+{
+    return m_levels.size();
+}
+
+unsigned int AlphaMask::width(unsigned int level) const
+{
+    assert(level < m_levels.size());
+    return m_levels[level].width;
+}
+
+unsigned int AlphaMask::height(unsigned int level) const
+{
+    assert(level < m_levels.size());
+    return m_levels[level].height;
+}
+
+// Returns true if the pixel at the given position of the given level is opaque (false if it's outside the image).
+bool AlphaMask::opaque(unsigned int level, int x, int y) const
+{
+    assert(level < m_levels.size());
+    const Level &l = m_levels[level];
+
+    if (x < 0 || y < 0 || static_cast<unsigned int>(x) >= l.width || static_cast<unsigned int>(y) >= l.height)
+        return false;
+
+    return (l.words[static_cast<size_t>(y) * l.wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
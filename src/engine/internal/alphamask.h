@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace libscratchcpp
+{
+
+class Costume;
+
+// Bit-packed opacity mask of a costume image, used by pixel-accurate touching checks.
+// Each mip level halves the resolution. A bit in a lower level is set if any of the pixels it covers is opaque.
+class AlphaMask
+{
+    public:
+        AlphaMask(unsigned int width, unsigned int height, const std::vector<unsigned char> &alpha);
+        AlphaMask(const AlphaMask &) = delete;
+
+        static std::shared_ptr<AlphaMask> fromCostume(const Costume *costume);
+
+        unsigned int levelCount() const;
+        unsigned int width(unsigned int level = 0) const;
+        unsigned int height(unsigned int level = 0) const;
+
+        bool opaque(unsigned int level, int x, int y) const;
+
+    private:
+        struct Level
+        {
+                unsigned int width = 0;
+                unsigned int height = 0;
+                unsigned int wordsPerRow = 0;
+                std::vector<uint64_t> words;
+        };
+
+        std::vector<Level> m_levels;
+};
+
+} // namespace libscratchcpp
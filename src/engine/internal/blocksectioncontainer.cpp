@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+
 #include "blocksectioncontainer.h"
 
 using namespace libscratchcpp;
@@ -31,6 +33,12 @@ void BlockSectionContainer::addFieldValue(const std::string &value, int id)
     m_fieldValues[value] = id;
 }
 
+void BlockSectionContainer::addFunction(BlockFunc f)
+{
+    if (std::find(m_functions.begin(), m_functions.end(), f) == m_functions.end())
+        m_functions.push_back(f);
+}
+
 BlockComp BlockSectionContainer::resolveBlockCompileFunc(const std::string &opcode) const
 {
     if (m_compileFunctions.count(opcode) == 1)
@@ -58,3 +66,18 @@ int BlockSectionContainer::resolveFieldValue(const std::string &value) const
         return m_fieldValues.at(value);
     return -1;
 }
+
+BlockFunc BlockSectionContainer::resolveFunction(unsigned int index) const
+{
+    if (index < m_functions.size())
+        return m_functions[index];
+    return nullptr;
+}
+
+int BlockSectionContainer::findFunction(BlockFunc f) const
+{
+    auto it = std::find(m_functions.begin(), m_functions.end(), f);
+    if (it != m_functions.end())
+        return it - m_functions.begin();
+    return -1;
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 #include <string>
 #include <scratchcpp/global.h>
 
@@ -20,17 +21,21 @@ class BlockSectionContainer
         void addInput(const std::string &name, int id);
         void addField(const std::string &name, int id);
         void addFieldValue(const std::string &value, int id);
+        void addFunction(BlockFunc f);
 
         BlockComp resolveBlockCompileFunc(const std::string &opcode) const;
         int resolveInput(const std::string &name) const;
         int resolveField(const std::string &name) const;
         int resolveFieldValue(const std::string &value) const;
+        BlockFunc resolveFunction(unsigned int index) const;
+        int findFunction(BlockFunc f) const;
 
     private:
         std::unordered_map<std::string, BlockComp> m_compileFunctions;
         std::unordered_map<std::string, int> m_inputs;
         std::unordered_map<std::string, int> m_fields;
         std::unordered_map<std::string, int> m_fieldValues;
+        std::vector<BlockFunc> m_functions; // in the order of registration
 };
 
 } // namespace libscratchcpp
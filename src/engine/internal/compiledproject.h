@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <scratchcpp/value.h>
+#include <string>
+#include <vector>
+
+namespace libscratchcpp
+{
+
+// Scripts registered by hat blocks when compiling
+enum class HatType
+{
+    Broadcast,
+    CloneInit,
+    KeyPress
+};
+
+// Compiled scripts of a target which refer to functions and entities by name or index, so that they can be stored in the project cache
+struct CompiledTarget
+{
+        struct Function
+        {
+                std::string section;
+                unsigned int index = 0; // in the order of IEngine::addFunction() calls of the section
+        };
+
+        struct Script
+        {
+                std::string blockId;                // the top level block
+                std::vector<unsigned int> bytecode; // function indices point to the function table of the target
+        };
+
+        // Variable or list, the target is the index of its target (or -1 if the entity doesn't exist)
+        struct Entity
+        {
+                int target = -1;
+                int index = -1;
+        };
+
+        struct Hat
+        {
+                HatType type = HatType::Broadcast;
+                std::string blockId;
+                int broadcast = -1; // index of the broadcast
+                int backdrop = -1;  // or index of the backdrop which broadcasts when the stage switches to it
+                std::string keyName;
+        };
+
+        std::vector<Function> functions;
+        std::vector<Script> scripts;
+        std::vector<std::string> procedureCodes;
+        std::vector<Value> constValues;
+        std::vector<Entity> variables;
+        std::vector<Entity> lists;
+        std::vector<Hat> hats;
+};
+
+// Compiled scripts of all targets (see Engine::compile())
+struct CompiledProject
+{
+        // The constant values contain indices of block sections and graphics effects,
+        // so the scripts can only be used if the sections and effects are registered in the same order
+        std::vector<std::string> sections;
+        std::vector<std::string> graphicsEffects;
+
+        std::vector<CompiledTarget> targets;
+};
+
+} // namespace libscratchcpp
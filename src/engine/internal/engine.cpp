@@ -16,6 +16,7 @@
 #include <scratchcpp/comment.h>
 #include <scratchcpp/costume.h>
 #include <scratchcpp/keyevent.h>
+#include <scratchcpp/igraphicseffect.h>
 #include <cassert>
 #include <iostream>
 
@@ -23,30 +24,56 @@
 #include "blocksectioncontainer.h"
 #include "timer.h"
 #include "clock.h"
+#include "virtualclock.h"
+#include "randomgenerator.h"
+#include "../virtualmachine_p.h"
+#include "../compiler_p.h"
+#include "../../scratch/sprite_p.h"
+#include "../../internal/workstealingpool.h"
 #include "../../blocks/standardblocks.h"
 
 using namespace libscratchcpp;
 
+thread_local Engine::TargetCompilation *Engine::m_currentCompilation = nullptr;
+
+// Maximum number of script passes in a frame in fixed timestep mode (replaces the frame time limit)
+static const unsigned int FIXED_TIMESTEP_MAX_PASSES = 100;
+
 Engine::Engine() :
-    m_defaultTimer(std::make_unique<Timer>()),
+    m_clock(Clock::instance().get()),
+    m_defaultTimer(std::make_unique<Timer>(m_clock)),
     m_timer(m_defaultTimer.get()),
-    m_clock(Clock::instance().get())
+    m_rng(std::make_unique<RandomGenerator>())
 {
 }
 
 Engine::~Engine()
 {
-    m_clones.clear();
     m_executableTargets.clear();
+    m_clones.clear();
 }
 
 void Engine::clear()
 {
+    m_executableTargets.clear();
+    m_spatialIndex.clear();
+
+    if (m_transformStore)
+        m_transformStore->clear();
+
     m_sections.clear();
+    m_sectionList.clear();
+    m_sectionNames.clear();
+    m_targetLocalFunctions.clear();
     m_targets.clear();
+    m_targetIndex.invalidate();
     m_broadcasts.clear();
-    removeExecutableClones();
+    m_broadcastNames.invalidate();
+    m_broadcastIds.invalidate();
+    m_entityMap.clear();
+    m_commentMap.clear();
     m_clones.clear();
+    clearClonePool();
 
     m_running = false;
 }
@@ -55,93 +82,688 @@ void Engine::clear()
 void Engine::resolveIds()
 {
     for (auto target : m_targets) {
-        std::cout << "Processing target " << target->name() << "..." << std::endl;
+        if (m_loggingEnabled)
+            std::cout << "Processing target " << target->name() << "..." << std::endl;
         const auto &blocks = target->blocks();
-        for (auto block : blocks) {
-            auto container = blockSectionContainer(block->opcode());
-            block->setNext(getBlock(block->nextId()));
-            block->setParent(getBlock(block->parentId()));
-            if (container)
-                block->setCompileFunction(container->resolveBlockCompileFunc(block->opcode()));
-
-            const auto &inputs = block->inputs();
-            for (const auto &input : inputs) {
-                input->setValueBlock(getBlock(input->valueBlockId()));
-                if (container)
-                    input->setInputId(container->resolveInput(input->name()));
-                input->primaryValue()->setValuePtr(getEntity(input->primaryValue()->valueId()));
-                input->secondaryValue()->setValuePtr(getEntity(input->primaryValue()->valueId()));
-            }
+        for (auto block : blocks)
+            resolveBlock(block);
+    }
+}
 
-            const auto &fields = block->fields();
-            for (auto field : fields) {
-                field->setValuePtr(getEntity(field->valueId()));
-                if (container) {
-                    field->setFieldId(container->resolveField(field->name()));
-                    if (!field->valuePtr())
-                        field->setSpecialValueId(container->resolveFieldValue(field->value().toString()));
-                }
-            }
+// Resolves ID references of the given block.
+void Engine::resolveBlock(std::shared_ptr<Block> block)
+{
+    auto container = blockSectionContainer(block->opcode());
+    block->setNext(getBlock(block->nextId()));
+    block->setParent(getBlock(block->parentId()));
+    if (container)
+        block->setCompileFunction(container->resolveBlockCompileFunc(block->opcode()));
+
+    const auto &inputs = block->inputs();
+    for (const auto &input : inputs) {
+        input->setValueBlock(getBlock(input->valueBlockId()));
+        if (container)
+            input->setInputId(container->resolveInput(input->name()));
+        input->primaryValue()->setValuePtr(getEntity(input->primaryValue()->valueId()));
+        input->secondaryValue()->setValuePtr(getEntity(input->primaryValue()->valueId()));
+    }
 
-            block->updateInputMap();
-            block->updateFieldMap();
+    const auto &fields = block->fields();
+    for (auto field : fields) {
+        field->setValuePtr(getEntity(field->valueId()));
+        if (container) {
+            field->setFieldId(container->resolveField(field->name()));
+            if (!field->valuePtr())
+                field->setSpecialValueId(container->resolveFieldValue(field->value().toString()));
+        }
+    }
 
-            auto comment = getComment(block->commentId());
-            block->setComment(comment);
+    block->updateInputMap();
+    block->updateFieldMap();
 
-            if (comment) {
-                comment->setBlock(block);
-                assert(comment->blockId() == block->id());
-            }
-        }
+    auto comment = getComment(block->commentId());
+    block->setComment(comment);
+
+    if (comment) {
+        comment->setBlock(block);
+        assert(comment->blockId() == block->id());
     }
 }
 
 void Engine::compile()
+{
+    compileTargets(nullptr);
+}
+
+// Compiles the scripts and stores them in the given compiled project, so that they can be loaded again without compiling (see loadCompiledProject()).
+// Returns false if the scripts can't be stored (e.g. if they call a function which isn't registered using addFunction()).
+bool Engine::compile(CompiledProject &compiledProject)
+{
+    return compileTargets(&compiledProject);
+}
+
+// Loads the scripts compiled by compile(CompiledProject &). Targets, broadcasts and extensions must be set like when they were compiled.
+// Returns false (without changing the scripts) if the compiled project doesn't match the project or the registered sections and graphics effects.
+bool Engine::loadCompiledProject(const CompiledProject &compiledProject)
+{
+    std::vector<std::string> sections, graphicsEffects;
+    registrationOrder(sections, graphicsEffects);
+
+    if (compiledProject.sections != sections || compiledProject.graphicsEffects != graphicsEffects || compiledProject.targets.size() != m_targets.size())
+        return false;
+
+    resolveIds();
+    std::vector<TargetCompilation> compilations(m_targets.size());
+
+    for (size_t i = 0; i < m_targets.size(); i++) {
+        compilations[i].engine = this;
+        compilations[i].target = m_targets[i].get();
+
+        if (!loadTarget(compiledProject.targets[i], compilations[i])) {
+            std::cerr << "warning: the compiled scripts of target " << m_targets[i]->name() << " are invalid" << std::endl;
+            return false;
+        }
+    }
+
+    finishCompilation(compilations);
+    return true;
+}
+
+bool Engine::compileTargets(CompiledProject *compiledProject)
 {
     // Resolve entities by ID
     resolveIds();
 
-    // Compile scripts to bytecode
-    for (auto target : m_targets) {
-        std::cout << "Compiling scripts in target " << target->name() << "..." << std::endl;
-        std::unordered_map<std::string, unsigned int *> procedureBytecodeMap;
-        Compiler compiler(this, target.get());
-        const auto &blocks = target->blocks();
-        for (auto block : blocks) {
-            if (block->topLevel() && !block->shadow()) {
-                auto section = blockSection(block->opcode());
-                if (section) {
-                    auto script = std::make_shared<Script>(target.get(), this);
-                    m_scripts[block] = script;
-
-                    compiler.compile(block);
-
-                    script->setBytecode(compiler.bytecode());
-                    if (block->opcode() == "procedures_definition") {
-                        auto b = block->inputAt(block->findInput("custom_block"))->valueBlock();
-                        procedureBytecodeMap[b->mutationPrototype()->procCode()] = script->bytecode();
-                    }
-                } else
-                    std::cout << "warning: unsupported top level block: " << block->opcode() << std::endl;
+    // Compile scripts to bytecode, every target on its own thread
+    std::vector<TargetCompilation> compilations(m_targets.size());
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (size_t i = 0; i < m_targets.size(); i++) {
+        compilations[i].engine = this;
+        compilations[i].target = m_targets[i].get();
+        tasks.push_back([this, &compilations, i]() { compileTarget(compilations[i]); });
+    }
+
+    // If this is called from a pool thread (e.g. by BatchRunner), the cores are busy already, so the targets are compiled one after another
+    if (tasks.size() > 1 && m_parallelCompilationEnabled && !WorkStealingPool::isWorkerThread())
+        threadPool()->run(tasks);
+    else {
+        for (const auto &task : tasks)
+            task();
+    }
+
+    // Store the results before merging them (merging modifies the bytecode)
+    bool stored = (compiledProject != nullptr);
+
+    if (compiledProject) {
+        registrationOrder(compiledProject->sections, compiledProject->graphicsEffects);
+        compiledProject->targets.clear();
+        compiledProject->targets.resize(compilations.size());
+
+        for (size_t i = 0; i < compilations.size() && stored; i++)
+            stored = saveTarget(compilations[i], compiledProject->targets[i]);
+
+        if (!stored)
+            compiledProject->targets.clear();
+    }
+
+    finishCompilation(compilations);
+    return stored;
+}
+
+// Merges the compiled targets in target order, so that the result is the same as if the targets were compiled one after another.
+void Engine::finishCompilation(std::vector<TargetCompilation> &compilations)
+{
+    m_scriptProcedures.clear();
+    m_procedureDefinitions.clear();
+
+    for (auto &compilation : compilations)
+        mergeTarget(compilation);
+
+    for (auto &compilation : compilations) {
+        m_procedureDefinitions[compilation.target] = compilation.procedureDefinitions;
+
+        std::vector<Script *> procedureScripts;
+
+        for (const std::string &code : compilation.procedureCodes) {
+            auto it = compilation.procedureDefinitions.find(code);
+            procedureScripts.push_back(it == compilation.procedureDefinitions.cend() ? nullptr : it->second);
+        }
+
+        for (const auto &[block, script] : compilation.scripts) {
+            m_scriptProcedures[script.get()] = compilation.procedureCodes;
+            script->setFunctions(m_functions);
+            script->setProcedures(compilation.procedures);
+            script->setConstValues(compilation.constValues);
+            script->setVariables(compilation.variables);
+            script->setLists(compilation.lists);
+
+            std::unordered_set<Script *> visitedProcedures;
+            script->setTargetLocal(isTargetLocal(script->bytecodeVector(), compilation.target, compilation.variables, procedureScripts, visitedProcedures));
+        }
+    }
+}
+
+// Compiles the scripts of a target. This runs on a worker thread, so the engine must not be modified here.
+void Engine::compileTarget(TargetCompilation &compilation)
+{
+    m_currentCompilation = &compilation;
+    Target *target = compilation.target;
+    std::unordered_map<std::string, unsigned int *> procedureBytecodeMap;
+    Compiler compiler(this, target);
+    compiler.impl->log = &compilation.log; // warnings are printed in target order after compiling
+    const auto &blocks = target->blocks();
+
+    for (auto block : blocks) {
+        if (block->topLevel() && !block->shadow()) {
+            auto section = blockSection(block->opcode());
+            if (section) {
+                auto script = std::make_shared<Script>(target, this);
+                compilation.scripts.push_back({ block, script });
+
+                compiler.compile(block);
+
+                script->setBytecode(compiler.bytecode());
+                if (block->opcode() == "procedures_definition") {
+                    auto b = block->inputAt(block->findInput("custom_block"))->valueBlock();
+                    procedureBytecodeMap[b->mutationPrototype()->procCode()] = script->bytecode();
+                    compilation.procedureDefinitions[b->mutationPrototype()->procCode()] = script.get();
+                }
+            } else
+                compilation.log += "warning: unsupported top level block: " + block->opcode() + "\n";
+        }
+    }
+
+    compilation.procedureCodes = compiler.procedures();
+    for (const std::string &code : compilation.procedureCodes)
+        compilation.procedures.push_back(procedureBytecodeMap[code]);
+
+    compilation.constValues = compiler.constValues();
+    compilation.variables = compiler.variables();
+    compilation.lists = compiler.lists();
+    m_currentCompilation = nullptr;
+}
+
+// Adds the scripts, functions and hat blocks of a compiled target to the engine.
+void Engine::mergeTarget(TargetCompilation &compilation)
+{
+    if (m_loggingEnabled)
+        std::cout << "Compiling scripts in target " << compilation.target->name() << "..." << std::endl << compilation.log << std::flush;
+
+    std::vector<unsigned int> functionMap;
+
+    for (BlockFunc f : compilation.functions)
+        functionMap.push_back(functionIndex(f));
+
+    for (const auto &[block, script] : compilation.scripts) {
+        remapFunctions(script->bytecode(), script->bytecodeVector().size(), functionMap);
+        m_scripts[block] = script;
+    }
+
+    for (const HatRegistration &registration : compilation.hatRegistrations) {
+        switch (registration.type) {
+            case HatType::Broadcast:
+                addBroadcastScript(registration.block, registration.broadcast);
+                break;
+
+            case HatType::CloneInit:
+                addCloneInitScript(registration.block);
+                break;
+
+            case HatType::KeyPress:
+                addKeyPressScript(registration.block, registration.keyName);
+                break;
+        }
+    }
+}
+
+// Stores the compiled target without pointers. Returns false if a function or an entity can't be stored.
+bool Engine::saveTarget(const TargetCompilation &compilation, CompiledTarget &compiledTarget) const
+{
+    // Functions are stored by section and index
+    for (BlockFunc f : compilation.functions) {
+        auto it = std::find_if(m_sectionList.begin(), m_sectionList.end(), [this, f](IBlockSection *section) { return blockSectionContainer(section)->findFunction(f) != -1; });
+
+        if (it == m_sectionList.end())
+            return false;
+
+        compiledTarget.functions.push_back({ (*it)->name(), static_cast<unsigned int>(blockSectionContainer(*it)->findFunction(f)) });
+    }
+
+    for (const auto &[block, script] : compilation.scripts)
+        compiledTarget.scripts.push_back({ block->id(), script->bytecodeVector() });
+
+    compiledTarget.procedureCodes = compilation.procedureCodes;
+    compiledTarget.constValues = compilation.constValues;
+
+    // Variables and lists are stored by target and index (missing variables and lists are null)
+    auto targetIndex = [this](Target *target) {
+        auto it = std::find_if(m_targets.begin(), m_targets.end(), [target](std::shared_ptr<Target> t) { return t.get() == target; });
+        return it == m_targets.end() ? -1 : it - m_targets.begin();
+    };
+
+    for (Variable *variable : compilation.variables) {
+        CompiledTarget::Entity entity;
+
+        if (variable) {
+            entity.target = targetIndex(variable->target());
+            entity.index = variable->target() ? variable->target()->findVariableById(variable->id()) : -1;
+
+            if (entity.target == -1 || entity.index == -1)
+                return false;
+        }
+
+        compiledTarget.variables.push_back(entity);
+    }
+
+    for (List *list : compilation.lists) {
+        CompiledTarget::Entity entity;
+
+        if (list) {
+            entity.target = targetIndex(list->target());
+            entity.index = list->target() ? list->target()->findListById(list->id()) : -1;
+
+            if (entity.target == -1 || entity.index == -1)
+                return false;
+        }
+
+        compiledTarget.lists.push_back(entity);
+    }
+
+    // Broadcasts of hat blocks are stored by index (or by the index of the backdrop)
+    Stage *stage = this->stage();
+
+    for (const HatRegistration &registration : compilation.hatRegistrations) {
+        CompiledTarget::Hat hat;
+        hat.type = registration.type;
+        hat.blockId = registration.block->id();
+        hat.keyName = registration.keyName;
+
+        if (registration.type == HatType::Broadcast) {
+            auto it = std::find_if(m_broadcasts.begin(), m_broadcasts.end(), [&registration](std::shared_ptr<Broadcast> broadcast) { return broadcast.get() == registration.broadcast; });
+
+            if (it != m_broadcasts.end())
+                hat.broadcast = it - m_broadcasts.begin();
+            else {
+                const auto &costumes = stage ? stage->costumes() : std::vector<std::shared_ptr<Costume>>();
+                auto costumeIt = std::find_if(costumes.begin(), costumes.end(), [&registration](std::shared_ptr<Costume> costume) { return costume->broadcast() == registration.broadcast; });
+
+                if (costumeIt == costumes.end())
+                    return false;
+
+                hat.backdrop = costumeIt - costumes.begin();
             }
         }
 
-        const std::vector<std::string> &procedures = compiler.procedures();
-        std::vector<unsigned int *> procedureBytecodes;
-        for (const std::string &code : procedures)
-            procedureBytecodes.push_back(procedureBytecodeMap[code]);
+        compiledTarget.hats.push_back(hat);
+    }
 
-        for (auto block : blocks) {
-            if (m_scripts.count(block) == 1) {
-                m_scripts[block]->setFunctions(m_functions);
-                m_scripts[block]->setProcedures(procedureBytecodes);
-                m_scripts[block]->setConstValues(compiler.constValues());
-                m_scripts[block]->setVariables(compiler.variables());
-                m_scripts[block]->setLists(compiler.lists());
+    return true;
+}
+
+// Reads a target stored by saveTarget(). Returns false if the compiled target doesn't match the project.
+bool Engine::loadTarget(const CompiledTarget &compiledTarget, TargetCompilation &compilation)
+{
+    Target *target = compilation.target;
+
+    for (const CompiledTarget::Function &function : compiledTarget.functions) {
+        auto it = m_sectionNames.find(function.section);
+        BlockFunc f = (it == m_sectionNames.cend()) ? nullptr : blockSectionContainer(m_sectionList[it->second])->resolveFunction(function.index);
+
+        if (!f)
+            return false;
+
+        compilation.functions.push_back(f);
+    }
+
+    compilation.procedureCodes = compiledTarget.procedureCodes;
+    compilation.constValues = compiledTarget.constValues;
+
+    for (const CompiledTarget::Entity &entity : compiledTarget.variables) {
+        Target *owner = (entity.target == -1) ? nullptr : targetAt(entity.target);
+
+        if (entity.target != -1 && (!owner || !owner->variableAt(entity.index)))
+            return false;
+
+        compilation.variables.push_back(owner ? owner->variableAt(entity.index).get() : nullptr);
+    }
+
+    for (const CompiledTarget::Entity &entity : compiledTarget.lists) {
+        Target *owner = (entity.target == -1) ? nullptr : targetAt(entity.target);
+
+        if (entity.target != -1 && (!owner || !owner->listAt(entity.index)))
+            return false;
+
+        compilation.lists.push_back(owner ? owner->listAt(entity.index).get() : nullptr);
+    }
+
+    // Scripts
+    std::unordered_map<std::string, unsigned int *> procedureBytecodeMap;
+
+    for (const CompiledTarget::Script &compiledScript : compiledTarget.scripts) {
+        auto block = getBlock(compiledScript.blockId);
+
+        if (!block || block->target() != target || !block->topLevel() || !isValidBytecode(compiledScript.bytecode, compilation))
+            return false;
+
+        auto script = std::make_shared<Script>(target, this);
+        script->setBytecode(compiledScript.bytecode);
+        compilation.scripts.push_back({ block, script });
+
+        if (block->opcode() == "procedures_definition") {
+            auto b = block->inputAt(block->findInput("custom_block"))->valueBlock();
+            procedureBytecodeMap[b->mutationPrototype()->procCode()] = script->bytecode();
+            compilation.procedureDefinitions[b->mutationPrototype()->procCode()] = script.get();
+        }
+    }
+
+    for (const std::string &code : compilation.procedureCodes)
+        compilation.procedures.push_back(procedureBytecodeMap[code]);
+
+    // Hat blocks
+    Stage *stage = this->stage();
+
+    for (const CompiledTarget::Hat &hat : compiledTarget.hats) {
+        HatRegistration registration;
+        registration.type = hat.type;
+        registration.block = getBlock(hat.blockId);
+        registration.keyName = hat.keyName;
+
+        auto it = std::find_if(compilation.scripts.begin(), compilation.scripts.end(), [&registration](const auto &script) { return script.first == registration.block; });
+
+        if (it == compilation.scripts.end())
+            return false;
+
+        if (hat.type == HatType::Broadcast) {
+            if (hat.broadcast >= 0 && hat.broadcast < m_broadcasts.size())
+                registration.broadcast = m_broadcasts[hat.broadcast].get();
+            else if (stage && hat.backdrop >= 0 && hat.backdrop < stage->costumes().size())
+                registration.broadcast = stage->costumeAt(hat.backdrop)->broadcast();
+            else
+                return false;
+        }
+
+        compilation.hatRegistrations.push_back(registration);
+    }
+
+    return true;
+}
+
+// Checks the instructions and their arguments of bytecode read from the project cache.
+bool Engine::isValidBytecode(const std::vector<unsigned int> &bytecode, const TargetCompilation &compilation) const
+{
+    static const unsigned int instructionCount = vm::OP_EXEC_CACHED + 1;
+    size_t pos = 0;
+
+    while (pos < bytecode.size()) {
+        unsigned int instruction = bytecode[pos];
+
+        if (instruction >= instructionCount || pos + VirtualMachinePrivate::instruction_arg_count[instruction] >= bytecode.size())
+            return false;
+
+        unsigned int arg = VirtualMachinePrivate::instruction_arg_count[instruction] > 0 ? bytecode[pos + 1] : 0;
+
+        switch (instruction) {
+            case vm::OP_CONST:
+                if (arg >= compilation.constValues.size())
+                    return false;
+                break;
+
+            case vm::OP_SET_VAR:
+            case vm::OP_CHANGE_VAR:
+            case vm::OP_READ_VAR:
+                if (arg >= compilation.variables.size())
+                    return false;
+                break;
+
+            case vm::OP_READ_LIST:
+            case vm::OP_LIST_APPEND:
+            case vm::OP_LIST_DEL:
+            case vm::OP_LIST_DEL_ALL:
+            case vm::OP_LIST_INSERT:
+            case vm::OP_LIST_REPLACE:
+            case vm::OP_LIST_GET_ITEM:
+            case vm::OP_LIST_INDEX_OF:
+            case vm::OP_LIST_LENGTH:
+            case vm::OP_LIST_CONTAINS:
+                if (arg >= compilation.lists.size())
+                    return false;
+                break;
+
+            case vm::OP_EXEC:
+            case vm::OP_EXEC_CACHED:
+                if (arg >= compilation.functions.size())
+                    return false;
+                break;
+
+            case vm::OP_CALL_PROCEDURE:
+                if (arg >= compilation.procedureCodes.size())
+                    return false;
+                break;
+
+            default:
+                break;
+        }
+
+        pos += VirtualMachinePrivate::instruction_arg_count[instruction] + 1;
+    }
+
+    // The last instruction must stop the script
+    return !bytecode.empty() && bytecode.back() == vm::OP_HALT;
+}
+
+// Returns the names of the registered block sections and graphics effects by index (compiled code contains these indices).
+void Engine::registrationOrder(std::vector<std::string> &sections, std::vector<std::string> &graphicsEffects) const
+{
+    sections.clear();
+    graphicsEffects.clear();
+
+    for (IBlockSection *section : m_sectionList)
+        sections.push_back(section->name());
+
+    int count = ScratchConfiguration::graphicsEffectCount();
+
+    for (int i = 0; i < count; i++) {
+        IGraphicsEffect *effect = ScratchConfiguration::graphicsEffectAt(i);
+        graphicsEffects.push_back(effect ? effect->name() : "");
+    }
+}
+
+// Replaces target-local function indices with engine function indices.
+void Engine::remapFunctions(unsigned int *bytecode, size_t size, const std::vector<unsigned int> &functionMap)
+{
+    // NOTE: OP_HALT can be in the middle of the bytecode (e.g. "stop this script")
+    unsigned int *pos = bytecode;
+    unsigned int *end = bytecode + size;
+
+    while (pos < end) {
+        if (*pos == vm::OP_EXEC || *pos == vm::OP_EXEC_CACHED) {
+            assert(pos[1] < functionMap.size());
+            pos[1] = functionMap[pos[1]];
+        }
+
+        pos += VirtualMachinePrivate::instruction_arg_count[*pos] + 1;
+    }
+}
+
+void Engine::recompile(Target *target, const std::vector<std::shared_ptr<Block>> &changedBlocks, const std::vector<std::shared_ptr<Block>> &removedBlocks)
+{
+    if (!target)
+        return;
+
+    // Find the top level blocks of the affected scripts (before and after re-linking the blocks)
+    std::vector<std::shared_ptr<Block>> topLevelBlocks;
+
+    auto addTopLevelBlock = [&topLevelBlocks](std::shared_ptr<Block> block) {
+        while (block->parent())
+            block = block->parent();
+
+        if (std::find(topLevelBlocks.begin(), topLevelBlocks.end(), block) == topLevelBlocks.end())
+            topLevelBlocks.push_back(block);
+    };
+
+    for (auto block : changedBlocks)
+        addTopLevelBlock(block);
+
+    for (auto block : removedBlocks) {
+        addTopLevelBlock(block);
+        auto it = m_entityMap.find(block->id());
+
+        if (it != m_entityMap.end() && it->second == block)
+            m_entityMap.erase(it);
+    }
+
+    for (auto block : changedBlocks) {
+        block->setEngine(this);
+        block->setTarget(target);
+        m_entityMap[block->id()] = block;
+    }
+
+    for (auto block : changedBlocks)
+        resolveBlock(block);
+
+    for (auto block : changedBlocks)
+        addTopLevelBlock(block);
+
+    // Remove the old scripts
+    auto &procedureDefinitions = m_procedureDefinitions[target];
+    std::unordered_set<Script *> affectedScripts;
+    std::unordered_set<std::string> changedProcedures;
+
+    for (auto block : topLevelBlocks) {
+        auto it = m_scripts.find(block);
+
+        if (it == m_scripts.end())
+            continue;
+
+        Script *script = it->second.get();
+        removeHatScripts(script);
+        affectedScripts.insert(script);
+
+        for (auto procIt = procedureDefinitions.begin(); procIt != procedureDefinitions.end();) {
+            if (procIt->second == script) {
+                changedProcedures.insert(procIt->first);
+                procIt = procedureDefinitions.erase(procIt);
+            } else
+                procIt++;
+        }
+
+        // The script is reused if the block is still a top level block of the target
+        if (getBlock(block->id()) != block || !block->topLevel() || block->shadow()) {
+            m_scriptProcedures.erase(script);
+            m_scripts.erase(it);
+        }
+    }
+
+    // Compile the new scripts
+    for (auto block : topLevelBlocks) {
+        if (getBlock(block->id()) != block || !block->topLevel() || block->shadow())
+            continue;
+
+        Script *script = compileScript(target, block);
+
+        if (script) {
+            affectedScripts.insert(script);
+
+            if (block->opcode() == "procedures_definition") {
+                auto prototype = block->inputAt(block->findInput("custom_block"))->valueBlock()->mutationPrototype();
+                procedureDefinitions[prototype->procCode()] = script;
+                changedProcedures.insert(prototype->procCode());
             }
         }
     }
+
+    // Update procedure lists of the scripts which call changed procedures
+    for (const auto &[script, procedures] : m_scriptProcedures) {
+        if (script->target() != target)
+            continue;
+
+        bool affected = affectedScripts.find(script) != affectedScripts.cend();
+
+        for (auto it = procedures.begin(); !affected && it != procedures.end(); it++)
+            affected = changedProcedures.find(*it) != changedProcedures.cend();
+
+        if (affected) {
+            affectedScripts.insert(script);
+            updateProcedures(script);
+        }
+    }
+
+    // Remove running scripts which use the old bytecode (it has been freed, so they can't wait for the next frame to be removed)
+    std::vector<VirtualMachine *> oldScripts;
+
+    for (const TargetScriptMap *scriptMap : { &m_runningScripts, &m_newScripts }) {
+        for (const auto &[runningTarget, scripts] : *scriptMap) {
+            for (auto vm : scripts) {
+                if (affectedScripts.find(vm->script()) != affectedScripts.cend() && std::find(oldScripts.begin(), oldScripts.end(), vm.get()) == oldScripts.end())
+                    oldScripts.push_back(vm.get());
+            }
+        }
+    }
+
+    for (VirtualMachine *vm : oldScripts)
+        removeRunningScript(vm);
+}
+
+// Compiles the given top level block of the target and returns its script (without the procedure list).
+Script *Engine::compileScript(Target *target, std::shared_ptr<Block> topLevelBlock)
+{
+    if (!blockSection(topLevelBlock->opcode())) {
+        if (m_loggingEnabled)
+            std::cout << "warning: unsupported top level block: " << topLevelBlock->opcode() << std::endl;
+
+        return nullptr;
+    }
+
+    auto &script = m_scripts[topLevelBlock];
+
+    if (!script)
+        script = std::make_shared<Script>(target, this);
+
+    Compiler compiler(this, target);
+    compiler.compile(topLevelBlock);
+
+    script->setBytecode(compiler.bytecode());
+    script->setFunctions(m_functions);
+    script->setConstValues(compiler.constValues());
+    script->setVariables(compiler.variables());
+    script->setLists(compiler.lists());
+    m_scriptProcedures[script.get()] = compiler.procedures();
+
+    return script.get();
+}
+
+// Sets the procedure list of the script using the current custom block definitions.
+void Engine::updateProcedures(Script *script)
+{
+    Target *target = script->target();
+    const auto &procedureDefinitions = m_procedureDefinitions[target];
+    std::vector<unsigned int *> procedures;
+    std::vector<Script *> procedureScripts;
+
+    for (const std::string &code : m_scriptProcedures[script]) {
+        auto it = procedureDefinitions.find(code);
+        procedures.push_back(it == procedureDefinitions.cend() ? nullptr : it->second->bytecode());
+        procedureScripts.push_back(it == procedureDefinitions.cend() ? nullptr : it->second);
+    }
+
+    script->setProcedures(procedures);
+
+    std::unordered_set<Script *> visitedProcedures;
+    script->setTargetLocal(isTargetLocal(script->bytecodeVector(), target, script->variables(), procedureScripts, visitedProcedures));
+}
+
+// Removes the script from the hat block maps.
+void Engine::removeHatScripts(Script *script)
+{
+    for (auto &[broadcast, scripts] : m_broadcastMap)
+        scripts.erase(std::remove(scripts.begin(), scripts.end(), script), scripts.end());
+
+    for (auto &[target, scripts] : m_cloneInitScriptsMap)
+        scripts.erase(std::remove(scripts.begin(), scripts.end(), script), scripts.end());
+
+    for (auto &[key, scripts] : m_whenKeyPressedScripts)
+        scripts.erase(std::remove(scripts.begin(), scripts.end(), script), scripts.end());
 }
 
 void Engine::start()
@@ -150,9 +772,11 @@ void Engine::start()
     /*if (m_running)
         finalize();*/
 
+    if (postInputEvent({ InputEvent::Type::Start }))
+        return;
+
     deleteClones();
 
-    m_eventLoopMutex.lock();
     m_timer->reset();
     m_running = true;
 
@@ -161,12 +785,13 @@ void Engine::start()
         for (auto block : gfBlocks)
             startScript(block, target.get());
     }
-
-    m_eventLoopMutex.unlock();
 }
 
 void Engine::stop()
 {
+    if (postInputEvent({ InputEvent::Type::Stop }))
+        return;
+
     finalize();
     deleteClones();
 }
@@ -246,7 +871,7 @@ void Engine::stopTarget(Target *target, VirtualMachine *exceptScript)
 
 void Engine::initClone(std::shared_ptr<Sprite> clone)
 {
-    if (!clone || ((m_cloneLimit >= 0) && (m_clones.size() >= m_cloneLimit)))
+    if (!clone || ((m_cloneLimit >= 0) && (m_clones.size() >= static_cast<size_t>(m_cloneLimit))))
         return;
 
     Target *root = clone->cloneSprite();
@@ -274,16 +899,35 @@ void Engine::initClone(std::shared_ptr<Sprite> clone)
         }
     }
 
-    assert(std::find(m_clones.begin(), m_clones.end(), clone) == m_clones.end());
-    assert(std::find(m_executableTargets.begin(), m_executableTargets.end(), clone.get()) == m_executableTargets.end());
+    assert(m_clones.find(clone) == m_clones.end());
+    assert(!m_executableTargets.contains(clone.get()));
     m_clones.insert(clone);
-    m_executableTargets.push_back(clone.get()); // execution order needs to be updated after this
+
+    // The clone has the layer order of the sprite it was created from, so insert it right behind that sprite
+    // (moveSpriteBehindOther() doesn't have to move it then)
+    m_executableTargets.insert(std::max(clone->layerOrder(), 1), clone.get());
+    m_spatialIndex.addSprite(clone.get());
+
+    if (m_transformStore)
+        m_transformStore->attach(clone.get());
 }
 
 void Engine::deinitClone(std::shared_ptr<Sprite> clone)
 {
     m_clones.erase(clone);
-    m_executableTargets.erase(std::remove(m_executableTargets.begin(), m_executableTargets.end(), clone.get()), m_executableTargets.end());
+    m_executableTargets.remove(clone.get());
+    m_spatialIndex.removeSprite(clone.get());
+
+    if (m_transformStore)
+        m_transformStore->detach(clone.get());
+
+    // Keep the clone for reuse
+    Sprite *root = clone->cloneSprite();
+
+    if (root && m_clonePoolSize < m_clonePoolLimit) {
+        m_clonePool[root].push_back(clone);
+        m_clonePoolSize++;
+    }
 }
 
 void Engine::run()
@@ -300,9 +944,20 @@ void Engine::runEventLoop()
 
 void Engine::stopEventLoop()
 {
-    m_stopEventLoopMutex.lock();
     m_stopEventLoop = true;
-    m_stopEventLoopMutex.unlock();
+}
+
+void Engine::step(unsigned int frames)
+{
+    updateFrameDuration();
+
+    for (unsigned int i = 0; i < frames; i++) {
+        runFixedFrame();
+        callRedrawHandler();
+
+        if (m_virtualClock)
+            m_virtualClock->advance(1000 / m_fps);
+    }
 }
 
 void Engine::setRedrawHandler(const std::function<void()> &handler)
@@ -312,11 +967,36 @@ void Engine::setRedrawHandler(const std::function<void()> &handler)
 
 void Engine::eventLoop(bool untilProjectStops)
 {
+    // Queue input events from now on, but wait for the host thread if it's handling one right now
+    // (it might have checked m_eventLoopRunning before it was changed)
+    m_eventLoopThread = std::this_thread::get_id();
+    m_eventLoopRunning = true;
+    waitForInputEvents();
+
     updateFrameDuration();
     m_newScripts.clear();
     m_stopEventLoop = false;
 
     while (true) {
+        // Input events are processed once per frame
+        processInputEvents();
+
+        if (m_fixedTimestepEnabled) {
+            runFixedFrame();
+
+            // Stop the event loop if the project has finished running (and untilProjectStops is set to true)
+            if (untilProjectStops && !hasRunningScripts())
+                break;
+
+            // Stop the event loop if stopEventLoop() was called
+            if (m_stopEventLoop)
+                break;
+
+            callRedrawHandler();
+            m_virtualClock->advance(1000 / m_fps);
+            continue;
+        }
+
         auto frameStart = m_clock->currentSteadyTime();
         std::chrono::steady_clock::time_point currentTime;
         std::chrono::milliseconds elapsedTime, sleepTime;
@@ -327,7 +1007,6 @@ void Engine::eventLoop(bool untilProjectStops)
         TargetScriptMap scripts = m_runningScripts; // this must be copied (for now)
 
         do {
-            m_eventLoopMutex.lock();
             m_scriptsToRemove.clear();
 
             // Execute new scripts from last frame
@@ -338,84 +1017,199 @@ void Engine::eventLoop(bool untilProjectStops)
             runScripts(scripts, scripts);
 
             // Stop the event loop if the project has finished running (and untilProjectStops is set to true)
-            if (untilProjectStops) {
-                bool empty = true;
-
-                for (const auto &pair : m_runningScripts) {
-                    if (!pair.second.empty()) {
-                        empty = false;
-                        m_eventLoopMutex.unlock();
-                        break;
-                    }
-                }
-
-                if (empty) {
-                    stop = true;
-                    m_eventLoopMutex.unlock();
-                    break;
-                }
-            }
-
-            // Stop the event loop if stopEventLoop() was called
-            m_stopEventLoopMutex.lock();
-
-            if (m_stopEventLoop) {
+            // or if stopEventLoop() was called
+            if ((untilProjectStops && !hasRunningScripts()) || m_stopEventLoop) {
                 stop = true;
-                m_eventLoopMutex.unlock();
                 break;
             }
 
-            m_stopEventLoopMutex.unlock();
-
             currentTime = m_clock->currentSteadyTime();
             elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - frameStart);
             sleepTime = m_frameDuration - elapsedTime;
             timeout = sleepTime <= std::chrono::milliseconds::zero();
-            m_eventLoopMutex.unlock();
         } while (!((m_redrawRequested && !m_turboModeEnabled) || timeout || stop));
 
         if (stop)
             break;
 
         // Redraw
-        if (m_redrawHandler)
-            m_redrawHandler();
+        callRedrawHandler();
 
         // If the timeout hasn't been reached yet (redraw was requested), sleep
         if (!timeout)
             m_clock->sleep(sleepTime);
     }
 
+    // Stop accepting input events, but wait for the host thread if it's posting one right now
+    // (it might have checked m_eventLoopRunning before it was changed)
+    m_eventLoopStopping = true;
+    m_eventLoopRunning = false;
+    waitForInputEvents();
+
+    // Events which were posted after the last frame
+    processInputEvents();
+
     finalize();
+    m_eventLoopThread = std::thread::id();
+    m_eventLoopStopping = false;
+}
+
+// Queues the event if the event loop is running in another thread, otherwise handles it immediately.
+// Returns false if the caller should handle the event (on the event loop thread, or while the event is being handled).
+bool Engine::postInputEvent(const InputEvent &event)
+{
+    std::thread::id thread = std::this_thread::get_id();
+
+    if (thread == m_eventLoopThread || thread == m_inputEventThread)
+        return false;
+
+    while (true) {
+        // The event loop doesn't start or finish while this isn't 0, so the event can't be left in the queue
+        // and it can't be handled by both threads at the same time
+        m_inputEventsPosting++;
+
+        if (m_eventLoopRunning) {
+            // If the queue is full, wait for the event loop to process it (at most one frame)
+            while (!m_inputQueue.push(event))
+                std::this_thread::yield();
+
+            m_inputEventsPosting--;
+            return true;
+        }
+
+        if (!m_eventLoopStopping)
+            break;
+
+        // If the event loop is stopping, wait until it processes the queued events (to keep the order of the events)
+        m_inputEventsPosting--;
+
+        while (m_eventLoopStopping)
+            std::this_thread::yield();
+    }
+
+    m_inputEventThread = thread;
+    handleInputEvent(event);
+    m_inputEventThread = std::thread::id();
+    m_inputEventsPosting--;
+    return true;
+}
+
+// Waits until the host thread doesn't post or handle any input event
+void Engine::waitForInputEvents()
+{
+    while (m_inputEventsPosting > 0) {
+        processInputEvents(); // the queue might be full
+        std::this_thread::yield();
+    }
+}
+
+void Engine::processInputEvents()
+{
+    InputEvent event;
+
+    while (m_inputQueue.pop(event))
+        handleInputEvent(event);
+}
+
+void Engine::handleInputEvent(const InputEvent &event)
+{
+    switch (event.type) {
+        case InputEvent::Type::Key:
+            setKeyState(event.key, event.pressed);
+            break;
+
+        case InputEvent::Type::AnyKey:
+            setAnyKeyPressed(event.pressed);
+            break;
+
+        case InputEvent::Type::MouseX:
+            setMouseX(event.value);
+            break;
+
+        case InputEvent::Type::MouseY:
+            setMouseY(event.value);
+            break;
+
+        case InputEvent::Type::MousePressed:
+            setMousePressed(event.pressed);
+            break;
+
+        case InputEvent::Type::Start:
+            start();
+            break;
+
+        case InputEvent::Type::Stop:
+            stop();
+            break;
+
+        case InputEvent::Type::ParallelExecution:
+            setParallelExecutionEnabled(event.pressed);
+            break;
+    }
+}
+
+void Engine::runFixedFrame()
+{
+    m_redrawRequested = false;
+    unsigned int passes = 0;
+    // TODO: Avoid copying by passing current size to runScripts()
+    TargetScriptMap scripts = m_runningScripts; // this must be copied (for now)
+
+    do {
+        m_scriptsToRemove.clear();
+
+        // Execute new scripts from last frame
+        runScripts(m_newScripts, scripts);
+
+        // Execute all running scripts
+        m_newScripts.clear();
+        runScripts(scripts, scripts);
+        passes++;
+    } while (!((m_redrawRequested && !m_turboModeEnabled) || passes >= FIXED_TIMESTEP_MAX_PASSES || !hasRunningScripts()));
+}
+
+bool Engine::hasRunningScripts() const
+{
+    for (const auto &pair : m_runningScripts) {
+        if (!pair.second.empty())
+            return true;
+    }
+
+    return false;
 }
 
 void Engine::runScripts(const TargetScriptMap &scriptMap, TargetScriptMap &globalScriptMap)
 {
+    // Consecutive targets with only target-local scripts can run in parallel (if enabled)
+    std::vector<const std::vector<std::shared_ptr<VirtualMachine>> *> parallelScripts;
+
     // globalScriptMap is used to remove "scripts to remove" from it so that they're removed from the correct list
     for (int i = m_executableTargets.size() - 1; i >= 0; i--) {
-        auto it = scriptMap.find(m_executableTargets[i]);
+        auto it = scriptMap.find(m_executableTargets.at(i)); // the layers can change while running the scripts
 
         if ((it == scriptMap.cend()) || it->second.empty())
             continue; // skip the target if it doesn't have any running script
 
         const auto &scripts = it->second;
 
-        for (int i = 0; i < scripts.size(); i++) {
-            auto script = scripts[i];
-            assert(script);
+        if (m_parallelExecutionEnabled) {
+            auto pred = [](std::shared_ptr<VirtualMachine> vm) { return vm->script() && vm->script()->isTargetLocal(); };
 
-            if (std::find(m_scriptsToRemove.begin(), m_scriptsToRemove.end(), script.get()) != m_scriptsToRemove.end())
-                continue; // skip the script if it is scheduled to be removed
-
-            script->run();
-
-            if (script->atEnd() && m_running) {
-                if (std::find(m_scriptsToRemove.begin(), m_scriptsToRemove.end(), script.get()) == m_scriptsToRemove.end())
-                    m_scriptsToRemove.push_back(script.get());
+            if (std::all_of(scripts.begin(), scripts.end(), pred)) {
+                parallelScripts.push_back(&scripts);
+                continue;
             }
+
+            // Other scripts might read the targets, so the parallel scripts must finish first
+            runParallelScripts(parallelScripts);
+            parallelScripts.clear();
         }
+
+        runTargetScripts(scripts, m_scriptsToRemove);
     }
 
+    runParallelScripts(parallelScripts);
+
     assert(m_running || m_scriptsToRemove.empty());
 
     for (auto script : m_scriptsToRemove) {
@@ -437,33 +1231,159 @@ void Engine::runScripts(const TargetScriptMap &scriptMap, TargetScriptMap &globa
             }
         }
 
-        assert(found);
+        assert(found);
+
+        // Remove from globalScriptMap
+        for (auto &[target, scripts] : globalScriptMap) {
+            auto it = std::find_if(scripts.begin(), scripts.end(), pred);
+
+            if (it != scripts.end()) {
+                scripts.erase(it);
+                break;
+            }
+        }
+
+        // Remove from m_runningBroadcastMap
+        for (auto &[broadcast, pairs] : m_runningBroadcastMap) {
+            size_t index = 0;
+
+            for (const auto &pair : pairs) {
+                if (pair.second == script) {
+                    pairs.erase(pairs.begin() + index);
+                    break;
+                }
+
+                index++;
+            }
+        }
+    }
+    m_scriptsToRemove.clear();
+}
+
+void Engine::runTargetScripts(const std::vector<std::shared_ptr<VirtualMachine>> &scripts, std::vector<VirtualMachine *> &finishedScripts)
+{
+    for (int i = 0; i < scripts.size(); i++) {
+        auto script = scripts[i];
+        assert(script);
+
+        if (std::find(m_scriptsToRemove.begin(), m_scriptsToRemove.end(), script.get()) != m_scriptsToRemove.end())
+            continue; // skip the script if it is scheduled to be removed
+
+        script->run();
+
+        if (script->atEnd() && m_running) {
+            if (std::find(finishedScripts.begin(), finishedScripts.end(), script.get()) == finishedScripts.end())
+                finishedScripts.push_back(script.get());
+        }
+    }
+}
+
+void Engine::runParallelScripts(const std::vector<const std::vector<std::shared_ptr<VirtualMachine>> *> &targetScripts)
+{
+    if (targetScripts.size() <= 1) {
+        for (auto scripts : targetScripts)
+            runTargetScripts(*scripts, m_scriptsToRemove);
+
+        return;
+    }
+
+    // Target-local scripts don't modify m_scriptsToRemove, so finished scripts are collected separately and merged in the original order
+    std::vector<std::vector<VirtualMachine *>> finishedScripts(targetScripts.size());
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (size_t i = 0; i < targetScripts.size(); i++)
+        tasks.push_back([this, i, &targetScripts, &finishedScripts]() { runTargetScripts(*targetScripts[i], finishedScripts[i]); });
+
+    threadPool()->run(tasks);
+
+    for (const auto &scripts : finishedScripts) {
+        for (VirtualMachine *script : scripts) {
+            if (std::find(m_scriptsToRemove.begin(), m_scriptsToRemove.end(), script) == m_scriptsToRemove.end())
+                m_scriptsToRemove.push_back(script);
+        }
+    }
+}
+
+// Returns the thread pool used for parallel compilation and execution (it's created on the first use).
+WorkStealingPool *Engine::threadPool()
+{
+    if (!m_threadPool)
+        m_threadPool = std::make_unique<WorkStealingPool>();
+
+    return m_threadPool.get();
+}
+
+// Returns true if the bytecode (including called procedures) only uses the given target.
+bool Engine::isTargetLocal(
+    const std::vector<unsigned int> &bytecode,
+    Target *target,
+    const std::vector<Variable *> &variables,
+    const std::vector<Script *> &procedures,
+    std::unordered_set<Script *> &visitedProcedures) const
+{
+    // The stage is shared by all sprites
+    if (bytecode.empty() || !target || target->isStage())
+        return false;
 
-        // Remove from globalScriptMap
-        for (auto &[target, scripts] : globalScriptMap) {
-            auto it = std::find_if(scripts.begin(), scripts.end(), pred);
+    // NOTE: OP_HALT can be in the middle of the bytecode (e.g. "stop this script"), so the whole bytecode is checked
+    const unsigned int *pos = bytecode.data();
+    const unsigned int *end = pos + bytecode.size();
+
+    while (pos < end) {
+        unsigned int op = *pos;
+
+        switch (op) {
+            case vm::OP_PRINT:
+            case vm::OP_RANDOM:
+            case vm::OP_READ_LIST:
+            case vm::OP_LIST_APPEND:
+            case vm::OP_LIST_DEL:
+            case vm::OP_LIST_DEL_ALL:
+            case vm::OP_LIST_INSERT:
+            case vm::OP_LIST_REPLACE:
+            case vm::OP_LIST_GET_ITEM:
+            case vm::OP_LIST_INDEX_OF:
+            case vm::OP_LIST_LENGTH:
+            case vm::OP_LIST_CONTAINS:
+                return false;
+
+            case vm::OP_SET_VAR:
+            case vm::OP_CHANGE_VAR:
+            case vm::OP_READ_VAR: {
+                // Only sprite-local variables (these are copied to clones)
+                if (pos[1] >= variables.size() || variables[pos[1]]->target() != target)
+                    return false;
 
-            if (it != scripts.end()) {
-                scripts.erase(it);
                 break;
             }
-        }
 
-        // Remove from m_runningBroadcastMap
-        for (auto &[broadcast, pairs] : m_runningBroadcastMap) {
-            size_t index = 0;
+            case vm::OP_EXEC:
+            case vm::OP_EXEC_CACHED:
+                if (pos[1] >= m_functions.size() || m_targetLocalFunctions.find(m_functions[pos[1]]) == m_targetLocalFunctions.cend())
+                    return false;
 
-            for (const auto &pair : pairs) {
-                if (pair.second == script) {
-                    pairs.erase(pairs.begin() + index);
-                    break;
-                }
+                break;
 
-                index++;
+            case vm::OP_CALL_PROCEDURE: {
+                Script *procedure = pos[1] < procedures.size() ? procedures[pos[1]] : nullptr;
+
+                if (!procedure)
+                    return false;
+
+                if (visitedProcedures.insert(procedure).second && !isTargetLocal(procedure->bytecodeVector(), target, variables, procedures, visitedProcedures))
+                    return false;
+
+                break;
             }
+
+            default:
+                break;
         }
+
+        pos += VirtualMachinePrivate::instruction_arg_count[op] + 1;
     }
-    m_scriptsToRemove.clear();
+
+    return true;
 }
 
 bool Engine::isRunning() const
@@ -492,6 +1412,74 @@ void Engine::setTurboModeEnabled(bool turboMode)
     m_turboModeEnabled = turboMode;
 }
 
+bool Engine::fixedTimestepEnabled() const
+{
+    return m_fixedTimestepEnabled;
+}
+
+// Returns true if the targets are compiled in parallel (enabled by default).
+bool Engine::parallelCompilationEnabled() const
+{
+    return m_parallelCompilationEnabled;
+}
+
+// Toggles parallel compilation. The result is the same in both modes.
+void Engine::setParallelCompilationEnabled(bool enable)
+{
+    m_parallelCompilationEnabled = enable;
+}
+
+bool Engine::parallelExecutionEnabled() const
+{
+    return m_parallelExecutionEnabled;
+}
+
+void Engine::setParallelExecutionEnabled(bool enable)
+{
+    // The event loop might be using the thread pool
+    if (postInputEvent({ InputEvent::Type::ParallelExecution, "", enable }))
+        return;
+
+    m_parallelExecutionEnabled = enable;
+
+    if (!enable)
+        m_threadPool.reset();
+}
+
+bool Engine::loggingEnabled() const
+{
+    return m_loggingEnabled;
+}
+
+void Engine::setLoggingEnabled(bool enable)
+{
+    m_loggingEnabled = enable;
+}
+
+void Engine::setFixedTimestepEnabled(bool enable)
+{
+    if (enable == m_fixedTimestepEnabled)
+        return;
+
+    m_fixedTimestepEnabled = enable;
+
+    if (enable) {
+        m_virtualClock = std::make_unique<VirtualClock>();
+        m_clock = m_virtualClock.get();
+    } else
+        m_clock = Clock::instance().get();
+
+    // The default timer must use the new clock
+    bool defaultTimer = (m_timer == m_defaultTimer.get());
+    m_defaultTimer = std::make_unique<Timer>(m_clock);
+
+    if (defaultTimer)
+        m_timer = m_defaultTimer.get();
+
+    if (!enable)
+        m_virtualClock.reset();
+}
+
 bool Engine::keyPressed(const std::string &name) const
 {
     if (name == "any") {
@@ -523,6 +1511,9 @@ void Engine::setKeyState(const std::string &name, bool pressed)
 
 void Engine::setKeyState(const KeyEvent &event, bool pressed)
 {
+    if (postInputEvent({ InputEvent::Type::Key, event.name(), pressed }))
+        return;
+
     m_keyMap[event.name()] = pressed;
 
     // Start "when key pressed" scripts
@@ -541,6 +1532,9 @@ void Engine::setKeyState(const KeyEvent &event, bool pressed)
 
 void Engine::setAnyKeyPressed(bool pressed)
 {
+    if (postInputEvent({ InputEvent::Type::AnyKey, "", pressed }))
+        return;
+
     m_anyKeyPressed = pressed;
 
     // Start "when key pressed" scripts
@@ -559,6 +1553,9 @@ double Engine::mouseX() const
 
 void Engine::setMouseX(double x)
 {
+    if (postInputEvent({ InputEvent::Type::MouseX, "", false, x }))
+        return;
+
     m_mouseX = x;
 }
 
@@ -569,6 +1566,9 @@ double Engine::mouseY() const
 
 void Engine::setMouseY(double y)
 {
+    if (postInputEvent({ InputEvent::Type::MouseY, "", false, y }))
+        return;
+
     m_mouseY = y;
 }
 
@@ -579,6 +1579,9 @@ bool Engine::mousePressed() const
 
 void Engine::setMousePressed(bool pressed)
 {
+    if (postInputEvent({ InputEvent::Type::MousePressed, "", pressed }))
+        return;
+
     m_mousePressed = pressed;
 }
 
@@ -595,6 +1598,7 @@ unsigned int Engine::stageWidth() const
 void Engine::setStageWidth(unsigned int width)
 {
     m_stageWidth = width;
+    m_spatialIndex.setStageSize(m_stageWidth, m_stageHeight);
 }
 
 unsigned int Engine::stageHeight() const
@@ -605,6 +1609,7 @@ unsigned int Engine::stageHeight() const
 void Engine::setStageHeight(unsigned int height)
 {
     m_stageHeight = height;
+    m_spatialIndex.setStageSize(m_stageWidth, m_stageHeight);
 }
 
 int Engine::cloneLimit() const
@@ -622,6 +1627,57 @@ int Engine::cloneCount() const
     return m_clones.size();
 }
 
+std::shared_ptr<Sprite> Engine::takeClone(Sprite *sprite)
+{
+    auto it = m_clonePool.find(sprite);
+
+    if (it != m_clonePool.end()) {
+        auto &clones = it->second;
+
+        while (!clones.empty()) {
+            std::shared_ptr<Sprite> clone = clones.back();
+            clones.pop_back();
+            m_clonePoolSize--;
+
+            // Don't reuse clones which are still referenced somewhere else
+            if (clone.use_count() == 1) {
+                m_clonePoolHits++;
+                return clone;
+            }
+        }
+    }
+
+    m_clonePoolMisses++;
+    return nullptr;
+}
+
+int Engine::clonePoolLimit() const
+{
+    return m_clonePoolLimit;
+}
+
+void Engine::setClonePoolLimit(int limit)
+{
+    m_clonePoolLimit = std::max(limit, 0);
+
+    for (auto &[sprite, clones] : m_clonePool) {
+        while (m_clonePoolSize > m_clonePoolLimit && !clones.empty()) {
+            clones.pop_back();
+            m_clonePoolSize--;
+        }
+    }
+}
+
+unsigned int Engine::clonePoolHits() const
+{
+    return m_clonePoolHits;
+}
+
+unsigned int Engine::clonePoolMisses() const
+{
+    return m_clonePoolMisses;
+}
+
 bool Engine::spriteFencingEnabled() const
 {
     return m_spriteFencingEnabled;
@@ -632,6 +1688,45 @@ void Engine::setSpriteFencingEnabled(bool enable)
     m_spriteFencingEnabled = enable;
 }
 
+bool Engine::spriteTransformStoreEnabled() const
+{
+    return m_transformStore != nullptr;
+}
+
+void Engine::setSpriteTransformStoreEnabled(bool enable)
+{
+    if (enable == (m_transformStore != nullptr))
+        return;
+
+    if (!enable) {
+        m_transformStore.reset(); // moves the transforms back to the sprites
+        return;
+    }
+
+    m_transformStore = std::make_unique<TransformStore>();
+
+    for (auto target : m_targets) {
+        if (Sprite *sprite = dynamic_cast<Sprite *>(target.get()))
+            m_transformStore->attach(sprite);
+    }
+
+    for (auto clone : m_clones)
+        m_transformStore->attach(clone.get());
+}
+
+bool Engine::batchedSpriteNotificationsEnabled() const
+{
+    return m_batchedSpriteNotificationsEnabled;
+}
+
+void Engine::setBatchedSpriteNotificationsEnabled(bool enable)
+{
+    if (m_batchedSpriteNotificationsEnabled && !enable)
+        flushSpriteChanges();
+
+    m_batchedSpriteNotificationsEnabled = enable;
+}
+
 bool Engine::broadcastRunning(unsigned int index, VirtualMachine *sourceScript)
 {
     if (index < 0 || index >= m_broadcasts.size())
@@ -672,6 +1767,21 @@ void Engine::setTimer(ITimer *timer)
     m_timer = timer;
 }
 
+IClock *Engine::clock() const
+{
+    return m_clock;
+}
+
+IRandomGenerator *Engine::randomGenerator() const
+{
+    return m_rng.get();
+}
+
+void Engine::setRandomSeed(unsigned int seed)
+{
+    m_rng->setSeed(seed);
+}
+
 void Engine::registerSection(std::shared_ptr<IBlockSection> section)
 {
     if (section) {
@@ -681,6 +1791,8 @@ void Engine::registerSection(std::shared_ptr<IBlockSection> section)
         }
 
         m_sections[section] = std::make_unique<BlockSectionContainer>();
+        m_sectionNames.insert({ section->name(), m_sectionList.size() });
+        m_sectionList.push_back(section.get());
         section->registerBlocks(this);
     }
 }
@@ -695,12 +1807,43 @@ std::vector<std::shared_ptr<IBlockSection>> Engine::registeredSections() const
     return ret;
 }
 
+int Engine::findSection(const std::string &name) const
+{
+    auto it = m_sectionNames.find(name);
+
+    if (it == m_sectionNames.cend())
+        return -1;
+    else
+        return it->second;
+}
+
+IBlockSection *Engine::sectionAt(int index) const
+{
+    if (index < 0 || index >= m_sectionList.size())
+        return nullptr;
+
+    return m_sectionList[index];
+}
+
 unsigned int Engine::functionIndex(BlockFunc f)
 {
-    auto it = std::find(m_functions.begin(), m_functions.end(), f);
-    if (it != m_functions.end())
-        return it - m_functions.begin();
+    // Targets being compiled use their own function table (see mergeTarget())
+    if (m_currentCompilation && m_currentCompilation->engine == this) {
+        auto &functions = m_currentCompilation->functions;
+        auto it = std::find(functions.begin(), functions.end(), f);
+
+        if (it != functions.end())
+            return it - functions.begin();
+
+        functions.push_back(f);
+        return functions.size() - 1;
+    }
+
+    auto it = m_functionIndexes.find(f);
+    if (it != m_functionIndexes.end())
+        return it->second;
     m_functions.push_back(f);
+    m_functionIndexes[f] = m_functions.size() - 1;
     return m_functions.size() - 1;
 }
 
@@ -744,6 +1887,19 @@ void Engine::addFieldValue(IBlockSection *section, const std::string &value, int
         container->addFieldValue(value, id);
 }
 
+void Engine::addFunction(IBlockSection *section, BlockFunc f)
+{
+    auto container = blockSectionContainer(section);
+
+    if (container)
+        container->addFunction(f);
+}
+
+void Engine::addTargetLocalFunction(BlockFunc f)
+{
+    m_targetLocalFunctions.insert(f);
+}
+
 const std::vector<std::shared_ptr<Broadcast>> &Engine::broadcasts() const
 {
     return m_broadcasts;
@@ -752,6 +1908,12 @@ const std::vector<std::shared_ptr<Broadcast>> &Engine::broadcasts() const
 void Engine::setBroadcasts(const std::vector<std::shared_ptr<Broadcast>> &broadcasts)
 {
     m_broadcasts = broadcasts;
+    m_broadcastNames.invalidate();
+    m_broadcastIds.invalidate();
+
+    for (auto broadcast : m_broadcasts)
+        m_indexGroup->adopt(*broadcast);
+    updateEntityMap();
 }
 
 std::shared_ptr<Broadcast> Engine::broadcastAt(int index) const
@@ -764,28 +1926,21 @@ std::shared_ptr<Broadcast> Engine::broadcastAt(int index) const
 
 int Engine::findBroadcast(const std::string &broadcastName) const
 {
-    int i = 0;
-    for (auto broadcast : m_broadcasts) {
-        if (broadcast->name() == broadcastName)
-            return i;
-        i++;
-    }
-    return -1;
+    return m_broadcastNames.find(m_broadcasts, broadcastName);
 }
 
 int Engine::findBroadcastById(const std::string &broadcastId) const
 {
-    int i = 0;
-    for (auto broadcast : m_broadcasts) {
-        if (broadcast->id() == broadcastId)
-            return i;
-        i++;
-    }
-    return -1;
+    return m_broadcastIds.find(m_broadcasts, broadcastId);
 }
 
 void Engine::addBroadcastScript(std::shared_ptr<Block> whenReceivedBlock, Broadcast *broadcast)
 {
+    if (m_currentCompilation && m_currentCompilation->engine == this) {
+        m_currentCompilation->hatRegistrations.push_back({ HatType::Broadcast, whenReceivedBlock, broadcast });
+        return;
+    }
+
     if (m_broadcastMap.count(broadcast) == 1) {
         std::vector<Script *> &scripts = m_broadcastMap[broadcast];
         // TODO: Do not allow adding existing scripts
@@ -801,6 +1956,11 @@ void Engine::addBroadcastScript(std::shared_ptr<Block> whenReceivedBlock, Broadc
 
 void Engine::addCloneInitScript(std::shared_ptr<Block> hatBlock)
 {
+    if (m_currentCompilation && m_currentCompilation->engine == this) {
+        m_currentCompilation->hatRegistrations.push_back({ HatType::CloneInit, hatBlock });
+        return;
+    }
+
     Target *target = hatBlock->target();
     Script *script = m_scripts[hatBlock].get();
     auto it = m_cloneInitScriptsMap.find(target);
@@ -817,6 +1977,11 @@ void Engine::addCloneInitScript(std::shared_ptr<Block> hatBlock)
 
 void Engine::addKeyPressScript(std::shared_ptr<Block> hatBlock, std::string keyName)
 {
+    if (m_currentCompilation && m_currentCompilation->engine == this) {
+        m_currentCompilation->hatRegistrations.push_back({ HatType::KeyPress, hatBlock, nullptr, keyName });
+        return;
+    }
+
     std::transform(keyName.begin(), keyName.end(), keyName.begin(), ::tolower);
     Script *script = m_scripts[hatBlock].get();
     auto it = m_whenKeyPressedScripts.find(keyName);
@@ -838,14 +2003,30 @@ const std::vector<std::shared_ptr<Target>> &Engine::targets() const
 
 void Engine::setTargets(const std::vector<std::shared_ptr<Target>> &newTargets)
 {
-    m_targets = newTargets;
     m_executableTargets.clear();
+    m_targets = newTargets;
+    m_targetIndex.invalidate();
+    clearClonePool(); // the clones belong to the old targets
+
+    m_spatialIndex.clear();
+    std::vector<Target *> executableTargets;
+
+    if (m_transformStore)
+        m_transformStore->clear();
 
     for (auto target : m_targets) {
-        m_executableTargets.push_back(target.get());
+        executableTargets.push_back(target.get());
+
+        if (Sprite *sprite = dynamic_cast<Sprite *>(target.get())) {
+            m_spatialIndex.addSprite(sprite);
+
+            if (m_transformStore)
+                m_transformStore->attach(sprite);
+        }
 
         // Set engine in the target
         target->setEngine(this);
+        m_indexGroup->adopt(*target);
         auto blocks = target->blocks();
 
         for (auto block : blocks) {
@@ -855,8 +2036,13 @@ void Engine::setTargets(const std::vector<std::shared_ptr<Target>> &newTargets)
         }
     }
 
-    // Sort the executable targets by layer order
-    std::sort(m_executableTargets.begin(), m_executableTargets.end(), [](Target *t1, Target *t2) { return t1->layerOrder() < t2->layerOrder(); });
+    // Sort the executable targets by layer order (the layer orders are normalized by the layer list)
+    std::stable_sort(executableTargets.begin(), executableTargets.end(), [](Target *t1, Target *t2) { return t1->layerOrder() < t2->layerOrder(); });
+
+    for (Target *target : executableTargets)
+        m_executableTargets.append(target);
+
+    updateEntityMap();
 }
 
 Target *Engine::targetAt(int index) const
@@ -869,13 +2055,7 @@ Target *Engine::targetAt(int index) const
 
 int Engine::findTarget(const std::string &targetName) const
 {
-    int i = 0;
-    for (auto target : m_targets) {
-        if ((target->isStage() && targetName == "_stage_") || (!target->isStage() && target->name() == targetName))
-            return i;
-        i++;
-    }
-    return -1;
+    return m_targetIndex.find(m_targets, targetName);
 }
 
 void Engine::moveSpriteToFront(Sprite *sprite)
@@ -883,12 +2063,7 @@ void Engine::moveSpriteToFront(Sprite *sprite)
     if (!sprite || m_executableTargets.size() <= 2)
         return;
 
-    auto it = std::find(m_executableTargets.begin(), m_executableTargets.end(), sprite);
-
-    if (it != m_executableTargets.end()) {
-        std::rotate(it, it + 1, m_executableTargets.end());
-        updateSpriteLayerOrder();
-    }
+    m_executableTargets.move(sprite, m_executableTargets.size() - 1);
 }
 
 void Engine::moveSpriteToBack(Sprite *sprite)
@@ -896,12 +2071,7 @@ void Engine::moveSpriteToBack(Sprite *sprite)
     if (!sprite || m_executableTargets.size() <= 2)
         return;
 
-    auto it = std::find(m_executableTargets.begin(), m_executableTargets.end(), sprite);
-
-    if (it != m_executableTargets.end()) {
-        std::rotate(m_executableTargets.begin() + 1, it, it + 1); // stage is always the first
-        updateSpriteLayerOrder();
-    }
+    m_executableTargets.move(sprite, 1); // stage is always the first
 }
 
 void Engine::moveSpriteForwardLayers(Sprite *sprite, int layers)
@@ -909,29 +2079,24 @@ void Engine::moveSpriteForwardLayers(Sprite *sprite, int layers)
     if (!sprite || layers == 0)
         return;
 
-    auto it = std::find(m_executableTargets.begin(), m_executableTargets.end(), sprite);
+    int index = m_executableTargets.indexOf(sprite);
 
-    if (it == m_executableTargets.end())
+    if (index == -1)
         return;
 
-    auto target = it + layers;
+    int target = index + layers;
 
-    if (target <= m_executableTargets.begin()) {
+    if (target <= 0) {
         moveSpriteToBack(sprite);
         return;
     }
 
-    if (target >= m_executableTargets.end()) {
+    if (target >= static_cast<int>(m_executableTargets.size())) {
         moveSpriteToFront(sprite);
         return;
     }
 
-    if (layers > 0)
-        std::rotate(it, it + 1, target + 1);
-    else
-        std::rotate(target, it, it + 1);
-
-    updateSpriteLayerOrder();
+    m_executableTargets.move(sprite, target);
 }
 
 void Engine::moveSpriteBackwardLayers(Sprite *sprite, int layers)
@@ -944,33 +2109,42 @@ void Engine::moveSpriteBehindOther(Sprite *sprite, Sprite *other)
     if (sprite == other)
         return;
 
-    auto itSprite = std::find(m_executableTargets.begin(), m_executableTargets.end(), sprite);
-    auto itOther = std::find(m_executableTargets.begin(), m_executableTargets.end(), other);
+    int spriteIndex = m_executableTargets.indexOf(sprite);
+    int otherIndex = m_executableTargets.indexOf(other);
+
+    if ((spriteIndex == -1) || (otherIndex == -1))
+        return;
 
-    if ((itSprite == m_executableTargets.end()) || (itOther == m_executableTargets.end()))
+    // New clones are already behind the sprite they were created from
+    if (spriteIndex + 1 == otherIndex)
         return;
 
-    auto target = itOther - 1; // behind
+    int target = otherIndex - 1; // behind
 
-    if (target < itSprite)
+    if (target < spriteIndex)
         target++;
 
-    if (target <= m_executableTargets.begin()) {
+    if (target <= 0) {
         moveSpriteToBack(sprite);
         return;
     }
 
-    if (target >= m_executableTargets.end()) {
+    if (target >= static_cast<int>(m_executableTargets.size())) {
         moveSpriteToFront(sprite);
         return;
     }
 
-    if (target > itSprite)
-        std::rotate(itSprite, itSprite + 1, target + 1);
-    else
-        std::rotate(target, itSprite, itSprite + 1);
+    m_executableTargets.move(sprite, target);
+}
+
+void Engine::invalidateSpriteBounds(const Sprite *sprite)
+{
+    m_spatialIndex.invalidate(sprite);
+}
 
-    updateSpriteLayerOrder();
+bool Engine::touchingSprite(const Sprite *sprite, const Sprite *other)
+{
+    return m_spatialIndex.touchingSprite(sprite, other);
 }
 
 Stage *Engine::stage() const
@@ -991,6 +2165,9 @@ const std::vector<std::string> &Engine::extensions() const
 void Engine::setExtensions(const std::vector<std::string> &newExtensions)
 {
     m_sections.clear();
+    m_sectionList.clear();
+    m_sectionNames.clear();
+    m_targetLocalFunctions.clear();
     m_extensions = newExtensions;
 
     // Register standard block sections
@@ -1011,62 +2188,42 @@ const std::unordered_map<std::shared_ptr<Block>, std::shared_ptr<Script>> &Engin
     return m_scripts;
 }
 
-// Returns the block with the given ID.
-std::shared_ptr<Block> Engine::getBlock(const std::string &id)
+// Rebuilds the ID -> entity maps used by resolveIds().
+void Engine::updateEntityMap()
 {
-    if (id.empty())
-        return nullptr;
+    m_entityMap.clear();
+    m_commentMap.clear();
 
+    // Entities are inserted in the order of lookup priority (blocks, variables, lists, broadcasts),
+    // emplace() keeps the first entity if an ID is used more than once
     for (auto target : m_targets) {
-        int index = target->findBlock(id);
-        if (index != -1)
-            return target->blockAt(index);
+        for (auto block : target->blocks())
+            m_entityMap.emplace(block->id(), block);
     }
 
-    return nullptr;
-}
-
-// Returns the variable with the given ID.
-std::shared_ptr<Variable> Engine::getVariable(const std::string &id)
-{
-    if (id.empty())
-        return nullptr;
-
     for (auto target : m_targets) {
-        int index = target->findVariableById(id);
-        if (index != -1)
-            return target->variableAt(index);
+        for (auto variable : target->variables())
+            m_entityMap.emplace(variable->id(), variable);
     }
 
-    return nullptr;
-}
+    for (auto target : m_targets) {
+        for (auto list : target->lists())
+            m_entityMap.emplace(list->id(), list);
+    }
 
-// Returns the Scratch list with the given ID.
-std::shared_ptr<List> Engine::getList(const std::string &id)
-{
-    if (id.empty())
-        return nullptr;
+    for (auto broadcast : m_broadcasts)
+        m_entityMap.emplace(broadcast->id(), broadcast);
 
     for (auto target : m_targets) {
-        int index = target->findListById(id);
-        if (index != -1)
-            return target->listAt(index);
+        for (auto comment : target->comments())
+            m_commentMap.emplace(comment->id(), comment);
     }
-
-    return nullptr;
 }
 
-// Returns the broadcast with the given ID.
-std::shared_ptr<Broadcast> Engine::getBroadcast(const std::string &id)
+// Returns the block with the given ID.
+std::shared_ptr<Block> Engine::getBlock(const std::string &id)
 {
-    if (id.empty())
-        return nullptr;
-
-    int index = findBroadcastById(id);
-    if (index != -1)
-        return broadcastAt(index);
-
-    return nullptr;
+    return std::dynamic_pointer_cast<Block>(getEntity(id));
 }
 
 // Returns the comment with the given ID.
@@ -1075,39 +2232,26 @@ std::shared_ptr<Comment> Engine::getComment(const std::string &id)
     if (id.empty())
         return nullptr;
 
-    for (auto target : m_targets) {
-        int index = target->findComment(id);
-        if (index != -1)
-            return target->commentAt(index);
-    }
+    auto it = m_commentMap.find(id);
 
-    return nullptr;
+    if (it == m_commentMap.cend())
+        return nullptr;
+
+    return it->second;
 }
 
 // Returns the entity with the given ID. \see IEntity
 std::shared_ptr<Entity> Engine::getEntity(const std::string &id)
 {
-    // Blocks
-    auto block = getBlock(id);
-    if (block)
-        return std::static_pointer_cast<Entity>(block);
-
-    // Variables
-    auto variable = getVariable(id);
-    if (variable)
-        return std::static_pointer_cast<Entity>(variable);
+    if (id.empty())
+        return nullptr;
 
-    // Lists
-    auto list = getList(id);
-    if (list)
-        return std::static_pointer_cast<Entity>(list);
+    auto it = m_entityMap.find(id);
 
-    // Broadcasts
-    auto broadcast = getBroadcast(id);
-    if (broadcast)
-        return std::static_pointer_cast<Entity>(broadcast);
+    if (it == m_entityMap.cend())
+        return nullptr;
 
-    return nullptr;
+    return it->second;
 }
 
 std::shared_ptr<IBlockSection> Engine::blockSection(const std::string &opcode) const
@@ -1121,14 +2265,6 @@ std::shared_ptr<IBlockSection> Engine::blockSection(const std::string &opcode) c
     return nullptr;
 }
 
-void Engine::updateSpriteLayerOrder()
-{
-    assert(m_executableTargets.empty() || m_executableTargets[0]->isStage());
-
-    for (size_t i = 1; i < m_executableTargets.size(); i++) // i = 1 to skip the stage
-        m_executableTargets[i]->setLayerOrder(i);
-}
-
 BlockSectionContainer *Engine::blockSectionContainer(const std::string &opcode) const
 {
     for (const auto &pair : m_sections) {
@@ -1155,18 +2291,22 @@ BlockSectionContainer *Engine::blockSectionContainer(IBlockSection *section) con
 
 void Engine::finalize()
 {
-    m_eventLoopMutex.lock();
     m_runningScripts.clear();
     m_scriptsToRemove.clear();
     m_running = false;
     m_redrawRequested = false;
-    m_eventLoopMutex.unlock();
 }
 
 void Engine::deleteClones()
 {
-    m_eventLoopMutex.lock();
-    removeExecutableClones();
+    for (auto clone : m_clones) {
+        m_executableTargets.remove(clone.get());
+        m_spatialIndex.removeSprite(clone.get());
+
+        if (m_transformStore)
+            m_transformStore->detach(clone.get());
+    }
+
     m_clones.clear();
 
     for (auto target : m_targets) {
@@ -1181,15 +2321,44 @@ void Engine::deleteClones()
             }
         }
     }
+}
+
+void Engine::clearClonePool()
+{
+    m_clonePool.clear();
+    m_clonePoolSize = 0;
+}
+
+void Engine::callRedrawHandler()
+{
+    if (m_batchedSpriteNotificationsEnabled)
+        flushSpriteChanges();
+
+    if (m_redrawHandler)
+        m_redrawHandler();
+
+    // The dirty flags hold the changes since the last redraw
+    if (m_transformStore)
+        m_transformStore->clearDirty();
+}
 
-    m_eventLoopMutex.unlock();
+// Sends the changes recorded since the last redraw to the sprite handlers (sprites first, then their clones)
+void Engine::flushSpriteChanges()
+{
+    for (auto target : m_targets) {
+        if (Sprite *sprite = dynamic_cast<Sprite *>(target.get())) {
+            sprite->impl->flushChanges();
+
+            for (auto clone : sprite->clones())
+                clone->impl->flushChanges();
+        }
+    }
 }
 
-void Engine::removeExecutableClones()
+const std::string &Engine::TargetKey::operator()(const Target &target) const
 {
-    // Remove clones from the executable targets
-    for (std::shared_ptr<Sprite> clone : m_clones)
-        m_executableTargets.erase(std::remove(m_executableTargets.begin(), m_executableTargets.end(), clone.get()), m_executableTargets.end());
+    static const std::string stageKey = "_stage_";
+    return target.isStage() ? stageKey : target.name();
 }
 
 void Engine::updateFrameDuration()
@@ -1219,6 +2388,22 @@ void Engine::addRunningScript(std::shared_ptr<VirtualMachine> vm)
     }
 }
 
+// Removes the script from running scripts immediately (unlike stopScript(), which removes it after the current frame)
+void Engine::removeRunningScript(VirtualMachine *vm)
+{
+    auto pred = [vm](std::shared_ptr<VirtualMachine> script) { return script.get() == vm; };
+
+    for (TargetScriptMap *scriptMap : { &m_runningScripts, &m_newScripts }) {
+        for (auto &[target, scripts] : *scriptMap)
+            scripts.erase(std::remove_if(scripts.begin(), scripts.end(), pred), scripts.end());
+    }
+
+    m_scriptsToRemove.erase(std::remove(m_scriptsToRemove.begin(), m_scriptsToRemove.end(), vm), m_scriptsToRemove.end());
+
+    for (auto &[broadcast, pairs] : m_runningBroadcastMap)
+        pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [vm](const auto &pair) { return pair.second == vm; }), pairs.end());
+}
+
 std::vector<VirtualMachine *> Engine::startHats(const std::vector<Script *> &scripts)
 {
     std::vector<VirtualMachine *> startedScripts;
@@ -5,19 +5,33 @@
 #include <scratchcpp/iengine.h>
 #include <scratchcpp/target.h>
 #include <scratchcpp/itimer.h>
+#include <scratchcpp/value.h>
 #include <unordered_map>
 #include <memory>
 #include <chrono>
-#include <mutex>
-#include <set>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 #include "blocksectioncontainer.h"
+#include "compiledproject.h"
+#include "spscqueue.h"
+#include "layerlist.h"
+#include "spatialindex.h"
+#include "transformstore.h"
+#include "../../internal/nameindex.h"
 
 namespace libscratchcpp
 {
 
 class Entity;
+class Variable;
+class List;
+class Script;
 class IClock;
+class VirtualClock;
+class RandomGenerator;
+class WorkStealingPool;
 
 class Engine : public IEngine
 {
@@ -28,7 +42,11 @@ class Engine : public IEngine
 
         void clear() override;
         void resolveIds();
+        void resolveBlock(std::shared_ptr<Block> block);
         void compile() override;
+        bool compile(CompiledProject &compiledProject);
+        bool loadCompiledProject(const CompiledProject &compiledProject);
+        void recompile(Target *target, const std::vector<std::shared_ptr<Block>> &changedBlocks, const std::vector<std::shared_ptr<Block>> &removedBlocks = {}) override;
 
         void start() override;
         void stop() override;
@@ -43,10 +61,12 @@ class Engine : public IEngine
         void run() override;
         void runEventLoop() override;
         void stopEventLoop() override;
+        void step(unsigned int frames = 1) override;
 
         void setRedrawHandler(const std::function<void()> &handler) override;
 
         bool isRunning() const override;
+        bool hasRunningScripts() const override;
 
         double fps() const override;
         void setFps(double fps) override;
@@ -54,6 +74,15 @@ class Engine : public IEngine
         bool turboModeEnabled() const override;
         void setTurboModeEnabled(bool turboMode) override;
 
+        bool fixedTimestepEnabled() const override;
+        void setFixedTimestepEnabled(bool enable) override;
+
+        bool parallelExecutionEnabled() const override;
+        void setParallelExecutionEnabled(bool enable) override;
+
+        bool loggingEnabled() const override;
+        void setLoggingEnabled(bool enable) override;
+
         bool keyPressed(const std::string &name) const override;
         void setKeyState(const std::string &name, bool pressed) override;
         void setKeyState(const KeyEvent &event, bool pressed) override;
@@ -81,9 +110,23 @@ class Engine : public IEngine
 
         int cloneCount() const override;
 
+        std::shared_ptr<Sprite> takeClone(Sprite *sprite) override;
+
+        int clonePoolLimit() const override;
+        void setClonePoolLimit(int limit) override;
+
+        unsigned int clonePoolHits() const override;
+        unsigned int clonePoolMisses() const override;
+
         bool spriteFencingEnabled() const override;
         void setSpriteFencingEnabled(bool enable) override;
 
+        bool spriteTransformStoreEnabled() const override;
+        void setSpriteTransformStoreEnabled(bool enable) override;
+
+        bool batchedSpriteNotificationsEnabled() const override;
+        void setBatchedSpriteNotificationsEnabled(bool enable) override;
+
         bool broadcastRunning(unsigned int index, VirtualMachine *sourceScript) override;
         bool broadcastByPtrRunning(Broadcast *broadcast, VirtualMachine *sourceScript) override;
 
@@ -92,8 +135,14 @@ class Engine : public IEngine
         ITimer *timer() const override;
         void setTimer(ITimer *timer);
 
+        IClock *clock() const override;
+        IRandomGenerator *randomGenerator() const override;
+        void setRandomSeed(unsigned int seed) override;
+
         void registerSection(std::shared_ptr<IBlockSection> section) override;
         std::vector<std::shared_ptr<IBlockSection>> registeredSections() const;
+        int findSection(const std::string &name) const override;
+        IBlockSection *sectionAt(int index) const override;
         unsigned int functionIndex(BlockFunc f) override;
 
         void addCompileFunction(IBlockSection *section, const std::string &opcode, BlockComp f) override;
@@ -101,6 +150,8 @@ class Engine : public IEngine
         void addInput(IBlockSection *section, const std::string &name, int id) override;
         void addField(IBlockSection *section, const std::string &name, int id) override;
         void addFieldValue(IBlockSection *section, const std::string &value, int id) override;
+        void addFunction(IBlockSection *section, BlockFunc f) override;
+        void addTargetLocalFunction(BlockFunc f) override;
 
         const std::vector<std::shared_ptr<Broadcast>> &broadcasts() const override;
         void setBroadcasts(const std::vector<std::shared_ptr<Broadcast>> &broadcasts) override;
@@ -123,6 +174,9 @@ class Engine : public IEngine
         void moveSpriteBackwardLayers(Sprite *sprite, int layers) override;
         void moveSpriteBehindOther(Sprite *sprite, Sprite *other) override;
 
+        void invalidateSpriteBounds(const Sprite *sprite) override;
+        bool touchingSprite(const Sprite *sprite, const Sprite *other) override;
+
         Stage *stage() const override;
 
         const std::vector<std::string> &extensions() const override;
@@ -133,51 +187,156 @@ class Engine : public IEngine
         BlockSectionContainer *blockSectionContainer(const std::string &opcode) const;
         BlockSectionContainer *blockSectionContainer(IBlockSection *section) const;
 
+        bool parallelCompilationEnabled() const;
+        void setParallelCompilationEnabled(bool enable);
+
         IClock *m_clock = nullptr;
 
     private:
         using TargetScriptMap = std::unordered_map<Target *, std::vector<std::shared_ptr<VirtualMachine>>>;
 
+        // Key of the target index (the stage is found by "_stage_")
+        struct TargetKey
+        {
+                const std::string &operator()(const Target &target) const;
+        };
+
+        // Input from the host thread which is processed by the event loop
+        struct InputEvent
+        {
+                enum class Type
+                {
+                    Key,
+                    AnyKey,
+                    MouseX,
+                    MouseY,
+                    MousePressed,
+                    Start,
+                    Stop,
+                    ParallelExecution
+                };
+
+                Type type = Type::Key;
+                std::string key = "";
+                bool pressed = false; // also used by the events which toggle a setting
+                double value = 0;
+        };
+
         void eventLoop(bool untilProjectStops = false);
+        bool postInputEvent(const InputEvent &event);
+        void waitForInputEvents();
+        void processInputEvents();
+        void handleInputEvent(const InputEvent &event);
+        void runFixedFrame();
         void runScripts(const TargetScriptMap &scriptMap, TargetScriptMap &globalScriptMap);
+        void runTargetScripts(const std::vector<std::shared_ptr<VirtualMachine>> &scripts, std::vector<VirtualMachine *> &finishedScripts);
+        void runParallelScripts(const std::vector<const std::vector<std::shared_ptr<VirtualMachine>> *> &targetScripts);
+        WorkStealingPool *threadPool();
+        bool isTargetLocal(
+            const std::vector<unsigned int> &bytecode,
+            Target *target,
+            const std::vector<Variable *> &variables,
+            const std::vector<Script *> &procedures,
+            std::unordered_set<Script *> &visitedProcedures) const;
         void finalize();
         void deleteClones();
-        void removeExecutableClones();
+        void clearClonePool();
+        void callRedrawHandler();
+        void flushSpriteChanges();
+        void updateEntityMap();
         std::shared_ptr<Block> getBlock(const std::string &id);
-        std::shared_ptr<Variable> getVariable(const std::string &id);
-        std::shared_ptr<List> getList(const std::string &id);
-        std::shared_ptr<Broadcast> getBroadcast(const std::string &id);
         std::shared_ptr<Comment> getComment(const std::string &id);
         std::shared_ptr<Entity> getEntity(const std::string &id);
         std::shared_ptr<IBlockSection> blockSection(const std::string &opcode) const;
 
-        void updateSpriteLayerOrder();
+        // Script registered by a hat block while compiling (see mergeTarget())
+        struct HatRegistration
+        {
+                HatType type = HatType::Broadcast;
+                std::shared_ptr<Block> block;
+                Broadcast *broadcast = nullptr;
+                std::string keyName;
+        };
+
+        // Result of compiling one target (targets are compiled in parallel and merged in order)
+        struct TargetCompilation
+        {
+                Engine *engine = nullptr;
+                Target *target = nullptr;
+                std::vector<std::pair<std::shared_ptr<Block>, std::shared_ptr<Script>>> scripts;
+                std::vector<BlockFunc> functions; // local function table, merged into m_functions
+                std::vector<HatRegistration> hatRegistrations;
+                std::vector<std::string> procedureCodes;
+                std::vector<unsigned int *> procedures;
+                std::unordered_map<std::string, Script *> procedureDefinitions;
+                std::vector<Value> constValues;
+                std::vector<Variable *> variables;
+                std::vector<List *> lists;
+                std::string log;
+        };
+
+        bool compileTargets(CompiledProject *compiledProject);
+        void compileTarget(TargetCompilation &compilation);
+        void finishCompilation(std::vector<TargetCompilation> &compilations);
+        void mergeTarget(TargetCompilation &compilation);
+        bool saveTarget(const TargetCompilation &compilation, CompiledTarget &compiledTarget) const;
+        bool loadTarget(const CompiledTarget &compiledTarget, TargetCompilation &compilation);
+        bool isValidBytecode(const std::vector<unsigned int> &bytecode, const TargetCompilation &compilation) const;
+        void registrationOrder(std::vector<std::string> &sections, std::vector<std::string> &graphicsEffects) const;
+        static void remapFunctions(unsigned int *bytecode, size_t size, const std::vector<unsigned int> &functionMap);
+
+        static thread_local TargetCompilation *m_currentCompilation; // compilation running on the current thread
+
+        Script *compileScript(Target *target, std::shared_ptr<Block> topLevelBlock);
+        void updateProcedures(Script *script);
+        void removeHatScripts(Script *script);
 
         void updateFrameDuration();
         void addRunningScript(std::shared_ptr<VirtualMachine> vm);
+        void removeRunningScript(VirtualMachine *vm);
         std::vector<VirtualMachine *> startHats(const std::vector<Script *> &scripts);
 
         std::unordered_map<std::shared_ptr<IBlockSection>, std::unique_ptr<BlockSectionContainer>> m_sections;
+        std::vector<IBlockSection *> m_sectionList; // in the order of registration (see findSection())
+        std::unordered_map<std::string, int> m_sectionNames;
+        std::shared_ptr<NameIndexGroup> m_indexGroup = std::make_shared<NameIndexGroup>(); // targets and broadcasts
         std::vector<std::shared_ptr<Target>> m_targets;
+        NameIndex<Target, TargetKey> m_targetIndex{ *m_indexGroup };
         std::vector<std::shared_ptr<Broadcast>> m_broadcasts;
+        NameIndex<Broadcast> m_broadcastNames{ *m_indexGroup };
+        NameIndex<Broadcast, IdKey> m_broadcastIds{ *m_indexGroup };
+        std::unordered_map<std::string, std::shared_ptr<Entity>> m_entityMap; // blocks, variables, lists and broadcasts by ID
+        std::unordered_map<std::string, std::shared_ptr<Comment>> m_commentMap;
         std::unordered_map<Broadcast *, std::vector<Script *>> m_broadcastMap;
         std::unordered_map<Broadcast *, std::vector<std::pair<VirtualMachine *, VirtualMachine *>>> m_runningBroadcastMap; // source script, "when received" script
         std::unordered_map<Target *, std::vector<Script *>> m_cloneInitScriptsMap;                                         // target (no clones), "when I start as a clone" scripts
         std::unordered_map<std::string, std::vector<Script *>> m_whenKeyPressedScripts;                                    // key name, "when key pressed" scripts
         std::vector<std::string> m_extensions;
-        std::vector<Target *> m_executableTargets; // sorted by layer (reverse order of execution)
+        LayerList m_executableTargets;                    // sorted by layer (reverse order of execution)
+        SpatialIndex m_spatialIndex;                      // sprite bounds for touching checks
+        std::unique_ptr<TransformStore> m_transformStore; // transforms of sprites and clones (if enabled)
         TargetScriptMap m_runningScripts;
         TargetScriptMap m_newScripts;
         std::vector<VirtualMachine *> m_scriptsToRemove;
         std::unordered_map<std::shared_ptr<Block>, std::shared_ptr<Script>> m_scripts;
+        std::unordered_map<Script *, std::vector<std::string>> m_scriptProcedures;                     // procedure codes in the procedure list of each script
+        std::unordered_map<Target *, std::unordered_map<std::string, Script *>> m_procedureDefinitions; // custom block definitions of each target
         std::vector<BlockFunc> m_functions;
-        std::recursive_mutex m_eventLoopMutex;
+        std::unordered_map<BlockFunc, unsigned int> m_functionIndexes;
+        std::unordered_set<BlockFunc> m_targetLocalFunctions;
 
         std::unique_ptr<ITimer> m_defaultTimer;
         ITimer *m_timer = nullptr;
+        std::unique_ptr<RandomGenerator> m_rng;
         double m_fps = 30;                         // default FPS
         std::chrono::milliseconds m_frameDuration; // will be computed in eventLoop()
         bool m_turboModeEnabled = false;
+        bool m_fixedTimestepEnabled = false;
+        std::unique_ptr<VirtualClock> m_virtualClock; // used in fixed timestep mode
+        bool m_parallelCompilationEnabled = true;
+        std::atomic<bool> m_parallelExecutionEnabled = false;
+        std::unique_ptr<WorkStealingPool> m_threadPool; // used for compilation and in parallel execution mode
+        bool m_loggingEnabled = true;
         std::unordered_map<std::string, bool> m_keyMap; // holds key states
         bool m_anyKeyPressed = false;
         double m_mouseX = 0;
@@ -186,14 +345,25 @@ class Engine : public IEngine
         unsigned int m_stageWidth = 480;
         unsigned int m_stageHeight = 360;
         int m_cloneLimit = 300;
-        std::set<std::shared_ptr<Sprite>> m_clones;
+        std::unordered_set<std::shared_ptr<Sprite>> m_clones;
+        std::unordered_map<Sprite *, std::vector<std::shared_ptr<Sprite>>> m_clonePool; // deleted clones of each sprite
+        int m_clonePoolSize = 0;
+        int m_clonePoolLimit = 300;
+        unsigned int m_clonePoolHits = 0;
+        unsigned int m_clonePoolMisses = 0;
         bool m_spriteFencingEnabled = true;
+        bool m_batchedSpriteNotificationsEnabled = false;
 
         bool m_running = false;
-        bool m_redrawRequested = false;
+        std::atomic<bool> m_redrawRequested = false;
         std::function<void()> m_redrawHandler = nullptr;
-        bool m_stopEventLoop = false;
-        std::mutex m_stopEventLoopMutex;
+        std::atomic<bool> m_stopEventLoop = false;
+        std::atomic<bool> m_eventLoopRunning = false;
+        std::atomic<bool> m_eventLoopStopping = false;
+        std::atomic<int> m_inputEventsPosting = 0; // number of input events being posted or handled by the host thread
+        std::atomic<std::thread::id> m_eventLoopThread;
+        std::atomic<std::thread::id> m_inputEventThread; // the host thread while it's handling an input event
+        SpscQueue<InputEvent, 1024> m_inputQueue; // host thread -> event loop
 };
 
 } // namespace libscratchcpp
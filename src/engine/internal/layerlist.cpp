@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/target.h>
+#include <cassert>
+
+#include "layerlist.h"
+#include "../../scratch/target_p.h"
+
+using namespace libscratchcpp;
+
+namespace libscratchcpp
+{
+
+struct LayerNode
+{
+        LayerList *list = nullptr;
+        Target *target = nullptr;
+        LayerNode *left = nullptr;
+        LayerNode *right = nullptr;
+        LayerNode *parent = nullptr;
+        size_t size = 1;
+        uint32_t priority = 0;
+};
+
+} // namespace libscratchcpp
+
+LayerList::~LayerList()
+{
+    clear();
+}
+
+// Removes all targets. The targets keep their last layer order.
+void LayerList::clear()
+{
+    std::vector<LayerNode *> nodes;
+    collect(m_root, nodes);
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        LayerNode *node = nodes[i];
+        node->target->impl->layerOrder = i;
+        node->target->impl->layerNode = nullptr;
+        delete node;
+    }
+
+    m_root = nullptr;
+}
+
+size_t LayerList::size() const
+{
+    return nodeSize(m_root);
+}
+
+bool LayerList::empty() const
+{
+    return !m_root;
+}
+
+// Returns the target at the given layer, or nullptr if the index is out of range.
+Target *LayerList::at(size_t index) const
+{
+    LayerNode *node = m_root;
+
+    while (node) {
+        size_t leftSize = nodeSize(node->left);
+
+        if (index < leftSize)
+            node = node->left;
+        else if (index == leftSize)
+            return node->target;
+        else {
+            index -= leftSize + 1;
+            node = node->right;
+        }
+    }
+
+    return nullptr;
+}
+
+// Returns the layer of the given target, or -1 if it isn't in the list.
+int LayerList::indexOf(const Target *target) const
+{
+    LayerNode *node = nodeOf(target);
+    return node ? nodeIndex(node) : -1;
+}
+
+bool LayerList::contains(const Target *target) const
+{
+    return nodeOf(target);
+}
+
+// Inserts the target at the given layer (or at the end if the index is out of range).
+void LayerList::insert(size_t index, Target *target)
+{
+    assert(target && !target->impl->layerNode);
+    insertNode(index, createNode(target));
+}
+
+void LayerList::append(Target *target)
+{
+    insert(SIZE_MAX, target);
+}
+
+// Removes the target and keeps its last layer order in it.
+bool LayerList::remove(Target *target)
+{
+    LayerNode *node = nodeOf(target);
+
+    if (!node)
+        return false;
+
+    target->impl->layerOrder = nodeIndex(node);
+    target->impl->layerNode = nullptr;
+    delete takeNode(node);
+    return true;
+}
+
+// Moves the target to the given layer.
+bool LayerList::move(Target *target, size_t index)
+{
+    LayerNode *node = nodeOf(target);
+
+    if (!node)
+        return false;
+
+    insertNode(index, takeNode(node));
+    return true;
+}
+
+// Returns the layer of the given node by walking up to the root.
+int LayerList::nodeIndex(const LayerNode *node)
+{
+    assert(node);
+    size_t index = nodeSize(node->left);
+
+    while (node->parent) {
+        if (node->parent->right == node)
+            index += nodeSize(node->parent->left) + 1;
+
+        node = node->parent;
+    }
+
+    return index;
+}
+
+// Removes the target from the list it belongs to (if any).
+void LayerList::detach(Target *target)
+{
+    LayerNode *node = target->impl->layerNode;
+
+    if (node)
+        node->list->remove(target);
+}
+
+LayerNode *LayerList::createNode(Target *target)
+{
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    LayerNode *node = new LayerNode;
+    node->list = this;
+    node->target = target;
+    node->priority = m_seed;
+    target->impl->layerNode = node;
+
+    return node;
+}
+
+void LayerList::insertNode(size_t index, LayerNode *node)
+{
+    LayerNode *left, *right;
+    split(m_root, index, left, right);
+    m_root = merge(merge(left, node), right);
+    m_root->parent = nullptr;
+}
+
+// Unlinks the node from the tree and returns it.
+LayerNode *LayerList::takeNode(LayerNode *node)
+{
+    LayerNode *left, *middle, *right;
+    split(m_root, nodeIndex(node), left, right);
+    split(right, 1, middle, right);
+    assert(middle == node);
+
+    m_root = merge(left, right);
+
+    if (m_root)
+        m_root->parent = nullptr;
+
+    node->parent = nullptr;
+
+    return node;
+}
+
+LayerNode *LayerList::nodeOf(const Target *target) const
+{
+    if (!target)
+        return nullptr;
+
+    LayerNode *node = target->impl->layerNode;
+    return (node && node->list == this) ? node : nullptr;
+}
+
+size_t LayerList::nodeSize(const LayerNode *node)
+{
+    return node ? node->size : 0;
+}
+
+void LayerList::update(LayerNode *node)
+{
+    node->size = nodeSize(node->left) + nodeSize(node->right) + 1;
+
+    if (node->left)
+        node->left->parent = node;
+
+    if (node->right)
+        node->right->parent = node;
+}
+
+// Splits the tree into the first count nodes and the rest.
+void LayerList::split(LayerNode *node, size_t count, LayerNode *&left, LayerNode *&right)
+{
+    if (!node) {
+        left = right = nullptr;
+        return;
+    }
+
+    size_t leftSize = nodeSize(node->left);
+
+    if (count <= leftSize) {
+        split(node->left, count, left, node->left);
+        right = node;
+
+        if (left)
+            left->parent = nullptr;
+    } else {
+        split(node->right, count - leftSize - 1, node->right, right);
+        left = node;
+
+        if (right)
+            right->parent = nullptr;
+    }
+
+    update(node);
+}
+
+LayerNode *LayerList::merge(LayerNode *left, LayerNode *right)
+{
+    if (!left || !right)
+        return left ? left : right;
+
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    } else {
+        right->left = merge(left, right->left);
+        update(right);
+        return right;
+    }
+}
+
+void LayerList::collect(const LayerNode *node, std::vector<LayerNode *> &nodes)
+{
+    // Iterative in-order traversal (the tree depth is only O(log n) on average)
+    std::vector<const LayerNode *> stack;
+
+    while (node || !stack.empty()) {
+        while (node) {
+            stack.push_back(node);
+            node = node->left;
+        }
+
+        node = stack.back();
+        stack.pop_back();
+        nodes.push_back(const_cast<LayerNode *>(node));
+        node = node->right;
+    }
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libscratchcpp
+{
+
+class Target;
+struct LayerNode;
+
+// Targets ordered by layer (order-statistic treap with implicit keys)
+// Moves, insertions, removals and index lookups are O(log n).
+class LayerList
+{
+    public:
+        LayerList() = default;
+        LayerList(const LayerList &) = delete;
+        ~LayerList();
+
+        void clear();
+
+        size_t size() const;
+        bool empty() const;
+
+        Target *at(size_t index) const;
+        int indexOf(const Target *target) const;
+        bool contains(const Target *target) const;
+
+        void insert(size_t index, Target *target);
+        void append(Target *target);
+        bool remove(Target *target);
+        bool move(Target *target, size_t index);
+
+        static int nodeIndex(const LayerNode *node);
+        static void detach(Target *target);
+
+    private:
+        LayerNode *createNode(Target *target);
+        void insertNode(size_t index, LayerNode *node);
+        LayerNode *takeNode(LayerNode *node);
+        LayerNode *nodeOf(const Target *target) const;
+
+        static size_t nodeSize(const LayerNode *node);
+        static void update(LayerNode *node);
+        static void split(LayerNode *node, size_t count, LayerNode *&left, LayerNode *&right);
+        static LayerNode *merge(LayerNode *left, LayerNode *right);
+        static void collect(const LayerNode *node, std::vector<LayerNode *> &nodes);
+
+        LayerNode *m_root = nullptr;
+        uint32_t m_seed = 2463534242;
+};
+
+} // namespace libscratchcpp
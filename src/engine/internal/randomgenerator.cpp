@@ -6,16 +6,14 @@
 
 using namespace libscratchcpp;
 
-std::shared_ptr<RandomGenerator> RandomGenerator::m_instance = std::make_shared<RandomGenerator>();
-
 RandomGenerator::RandomGenerator() :
     m_generator(std::make_unique<std::mt19937>(m_device()))
 {
 }
 
-std::shared_ptr<RandomGenerator> RandomGenerator::instance()
+RandomGenerator::RandomGenerator(unsigned int seed) :
+    m_generator(std::make_unique<std::mt19937>(seed))
 {
-    return m_instance;
 }
 
 long RandomGenerator::randint(long start, long end) const
@@ -41,3 +39,8 @@ double RandomGenerator::randintDouble(double start, double end) const
     std::uniform_real_distribution<double> distribution(start, end);
     return distribution(*m_generator);
 }
+
+void RandomGenerator::setSeed(unsigned int seed)
+{
+    m_generator->seed(seed);
+}
@@ -14,15 +14,15 @@ class RandomGenerator : public IRandomGenerator
 {
     public:
         RandomGenerator();
+        RandomGenerator(unsigned int seed);
         RandomGenerator(const RandomGenerator &) = delete;
 
-        static std::shared_ptr<RandomGenerator> instance();
-
         long randint(long start, long end) const override;
         double randintDouble(double start, double end) const override;
 
+        void setSeed(unsigned int seed);
+
     private:
-        static std::shared_ptr<RandomGenerator> m_instance;
         std::random_device m_device;
         std::unique_ptr<std::mt19937> m_generator;
 };
@@ -0,0 +1,457 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/rect.h>
+#include <scratchcpp/costume.h>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "spatialindex.h"
+#include "alphamask.h"
+
+using namespace libscratchcpp;
+
+// Sprites covering more cells are checked by every query instead of being stored in the cells
+static const int MAX_SPRITE_CELLS = 64;
+
+static const double pi = std::acos(-1); // TODO: Use std::numbers::pi in C++20
+
+namespace
+{
+
+// Maps stage coordinates to the pixels of the costume image of a sprite
+struct SpriteShape
+{
+        bool opaqueAt(double stageX, double stageY) const
+        {
+            if (!known)
+                return true;
+
+            double dx = stageX - x;
+            double dy = stageY - y;
+            double u = centerX + m00 * dx + m01 * dy;
+            double v = centerY + m10 * dx + m11 * dy;
+
+            if (u < 0 || v < 0 || u >= width || v >= height)
+                return false;
+
+            if (!mask)
+                return true;
+
+            return mask->opaque(level, static_cast<int>(u) >> level, static_cast<int>(v) >> level);
+        }
+
+        bool known = false; // if the image size is unknown, the whole bounding rectangle is opaque
+        double x = 0;
+        double y = 0;
+        double centerX = 0;
+        double centerY = 0;
+        double m00 = 0;
+        double m01 = 0;
+        double m10 = 0;
+        double m11 = 0;
+        double width = 0;
+        double height = 0;
+        const AlphaMask *mask = nullptr; // the image is opaque if there isn't any mask
+        unsigned int level = 0;
+};
+
+} // namespace
+
+// Inverts the costume transform (see SpritePrivate::getCostumeBounds())
+static SpriteShape spriteShape(const Sprite *sprite, const Costume *costume, const AlphaMask *mask)
+{
+    SpriteShape shape;
+
+    if (!costume || costume->width() <= 0 || costume->height() <= 0)
+        return shape;
+
+    double resolution = costume->bitmapResolution() > 0 ? costume->bitmapResolution() : 1;
+    double scale = sprite->size() / 100 / resolution;
+
+    if (scale <= 0)
+        return shape;
+
+    double angle = 0;
+    double sign = 1;
+
+    switch (sprite->rotationStyle()) {
+        case Sprite::RotationStyle::AllAround:
+            angle = (90 - sprite->direction()) * pi / 180;
+            break;
+
+        case Sprite::RotationStyle::LeftRight:
+            sign = sprite->direction() < 0 ? -1 : 1;
+            break;
+
+        case Sprite::RotationStyle::DoNotRotate:
+            break;
+    }
+
+    double c = std::cos(angle);
+    double s = std::sin(angle);
+
+    shape.known = true;
+    shape.x = sprite->x();
+    shape.y = sprite->y();
+    shape.centerX = costume->rotationCenterX();
+    shape.centerY = costume->rotationCenterY();
+    shape.m00 = sign * c / scale;
+    shape.m01 = sign * s / scale;
+    shape.m10 = s / scale;
+    shape.m11 = -c / scale;
+    shape.width = costume->width();
+    shape.height = costume->height();
+
+    if (mask && mask->width() == shape.width && mask->height() == shape.height) {
+        shape.mask = mask;
+
+        // Use the level which has roughly one pixel per stage unit
+        double pixelsPerUnit = 1 / scale;
+
+        while (shape.level + 1 < mask->levelCount() && (1 << (shape.level + 1)) <= pixelsPerUnit)
+            shape.level++;
+    }
+
+    return shape;
+}
+
+SpatialIndex::SpatialIndex(double cellSize) :
+    m_cellSize(cellSize)
+{
+    assert(cellSize > 0);
+}
+
+void SpatialIndex::clear()
+{
+    m_entries.clear();
+    m_cells.clear();
+    m_largeSprites.clear();
+    m_dirtySprites.clear();
+}
+
+// Sets the size of the stage. Sprites can only touch each other on the stage.
+void SpatialIndex::setStageSize(double width, double height)
+{
+    if (width == m_stageWidth && height == m_stageHeight)
+        return;
+
+    m_stageWidth = width;
+    m_stageHeight = height;
+
+    // The masks only contain the pixels on the stage
+    for (auto &[sprite, entry] : m_entries)
+        entry.mask.valid = false;
+}
+
+// Adds the sprite to the index. Its bounds are read by the next query.
+void SpatialIndex::addSprite(const Sprite *sprite)
+{
+    assert(sprite);
+    auto [it, inserted] = m_entries.try_emplace(sprite);
+
+    if (inserted)
+        m_dirtySprites.push_back(sprite);
+}
+
+void SpatialIndex::removeSprite(const Sprite *sprite)
+{
+    auto it = m_entries.find(sprite);
+
+    if (it == m_entries.end())
+        return;
+
+    removeFromCells(sprite, it->second);
+    m_entries.erase(it); // the sprite is skipped if it's still in the list of dirty sprites
+}
+
+bool SpatialIndex::containsSprite(const Sprite *sprite) const
+{
+    return m_entries.find(sprite) != m_entries.end();
+}
+
+// Marks the bounds of the sprite as changed. This is O(1) and can be called from parallel scripts.
+void SpatialIndex::invalidate(const Sprite *sprite)
+{
+    auto it = m_entries.find(sprite);
+
+    if (it == m_entries.end())
+        return;
+
+    if (!it->second.dirty.exchange(true)) {
+        std::lock_guard<std::mutex> lock(m_dirtyMutex);
+        m_dirtySprites.push_back(sprite);
+    }
+}
+
+// Returns true if the sprite touches the other sprite or any of its visible clones.
+bool SpatialIndex::touchingSprite(const Sprite *sprite, const Sprite *other)
+{
+    if (!sprite || !other)
+        return false;
+
+    update();
+    auto it = m_entries.find(sprite);
+
+    if (it == m_entries.end())
+        return false;
+
+    Entry &entry = it->second;
+
+    if (!entry.hasBounds)
+        return false;
+
+    const Sprite *root = other->isClone() ? other->cloneSprite() : other;
+    m_queryStamp++;
+
+    if (entry.large) {
+        // Checking the instances of the other sprite is cheaper than checking all the cells
+        if (touchingCandidate(sprite, entry, root, root))
+            return true;
+
+        for (auto clone : root->clones()) {
+            if (touchingCandidate(sprite, entry, clone.get(), root))
+                return true;
+        }
+
+        return false;
+    }
+
+    for (int x = entry.minCellX; x <= entry.maxCellX; x++) {
+        for (int y = entry.minCellY; y <= entry.maxCellY; y++) {
+            auto cellIt = m_cells.find(cellKey(x, y));
+
+            if (cellIt == m_cells.end())
+                continue;
+
+            for (const Sprite *candidate : cellIt->second) {
+                if (touchingCandidate(sprite, entry, candidate, root))
+                    return true;
+            }
+        }
+    }
+
+    for (const Sprite *candidate : m_largeSprites) {
+        if (touchingCandidate(sprite, entry, candidate, root))
+            return true;
+    }
+
+    return false;
+}
+
+// Reads the bounds of the sprites which changed since the last query.
+void SpatialIndex::update()
+{
+    std::lock_guard<std::mutex> lock(m_dirtyMutex);
+
+    for (const Sprite *sprite : m_dirtySprites) {
+        auto it = m_entries.find(sprite);
+
+        if (it != m_entries.end() && it->second.dirty)
+            updateEntry(sprite, it->second);
+    }
+
+    m_dirtySprites.clear();
+}
+
+void SpatialIndex::updateEntry(const Sprite *sprite, Entry &entry)
+{
+    removeFromCells(sprite, entry);
+    entry.dirty = false;
+    entry.mask.valid = false; // rasterized again by the next pixel check
+
+    Rect rect = sprite->boundingRect();
+    entry.left = std::min(rect.left(), rect.right());
+    entry.right = std::max(rect.left(), rect.right());
+    entry.bottom = std::min(rect.top(), rect.bottom());
+    entry.top = std::max(rect.top(), rect.bottom());
+
+    // An empty rectangle means the bounds are unknown (e.g. the sprite doesn't have an interface)
+    entry.hasBounds = !(entry.left == entry.right && entry.top == entry.bottom);
+
+    if (entry.hasBounds)
+        insertIntoCells(sprite, entry);
+}
+
+void SpatialIndex::insertIntoCells(const Sprite *sprite, Entry &entry)
+{
+    entry.minCellX = cellIndex(entry.left);
+    entry.maxCellX = cellIndex(entry.right);
+    entry.minCellY = cellIndex(entry.bottom);
+    entry.maxCellY = cellIndex(entry.top);
+
+    int64_t cellCount = int64_t(entry.maxCellX - entry.minCellX + 1) * (entry.maxCellY - entry.minCellY + 1);
+    entry.large = cellCount > MAX_SPRITE_CELLS;
+
+    if (entry.large) {
+        m_largeSprites.insert(sprite);
+        return;
+    }
+
+    for (int x = entry.minCellX; x <= entry.maxCellX; x++) {
+        for (int y = entry.minCellY; y <= entry.maxCellY; y++)
+            m_cells[cellKey(x, y)].push_back(sprite);
+    }
+}
+
+void SpatialIndex::removeFromCells(const Sprite *sprite, Entry &entry)
+{
+    if (!entry.hasBounds)
+        return;
+
+    entry.hasBounds = false;
+
+    if (entry.large) {
+        m_largeSprites.erase(sprite);
+        return;
+    }
+
+    for (int x = entry.minCellX; x <= entry.maxCellX; x++) {
+        for (int y = entry.minCellY; y <= entry.maxCellY; y++) {
+            auto it = m_cells.find(cellKey(x, y));
+            assert(it != m_cells.end());
+
+            if (it == m_cells.end())
+                continue;
+
+            auto &cell = it->second;
+            auto spriteIt = std::find(cell.begin(), cell.end(), sprite);
+            assert(spriteIt != cell.end());
+
+            if (spriteIt != cell.end()) {
+                *spriteIt = cell.back();
+                cell.pop_back();
+            }
+
+            if (cell.empty())
+                m_cells.erase(it);
+        }
+    }
+}
+
+bool SpatialIndex::intersects(const Entry &e1, const Entry &e2) const
+{
+    return e1.left <= e2.right && e2.left <= e1.right && e1.top >= e2.bottom && e2.top >= e1.bottom;
+}
+
+bool SpatialIndex::touchingCandidate(const Sprite *sprite, Entry &entry, const Sprite *candidate, const Sprite *root)
+{
+    if (candidate == sprite || !candidate->visible())
+        return false;
+
+    if (candidate != root && candidate->cloneSprite() != root)
+        return false;
+
+    auto it = m_entries.find(candidate);
+
+    if (it == m_entries.end())
+        return false;
+
+    Entry &candidateEntry = it->second;
+
+    // Large candidates and candidates in multiple cells are only checked once
+    if (candidateEntry.queryStamp == m_queryStamp)
+        return false;
+
+    candidateEntry.queryStamp = m_queryStamp;
+    return candidateEntry.hasBounds && intersects(entry, candidateEntry) && pixelsTouching(sprite, entry, candidate, candidateEntry);
+}
+
+// Checks the opaque pixels of the sprites with overlapping bounds.
+bool SpatialIndex::pixelsTouching(const Sprite *sprite1, Entry &entry1, const Sprite *sprite2, Entry &entry2)
+{
+    if (!entry1.mask.valid)
+        rasterize(sprite1, entry1);
+
+    if (!entry2.mask.valid)
+        rasterize(sprite2, entry2);
+
+    const RowMask &mask1 = entry1.mask;
+    const RowMask &mask2 = entry2.mask;
+
+    if (!mask1.known && !mask2.known)
+        return true; // only the bounding rectangles are known
+
+    // AND the words of the overlapping rows
+    int firstRow = std::max(mask1.y0, mask2.y0);
+    int endRow = std::min(mask1.y0 + mask1.rows, mask2.y0 + mask2.rows);
+    int firstWord1 = mask1.x0 / 64;
+    int firstWord2 = mask2.x0 / 64;
+    int firstWord = std::max(firstWord1, firstWord2);
+    int wordCount = std::min(firstWord1 + mask1.wordsPerRow, firstWord2 + mask2.wordsPerRow) - firstWord;
+
+    for (int y = firstRow; y < endRow; y++) {
+        const uint64_t *row1 = mask1.words.data() + static_cast<size_t>(y - mask1.y0) * mask1.wordsPerRow + (firstWord - firstWord1);
+        const uint64_t *row2 = mask2.words.data() + static_cast<size_t>(y - mask2.y0) * mask2.wordsPerRow + (firstWord - firstWord2);
+
+        for (int i = 0; i < wordCount; i++) {
+            if (row1[i] & row2[i])
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// Rasterizes the part of the sprite on the stage into the row mask of its entry.
+void SpatialIndex::rasterize(const Sprite *sprite, Entry &entry) const
+{
+    RowMask &mask = entry.mask;
+    auto costume = sprite->currentCostume();
+    SpriteShape shape = spriteShape(sprite, costume.get(), costume ? costume->alphaMask() : nullptr);
+    mask.valid = true;
+    mask.known = shape.known;
+    mask.wordsPerRow = 0;
+    mask.rows = 0;
+    mask.words.clear();
+
+    double left = std::max(entry.left, -m_stageWidth / 2);
+    double right = std::min(entry.right, m_stageWidth / 2);
+    double bottom = std::max(entry.bottom, -m_stageHeight / 2);
+    double top = std::min(entry.top, m_stageHeight / 2);
+
+    if (left > right || bottom > top)
+        return;
+
+    // Pixel (x, y) covers the stage area from (x, y) to (x + 1, y + 1)
+    int x0 = static_cast<int>(std::floor(left));
+    int x1 = std::max(static_cast<int>(std::ceil(right)), x0 + 1);
+    mask.x0 = static_cast<int>(std::floor(x0 / 64.0)) * 64;
+    mask.y0 = static_cast<int>(std::floor(bottom));
+    mask.rows = std::max(static_cast<int>(std::ceil(top)) - mask.y0, 1);
+    mask.wordsPerRow = (x1 - mask.x0 + 63) / 64;
+    mask.words.assign(static_cast<size_t>(mask.wordsPerRow) * mask.rows, 0);
+
+    for (int row = 0; row < mask.rows; row++) {
+        double y = mask.y0 + row + 0.5;
+        uint64_t *words = mask.words.data() + static_cast<size_t>(row) * mask.wordsPerRow;
+
+        for (int x = x0; x < x1; x++) {
+            if (shape.opaqueAt(x + 0.5, y)) {
+                int col = x - mask.x0;
+                words[col / 64] |= uint64_t(1) << (col % 64);
+            }
+        }
+    }
+}
+
+int SpatialIndex::cellIndex(double coord) const
+{
+    double index = std::floor(coord / m_cellSize);
+
+    // Keep far away sprites in the outermost cells
+    if (std::isnan(index))
+        return 0;
+    else if (index < INT32_MIN / 2)
+        return INT32_MIN / 2;
+    else if (index > INT32_MAX / 2)
+        return INT32_MAX / 2;
+
+    return static_cast<int>(index);
+}
+
+uint64_t SpatialIndex::cellKey(int x, int y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
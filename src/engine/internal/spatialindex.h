@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+namespace libscratchcpp
+{
+
+class Sprite;
+
+// Uniform grid of sprite bounding rectangles used by touching checks
+// The bounds are read lazily: invalidate() only marks the sprite, and the next query reads its bounding rectangle again.
+// Candidates with overlapping bounds are checked pixel by pixel: the costume of every sprite is rasterized into stage pixel rows
+// (once per bounds change), and the rows of both sprites are ANDed.
+class SpatialIndex
+{
+    public:
+        SpatialIndex(double cellSize = 64);
+        SpatialIndex(const SpatialIndex &) = delete;
+
+        void clear();
+
+        void setStageSize(double width, double height);
+
+        void addSprite(const Sprite *sprite);
+        void removeSprite(const Sprite *sprite);
+        bool containsSprite(const Sprite *sprite) const;
+
+        void invalidate(const Sprite *sprite);
+
+        bool touchingSprite(const Sprite *sprite, const Sprite *other);
+
+    private:
+        // Opaque stage pixels of a sprite, one bit per pixel
+        struct RowMask
+        {
+                bool valid = false; // false if the sprite changed since it was rasterized
+                bool known = false; // if the image size is unknown, the whole bounding rectangle is opaque
+                int x0 = 0;         // stage x of the first column, a multiple of 64 (so that the words of all masks are aligned)
+                int y0 = 0;         // stage y of the first row
+                int wordsPerRow = 0;
+                int rows = 0;
+                std::vector<uint64_t> words;
+        };
+
+        struct Entry
+        {
+                std::atomic<bool> dirty = true;
+                bool hasBounds = false;
+                bool large = false; // covers too many cells, so it's kept in m_largeSprites instead
+                double left = 0;
+                double top = 0;
+                double right = 0;
+                double bottom = 0;
+                int minCellX = 0;
+                int minCellY = 0;
+                int maxCellX = -1;
+                int maxCellY = -1;
+                unsigned int queryStamp = 0;
+                RowMask mask;
+        };
+
+        void update();
+        void updateEntry(const Sprite *sprite, Entry &entry);
+        void insertIntoCells(const Sprite *sprite, Entry &entry);
+        void removeFromCells(const Sprite *sprite, Entry &entry);
+        bool intersects(const Entry &e1, const Entry &e2) const;
+        bool touchingCandidate(const Sprite *sprite, Entry &entry, const Sprite *candidate, const Sprite *root);
+        bool pixelsTouching(const Sprite *sprite1, Entry &entry1, const Sprite *sprite2, Entry &entry2);
+        void rasterize(const Sprite *sprite, Entry &entry) const;
+        int cellIndex(double coord) const;
+
+        static uint64_t cellKey(int x, int y);
+
+        double m_cellSize;
+        std::unordered_map<const Sprite *, Entry> m_entries;
+        std::unordered_map<uint64_t, std::vector<const Sprite *>> m_cells;
+        std::unordered_set<const Sprite *> m_largeSprites;
+        std::vector<const Sprite *> m_dirtySprites;
+        std::mutex m_dirtyMutex; // sprites can move in parallel scripts
+        unsigned int m_queryStamp = 0;
+        double m_stageWidth = 480;
+        double m_stageHeight = 360;
+};
+
+} // namespace libscratchcpp
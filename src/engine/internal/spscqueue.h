@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace libscratchcpp
+{
+
+// Bounded lock-free queue for one producer thread and one consumer thread
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    public:
+        SpscQueue() { }
+        SpscQueue(const SpscQueue &) = delete;
+
+        // Producer: returns false if the queue is full
+        bool push(const T &item)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t next = (tail + 1) % Size;
+
+            if (next == m_head.load(std::memory_order_acquire))
+                return false;
+
+            m_buffer[tail] = item;
+            m_tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer: returns false if the queue is empty
+        bool pop(T &item)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+
+            item = std::move(m_buffer[head]);
+            m_head.store((head + 1) % Size, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        // One slot is always kept free to distinguish a full queue from an empty one
+        static constexpr size_t Size = Capacity + 1;
+
+        std::array<T, Size> m_buffer;
+        alignas(64) std::atomic<size_t> m_head = 0;
+        alignas(64) std::atomic<size_t> m_tail = 0;
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/sprite.h>
+#include <algorithm>
+#include <cassert>
+
+#include "transformstore.h"
+#include "../../scratch/sprite_p.h"
+
+using namespace libscratchcpp;
+
+TransformStore::~TransformStore()
+{
+    clear();
+}
+
+// Moves all sprites out of the store
+void TransformStore::clear()
+{
+    for (Sprite *sprite : sprites) {
+        if (sprite)
+            detach(sprite);
+    }
+
+    sprites.clear();
+    x.clear();
+    y.clear();
+    size.clear();
+    direction.clear();
+    costume.clear();
+    flags.clear();
+    dirty.clear();
+    m_freeHandles.clear();
+}
+
+// Moves the transform of the sprite to the store (the sprite gets a handle which doesn't change until it's detached)
+void TransformStore::attach(Sprite *sprite)
+{
+    assert(sprite);
+    SpritePrivate *impl = sprite->impl.get();
+
+    if (impl->transforms == this)
+        return;
+
+    assert(!impl->transforms);
+    unsigned int handle;
+
+    if (m_freeHandles.empty()) {
+        handle = sprites.size();
+        sprites.push_back(nullptr);
+        x.push_back(0);
+        y.push_back(0);
+        size.push_back(0);
+        direction.push_back(0);
+        costume.push_back(-1);
+        flags.push_back(0);
+        dirty.push_back(0);
+    } else {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+
+    const SpritePrivate::Transform &local = impl->local;
+    sprites[handle] = sprite;
+    x[handle] = local.x;
+    y[handle] = local.y;
+    size[handle] = local.size;
+    direction[handle] = local.direction;
+    costume[handle] = sprite->costumeIndex();
+    flags[handle] = Used | (local.visible ? Visible : 0) | (local.draggable ? Draggable : 0) | (static_cast<uint8_t>(local.rotationStyle) << ROTATION_STYLE_SHIFT);
+    dirty[handle] = PositionDirty | SizeDirty | DirectionDirty | CostumeDirty | VisibilityDirty | RotationStyleDirty;
+
+    impl->transforms = this;
+    impl->transformHandle = handle;
+}
+
+// Moves the transform of the sprite back to the sprite
+void TransformStore::detach(Sprite *sprite)
+{
+    assert(sprite);
+    SpritePrivate *impl = sprite->impl.get();
+
+    if (impl->transforms != this)
+        return;
+
+    SpritePrivate::Transform &local = impl->local;
+    local.visible = impl->visible();
+    local.x = impl->x();
+    local.y = impl->y();
+    local.size = impl->size();
+    local.direction = impl->direction();
+    local.draggable = impl->draggable();
+    local.rotationStyle = impl->rotationStyle();
+
+    release(impl->transformHandle);
+    impl->transforms = nullptr;
+    impl->transformHandle = 0;
+}
+
+// Frees the slot with the given handle (it can be used by another sprite then)
+void TransformStore::release(unsigned int handle)
+{
+    assert(handle < sprites.size());
+    sprites[handle] = nullptr;
+    flags[handle] = 0;
+    dirty[handle] = 0;
+    m_freeHandles.push_back(handle);
+}
+
+void TransformStore::clearDirty()
+{
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
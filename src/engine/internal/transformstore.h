@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace libscratchcpp
+{
+
+class Sprite;
+
+// Transforms of sprites and clones stored as structure of arrays (see IEngine::setSpriteTransformStoreEnabled())
+// Sprites in the store read and write their transform here, so the arrays can be processed sequentially.
+// The arrays are indexed by sprite handles, which don't change while the sprite is in the store.
+struct TransformStore
+{
+        enum Flag : uint8_t
+        {
+            Used = 1 << 0, // the slot belongs to a sprite
+            Visible = 1 << 1,
+            Draggable = 1 << 2
+        };
+
+        static constexpr int ROTATION_STYLE_SHIFT = 3; // the rotation style is stored in 2 bits of the flags
+        static constexpr uint8_t ROTATION_STYLE_MASK = 3 << ROTATION_STYLE_SHIFT;
+
+        enum DirtyFlag : uint8_t
+        {
+            PositionDirty = 1 << 0,
+            SizeDirty = 1 << 1,
+            DirectionDirty = 1 << 2,
+            CostumeDirty = 1 << 3,
+            VisibilityDirty = 1 << 4,
+            RotationStyleDirty = 1 << 5
+        };
+
+        TransformStore() = default;
+        TransformStore(const TransformStore &) = delete;
+        ~TransformStore();
+
+        void clear();
+
+        void attach(Sprite *sprite);
+        void detach(Sprite *sprite);
+        void release(unsigned int handle);
+
+        void clearDirty();
+
+        std::vector<Sprite *> sprites;
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> size;
+        std::vector<double> direction;
+        std::vector<int> costume;
+        std::vector<uint8_t> flags;
+        std::vector<uint8_t> dirty;
+
+    private:
+        std::vector<unsigned int> m_freeHandles;
+};
+
+} // namespace libscratchcpp
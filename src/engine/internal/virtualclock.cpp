@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cmath>
+
+#include "virtualclock.h"
+
+using namespace libscratchcpp;
+
+// The system time starts at 2000-01-01 00:00:00 UTC
+static const std::chrono::system_clock::time_point SYSTEM_START_TIME(std::chrono::seconds(946684800));
+
+VirtualClock::VirtualClock()
+{
+}
+
+std::chrono::steady_clock::time_point VirtualClock::currentSteadyTime() const
+{
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(std::llround(m_elapsedTime * 1000000)));
+}
+
+std::chrono::system_clock::time_point VirtualClock::currentSystemTime() const
+{
+    return SYSTEM_START_TIME + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(std::llround(m_elapsedTime * 1000000)));
+}
+
+void VirtualClock::sleep(const std::chrono::milliseconds &) const
+{
+    // The time is advanced by the engine, so there's nothing to wait for
+}
+
+double VirtualClock::elapsedTime() const
+{
+    return m_elapsedTime;
+}
+
+void VirtualClock::advance(double ms)
+{
+    m_elapsedTime += ms;
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "iclock.h"
+
+namespace libscratchcpp
+{
+
+// A clock which doesn't read the wall clock, it's advanced manually
+class VirtualClock : public IClock
+{
+    public:
+        VirtualClock();
+        VirtualClock(const VirtualClock &) = delete;
+
+        std::chrono::steady_clock::time_point currentSteadyTime() const override;
+        std::chrono::system_clock::time_point currentSystemTime() const override;
+
+        void sleep(const std::chrono::milliseconds &time) const override;
+
+        double elapsedTime() const;
+        void advance(double ms);
+
+    private:
+        double m_elapsedTime = 0; // ms
+};
+
+} // namespace libscratchcpp
@@ -7,11 +7,14 @@
 #include <scratchcpp/sprite.h>
 #include <scratchcpp/iengine.h>
 #include <iostream>
+#include <atomic>
 
 #include "script_p.h"
 
 using namespace libscratchcpp;
 
+static std::atomic<unsigned int> nextStorageId = 1;
+
 /*! Constructs Script. */
 Script::Script(Target *target, IEngine *engine) :
     impl(spimpl::make_unique_impl<ScriptPrivate>(target, engine))
@@ -72,38 +75,55 @@ std::shared_ptr<VirtualMachine> Script::start(Target *target)
             return vm;
         }
 
-        // Use internal variables and lists from the clone
-        std::vector<Value *> variables;
-        std::vector<List *> lists;
+        // Use internal variables and lists from the clone (clones have them at the same indexes as the original sprite)
+        // The slots are resolved once per script and the result is kept in the clone
+        CloneScriptData &data = sprite->scriptData(this);
 
-        for (const auto &var : impl->variables) {
-            Target *owner = var->target();
+        if (data.id != impl->storageId) {
+            data.id = impl->storageId;
+            data.variables.clear();
+            data.lists.clear();
+            data.variables.reserve(impl->variables.size());
+            data.lists.reserve(impl->lists.size());
 
-            if (owner && (owner == root)) {
-                auto cloneVar = sprite->variableAt(sprite->findVariableById(var->id()));
-                assert(cloneVar);
+            for (size_t i = 0; i < impl->variables.size(); i++) {
+                Variable *var = impl->variables[i];
 
-                if (cloneVar)
-                    variables.push_back(cloneVar->valuePtr());
-            } else
-                variables.push_back(var->valuePtr());
-        }
+                if (impl->variableSlots[i] != -1) {
+                    auto cloneVar = sprite->variableAt(impl->variableSlots[i]);
+
+                    // The variable might have been added after setVariables()
+                    if (!cloneVar || cloneVar->id() != var->id())
+                        cloneVar = sprite->variableAt(sprite->findVariableById(var->id()));
+
+                    assert(cloneVar);
+
+                    if (cloneVar)
+                        data.variables.push_back(cloneVar->valuePtr());
+                } else
+                    data.variables.push_back(var->valuePtr());
+            }
 
-        for (const auto &list : impl->lists) {
-            Target *owner = list->target();
+            for (size_t i = 0; i < impl->lists.size(); i++) {
+                List *list = impl->lists[i];
 
-            if (owner && (owner == root)) {
-                auto cloneList = sprite->listAt(sprite->findListById(list->id()));
-                assert(cloneList);
+                if (impl->listSlots[i] != -1) {
+                    auto cloneList = sprite->listAt(impl->listSlots[i]);
 
-                if (cloneList)
-                    lists.push_back(cloneList.get());
-            } else
-                lists.push_back(list);
+                    if (!cloneList || cloneList->id() != list->id())
+                        cloneList = sprite->listAt(sprite->findListById(list->id()));
+
+                    assert(cloneList);
+
+                    if (cloneList)
+                        data.lists.push_back(cloneList.get());
+                } else
+                    data.lists.push_back(list);
+            }
         }
 
-        vm->setVariablesVector(variables);
-        vm->setListsVector(lists);
+        vm->setVariables(data.variables.data());
+        vm->setLists(data.lists.data());
     } else {
         vm->setVariables(impl->variableValues.data());
         vm->setLists(impl->lists.data());
@@ -133,18 +153,49 @@ void Script::setConstValues(const std::vector<Value> &values)
     impl->constValues = impl->constValuesVector.data();
 }
 
+/*! Returns the list of variables. */
+const std::vector<Variable *> &Script::variables() const
+{
+    return impl->variables;
+}
+
 /*! Sets the list of variables. */
 void Script::setVariables(const std::vector<Variable *> &variables)
 {
     impl->variables = variables;
+    impl->storageId = nextStorageId++;
     impl->variableValues.clear();
+    impl->variableSlots.clear();
 
-    for (const auto &var : variables)
+    for (const auto &var : variables) {
         impl->variableValues.push_back(var->valuePtr());
+        impl->variableSlots.push_back((impl->target && var->target() == impl->target) ? impl->target->findVariableById(var->id()) : -1);
+    }
 }
 
 /*! Sets the list of lists. */
 void Script::setLists(const std::vector<List *> &lists)
 {
     impl->lists = lists;
+    impl->storageId = nextStorageId++;
+    impl->listSlots.clear();
+
+    for (const auto &list : lists)
+        impl->listSlots.push_back((impl->target && list->target() == impl->target) ? impl->target->findListById(list->id()) : -1);
+}
+
+/*!
+ * Returns true if the script only reads and modifies its own target (sprite-local variables, position, costume, etc.).
+ * Such scripts can run in parallel with scripts of other targets.
+ * \see IEngine::setParallelExecutionEnabled()
+ */
+bool Script::isTargetLocal() const
+{
+    return impl->targetLocal;
+}
+
+/*! Sets whether the script only reads and modifies its own target. */
+void Script::setTargetLocal(bool targetLocal)
+{
+    impl->targetLocal = targetLocal;
 }
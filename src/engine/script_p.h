@@ -13,6 +13,14 @@ class IEngine;
 class Variable;
 class List;
 
+// Variables and lists of a clone used by a script of the original sprite (see Script::start())
+struct CloneScriptData
+{
+        unsigned int id = 0; // the storage ID of the script (it changes when the script is compiled again)
+        std::vector<Value *> variables;
+        std::vector<List *> lists;
+};
+
 struct ScriptPrivate
 {
         ScriptPrivate(Target *target, IEngine *engine);
@@ -35,8 +43,14 @@ struct ScriptPrivate
 
         std::vector<Value *> variableValues;
         std::vector<Variable *> variables;
+        std::vector<int> variableSlots; // indexes of the variables in the target (and in its clones), -1 if the target doesn't own them
 
         std::vector<List *> lists;
+        std::vector<int> listSlots; // indexes of the lists in the target (and in its clones), -1 if the target doesn't own them
+
+        unsigned int storageId = 0; // changes when the variables or lists change, so that clones resolve them again
+
+        bool targetLocal = false;
 };
 
 } // namespace libscratchcpp
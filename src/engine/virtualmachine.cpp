@@ -1,9 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <scratchcpp/virtualmachine.h>
+#include <scratchcpp/script.h>
 #include <cassert>
 
 #include "virtualmachine_p.h"
+#include "inlinecache_p.h"
+#include "../internal/nameindex.h"
 
 using namespace libscratchcpp;
 using namespace vm;
@@ -24,6 +27,8 @@ VirtualMachine::VirtualMachine(Target *target, IEngine *engine, Script *script)
 void VirtualMachine::setProcedures(unsigned int **procedures)
 {
     impl->procedures = procedures;
+    impl->inlineCaches.clear();
+    impl->sharedInlineCache.clear();
 }
 
 /*! Sets the list of functions. */
@@ -75,6 +80,8 @@ void VirtualMachine::setBytecode(unsigned int *code)
 {
     impl->bytecode = code;
     impl->pos = code;
+    impl->inlineCaches.clear();
+    impl->sharedInlineCache.clear();
 }
 
 /*! Returns the array of procedures. */
@@ -161,6 +168,48 @@ void VirtualMachine::replaceReturnValue(const Value &v, unsigned int offset)
     *impl->regs[impl->regCount - offset] = v;
 }
 
+/*!
+ * Returns the inline cache of the function call which is being executed.\n
+ * Every function call added by Compiler::addFunctionCallWithInlineCache() (the OP_EXEC_CACHED instruction) has its own cache.
+ * Block functions can use it to store the target or variable resolved from a name, so that they don't have to look it up on every call.
+ * Functions called by OP_EXEC share one cache.
+ * \code
+ * InlineCache &cache = vm->inlineCache();
+ *
+ * if (!cache.matches(name))
+ *     cache.store(name, vm->engine()->targetAt(vm->engine()->findTarget(name)));
+ *
+ * Target *target = cache.target();
+ * \endcode
+ * \note The caches are only used if the VM has a target.
+ */
+InlineCache &VirtualMachine::inlineCache()
+{
+    InlineCache *cachePtr = &impl->sharedInlineCache;
+
+    if (impl->inlineCacheSlot != -1) {
+        // The slots are assigned by the compiler, the vector grows when a slot is used for the first time
+        size_t slot = impl->inlineCacheSlot;
+
+        if (slot >= impl->inlineCaches.size())
+            impl->inlineCaches.resize(slot + 1);
+
+        cachePtr = &impl->inlineCaches[slot];
+    }
+
+    InlineCache &cache = *cachePtr;
+
+    // Resolutions are validated against the name indices of the engine (clones use the indices of their sprite)
+    const NameIndexGroup *group = NameIndexGroup::root(impl->script && impl->script->target() ? impl->script->target() : impl->target);
+
+    if (cache.impl->group != group) {
+        cache.clear();
+        cache.impl->group = group;
+    }
+
+    return cache;
+}
+
 /*! Continues running the script from last position (the first instruction is skipped). */
 void VirtualMachine::run()
 {
@@ -34,7 +34,6 @@ using namespace vm;
 
 static const double pi = std::acos(-1); // TODO: Use std::numbers::pi in C++20
 
-IRandomGenerator *VirtualMachinePrivate::rng = nullptr;
 
 const unsigned int VirtualMachinePrivate::instruction_arg_count[] = {
     0, // OP_START
@@ -99,7 +98,8 @@ const unsigned int VirtualMachinePrivate::instruction_arg_count[] = {
     0, // OP_ADD_ARG
     1, // OP_READ_ARG
     0, // OP_BREAK_FRAME
-    0  // OP_WARP
+    0, // OP_WARP
+    2  // OP_EXEC_CACHED
 };
 
 VirtualMachinePrivate::VirtualMachinePrivate(VirtualMachine *vm, Target *target, IEngine *engine, Script *script) :
@@ -114,9 +114,6 @@ VirtualMachinePrivate::VirtualMachinePrivate(VirtualMachine *vm, Target *target,
     regs = regsVector.data();
     loops.reserve(256);
     callTree.reserve(1024);
-
-    if (!rng)
-        rng = RandomGenerator::instance().get();
 }
 
 VirtualMachinePrivate::~VirtualMachinePrivate()
@@ -125,6 +122,20 @@ VirtualMachinePrivate::~VirtualMachinePrivate()
         delete regsVector[i];
 }
 
+// Returns the random number generator of the engine (or an own one if there isn't any engine)
+IRandomGenerator *VirtualMachinePrivate::randomGenerator()
+{
+    IRandomGenerator *engineRng = engine ? engine->randomGenerator() : nullptr;
+
+    if (engineRng)
+        return engineRng;
+
+    if (!rng)
+        rng = std::make_unique<RandomGenerator>();
+
+    return rng.get();
+}
+
 unsigned int *VirtualMachinePrivate::run(unsigned int *pos, bool reset)
 {
     static const void *dispatch_table[] = {
@@ -190,12 +201,14 @@ unsigned int *VirtualMachinePrivate::run(unsigned int *pos, bool reset)
         &&do_add_arg,
         &&do_read_arg,
         &&do_break_frame,
-        &&do_warp
+        &&do_warp,
+        &&do_exec_cached
     };
     assert(pos);
     unsigned int *loopStart;
     unsigned int *loopEnd;
     size_t loopCount;
+    unsigned int execArgCount;
     if (reset) {
         atEnd = false;
         noBreak = true;
@@ -408,9 +421,9 @@ do_mod:
 
 do_random:
     if ((READ_REG(0, 2)->type() == Value::Type::Integer) && (READ_REG(1, 2)->type() == Value::Type::Integer))
-        REPLACE_RET_VALUE(rng->randint(READ_REG(0, 2)->toInt(), READ_REG(1, 2)->toInt()), 2);
+        REPLACE_RET_VALUE(randomGenerator()->randint(READ_REG(0, 2)->toInt(), READ_REG(1, 2)->toInt()), 2);
     else
-        REPLACE_RET_VALUE(rng->randintDouble(READ_REG(0, 2)->toDouble(), READ_REG(1, 2)->toDouble()), 2);
+        REPLACE_RET_VALUE(randomGenerator()->randintDouble(READ_REG(0, 2)->toDouble(), READ_REG(1, 2)->toDouble()), 2);
     FREE_REGS(1);
     DISPATCH();
 
@@ -589,7 +602,7 @@ do_list_del : {
             index = 0;
         } else if (str == "random") {
             size_t size = list->size();
-            index = size == 0 ? 0 : rng->randint(1, size);
+            index = size == 0 ? 0 : randomGenerator()->randint(1, size);
         } else
             index = 0;
     } else {
@@ -617,7 +630,7 @@ do_list_insert : {
             index = 0;
         } else if (str == "random") {
             size_t size = list->size();
-            index = size == 0 ? 1 : rng->randint(1, size);
+            index = size == 0 ? 1 : randomGenerator()->randint(1, size);
         } else
             index = 0;
     } else {
@@ -644,7 +657,7 @@ do_list_replace : {
             index = list->size();
         else if (str == "random") {
             size_t size = list->size();
-            index = size == 0 ? 0 : rng->randint(1, size);
+            index = size == 0 ? 0 : randomGenerator()->randint(1, size);
         } else
             index = 0;
     } else {
@@ -667,7 +680,7 @@ do_list_get_item : {
             index = list->size();
         else if (str == "random") {
             size_t size = list->size();
-            index = size == 0 ? 0 : rng->randint(1, size);
+            index = size == 0 ? 0 : randomGenerator()->randint(1, size);
         } else
             index = 0;
     } else {
@@ -723,8 +736,20 @@ do_str_contains:
     FREE_REGS(1);
     DISPATCH();
 
-do_exec : {
-    auto ret = functions[*++pos](vm);
+do_exec:
+    execArgCount = instruction_arg_count[OP_EXEC];
+    inlineCacheSlot = -1;
+    pos++;
+    goto exec_function;
+
+do_exec_cached:
+    execArgCount = instruction_arg_count[OP_EXEC_CACHED];
+    pos += 2;
+    inlineCacheSlot = *pos;
+
+exec_function : {
+    // pos points to the last argument, the function index is the first one
+    auto ret = functions[*(pos - execArgCount + 1)](vm);
     if (updatePos) {
         pos = this->pos;
         updatePos = false;
@@ -733,7 +758,7 @@ do_exec : {
         stop = false;
         if (goBack) {
             goBack = false;
-            pos -= instruction_arg_count[OP_EXEC] + 1;
+            pos -= execArgCount + 1;
             // NOTE: Going back leaks all registers for the next time the same function is called.
             // This is for example used in the wait block (to call it again with the same time value).
         } else
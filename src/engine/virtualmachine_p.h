@@ -3,8 +3,10 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <cstddef>
 #include <scratchcpp/global.h>
+#include <scratchcpp/inlinecache.h>
 
 namespace libscratchcpp
 {
@@ -24,6 +26,7 @@ struct VirtualMachinePrivate
         ~VirtualMachinePrivate();
 
         unsigned int *run(unsigned int *pos, bool reset = true);
+        IRandomGenerator *randomGenerator();
 
         static const unsigned int instruction_arg_count[];
 
@@ -42,6 +45,7 @@ struct VirtualMachinePrivate
         IEngine *engine = nullptr;
         Script *script = nullptr;
         unsigned int *pos = nullptr;
+        int inlineCacheSlot = -1; // inline cache slot of the function call which is being executed (-1 for OP_EXEC)
         unsigned int *checkpoint = nullptr;
         bool running = false;
         bool atEnd = false;
@@ -69,7 +73,10 @@ struct VirtualMachinePrivate
         std::vector<Value *> regsVector;
         size_t regCount = 0;
 
-        static IRandomGenerator *rng;
+        std::vector<InlineCache> inlineCaches; // by the slot in the OP_EXEC_CACHED instruction (assigned by the compiler)
+        InlineCache sharedInlineCache;         // used by OP_EXEC calls
+
+        std::unique_ptr<IRandomGenerator> rng; // used if there isn't any engine
 };
 
 } // namespace libscratchcpp
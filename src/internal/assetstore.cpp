@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "assetstore.h"
+
+using namespace libscratchcpp;
+
+std::shared_ptr<AssetStore> AssetStore::m_instance = std::make_shared<AssetStore>();
+
+AssetStore::AssetStore()
+{
+}
+
+std::shared_ptr<AssetStore> AssetStore::instance()
+{
+    return m_instance;
+}
+
+// Returns the data of the given asset file. If it isn't in the store, it's loaded using the loader.
+std::shared_ptr<const void> AssetStore::data(const std::string &fileName, const Loader &loader)
+{
+    auto data = find(fileName);
+
+    if (data)
+        return data;
+
+    // Load without locking, assets are often loaded in parallel
+    data = loader();
+
+    if (!data)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = m_data[fileName];
+    auto existing = entry.lock();
+
+    // Another thread might have loaded the same asset in the meantime
+    if (existing)
+        return existing;
+
+    entry = data;
+    return data;
+}
+
+// Returns the data of the given asset file, or nullptr if it isn't used by any asset.
+std::shared_ptr<const void> AssetStore::find(const std::string &fileName)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_data.find(fileName);
+
+    if (it == m_data.cend())
+        return nullptr;
+
+    auto data = it->second.lock();
+
+    if (!data)
+        m_data.erase(it);
+
+    return data;
+}
+
+// Returns the number of asset files in the store (including the ones which might have been freed).
+size_t AssetStore::size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_data.size();
+}
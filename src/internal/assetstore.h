@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+
+namespace libscratchcpp
+{
+
+// Content-addressed store of asset data shared by all assets (and projects) in the process.
+// Asset file names contain the MD5 hash of the content, so they're used as keys.
+// The store doesn't own the data, it's freed when no asset uses it.
+class AssetStore
+{
+    public:
+        using Loader = std::function<std::shared_ptr<const void>()>;
+
+        AssetStore();
+        AssetStore(const AssetStore &) = delete;
+
+        static std::shared_ptr<AssetStore> instance();
+
+        std::shared_ptr<const void> data(const std::string &fileName, const Loader &loader);
+        std::shared_ptr<const void> find(const std::string &fileName);
+        size_t size();
+
+    private:
+        static std::shared_ptr<AssetStore> m_instance;
+        std::unordered_map<std::string, std::weak_ptr<const void>> m_data;
+        std::mutex m_mutex;
+};
+
+} // namespace libscratchcpp
@@ -18,6 +18,8 @@ class IProjectDownloader
         virtual bool downloadAssets(const std::vector<std::string> &assetIds) = 0;
         virtual void cancel() = 0;
 
+        virtual void setCacheDirectory(const std::string &directory) = 0;
+
         virtual void setDownloadProgressCallback(const std::function<void(unsigned int, unsigned int)> &f) = 0;
 
         virtual const std::string &json() const = 0;
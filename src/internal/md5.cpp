@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <cstring>
+
+#include "md5.h"
+
+using namespace libscratchcpp;
+
+static const uint32_t SHIFTS[64] = { 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+                                     4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21 };
+
+static const uint32_t CONSTANTS[64] = { 0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1,
+                                        0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453,
+                                        0xd8a1e681, 0xe7d3fbc8, 0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a, 0xfffa3942,
+                                        0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+                                        0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665, 0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d,
+                                        0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 };
+
+static uint32_t rotateLeft(uint32_t x, uint32_t n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+static void processChunk(const unsigned char *chunk, uint32_t *state)
+{
+    uint32_t words[16];
+
+    for (int i = 0; i < 16; i++)
+        words[i] = uint32_t(chunk[i * 4]) | (uint32_t(chunk[i * 4 + 1]) << 8) | (uint32_t(chunk[i * 4 + 2]) << 16) | (uint32_t(chunk[i * 4 + 3]) << 24);
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t f, g;
+
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        f += a + CONSTANTS[i] + words[g];
+        a = d;
+        d = c;
+        c = b;
+        b += rotateLeft(f, SHIFTS[i]);
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+std::string Md5::hex(const std::string &data)
+{
+    uint32_t state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    size_t size = data.size();
+    size_t i;
+
+    for (i = 0; i + 64 <= size; i += 64)
+        processChunk(bytes + i, state);
+
+    // Pad the last chunk with 0x80, zeros and the length in bits
+    unsigned char tail[128] = { 0 };
+    size_t remaining = size - i;
+    std::memcpy(tail, bytes + i, remaining);
+    tail[remaining] = 0x80;
+    size_t tailSize = remaining < 56 ? 64 : 128;
+    uint64_t bitCount = uint64_t(size) * 8;
+
+    for (int j = 0; j < 8; j++)
+        tail[tailSize - 8 + j] = (bitCount >> (j * 8)) & 0xff;
+
+    for (size_t j = 0; j < tailSize; j += 64)
+        processChunk(tail + j, state);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string ret;
+    ret.reserve(32);
+
+    for (uint32_t word : state) {
+        for (int j = 0; j < 4; j++) {
+            unsigned char byte = (word >> (j * 8)) & 0xff;
+            ret.push_back(digits[byte >> 4]);
+            ret.push_back(digits[byte & 0xf]);
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+namespace libscratchcpp
+{
+
+// MD5 hash (RFC 1321), used to verify assets because Scratch asset IDs contain the MD5 hash of the content.
+class Md5
+{
+    public:
+        static std::string hex(const std::string &data);
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/entity.h>
+#include <scratchcpp/target.h>
+
+#include "nameindex.h"
+#include "scratch/entity_p.h"
+#include "scratch/target_p.h"
+
+using namespace libscratchcpp;
+
+unsigned int NameIndexGroup::generation() const
+{
+    return m_generation.load(std::memory_order_acquire);
+}
+
+unsigned int NameIndexGroup::epoch() const
+{
+    return m_epoch.load(std::memory_order_acquire);
+}
+
+// Invalidates the indices of the group (used when an item of the owner is renamed)
+void NameIndexGroup::invalidate()
+{
+    increment(m_generation);
+    touch();
+}
+
+// Invalidates cached name resolutions which depend on the group or its parents (used when items are added)
+void NameIndexGroup::touch()
+{
+    increment(m_epoch);
+
+    if (m_parent)
+        m_parent->touch();
+}
+
+// Renaming the item will invalidate the indices of this group
+void NameIndexGroup::adopt(Entity &item)
+{
+    item.impl->indexGroup = shared_from_this();
+}
+
+// Renaming the target will invalidate the indices of this group, and changes in the target change the epoch of this group
+void NameIndexGroup::adopt(Target &target)
+{
+    target.impl->indexGroup->m_parent = shared_from_this();
+}
+
+// Invalidates the indices of the owner of the given item (if it has any)
+void NameIndexGroup::invalidateOwner(const Entity &item)
+{
+    if (item.impl->indexGroup)
+        item.impl->indexGroup->invalidate();
+}
+
+// Invalidates the indices of the owner of the given target (if it has any)
+void NameIndexGroup::invalidateOwner(const Target &target)
+{
+    if (target.impl->indexGroup->m_parent)
+        target.impl->indexGroup->m_parent->invalidate();
+}
+
+// Returns the group whose epoch changes when a name resolution of a script of the given target might change
+const NameIndexGroup *NameIndexGroup::root(const Target *target)
+{
+    if (!target)
+        return nullptr;
+
+    const NameIndexGroup *group = target->impl->indexGroup.get();
+    return group->m_parent ? group->m_parent.get() : group;
+}
+
+void NameIndexGroup::increment(std::atomic<unsigned int> &counter)
+{
+    unsigned int value = counter.load();
+
+    // The value can't be 0 (that means a cache is empty)
+    while (!counter.compare_exchange_weak(value, value + 1 == 0 ? 1 : value + 1))
+        ;
+}
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+namespace libscratchcpp
+{
+
+class Entity;
+class Target;
+
+// Counters shared by the name indices of one owner (an engine or a target)
+// The generation changes when an item of the owner is renamed, so only the indices of that owner are rebuilt.
+// The epoch also changes when items are added to the owner or to its children (the targets of an engine),
+// so it can be used to validate cached name resolutions (see InlineCache).
+class NameIndexGroup : public std::enable_shared_from_this<NameIndexGroup>
+{
+    public:
+        NameIndexGroup() = default;
+        NameIndexGroup(const NameIndexGroup &) = delete;
+
+        unsigned int generation() const;
+        unsigned int epoch() const;
+
+        void invalidate();
+        void touch();
+
+        void adopt(Entity &item);
+        void adopt(Target &target);
+
+        static void invalidateOwner(const Entity &item);
+        static void invalidateOwner(const Target &target);
+        static const NameIndexGroup *root(const Target *target);
+
+    private:
+        static void increment(std::atomic<unsigned int> &counter);
+
+        std::atomic<unsigned int> m_generation = 1;
+        std::atomic<unsigned int> m_epoch = 1;
+        std::shared_ptr<NameIndexGroup> m_parent;
+};
+
+struct NameKey
+{
+        template<typename T>
+        const std::string &operator()(const T &item) const
+        {
+            return item.name();
+        }
+};
+
+struct IdKey
+{
+        template<typename T>
+        const std::string &operator()(const T &item) const
+        {
+            return item.id();
+        }
+};
+
+// Hash index which maps names (or IDs) to positions in a vector of items
+// It's built on the first lookup and rebuilt after invalidate() (call it when items are added) or after an item of the group is renamed.
+// Lookups can run on multiple threads: the map is never modified after it's built, a rebuild replaces it.
+template<typename T, typename Key = NameKey>
+class NameIndex
+{
+    public:
+        NameIndex(NameIndexGroup &group) :
+            m_group(group)
+        {
+        }
+
+        NameIndex(const NameIndex &) = delete;
+
+        // Returns the index of the first item with the given key, or -1 if there isn't any
+        int find(const std::vector<std::shared_ptr<T>> &items, const std::string &key) const
+        {
+            unsigned int currentGeneration = m_group.generation();
+            std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&m_snapshot);
+
+            if (!snapshot || snapshot->generation != currentGeneration) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                snapshot = std::atomic_load(&m_snapshot);
+
+                if (!snapshot || snapshot->generation != currentGeneration) {
+                    auto newSnapshot = std::make_shared<Snapshot>();
+                    newSnapshot->generation = currentGeneration;
+                    newSnapshot->map.reserve(items.size());
+
+                    for (size_t i = 0; i < items.size(); i++)
+                        newSnapshot->map.emplace(Key()(*items[i]), i); // keeps the first item with the key
+
+                    snapshot = newSnapshot;
+                    std::atomic_store(&m_snapshot, snapshot);
+                }
+            }
+
+            auto it = snapshot->map.find(key);
+
+            if (it == snapshot->map.cend())
+                return -1;
+
+            return it->second;
+        }
+
+        void invalidate()
+        {
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>());
+            m_group.touch();
+        }
+
+    private:
+        struct Snapshot
+        {
+                unsigned int generation = 0;
+                std::unordered_map<std::string, int> map;
+        };
+
+        NameIndexGroup &m_group;
+        mutable std::shared_ptr<const Snapshot> m_snapshot; // accessed atomically
+        mutable std::mutex m_mutex;
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+// miniz is a part of the zip library (its implementation is compiled there)
+#define MINIZ_HEADER_FILE_ONLY
+#include <miniz.h>
+
+#include "pngdecoder.h"
+
+using namespace libscratchcpp;
+
+// Images with more data are ignored
+static const uint64_t MAX_IMAGE_DATA_SIZE = 1 << 28;
+
+static uint32_t readUInt32BE(const unsigned char *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+static unsigned char paethPredictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+        return a;
+    else if (pb <= pc)
+        return b;
+    else
+        return c;
+}
+
+// Reverses the filter of the given scanline (see https://www.w3.org/TR/png/#9Filters)
+static bool unfilter(unsigned char filter, unsigned char *line, const unsigned char *prev, unsigned int length, unsigned int bpp)
+{
+    switch (filter) {
+        case 0:
+            break;
+
+        case 1:
+            for (unsigned int i = bpp; i < length; i++)
+                line[i] += line[i - bpp];
+
+            break;
+
+        case 2:
+            for (unsigned int i = 0; i < length; i++)
+                line[i] += prev[i];
+
+            break;
+
+        case 3:
+            for (unsigned int i = 0; i < length; i++)
+                line[i] += ((i >= bpp ? line[i - bpp] : 0) + prev[i]) / 2;
+
+            break;
+
+        case 4:
+            for (unsigned int i = 0; i < length; i++)
+                line[i] += paethPredictor(i >= bpp ? line[i - bpp] : 0, prev[i], i >= bpp ? prev[i - bpp] : 0);
+
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * Reads the alpha channel of the given PNG image.
+ * Returns false if the image isn't a valid PNG image or if it doesn't have transparency (i. e. it's fully opaque).
+ */
+bool PngDecoder::readAlpha(const void *data, unsigned int size, unsigned int *width, unsigned int *height, std::vector<unsigned char> *alpha)
+{
+    static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+    if (!data || size < 33 || memcmp(bytes, signature, sizeof(signature)) != 0 || memcmp(bytes + 12, "IHDR", 4) != 0)
+        return false;
+
+    uint32_t w = readUInt32BE(bytes + 16);
+    uint32_t h = readUInt32BE(bytes + 20);
+    unsigned char bitDepth = bytes[24];
+    unsigned char colorType = bytes[25];
+    unsigned char interlace = bytes[28];
+    unsigned int channels;
+
+    switch (colorType) {
+        case 3:
+            channels = 1;
+            break;
+
+        case 4:
+            channels = 2;
+            break;
+
+        case 6:
+            channels = 4;
+            break;
+
+        default:
+            return false; // grayscale and RGB images without alpha
+    }
+
+    if (w == 0 || h == 0 || interlace != 0 || (colorType == 3 && bitDepth > 8) || (colorType != 3 && bitDepth != 8 && bitDepth != 16))
+        return false;
+
+    unsigned int bitsPerPixel = channels * bitDepth;
+    uint64_t stride = (uint64_t(w) * bitsPerPixel + 7) / 8;
+    uint64_t dataSize = (stride + 1) * h;
+
+    if (dataSize > MAX_IMAGE_DATA_SIZE)
+        return false;
+
+    // Read the chunks
+    std::vector<unsigned char> compressed;
+    std::vector<unsigned char> transparency;
+    unsigned int pos = 8;
+
+    while (pos + 12 <= size) {
+        uint32_t length = readUInt32BE(bytes + pos);
+        const unsigned char *type = bytes + pos + 4;
+        const unsigned char *chunk = bytes + pos + 8;
+
+        if (length > size - pos - 12)
+            return false;
+
+        if (memcmp(type, "IDAT", 4) == 0)
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        else if (memcmp(type, "tRNS", 4) == 0)
+            transparency.assign(chunk, chunk + length);
+        else if (memcmp(type, "IEND", 4) == 0)
+            break;
+
+        pos += length + 12;
+    }
+
+    if (colorType == 3 && transparency.empty())
+        return false; // the palette is opaque
+
+    // The image data is a zlib stream
+    std::vector<unsigned char> raw(dataSize);
+    mz_ulong rawSize = static_cast<mz_ulong>(dataSize);
+
+    if (mz_uncompress(raw.data(), &rawSize, compressed.data(), static_cast<mz_ulong>(compressed.size())) != MZ_OK || rawSize < dataSize)
+        return false;
+
+    // Unfilter the scanlines and read the alpha values
+    unsigned int bpp = std::max(1u, bitsPerPixel / 8);
+    std::vector<unsigned char> prev(stride, 0);
+    alpha->resize(uint64_t(w) * h);
+
+    for (uint32_t y = 0; y < h; y++) {
+        unsigned char *line = raw.data() + y * (stride + 1);
+
+        if (!unfilter(line[0], line + 1, prev.data(), stride, bpp))
+            return false;
+
+        line++;
+        unsigned char *row = alpha->data() + uint64_t(y) * w;
+
+        if (colorType == 3) {
+            for (uint32_t x = 0; x < w; x++) {
+                unsigned int bit = x * bitDepth;
+                unsigned int index = (line[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1 << bitDepth) - 1);
+                row[x] = index < transparency.size() ? transparency[index] : 255;
+            }
+        } else {
+            // The alpha sample is the last one (the most significant byte comes first in 16-bit images)
+            unsigned int pixelSize = bitsPerPixel / 8;
+            unsigned int offset = pixelSize - bitDepth / 8;
+
+            for (uint32_t x = 0; x < w; x++)
+                row[x] = line[x * pixelSize + offset];
+        }
+
+        memcpy(prev.data(), line, stride);
+    }
+
+    *width = w;
+    *height = h;
+    return true;
+}
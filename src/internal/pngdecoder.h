@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <vector>
+
+namespace libscratchcpp
+{
+
+// Minimal PNG decoder which only reads the alpha channel (used for touching checks).
+// Interlaced images aren't supported.
+class PngDecoder
+{
+    public:
+        static bool readAlpha(const void *data, unsigned int size, unsigned int *width, unsigned int *height, std::vector<unsigned char> *alpha);
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,816 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/broadcast.h>
+#include <scratchcpp/input.h>
+#include <scratchcpp/inputvalue.h>
+#include <scratchcpp/field.h>
+#include <scratchcpp/block.h>
+#include <scratchcpp/blockprototype.h>
+#include <scratchcpp/variable.h>
+#include <scratchcpp/list.h>
+#include <scratchcpp/costume.h>
+#include <scratchcpp/comment.h>
+#include <scratchcpp/sound.h>
+#include <scratchcpp/stage.h>
+#include <scratchcpp/sprite.h>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+#include "projectcache.h"
+#include "sha256.h"
+
+using namespace libscratchcpp;
+
+static const char MAGIC[4] = { 'S', 'C', 'P', 'C' };
+
+// Stream buffer which reads from a block of memory (without copying it)
+class MemoryBuffer : public std::streambuf
+{
+    public:
+        MemoryBuffer(char *data, size_t size) { setg(data, data, data + size); }
+};
+
+template<typename T>
+static void write(std::ostream &stream, T value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static void writeString(std::ostream &stream, const std::string &str)
+{
+    write<uint32_t>(stream, str.size());
+    stream.write(str.c_str(), str.size());
+}
+
+template<typename T>
+static T read(std::istream &stream)
+{
+    T value = T();
+    stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+
+static std::string readString(std::istream &stream)
+{
+    uint32_t size = read<uint32_t>(stream);
+
+    // The stream reads from memory, so the rest of the file is available (don't allocate strings longer than that)
+    if (!stream || size > stream.rdbuf()->in_avail()) {
+        stream.setstate(std::ios::failbit);
+        return "";
+    }
+
+    std::string str(size, '\0');
+    stream.read(str.data(), size);
+    return str;
+}
+
+ProjectCache::ProjectCache(const std::string &directory) :
+    m_directory(directory)
+{
+}
+
+const std::string &ProjectCache::directory() const
+{
+    return m_directory;
+}
+
+// Returns the path of the cache file of the project with the given project.json.
+std::string ProjectCache::filePath(const std::string &json) const
+{
+    return keyFilePath(Sha256::hex(json));
+}
+
+// Returns the path of the cache file with the given key (the hash of project.json).
+std::string ProjectCache::keyFilePath(const std::string &key) const
+{
+    return m_directory + "/" + key + "_" + LIBSCRATCHCPP_VERSION + "_v" + std::to_string(FORMAT_VERSION) + ".bin";
+}
+
+// Loads the cached project with the given project.json. Returns false if it isn't cached.
+bool ProjectCache::load(const std::string &json)
+{
+    m_targets.clear();
+    m_broadcasts.clear();
+    m_extensions.clear();
+    m_compiledProject = CompiledProject();
+
+    std::string key = Sha256::hex(json);
+    std::string path = keyFilePath(key);
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+
+    if (!input.is_open())
+        return false;
+
+    // Read the whole file at once, so that lengths can be checked against the remaining data
+    std::string data(input.tellg(), '\0');
+    input.seekg(0);
+    input.read(data.data(), data.size());
+
+    if (!input)
+        return false;
+
+    MemoryBuffer buffer(data.data(), data.size());
+    std::istream file(&buffer);
+
+    // Header
+    char magic[4];
+    file.read(magic, 4);
+
+    if (!file || memcmp(magic, MAGIC, 4) != 0 || read<uint32_t>(file) != FORMAT_VERSION)
+        return false;
+
+    // The file name is the key, but the file might have been renamed or copied
+    if (readString(file) != key || readString(file) != LIBSCRATCHCPP_VERSION || !file)
+        return false;
+
+    // Targets
+    uint32_t count = read<uint32_t>(file);
+
+    for (uint32_t i = 0; i < count && file; i++)
+        m_targets.push_back(readTarget(file));
+
+    // Broadcasts
+    count = read<uint32_t>(file);
+
+    for (uint32_t i = 0; i < count && file; i++) {
+        std::string id = readString(file);
+        m_broadcasts.push_back(std::make_shared<Broadcast>(id, readString(file)));
+    }
+
+    // Extensions
+    count = read<uint32_t>(file);
+
+    for (uint32_t i = 0; i < count && file; i++)
+        m_extensions.push_back(readString(file));
+
+    // Compiled scripts
+    count = read<uint32_t>(file);
+
+    for (uint32_t i = 0; i < count && file; i++)
+        m_compiledProject.sections.push_back(readString(file));
+
+    count = read<uint32_t>(file);
+
+    for (uint32_t i = 0; i < count && file; i++)
+        m_compiledProject.graphicsEffects.push_back(readString(file));
+
+    // There are no compiled targets if the scripts couldn't be stored
+    count = read<uint32_t>(file);
+
+    if (file && count != 0 && count != m_targets.size())
+        file.setstate(std::ios::failbit);
+
+    m_compiledProject.targets.resize(file ? count : 0);
+
+    for (CompiledTarget &target : m_compiledProject.targets)
+        readCompiledTarget(file, target);
+
+    if (!file) {
+        std::cerr << "warning: invalid project cache file " << path << std::endl;
+        m_targets.clear();
+        m_broadcasts.clear();
+        m_extensions.clear();
+        m_compiledProject = CompiledProject();
+        return false;
+    }
+
+    return true;
+}
+
+// Writes the given project and its compiled scripts to the cache.
+bool ProjectCache::save(
+    const std::string &json,
+    const std::vector<std::shared_ptr<Target>> &targets,
+    const std::vector<std::shared_ptr<Broadcast>> &broadcasts,
+    const std::vector<std::string> &extensions,
+    const CompiledProject &compiledProject) const
+{
+    // Write to a temporary file first, other processes might read or write the cache at the same time
+    std::string key = Sha256::hex(json);
+    std::string path = keyFilePath(key);
+    std::string tmpPath = temporaryFilePath(path);
+    std::ofstream file(tmpPath, std::ios::binary);
+
+    if (!file.is_open()) {
+        std::cerr << "warning: could not write project cache file " << tmpPath << std::endl;
+        return false;
+    }
+
+    // Header
+    file.write(MAGIC, 4);
+    write<uint32_t>(file, FORMAT_VERSION);
+    writeString(file, key);
+    writeString(file, LIBSCRATCHCPP_VERSION);
+
+    // Targets
+    write<uint32_t>(file, targets.size());
+
+    for (auto target : targets)
+        writeTarget(file, target.get());
+
+    // Broadcasts
+    write<uint32_t>(file, broadcasts.size());
+
+    for (auto broadcast : broadcasts) {
+        writeString(file, broadcast->id());
+        writeString(file, broadcast->name());
+    }
+
+    // Extensions
+    write<uint32_t>(file, extensions.size());
+
+    for (const std::string &extension : extensions)
+        writeString(file, extension);
+
+    // Compiled scripts
+    write<uint32_t>(file, compiledProject.sections.size());
+
+    for (const std::string &section : compiledProject.sections)
+        writeString(file, section);
+
+    write<uint32_t>(file, compiledProject.graphicsEffects.size());
+
+    for (const std::string &effect : compiledProject.graphicsEffects)
+        writeString(file, effect);
+
+    write<uint32_t>(file, compiledProject.targets.size());
+
+    for (const CompiledTarget &target : compiledProject.targets)
+        writeCompiledTarget(file, target);
+
+    file.close();
+
+    if (!file || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "warning: could not write project cache file " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const std::vector<std::shared_ptr<Target>> &ProjectCache::targets() const
+{
+    return m_targets;
+}
+
+const std::vector<std::shared_ptr<Broadcast>> &ProjectCache::broadcasts() const
+{
+    return m_broadcasts;
+}
+
+const std::vector<std::string> &ProjectCache::extensions() const
+{
+    return m_extensions;
+}
+
+const CompiledProject &ProjectCache::compiledProject() const
+{
+    return m_compiledProject;
+}
+
+// Returns a path for a temporary file next to the given file, which is unique across threads and processes
+std::string ProjectCache::temporaryFilePath(const std::string &path)
+{
+    static std::atomic<unsigned int> counter = 0;
+    static thread_local std::mt19937 generator(std::random_device{}());
+    std::stringstream stream;
+    stream << path << "." << std::hex << generator() << generator() << "_" << counter++ << ".tmp";
+    return stream.str();
+}
+
+void ProjectCache::writeTarget(std::ostream &stream, Target *target)
+{
+    write<uint8_t>(stream, target->isStage());
+    writeString(stream, target->name());
+
+    // Variables
+    const auto &variables = target->variables();
+    write<uint32_t>(stream, variables.size());
+
+    for (auto variable : variables) {
+        writeString(stream, variable->id());
+        writeString(stream, variable->name());
+        writeValue(stream, variable->value());
+        write<uint8_t>(stream, variable->isCloudVariable());
+    }
+
+    // Lists
+    const auto &lists = target->lists();
+    write<uint32_t>(stream, lists.size());
+
+    for (auto list : lists) {
+        writeString(stream, list->id());
+        writeString(stream, list->name());
+        write<uint32_t>(stream, list->size());
+
+        for (const Value &item : *list)
+            writeValue(stream, item);
+    }
+
+    // Blocks
+    const auto &blocks = target->blocks();
+    write<uint32_t>(stream, blocks.size());
+
+    for (auto block : blocks)
+        writeBlock(stream, block.get());
+
+    // Comments
+    const auto &comments = target->comments();
+    write<uint32_t>(stream, comments.size());
+
+    for (auto comment : comments) {
+        writeString(stream, comment->id());
+        write<double>(stream, comment->x());
+        write<double>(stream, comment->y());
+        writeString(stream, comment->blockId());
+        write<double>(stream, comment->width());
+        write<double>(stream, comment->height());
+        write<uint8_t>(stream, comment->minimized());
+        writeString(stream, comment->text());
+    }
+
+    // Costumes
+    const auto &costumes = target->costumes();
+    write<uint32_t>(stream, costumes.size());
+
+    for (auto costume : costumes) {
+        writeString(stream, costume->name());
+        writeString(stream, costume->id());
+        writeString(stream, costume->dataFormat());
+        write<double>(stream, costume->bitmapResolution());
+        write<int32_t>(stream, costume->rotationCenterX());
+        write<int32_t>(stream, costume->rotationCenterY());
+    }
+
+    write<int32_t>(stream, target->costumeIndex());
+
+    // Sounds
+    const auto &sounds = target->sounds();
+    write<uint32_t>(stream, sounds.size());
+
+    for (auto sound : sounds) {
+        writeString(stream, sound->name());
+        writeString(stream, sound->id());
+        writeString(stream, sound->dataFormat());
+        write<int32_t>(stream, sound->rate());
+        write<int32_t>(stream, sound->sampleCount());
+    }
+
+    write<int32_t>(stream, target->layerOrder());
+    write<double>(stream, target->volume());
+
+    if (target->isStage()) {
+        Stage *stage = static_cast<Stage *>(target);
+        write<int32_t>(stream, stage->tempo());
+        writeString(stream, stage->videoStateStr());
+        write<int32_t>(stream, stage->videoTransparency());
+        writeString(stream, stage->textToSpeechLanguage());
+    } else {
+        Sprite *sprite = static_cast<Sprite *>(target);
+        write<uint8_t>(stream, sprite->visible());
+        write<double>(stream, sprite->x());
+        write<double>(stream, sprite->y());
+        write<double>(stream, sprite->size());
+        write<double>(stream, sprite->direction());
+        write<uint8_t>(stream, sprite->draggable());
+        writeString(stream, sprite->rotationStyleStr());
+    }
+}
+
+void ProjectCache::writeBlock(std::ostream &stream, Block *block)
+{
+    writeString(stream, block->id());
+    write<uint8_t>(stream, block->isTopLevelReporter());
+
+    if (block->isTopLevelReporter()) {
+        writeInputValue(stream, block->topLevelReporterInfo());
+        return;
+    }
+
+    writeString(stream, block->opcode());
+    writeString(stream, block->nextId());
+    writeString(stream, block->parentId());
+
+    // Inputs
+    const auto &inputs = block->inputs();
+    write<uint32_t>(stream, inputs.size());
+
+    for (auto input : inputs) {
+        writeString(stream, input->name());
+        write<int32_t>(stream, static_cast<int32_t>(input->type()));
+        writeInputValue(stream, input->primaryValue());
+        writeInputValue(stream, input->secondaryValue());
+    }
+
+    // Fields
+    const auto &fields = block->fields();
+    write<uint32_t>(stream, fields.size());
+
+    for (auto field : fields) {
+        writeString(stream, field->name());
+        writeValue(stream, field->value());
+        writeString(stream, field->valueId());
+    }
+
+    // Mutation
+    BlockPrototype *prototype = block->mutationPrototype();
+    write<uint8_t>(stream, block->mutationHasNext());
+    writeString(stream, prototype->procCode());
+    write<uint32_t>(stream, prototype->argumentIds().size());
+
+    for (const std::string &id : prototype->argumentIds())
+        writeString(stream, id);
+
+    write<uint32_t>(stream, prototype->argumentNames().size());
+
+    for (const std::string &name : prototype->argumentNames())
+        writeString(stream, name);
+
+    write<uint8_t>(stream, prototype->warp());
+
+    write<uint8_t>(stream, block->shadow());
+    writeString(stream, block->commentId());
+}
+
+void ProjectCache::writeInputValue(std::ostream &stream, InputValue *value)
+{
+    write<int32_t>(stream, static_cast<int32_t>(value->type()));
+    writeValue(stream, value->value());
+    writeString(stream, value->valueId());
+    writeString(stream, value->valueBlockId());
+}
+
+void ProjectCache::writeValue(std::ostream &stream, const Value &value)
+{
+    write<int8_t>(stream, static_cast<int8_t>(value.type()));
+
+    switch (value.type()) {
+        case Value::Type::Integer:
+            write<int64_t>(stream, value.toLong());
+            break;
+
+        case Value::Type::Double:
+            write<double>(stream, value.toDouble());
+            break;
+
+        case Value::Type::Bool:
+            write<uint8_t>(stream, value.toBool());
+            break;
+
+        case Value::Type::String:
+            writeString(stream, value.toString());
+            break;
+
+        default:
+            break;
+    }
+}
+
+void ProjectCache::writeCompiledTarget(std::ostream &stream, const CompiledTarget &target)
+{
+    // Functions
+    write<uint32_t>(stream, target.functions.size());
+
+    for (const auto &function : target.functions) {
+        writeString(stream, function.section);
+        write<uint32_t>(stream, function.index);
+    }
+
+    // Scripts
+    write<uint32_t>(stream, target.scripts.size());
+
+    for (const auto &script : target.scripts) {
+        writeString(stream, script.blockId);
+        write<uint32_t>(stream, script.bytecode.size());
+        stream.write(reinterpret_cast<const char *>(script.bytecode.data()), script.bytecode.size() * sizeof(unsigned int));
+    }
+
+    // Procedures
+    write<uint32_t>(stream, target.procedureCodes.size());
+
+    for (const std::string &code : target.procedureCodes)
+        writeString(stream, code);
+
+    // Constant values
+    write<uint32_t>(stream, target.constValues.size());
+
+    for (const Value &value : target.constValues)
+        writeValue(stream, value);
+
+    // Variables and lists
+    for (const auto *entities : { &target.variables, &target.lists }) {
+        write<uint32_t>(stream, entities->size());
+
+        for (const auto &entity : *entities) {
+            write<int32_t>(stream, entity.target);
+            write<int32_t>(stream, entity.index);
+        }
+    }
+
+    // Hats
+    write<uint32_t>(stream, target.hats.size());
+
+    for (const auto &hat : target.hats) {
+        write<uint8_t>(stream, static_cast<uint8_t>(hat.type));
+        writeString(stream, hat.blockId);
+        write<int32_t>(stream, hat.broadcast);
+        write<int32_t>(stream, hat.backdrop);
+        writeString(stream, hat.keyName);
+    }
+}
+
+std::shared_ptr<Target> ProjectCache::readTarget(std::istream &stream)
+{
+    std::shared_ptr<Target> target;
+
+    if (read<uint8_t>(stream))
+        target = std::make_shared<Stage>();
+    else
+        target = std::make_shared<Sprite>();
+
+    target->setName(readString(stream));
+
+    // Variables
+    uint32_t count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string id = readString(stream);
+        std::string name = readString(stream);
+        Value value = readValue(stream);
+        bool cloud = read<uint8_t>(stream);
+        target->addVariable(std::make_shared<Variable>(id, name, value, cloud));
+    }
+
+    // Lists
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string id = readString(stream);
+        auto list = std::make_shared<List>(id, readString(stream));
+        uint32_t size = read<uint32_t>(stream);
+
+        for (uint32_t j = 0; j < size && stream; j++)
+            list->push_back(readValue(stream));
+
+        target->addList(list);
+    }
+
+    // Blocks
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++)
+        target->addBlock(readBlock(stream));
+
+    // Comments
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string id = readString(stream);
+        double x = read<double>(stream);
+        double y = read<double>(stream);
+        auto comment = std::make_shared<Comment>(id, x, y);
+        comment->setBlockId(readString(stream));
+        comment->setWidth(read<double>(stream));
+        comment->setHeight(read<double>(stream));
+        comment->setMinimized(read<uint8_t>(stream));
+        comment->setText(readString(stream));
+        target->addComment(comment);
+    }
+
+    // Costumes
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string name = readString(stream);
+        std::string id = readString(stream);
+        auto costume = std::make_shared<Costume>(name, id, readString(stream));
+        costume->setBitmapResolution(read<double>(stream));
+        costume->setRotationCenterX(read<int32_t>(stream));
+        costume->setRotationCenterY(read<int32_t>(stream));
+        target->addCostume(costume);
+    }
+
+    target->setCostumeIndex(read<int32_t>(stream));
+
+    // Sounds
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string name = readString(stream);
+        std::string id = readString(stream);
+        auto sound = std::make_shared<Sound>(name, id, readString(stream));
+        sound->setRate(read<int32_t>(stream));
+        sound->setSampleCount(read<int32_t>(stream));
+        target->addSound(sound);
+    }
+
+    target->setLayerOrder(read<int32_t>(stream));
+    target->setVolume(read<double>(stream));
+
+    if (target->isStage()) {
+        auto stage = std::static_pointer_cast<Stage>(target);
+        stage->setTempo(read<int32_t>(stream));
+        stage->setVideoState(readString(stream));
+        stage->setVideoTransparency(read<int32_t>(stream));
+        stage->setTextToSpeechLanguage(readString(stream));
+    } else {
+        auto sprite = std::static_pointer_cast<Sprite>(target);
+        sprite->setVisible(read<uint8_t>(stream));
+        sprite->setX(read<double>(stream));
+        sprite->setY(read<double>(stream));
+        sprite->setSize(read<double>(stream));
+        sprite->setDirection(read<double>(stream));
+        sprite->setDraggable(read<uint8_t>(stream));
+        sprite->setRotationStyle(readString(stream));
+    }
+
+    return target;
+}
+
+std::shared_ptr<Block> ProjectCache::readBlock(std::istream &stream)
+{
+    std::string id = readString(stream);
+
+    if (read<uint8_t>(stream)) {
+        auto block = std::make_shared<Block>(id, "");
+        block->setIsTopLevelReporter(true);
+        readInputValue(stream, block->topLevelReporterInfo());
+        return block;
+    }
+
+    auto block = std::make_shared<Block>(id, readString(stream));
+    block->setNextId(readString(stream));
+    block->setParentId(readString(stream));
+
+    // Inputs
+    uint32_t count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string name = readString(stream);
+        auto input = std::make_shared<Input>(name, static_cast<Input::Type>(read<int32_t>(stream)));
+        readInputValue(stream, input->primaryValue());
+        readInputValue(stream, input->secondaryValue());
+        block->addInput(input);
+    }
+
+    // Fields
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        std::string name = readString(stream);
+        Value value = readValue(stream);
+        block->addField(std::make_shared<Field>(name, value, readString(stream)));
+    }
+
+    // Mutation
+    BlockPrototype *prototype = block->mutationPrototype();
+    block->setMutationHasNext(read<uint8_t>(stream));
+    std::string procCode = readString(stream);
+
+    if (!procCode.empty())
+        prototype->setProcCode(procCode);
+
+    std::vector<std::string> strings;
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++)
+        strings.push_back(readString(stream));
+
+    prototype->setArgumentIds(strings);
+    strings.clear();
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++)
+        strings.push_back(readString(stream));
+
+    prototype->setArgumentNames(strings);
+    prototype->setWarp(read<uint8_t>(stream));
+
+    block->setShadow(read<uint8_t>(stream));
+    block->setCommentId(readString(stream));
+
+    return block;
+}
+
+void ProjectCache::readInputValue(std::istream &stream, InputValue *value)
+{
+    // setValue() changes the type, so set the type after it
+    InputValue::Type type = static_cast<InputValue::Type>(read<int32_t>(stream));
+    value->setValue(readValue(stream));
+    value->setType(type);
+    value->setValueId(readString(stream));
+    value->setValueBlockId(readString(stream));
+}
+
+Value ProjectCache::readValue(std::istream &stream)
+{
+    Value::Type type = static_cast<Value::Type>(read<int8_t>(stream));
+
+    switch (type) {
+        case Value::Type::Integer:
+            return static_cast<long>(read<int64_t>(stream));
+
+        case Value::Type::Double:
+            return read<double>(stream);
+
+        case Value::Type::Bool:
+            return static_cast<bool>(read<uint8_t>(stream));
+
+        case Value::Type::String:
+            return readString(stream);
+
+        case Value::Type::Infinity:
+            return Value(Value::SpecialValue::Infinity);
+
+        case Value::Type::NegativeInfinity:
+            return Value(Value::SpecialValue::NegativeInfinity);
+
+        case Value::Type::NaN:
+            return Value(Value::SpecialValue::NaN);
+
+        default:
+            return Value();
+    }
+}
+
+void ProjectCache::readCompiledTarget(std::istream &stream, CompiledTarget &target)
+{
+    // Functions
+    uint32_t count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        CompiledTarget::Function function;
+        function.section = readString(stream);
+        function.index = read<uint32_t>(stream);
+        target.functions.push_back(function);
+    }
+
+    // Scripts
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        CompiledTarget::Script script;
+        script.blockId = readString(stream);
+        uint32_t size = read<uint32_t>(stream);
+
+        // Don't allocate more than the rest of the file
+        if (!stream || size > stream.rdbuf()->in_avail() / sizeof(unsigned int)) {
+            stream.setstate(std::ios::failbit);
+            return;
+        }
+
+        script.bytecode.resize(size);
+        stream.read(reinterpret_cast<char *>(script.bytecode.data()), size * sizeof(unsigned int));
+        target.scripts.push_back(std::move(script));
+    }
+
+    // Procedures
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++)
+        target.procedureCodes.push_back(readString(stream));
+
+    // Constant values
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++)
+        target.constValues.push_back(readValue(stream));
+
+    // Variables and lists
+    for (auto *entities : { &target.variables, &target.lists }) {
+        count = read<uint32_t>(stream);
+
+        for (uint32_t i = 0; i < count && stream; i++) {
+            CompiledTarget::Entity entity;
+            entity.target = read<int32_t>(stream);
+            entity.index = read<int32_t>(stream);
+            entities->push_back(entity);
+        }
+    }
+
+    // Hats
+    count = read<uint32_t>(stream);
+
+    for (uint32_t i = 0; i < count && stream; i++) {
+        CompiledTarget::Hat hat;
+        uint8_t type = read<uint8_t>(stream);
+
+        if (type > static_cast<uint8_t>(HatType::KeyPress)) {
+            stream.setstate(std::ios::failbit);
+            return;
+        }
+
+        hat.type = static_cast<HatType>(type);
+        hat.blockId = readString(stream);
+        hat.broadcast = read<int32_t>(stream);
+        hat.backdrop = read<int32_t>(stream);
+        hat.keyName = readString(stream);
+        target.hats.push_back(hat);
+    }
+}
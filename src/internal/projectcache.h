@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+#include "engine/internal/compiledproject.h"
+
+namespace libscratchcpp
+{
+
+class Target;
+class Broadcast;
+class Block;
+class InputValue;
+class Value;
+
+// Stores loaded and compiled projects in a binary format, so that they can be loaded again without parsing project.json and compiling the scripts.
+// Cache files are named by the SHA-256 hash of project.json, the library version and the format version.
+// Compiled scripts are stored with functions and entities referenced by index (see CompiledProject).
+class ProjectCache
+{
+    public:
+        static const unsigned int FORMAT_VERSION = 3;
+
+        ProjectCache(const std::string &directory);
+        ProjectCache(const ProjectCache &) = delete;
+
+        const std::string &directory() const;
+        std::string filePath(const std::string &json) const;
+
+        bool load(const std::string &json);
+        bool save(
+            const std::string &json,
+            const std::vector<std::shared_ptr<Target>> &targets,
+            const std::vector<std::shared_ptr<Broadcast>> &broadcasts,
+            const std::vector<std::string> &extensions,
+            const CompiledProject &compiledProject) const;
+
+        const std::vector<std::shared_ptr<Target>> &targets() const;
+        const std::vector<std::shared_ptr<Broadcast>> &broadcasts() const;
+        const std::vector<std::string> &extensions() const;
+        const CompiledProject &compiledProject() const;
+
+        static std::string temporaryFilePath(const std::string &path);
+
+    private:
+        std::string keyFilePath(const std::string &key) const;
+
+        static void writeTarget(std::ostream &stream, Target *target);
+        static void writeBlock(std::ostream &stream, Block *block);
+        static void writeInputValue(std::ostream &stream, InputValue *value);
+        static void writeValue(std::ostream &stream, const Value &value);
+        static void writeCompiledTarget(std::ostream &stream, const CompiledTarget &target);
+
+        static std::shared_ptr<Target> readTarget(std::istream &stream);
+        static std::shared_ptr<Block> readBlock(std::istream &stream);
+        static void readInputValue(std::istream &stream, InputValue *value);
+        static Value readValue(std::istream &stream);
+        static void readCompiledTarget(std::istream &stream, CompiledTarget &target);
+
+        std::string m_directory;
+        std::vector<std::shared_ptr<Target>> m_targets;
+        std::vector<std::shared_ptr<Broadcast>> m_broadcasts;
+        std::vector<std::string> m_extensions;
+        CompiledProject m_compiledProject;
+};
+
+} // namespace libscratchcpp
@@ -1,13 +1,18 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <iostream>
+#include <fstream>
 #include <thread>
+#include <cctype>
+#include <algorithm>
 #include <nlohmann/json.hpp>
 #include <cpr/cpr.h>
 
 #include "projectdownloader.h"
 #include "downloaderfactory.h"
 #include "idownloader.h"
+#include "projectcache.h"
+#include "md5.h"
 
 using namespace libscratchcpp;
 
@@ -16,6 +21,28 @@ static const std::string PROJECT_JSON_PREFIX = "https://projects.scratch.mit.edu
 static const std::string ASSET_PREFIX = "https://assets.scratch.mit.edu/internalapi/asset/";
 static const std::string ASSET_SUFFIX = "/get";
 
+// Asset IDs come from project.json, so only names like "<md5>.<extension>" are allowed in the cache directory
+static bool isValidAssetId(const std::string &assetId)
+{
+    if (assetId.empty() || assetId[0] == '.')
+        return false;
+
+    for (char c : assetId) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.')
+            return false;
+    }
+
+    return true;
+}
+
+// Checks whether the MD5 hash in the asset ID matches the content
+static bool matchesAssetId(const std::string &assetId, const std::string &data)
+{
+    std::string hash = assetId.substr(0, assetId.find('.'));
+    std::transform(hash.begin(), hash.end(), hash.begin(), [](unsigned char c) { return std::tolower(c); });
+    return hash == Md5::hex(data);
+}
+
 #define CHECK_CANCEL()                                                                                                                                                                                 \
     m_cancelMutex.lock();                                                                                                                                                                              \
     if (m_cancel) {                                                                                                                                                                                    \
@@ -100,12 +127,9 @@ bool ProjectDownloader::downloadAssets(const std::vector<std::string> &assetIds)
     threadCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(std::ceil(count / 5.0))));
 
     m_assets.clear();
-    m_assets.reserve(count);
+    m_assets.resize(count);
     m_downloadedAssetCount = 0;
 
-    for (unsigned int i = 0; i < count; i++)
-        m_assets.push_back(std::string());
-
     std::cout << "Downloading " << count << " asset(s)";
 
     if (threadCount > 1)
@@ -119,45 +143,36 @@ bool ProjectDownloader::downloadAssets(const std::vector<std::string> &assetIds)
     for (unsigned int i = 0; i < threadCount; i++)
         downloaders.push_back(m_downloaderFactory->create());
 
-    // Download assets
-    auto f = [this, &downloaders, &assetIds, count, threadCount](unsigned int thread) {
-        auto downloader = downloaders[thread];
-        unsigned int n = std::ceil(count / static_cast<double>(threadCount));
-
-        for (unsigned int i = 0; i < n; i++) {
-            unsigned int index = thread * n + i;
-
-            if (index < count) {
-                m_cancelMutex.lock();
+    // Download assets (threads take the next asset from a shared queue, so a slow asset doesn't block the others)
+    std::atomic<size_t> nextIndex = 0;
 
-                if (m_cancel)
-                    return;
-
-                m_cancelMutex.unlock();
-
-                bool ret = downloader->download(ASSET_PREFIX + assetIds[index] + ASSET_SUFFIX);
+    auto f = [this, &downloaders, &assetIds, &nextIndex, count](unsigned int thread) {
+        auto downloader = downloaders[thread];
+        size_t index;
 
-                if (!ret) {
-                    std::cerr << "Failed to download asset: " << assetIds[index] << std::endl;
-                    m_cancelMutex.lock();
-                    m_cancel = true;
-                    m_cancelMutex.unlock();
-                    return;
-                }
+        while ((index = nextIndex++) < count) {
+            if (isCancelled())
+                return;
 
-                m_assetsMutex.lock();
-                m_assets[index] = downloader->text();
-                m_downloadedAssetCount++;
-                std::cout << "Downloaded assets: " << m_downloadedAssetCount << " of " << count << std::endl;
+            const std::string &id = assetIds[index];
 
-                m_downloadProgressCallbackMutex.lock();
+            // Every thread writes to a different item, so the list doesn't need to be locked
+            if (readCachedAsset(id, m_assets[index])) {
+                assetReady(count);
+                continue;
+            }
 
-                if (m_downloadProgressCallback)
-                    m_downloadProgressCallback(m_downloadedAssetCount, count);
+            bool ret = downloader->download(ASSET_PREFIX + id + ASSET_SUFFIX);
 
-                m_downloadProgressCallbackMutex.unlock();
-                m_assetsMutex.unlock();
+            if (!ret) {
+                std::cerr << "Failed to download asset: " << id << std::endl;
+                setCancelled();
+                return;
             }
+
+            m_assets[index] = downloader->text();
+            writeCachedAsset(id, m_assets[index]);
+            assetReady(count);
         }
     };
 
@@ -182,6 +197,11 @@ void ProjectDownloader::cancel()
     m_downloadedAssetCount = 0;
 }
 
+void ProjectDownloader::setCacheDirectory(const std::string &directory)
+{
+    m_cacheDirectory = directory;
+}
+
 void ProjectDownloader::setDownloadProgressCallback(const std::function<void(unsigned int, unsigned int)> &f)
 {
     m_downloadProgressCallbackMutex.lock();
@@ -203,3 +223,81 @@ unsigned int ProjectDownloader::downloadedAssetCount() const
 {
     return m_downloadedAssetCount;
 }
+
+bool ProjectDownloader::isCancelled()
+{
+    std::lock_guard<std::mutex> lock(m_cancelMutex);
+    return m_cancel;
+}
+
+void ProjectDownloader::setCancelled()
+{
+    std::lock_guard<std::mutex> lock(m_cancelMutex);
+    m_cancel = true;
+}
+
+// Reads the asset from the cache directory. Asset IDs are MD5 hashes of the content, so cached assets never change.
+// Corrupted files (e.g. written by another program or truncated) are removed, so that the asset is downloaded again.
+bool ProjectDownloader::readCachedAsset(const std::string &assetId, std::string &data) const
+{
+    if (m_cacheDirectory.empty() || !isValidAssetId(assetId))
+        return false;
+
+    std::string path = m_cacheDirectory + "/" + assetId;
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    file.close();
+
+    if (file.bad() || !matchesAssetId(assetId, data)) {
+        std::cerr << "warning: removing corrupted asset cache file " << path << std::endl;
+        std::remove(path.c_str());
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void ProjectDownloader::writeCachedAsset(const std::string &assetId, const std::string &data) const
+{
+    if (m_cacheDirectory.empty() || !isValidAssetId(assetId))
+        return;
+
+    if (!matchesAssetId(assetId, data)) {
+        std::cerr << "warning: asset " << assetId << " doesn't match its MD5 hash, it won't be cached" << std::endl;
+        return;
+    }
+
+    // Write to a temporary file first, other threads or processes might read the cache at the same time
+    std::string path = m_cacheDirectory + "/" + assetId;
+    std::string tmpPath = ProjectCache::temporaryFilePath(path);
+    std::ofstream file(tmpPath, std::ios::binary);
+
+    if (!file.is_open()) {
+        std::cerr << "warning: could not write asset cache file " << tmpPath << std::endl;
+        return;
+    }
+
+    file.write(data.c_str(), data.size());
+    file.close();
+
+    if (!file || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "warning: could not write asset cache file " << path << std::endl;
+        std::remove(tmpPath.c_str());
+    }
+}
+
+void ProjectDownloader::assetReady(unsigned int count)
+{
+    unsigned int downloaded = ++m_downloadedAssetCount;
+    std::cout << "Downloaded assets: " << downloaded << " of " << count << std::endl;
+
+    std::lock_guard<std::mutex> lock(m_downloadProgressCallbackMutex);
+
+    if (m_downloadProgressCallback)
+        m_downloadProgressCallback(downloaded, count);
+}
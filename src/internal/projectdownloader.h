@@ -23,6 +23,8 @@ class ProjectDownloader : public IProjectDownloader
         bool downloadAssets(const std::vector<std::string> &assetIds) override;
         void cancel() override;
 
+        void setCacheDirectory(const std::string &directory) override;
+
         void setDownloadProgressCallback(const std::function<void(unsigned int, unsigned int)> &f) override;
 
         const std::string &json() const override;
@@ -30,11 +32,17 @@ class ProjectDownloader : public IProjectDownloader
         unsigned int downloadedAssetCount() const override;
 
     private:
+        bool isCancelled();
+        void setCancelled();
+        bool readCachedAsset(const std::string &assetId, std::string &data) const;
+        void writeCachedAsset(const std::string &assetId, const std::string &data) const;
+        void assetReady(unsigned int count);
+
         IDownloaderFactory *m_downloaderFactory = nullptr;
         std::shared_ptr<IDownloader> m_tokenDownloader;
         std::shared_ptr<IDownloader> m_jsonDownloader;
         std::vector<std::string> m_assets;
-        std::mutex m_assetsMutex;
+        std::string m_cacheDirectory;
         std::atomic<unsigned int> m_downloadedAssetCount = 0;
         bool m_cancel = false;
         std::mutex m_cancelMutex;
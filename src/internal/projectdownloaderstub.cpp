@@ -22,6 +22,10 @@ void ProjectDownloaderStub::cancel()
 {
 }
 
+void ProjectDownloaderStub::setCacheDirectory(const std::string &)
+{
+}
+
 void ProjectDownloaderStub::setDownloadProgressCallback(const std::function<void(unsigned int, unsigned int)> &)
 {
 }
@@ -9,12 +9,12 @@
 namespace libscratchcpp
 {
 
-Value jsonToValue(nlohmann::json value)
+inline Value jsonToValue(const nlohmann::json &value)
 {
     if (value.is_string())
         return value.get<std::string>();
     else if (value.is_number())
-        return std::stod(value.dump());
+        return value.get<double>();
     else if (value.is_boolean())
         return value.get<bool>();
     else
@@ -19,331 +19,284 @@
 using namespace libscratchcpp;
 using json = nlohmann::json;
 
-bool Scratch3Reader::load()
+namespace libscratchcpp
 {
-    if (m_json == "")
-        read();
-    auto project = m_json;
-    const char *step = "";
 
-    try {
-        // targets
-        READER_STEP(step, "targets");
-        auto targets = project["targets"];
-        for (auto jsonTarget : targets) {
-            std::shared_ptr<Target> target;
-
-            // isStage
-            READER_STEP(step, "target -> isStage");
-            if (jsonTarget["isStage"])
-                target = std::make_shared<Stage>();
+// Builds the project directly from the parse events of project.json.
+// Only small parts of the document are kept as JSON values: a single block,
+// the properties of the current target (except blocks) and the metadata.
+class Scratch3SaxHandler : public nlohmann::json_sax<json>
+{
+    public:
+        Scratch3SaxHandler(Scratch3Reader *reader) :
+            m_reader(reader)
+        {
+        }
+
+        bool null() override { return value(nullptr); }
+        bool boolean(bool val) override { return value(val); }
+        bool number_integer(json::number_integer_t val) override { return value(val); }
+        bool number_unsigned(json::number_unsigned_t val) override { return value(val); }
+        bool number_float(json::number_float_t val, const json::string_t &) override { return value(val); }
+        bool string(json::string_t &val) override { return value(std::move(val)); }
+        bool binary(json::binary_t &val) override { return value(json::binary(val)); }
+        bool start_object(std::size_t) override { return startContainer(json::object()); }
+        bool start_array(std::size_t) override { return startContainer(json::array()); }
+        bool end_object() override { return endContainer(); }
+        bool end_array() override { return endContainer(); }
+
+        bool key(json::string_t &val) override
+        {
+            if (m_captureStack.empty())
+                m_nodes.back().key = val;
             else
-                target = std::make_shared<Sprite>();
-
-            // name
-            READER_STEP(step, "target -> name");
-            target->setName(jsonTarget["name"]);
-
-            // variables
-            READER_STEP(step, "target -> variables");
-            auto variables = jsonTarget["variables"];
-            for (json::iterator it = variables.begin(); it != variables.end(); ++it) {
-                auto varInfo = it.value();
-                bool cloudVar = (varInfo.size() >= 3 && varInfo[2]);
-                auto variable = std::make_shared<Variable>(it.key(), varInfo[0], Value(jsonToValue(varInfo[1])), cloudVar);
-                target->addVariable(variable);
-            }
+                m_captureKey = val;
 
-            // lists
-            READER_STEP(step, "target -> lists");
-            auto lists = jsonTarget["lists"];
-            for (json::iterator it = lists.begin(); it != lists.end(); ++it) {
-                auto listInfo = it.value();
-                auto list = std::make_shared<List>(it.key(), listInfo[0]);
-                auto arr = listInfo[1];
-                for (auto item : arr)
-                    list->push_back(jsonToValue(item));
-                target->addList(list);
-            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string &, const json::exception &ex) override
+        {
+            m_parseError = ex.what();
+            return false;
+        }
 
-            // broadcasts
-            READER_STEP(step, "target -> broadcasts");
-            auto broadcasts = jsonTarget["broadcasts"];
-            for (json::iterator it = broadcasts.begin(); it != broadcasts.end(); ++it) {
-                auto broadcast = std::make_shared<Broadcast>(it.key(), it.value());
-                m_broadcasts.push_back(broadcast);
+        const std::string &parseError() const { return m_parseError; }
+
+    private:
+        enum class NodeType
+        {
+            Root,
+            Targets,
+            Target,
+            Blocks,
+            Other
+        };
+
+        enum class Capture
+        {
+            None,
+            TargetProperty,
+            Block,
+            Meta,
+            Extensions
+        };
+
+        struct Node
+        {
+                NodeType type;
+                std::string key; // last key in an object
+        };
+
+        // Returns what should be done with a value at the current position
+        Capture capture() const
+        {
+            if (m_nodes.empty())
+                return Capture::None;
+
+            const Node &node = m_nodes.back();
+
+            switch (node.type) {
+                case NodeType::Root:
+                    if (node.key == "meta")
+                        return Capture::Meta;
+                    else if (node.key == "extensions")
+                        return Capture::Extensions;
+
+                    return Capture::None;
+
+                case NodeType::Target:
+                    return node.key == "blocks" ? Capture::None : Capture::TargetProperty;
+
+                case NodeType::Blocks:
+                    return Capture::Block;
+
+                default:
+                    return Capture::None;
             }
+        }
 
-            // blocks
-            READER_STEP(step, "target -> blocks");
-            auto blocks = jsonTarget["blocks"];
-            for (json::iterator it = blocks.begin(); it != blocks.end(); ++it) {
-                auto blockInfo = it.value();
-
-                if (blockInfo.is_array()) {
-                    // This is a top level reporter block for a variable/list
-                    READER_STEP(step, "target -> block -> top level reporter info");
-                    auto block = std::make_shared<Block>(it.key(), "");
-                    block->setIsTopLevelReporter(true);
-                    InputValue *reporterInfo = block->topLevelReporterInfo();
-
-                    reporterInfo->setValue(jsonToValue(blockInfo[1]));
-                    reporterInfo->setValueId(jsonToValue(blockInfo[2]).toString());
-                    reporterInfo->setType(static_cast<InputValue::Type>(blockInfo[0]));
-
-                    target->addBlock(block);
-                    continue;
-                }
+        // Returns the type of a container which starts at the current position
+        NodeType childType() const
+        {
+            if (m_nodes.empty())
+                return NodeType::Root;
 
-                READER_STEP(step, "target -> block -> opcode");
-                auto block = std::make_shared<Block>(it.key(), blockInfo["opcode"]);
-                std::string nextId;
-                READER_STEP(step, "target -> block -> next");
-                if (!blockInfo["next"].is_null())
-                    nextId = blockInfo["next"];
-                block->setNextId(nextId);
-                std::string parentId;
-                READER_STEP(step, "target -> block -> parent");
-                if (!blockInfo["parent"].is_null())
-                    parentId = blockInfo["parent"];
-                block->setParentId(parentId);
-
-                // inputs
-                READER_STEP(step, "target -> block -> inputs");
-                auto inputs = blockInfo["inputs"];
-                for (json::iterator it = inputs.begin(); it != inputs.end(); ++it) {
-                    auto inputInfo = it.value();
-                    auto input = std::make_shared<Input>(it.key(), static_cast<Input::Type>(inputInfo[0]));
-                    auto primary = inputInfo[1];
-                    if (primary.is_array()) {
-                        input->setPrimaryValue(jsonToValue(primary[1]));
-                        input->primaryValue()->setType(static_cast<InputValue::Type>(primary[0]));
-                        if (primary.size() >= 3)
-                            input->primaryValue()->setValueId(jsonToValue(primary[2]).toString());
-                    } else if (primary.is_null())
-                        input->setValueBlockId("");
-                    else
-                        input->setValueBlockId(primary);
-                    if (inputInfo.size() >= 3) {
-                        auto secondary = inputInfo[2];
-                        if (secondary.is_array()) {
-                            input->setSecondaryValue(jsonToValue(secondary[1]));
-                            input->secondaryValue()->setType(static_cast<InputValue::Type>(secondary[0]));
-                            if (secondary.size() >= 3)
-                                input->secondaryValue()->setValueId(jsonToValue(secondary[2]).toString());
-                        }
-                    }
-                    block->addInput(input);
-                }
+            const Node &node = m_nodes.back();
 
-                // fields
-                READER_STEP(step, "target -> block -> fields");
-                auto fields = blockInfo["fields"];
-                for (json::iterator it = fields.begin(); it != fields.end(); ++it) {
-                    auto fieldInfo = it.value();
-                    std::shared_ptr<Field> field;
-                    if (fieldInfo.size() >= 2) {
-                        auto valueId = fieldInfo[1];
-                        std::string valueIdStr;
-                        if (!valueId.is_null())
-                            valueIdStr = valueId;
-                        field = std::make_shared<Field>(it.key(), jsonToValue(fieldInfo[0]), valueIdStr);
-                    } else
-                        field = std::make_shared<Field>(it.key(), jsonToValue(fieldInfo[0]));
-                    block->addField(field);
-                }
+            switch (node.type) {
+                case NodeType::Root:
+                    return node.key == "targets" ? NodeType::Targets : NodeType::Other;
 
-                // mutation
-                READER_STEP(step, "target -> block -> mutation");
-                if (blockInfo.contains("mutation")) {
-                    auto mutation = blockInfo["mutation"];
-                    READER_STEP(step, "target -> block -> mutation -> hasnext");
-                    if (mutation.contains("hasnext"))
-                        block->setMutationHasNext(jsonToValue(mutation["hasnext"]).toBool());
-                    BlockPrototype *prototype = block->mutationPrototype();
-                    READER_STEP(step, "target -> block -> mutation -> proccode");
-                    if (mutation.contains("proccode"))
-                        prototype->setProcCode(mutation["proccode"].get<std::string>());
-                    READER_STEP(step, "target -> block -> mutation -> argumentids");
-                    if (mutation.contains("argumentids")) {
-                        std::vector<std::string> argIDs;
-                        auto argIDsJson = json::parse(mutation["argumentids"].get<std::string>());
-                        for (auto arg : argIDsJson)
-                            argIDs.push_back(arg.get<std::string>());
-                        prototype->setArgumentIds(argIDs);
-                    }
-                    READER_STEP(step, "target -> block -> mutation -> argumentnames");
-                    if (mutation.contains("argumentnames")) {
-                        std::vector<std::string> argNames;
-                        auto argNamesJson = json::parse(mutation["argumentnames"].get<std::string>());
-                        for (auto arg : argNamesJson)
-                            argNames.push_back(arg.get<std::string>());
-                        prototype->setArgumentNames(argNames);
-                    }
-                    READER_STEP(step, "target -> block -> mutation -> warp");
-                    if (mutation.contains("warp"))
-                        prototype->setWarp(jsonToValue(mutation["warp"]).toBool());
-                }
+                case NodeType::Targets:
+                    return NodeType::Target;
 
-                // shadow
-                READER_STEP(step, "target -> block -> shadow");
-                block->setShadow(blockInfo["shadow"]);
+                case NodeType::Target:
+                    return node.key == "blocks" ? NodeType::Blocks : NodeType::Other;
 
-                // comment
-                READER_STEP(step, "target -> block -> comment");
-                if (!blockInfo["comment"].is_null())
-                    block->setCommentId(blockInfo["comment"]);
+                default:
+                    return NodeType::Other;
+            }
+        }
 
-                target->addBlock(block);
+        // Adds a value to the captured JSON value
+        json *addToCapture(json &&val)
+        {
+            json *parent = m_captureStack.back();
+
+            if (parent->is_array()) {
+                parent->push_back(std::move(val));
+                return &parent->back();
+            } else {
+                json &ref = (*parent)[m_captureKey];
+                ref = std::move(val);
+                return &ref;
             }
+        }
+
+        bool value(json &&val)
+        {
+            if (!m_captureStack.empty())
+                addToCapture(std::move(val));
+            else {
+                Capture c = capture();
 
-            // comments
-            READER_STEP(step, "target -> comments");
-            auto comments = jsonTarget["comments"];
-            for (json::iterator it = comments.begin(); it != comments.end(); ++it) {
-                auto commentInfo = it.value();
-                READER_STEP(step, "target -> comment -> { id, x, y }");
-                auto comment = std::make_shared<Comment>(it.key(), jsonToValue(commentInfo["x"]).toDouble(), jsonToValue(commentInfo["y"]).toDouble());
-                READER_STEP(step, "target -> comment -> blockId");
-
-                if (!commentInfo["blockId"].is_null())
-                    comment->setBlockId(commentInfo["blockId"]);
-
-                READER_STEP(step, "target -> comment -> width");
-                comment->setWidth(jsonToValue(commentInfo["width"]).toDouble());
-                READER_STEP(step, "target -> comment -> height");
-                comment->setHeight(jsonToValue(commentInfo["height"]).toDouble());
-                READER_STEP(step, "target -> comment -> minimized");
-                comment->setMinimized(commentInfo["minimized"]);
-                READER_STEP(step, "target -> comment -> text");
-                comment->setText(commentInfo["text"]);
-
-                target->addComment(comment);
+                if (c != Capture::None)
+                    deliver(c, m_nodes.back().key, val);
             }
 
-            // costumes
-            READER_STEP(step, "target -> costumes");
-            auto costumes = jsonTarget["costumes"];
-            for (auto jsonCostume : costumes) {
-                READER_STEP(step, "target -> costume -> { name, assetId, dataFormat }");
-                auto costume = std::make_shared<Costume>(jsonCostume["name"], jsonCostume["assetId"], jsonCostume["dataFormat"]);
-                READER_STEP(step, "target -> costume -> bitmapResolution");
-                if (jsonCostume.contains("bitmapResolution"))
-                    costume->setBitmapResolution(jsonCostume["bitmapResolution"]);
-                READER_STEP(step, "target -> costume -> rotationCenterX");
-                costume->setRotationCenterX(jsonCostume["rotationCenterX"]);
-                READER_STEP(step, "target -> costume -> rotationCenterY");
-                costume->setRotationCenterY(jsonCostume["rotationCenterY"]);
-
-                if (m_zipReader && !costume->data()) {
-                    void *data;
-                    unsigned int size = m_zipReader->readFile(costume->fileName(), &data);
-                    costume->setData(size, data);
-                }
+            return true;
+        }
 
-                target->addCostume(costume);
+        bool startContainer(json &&val)
+        {
+            if (!m_captureStack.empty()) {
+                m_captureStack.push_back(addToCapture(std::move(val)));
+                return true;
             }
 
-            // currentCostume
-            READER_STEP(step, "target -> currentCostume");
-            target->setCostumeIndex(jsonToValue(jsonTarget["currentCostume"]).toInt());
-
-            // sounds
-            READER_STEP(step, "target -> sounds");
-            auto sounds = jsonTarget["sounds"];
-            for (auto jsonSound : sounds) {
-                READER_STEP(step, "target -> sound -> { name, assetId, dataFormat }");
-                auto sound = std::make_shared<Sound>(jsonSound["name"], jsonSound["assetId"], jsonSound["dataFormat"]);
-                READER_STEP(step, "target -> sound -> rate");
-                sound->setRate(jsonSound["rate"]);
-                READER_STEP(step, "target -> sound -> sampleCount");
-                sound->setSampleCount(jsonSound["sampleCount"]);
-                target->addSound(sound);
+            Capture c = capture();
+
+            if (c != Capture::None) {
+                m_capture = std::move(val);
+                m_captureType = c;
+                m_captureName = m_nodes.back().key;
+                m_captureStack.push_back(&m_capture);
+                return true;
             }
 
-            // layerOrder
-            READER_STEP(step, "target -> layerOrder");
-            target->setLayerOrder(jsonTarget["layerOrder"]);
+            NodeType type = childType();
+            m_nodes.push_back({ type, "" });
 
-            // volume
-            READER_STEP(step, "target -> volume");
-            target->setVolume(jsonTarget["volume"]);
+            if (type == NodeType::Target) {
+                m_targetJson = json::object();
+                m_blocks.clear();
+            }
 
-            if (target->isStage()) {
-                auto stage = std::static_pointer_cast<Stage>(target);
+            return true;
+        }
 
-                // tempo
-                READER_STEP(step, "stage -> tempo");
-                if (jsonTarget.contains("tempo"))
-                    stage->setTempo(jsonTarget["tempo"]);
+        bool endContainer()
+        {
+            if (!m_captureStack.empty()) {
+                m_captureStack.pop_back();
 
-                // videoState
-                READER_STEP(step, "stage -> videoState");
-                if (jsonTarget.contains("videoState")) {
-                    std::string videoState = jsonTarget["videoState"];
-                    stage->setVideoState(videoState);
+                if (m_captureStack.empty()) {
+                    deliver(m_captureType, m_captureName, m_capture);
+                    m_capture = json();
                 }
 
-                // videoTransparency
-                READER_STEP(step, "stage -> videoTransparency");
-                if (jsonTarget.contains("videoTransparency"))
-                    stage->setVideoTransparency(jsonTarget["videoTransparency"]);
-
-                // textToSpeechLanguage
-                READER_STEP(step, "stage -> textToSpeechLanguage");
-                if (jsonTarget.contains("textToSpeechLanguage")) {
-                    auto lang = jsonTarget["textToSpeechLanguage"];
-                    std::string langStr;
-                    if (!lang.is_null())
-                        langStr = lang;
-                    stage->setTextToSpeechLanguage(langStr);
-                }
-            } else {
-                auto sprite = std::static_pointer_cast<Sprite>(target);
+                return true;
+            }
+
+            if (m_nodes.back().type == NodeType::Target)
+                finishTarget();
 
-                // visible
-                READER_STEP(step, "sprite -> visible");
-                sprite->setVisible(jsonTarget["visible"]);
+            m_nodes.pop_back();
+            return true;
+        }
+
+        void deliver(Capture capture, const std::string &key, json &val)
+        {
+            switch (capture) {
+                case Capture::TargetProperty:
+                    m_targetJson[key] = std::move(val);
+                    break;
+
+                case Capture::Block:
+                    if (m_reader->m_error)
+                        break;
+
+                    try {
+                        m_blocks.push_back(m_reader->readBlock(key, val));
+                    } catch (std::exception &e) {
+                        m_reader->setError(e.what());
+                    }
 
-                // x
-                READER_STEP(step, "sprite -> x");
-                sprite->setX(jsonTarget["x"]);
+                    break;
 
-                // y
-                READER_STEP(step, "sprite -> y");
-                sprite->setY(jsonTarget["y"]);
+                case Capture::Meta:
+                    m_reader->m_meta = std::move(val);
+                    break;
 
-                // size
-                READER_STEP(step, "sprite -> size");
-                sprite->setSize(jsonTarget["size"]);
+                case Capture::Extensions:
+                    if (m_reader->m_error)
+                        break;
 
-                // direction
-                READER_STEP(step, "sprite -> direction");
-                sprite->setDirection(jsonTarget["direction"]);
+                    try {
+                        m_reader->readExtensions(val);
+                    } catch (std::exception &e) {
+                        m_reader->setError(e.what());
+                    }
 
-                // draggable
-                READER_STEP(step, "sprite -> draggable");
-                sprite->setDraggable(jsonTarget["draggable"]);
+                    break;
 
-                // rotationStyle
-                READER_STEP(step, "sprite -> rotationStyle");
-                std::string rotationStyle = jsonTarget["rotationStyle"];
-                sprite->setRotationStyle(rotationStyle);
+                default:
+                    break;
+            }
+        }
+
+        void finishTarget()
+        {
+            if (!m_reader->m_error) {
+                try {
+                    m_reader->m_targets.push_back(m_reader->readTarget(m_targetJson, m_blocks));
+                } catch (std::exception &e) {
+                    m_reader->setError(e.what());
+                }
             }
 
-            m_targets.push_back(target);
+            m_targetJson = json();
+            m_blocks.clear();
         }
 
-        // extensions
-        READER_STEP(step, "extensions");
-        auto extensions = project["extensions"];
-        for (auto extension : extensions)
-            m_extensions.push_back(extension);
-    } catch (std::exception &e) {
-        if (strcmp(step, "") == 0)
-            printErr("could not parse project JSON file", e.what());
+        Scratch3Reader *m_reader = nullptr;
+        std::vector<Node> m_nodes;
+        json m_capture;
+        Capture m_captureType = Capture::None;
+        std::string m_captureName;       // key of the captured value
+        std::string m_captureKey;        // last key inside the captured value
+        std::vector<json *> m_captureStack; // containers of the captured value
+        json m_targetJson;
+        std::vector<std::shared_ptr<Block>> m_blocks;
+        std::string m_parseError;
+};
+
+} // namespace libscratchcpp
+
+bool Scratch3Reader::load()
+{
+    if (!m_parsed)
+        read();
+
+    if (!m_jsonValid)
+        return false;
+
+    if (m_error) {
+        if (strcmp(m_errorStep, "") == 0)
+            printErr("could not parse project JSON file", m_errorWhat.c_str());
         else
-            printErr(std::string("could not parse ") + step, e.what());
+            printErr(std::string("could not parse ") + m_errorStep, m_errorWhat.c_str());
 
         return false;
     }
@@ -353,25 +306,21 @@ bool Scratch3Reader::load()
 
 bool Scratch3Reader::loadData(const std::string &data)
 {
-    try {
-        m_json = json::parse(data);
-    } catch (std::exception &e) {
-        printErr("invalid JSON file", e.what());
+    if (!parse(data))
         return false;
-    }
 
     return load();
 }
 
 bool Scratch3Reader::isValid()
 {
-    if (m_json == "")
+    if (!m_parsed)
         read();
 
     std::string semver;
 
     try {
-        semver = m_json["meta"]["semver"];
+        semver = m_meta["semver"];
     } catch (std::exception &e) {
         printErr("could not find Scratch version", e.what());
         return false;
@@ -382,10 +331,17 @@ bool Scratch3Reader::isValid()
 
 void Scratch3Reader::clear()
 {
-    m_json = "";
+    m_parsed = false;
+    m_jsonValid = false;
+    m_meta = json();
+    m_step = "";
+    m_error = false;
+    m_errorStep = "";
+    m_errorWhat.clear();
     m_targets.clear();
     m_broadcasts.clear();
     m_extensions.clear();
+    m_zipReader.reset();
 }
 
 const std::vector<std::shared_ptr<Target>> &Scratch3Reader::targets()
@@ -409,14 +365,361 @@ void Scratch3Reader::read()
         return;
 
     // Read project.json
-    m_zipReader = std::make_unique<ZipReader>(fileName());
-    if (m_zipReader->open()) {
-        // Parse the JSON
-        try {
-            m_json = json::parse(m_zipReader->readFileToString("project.json"));
-        } catch (std::exception &e) {
-            printErr("invalid JSON file", e.what());
-        }
-    } else
+    auto zipReader = std::make_shared<ZipReader>(fileName());
+    if (zipReader->open())
+        parse(zipReader->readFileToString("project.json"), zipReader);
+    else
         printErr("could not read " + fileName());
 }
+
+// Reads the project from the given JSON without building a DOM of the whole document.
+// Asset data is loaded from the given archive when it's needed (if there's any).
+bool Scratch3Reader::parse(const std::string &data, std::shared_ptr<ZipReader> zipReader)
+{
+    clear();
+    m_parsed = true;
+    m_zipReader = zipReader;
+
+    Scratch3SaxHandler handler(this);
+    m_jsonValid = json::sax_parse(data, &handler);
+
+    if (!m_jsonValid) {
+        printErr("invalid JSON file", handler.parseError().c_str());
+        m_targets.clear();
+        m_broadcasts.clear();
+        m_extensions.clear();
+    }
+
+    return m_jsonValid;
+}
+
+std::shared_ptr<Block> Scratch3Reader::readBlock(const std::string &id, json &blockInfo)
+{
+    if (blockInfo.is_array()) {
+        // This is a top level reporter block for a variable/list
+        READER_STEP(m_step, "target -> block -> top level reporter info");
+        auto block = std::make_shared<Block>(id, "");
+        block->setIsTopLevelReporter(true);
+        InputValue *reporterInfo = block->topLevelReporterInfo();
+
+        reporterInfo->setValue(jsonToValue(blockInfo[1]));
+        reporterInfo->setValueId(jsonToValue(blockInfo[2]).toString());
+        reporterInfo->setType(static_cast<InputValue::Type>(blockInfo[0]));
+
+        return block;
+    }
+
+    READER_STEP(m_step, "target -> block -> opcode");
+    auto block = std::make_shared<Block>(id, blockInfo["opcode"]);
+    std::string nextId;
+    READER_STEP(m_step, "target -> block -> next");
+    if (!blockInfo["next"].is_null())
+        nextId = blockInfo["next"];
+    block->setNextId(nextId);
+    std::string parentId;
+    READER_STEP(m_step, "target -> block -> parent");
+    if (!blockInfo["parent"].is_null())
+        parentId = blockInfo["parent"];
+    block->setParentId(parentId);
+
+    // inputs
+    READER_STEP(m_step, "target -> block -> inputs");
+    auto &inputs = blockInfo["inputs"];
+    for (json::iterator it = inputs.begin(); it != inputs.end(); ++it) {
+        const auto &inputInfo = it.value();
+        auto input = std::make_shared<Input>(it.key(), static_cast<Input::Type>(inputInfo[0]));
+        const auto &primary = inputInfo[1];
+        if (primary.is_array()) {
+            input->setPrimaryValue(jsonToValue(primary[1]));
+            input->primaryValue()->setType(static_cast<InputValue::Type>(primary[0]));
+            if (primary.size() >= 3)
+                input->primaryValue()->setValueId(jsonToValue(primary[2]).toString());
+        } else if (primary.is_null())
+            input->setValueBlockId("");
+        else
+            input->setValueBlockId(primary);
+        if (inputInfo.size() >= 3) {
+            const auto &secondary = inputInfo[2];
+            if (secondary.is_array()) {
+                input->setSecondaryValue(jsonToValue(secondary[1]));
+                input->secondaryValue()->setType(static_cast<InputValue::Type>(secondary[0]));
+                if (secondary.size() >= 3)
+                    input->secondaryValue()->setValueId(jsonToValue(secondary[2]).toString());
+            }
+        }
+        block->addInput(input);
+    }
+
+    // fields
+    READER_STEP(m_step, "target -> block -> fields");
+    auto &fields = blockInfo["fields"];
+    for (json::iterator it = fields.begin(); it != fields.end(); ++it) {
+        const auto &fieldInfo = it.value();
+        std::shared_ptr<Field> field;
+        if (fieldInfo.size() >= 2) {
+            const auto &valueId = fieldInfo[1];
+            std::string valueIdStr;
+            if (!valueId.is_null())
+                valueIdStr = valueId;
+            field = std::make_shared<Field>(it.key(), jsonToValue(fieldInfo[0]), valueIdStr);
+        } else
+            field = std::make_shared<Field>(it.key(), jsonToValue(fieldInfo[0]));
+        block->addField(field);
+    }
+
+    // mutation
+    READER_STEP(m_step, "target -> block -> mutation");
+    if (blockInfo.contains("mutation")) {
+        auto &mutation = blockInfo["mutation"];
+        READER_STEP(m_step, "target -> block -> mutation -> hasnext");
+        if (mutation.contains("hasnext"))
+            block->setMutationHasNext(jsonToValue(mutation["hasnext"]).toBool());
+        BlockPrototype *prototype = block->mutationPrototype();
+        READER_STEP(m_step, "target -> block -> mutation -> proccode");
+        if (mutation.contains("proccode"))
+            prototype->setProcCode(mutation["proccode"].get<std::string>());
+        READER_STEP(m_step, "target -> block -> mutation -> argumentids");
+        if (mutation.contains("argumentids")) {
+            std::vector<std::string> argIDs;
+            auto argIDsJson = json::parse(mutation["argumentids"].get<std::string>());
+            for (const auto &arg : argIDsJson)
+                argIDs.push_back(arg.get<std::string>());
+            prototype->setArgumentIds(argIDs);
+        }
+        READER_STEP(m_step, "target -> block -> mutation -> argumentnames");
+        if (mutation.contains("argumentnames")) {
+            std::vector<std::string> argNames;
+            auto argNamesJson = json::parse(mutation["argumentnames"].get<std::string>());
+            for (const auto &arg : argNamesJson)
+                argNames.push_back(arg.get<std::string>());
+            prototype->setArgumentNames(argNames);
+        }
+        READER_STEP(m_step, "target -> block -> mutation -> warp");
+        if (mutation.contains("warp"))
+            prototype->setWarp(jsonToValue(mutation["warp"]).toBool());
+    }
+
+    // shadow
+    READER_STEP(m_step, "target -> block -> shadow");
+    block->setShadow(blockInfo["shadow"]);
+
+    // comment
+    READER_STEP(m_step, "target -> block -> comment");
+    if (!blockInfo["comment"].is_null())
+        block->setCommentId(blockInfo["comment"]);
+
+    return block;
+}
+
+std::shared_ptr<Target> Scratch3Reader::readTarget(json &jsonTarget, const std::vector<std::shared_ptr<Block>> &blocks)
+{
+    std::shared_ptr<Target> target;
+
+    // isStage
+    READER_STEP(m_step, "target -> isStage");
+    if (jsonTarget["isStage"])
+        target = std::make_shared<Stage>();
+    else
+        target = std::make_shared<Sprite>();
+
+    // name
+    READER_STEP(m_step, "target -> name");
+    target->setName(jsonTarget["name"]);
+
+    // variables
+    READER_STEP(m_step, "target -> variables");
+    auto &variables = jsonTarget["variables"];
+    for (json::iterator it = variables.begin(); it != variables.end(); ++it) {
+        const auto &varInfo = it.value();
+        bool cloudVar = (varInfo.size() >= 3 && varInfo[2]);
+        auto variable = std::make_shared<Variable>(it.key(), varInfo[0], Value(jsonToValue(varInfo[1])), cloudVar);
+        target->addVariable(variable);
+    }
+
+    // lists
+    READER_STEP(m_step, "target -> lists");
+    auto &lists = jsonTarget["lists"];
+    for (json::iterator it = lists.begin(); it != lists.end(); ++it) {
+        const auto &listInfo = it.value();
+        auto list = std::make_shared<List>(it.key(), listInfo[0]);
+        const auto &arr = listInfo[1];
+        for (const auto &item : arr)
+            list->push_back(jsonToValue(item));
+        target->addList(list);
+    }
+
+    // broadcasts
+    READER_STEP(m_step, "target -> broadcasts");
+    auto &broadcasts = jsonTarget["broadcasts"];
+    for (json::iterator it = broadcasts.begin(); it != broadcasts.end(); ++it) {
+        auto broadcast = std::make_shared<Broadcast>(it.key(), it.value());
+        m_broadcasts.push_back(broadcast);
+    }
+
+    // blocks
+    for (auto block : blocks)
+        target->addBlock(block);
+
+    // comments
+    READER_STEP(m_step, "target -> comments");
+    auto &comments = jsonTarget["comments"];
+    for (json::iterator it = comments.begin(); it != comments.end(); ++it) {
+        auto &commentInfo = it.value();
+        READER_STEP(m_step, "target -> comment -> { id, x, y }");
+        auto comment = std::make_shared<Comment>(it.key(), jsonToValue(commentInfo["x"]).toDouble(), jsonToValue(commentInfo["y"]).toDouble());
+        READER_STEP(m_step, "target -> comment -> blockId");
+
+        if (!commentInfo["blockId"].is_null())
+            comment->setBlockId(commentInfo["blockId"]);
+
+        READER_STEP(m_step, "target -> comment -> width");
+        comment->setWidth(jsonToValue(commentInfo["width"]).toDouble());
+        READER_STEP(m_step, "target -> comment -> height");
+        comment->setHeight(jsonToValue(commentInfo["height"]).toDouble());
+        READER_STEP(m_step, "target -> comment -> minimized");
+        comment->setMinimized(commentInfo["minimized"]);
+        READER_STEP(m_step, "target -> comment -> text");
+        comment->setText(commentInfo["text"]);
+
+        target->addComment(comment);
+    }
+
+    // costumes
+    READER_STEP(m_step, "target -> costumes");
+    auto &costumes = jsonTarget["costumes"];
+    for (auto &jsonCostume : costumes) {
+        READER_STEP(m_step, "target -> costume -> { name, assetId, dataFormat }");
+        auto costume = std::make_shared<Costume>(jsonCostume["name"], jsonCostume["assetId"], jsonCostume["dataFormat"]);
+        READER_STEP(m_step, "target -> costume -> bitmapResolution");
+        if (jsonCostume.contains("bitmapResolution"))
+            costume->setBitmapResolution(jsonCostume["bitmapResolution"]);
+        READER_STEP(m_step, "target -> costume -> rotationCenterX");
+        costume->setRotationCenterX(jsonCostume["rotationCenterX"]);
+        READER_STEP(m_step, "target -> costume -> rotationCenterY");
+        costume->setRotationCenterY(jsonCostume["rotationCenterY"]);
+
+        if (m_zipReader)
+            setAssetDataLoader(costume.get());
+
+        target->addCostume(costume);
+    }
+
+    // currentCostume
+    READER_STEP(m_step, "target -> currentCostume");
+    target->setCostumeIndex(jsonToValue(jsonTarget["currentCostume"]).toInt());
+
+    // sounds
+    READER_STEP(m_step, "target -> sounds");
+    auto &sounds = jsonTarget["sounds"];
+    for (auto &jsonSound : sounds) {
+        READER_STEP(m_step, "target -> sound -> { name, assetId, dataFormat }");
+        auto sound = std::make_shared<Sound>(jsonSound["name"], jsonSound["assetId"], jsonSound["dataFormat"]);
+        READER_STEP(m_step, "target -> sound -> rate");
+        sound->setRate(jsonSound["rate"]);
+        READER_STEP(m_step, "target -> sound -> sampleCount");
+        sound->setSampleCount(jsonSound["sampleCount"]);
+
+        if (m_zipReader)
+            setAssetDataLoader(sound.get());
+
+        target->addSound(sound);
+    }
+
+    // layerOrder
+    READER_STEP(m_step, "target -> layerOrder");
+    target->setLayerOrder(jsonTarget["layerOrder"]);
+
+    // volume
+    READER_STEP(m_step, "target -> volume");
+    target->setVolume(jsonTarget["volume"]);
+
+    if (target->isStage()) {
+        auto stage = std::static_pointer_cast<Stage>(target);
+
+        // tempo
+        READER_STEP(m_step, "stage -> tempo");
+        if (jsonTarget.contains("tempo"))
+            stage->setTempo(jsonTarget["tempo"]);
+
+        // videoState
+        READER_STEP(m_step, "stage -> videoState");
+        if (jsonTarget.contains("videoState")) {
+            std::string videoState = jsonTarget["videoState"];
+            stage->setVideoState(videoState);
+        }
+
+        // videoTransparency
+        READER_STEP(m_step, "stage -> videoTransparency");
+        if (jsonTarget.contains("videoTransparency"))
+            stage->setVideoTransparency(jsonTarget["videoTransparency"]);
+
+        // textToSpeechLanguage
+        READER_STEP(m_step, "stage -> textToSpeechLanguage");
+        if (jsonTarget.contains("textToSpeechLanguage")) {
+            const auto &lang = jsonTarget["textToSpeechLanguage"];
+            std::string langStr;
+            if (!lang.is_null())
+                langStr = lang;
+            stage->setTextToSpeechLanguage(langStr);
+        }
+    } else {
+        auto sprite = std::static_pointer_cast<Sprite>(target);
+
+        // visible
+        READER_STEP(m_step, "sprite -> visible");
+        sprite->setVisible(jsonTarget["visible"]);
+
+        // x
+        READER_STEP(m_step, "sprite -> x");
+        sprite->setX(jsonTarget["x"]);
+
+        // y
+        READER_STEP(m_step, "sprite -> y");
+        sprite->setY(jsonTarget["y"]);
+
+        // size
+        READER_STEP(m_step, "sprite -> size");
+        sprite->setSize(jsonTarget["size"]);
+
+        // direction
+        READER_STEP(m_step, "sprite -> direction");
+        sprite->setDirection(jsonTarget["direction"]);
+
+        // draggable
+        READER_STEP(m_step, "sprite -> draggable");
+        sprite->setDraggable(jsonTarget["draggable"]);
+
+        // rotationStyle
+        READER_STEP(m_step, "sprite -> rotationStyle");
+        std::string rotationStyle = jsonTarget["rotationStyle"];
+        sprite->setRotationStyle(rotationStyle);
+    }
+
+    return target;
+}
+
+void Scratch3Reader::readExtensions(const json &extensions)
+{
+    READER_STEP(m_step, "extensions");
+    for (const auto &extension : extensions)
+        m_extensions.push_back(extension);
+}
+
+// Makes the asset data load from the archive on first access.
+void Scratch3Reader::setAssetDataLoader(Asset *asset)
+{
+    std::shared_ptr<ZipReader> zipReader = m_zipReader;
+    std::string fileName = asset->fileName();
+    asset->setDataLoader(zipReader->fileSize(fileName), [zipReader, fileName]() { return zipReader->fileData(fileName); });
+}
+
+// Stores the first error which occurred while reading the project.
+void Scratch3Reader::setError(const char *what)
+{
+    if (m_error)
+        return;
+
+    m_error = true;
+    m_errorStep = m_step;
+    m_errorWhat = what;
+}
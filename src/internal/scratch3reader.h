@@ -10,6 +10,9 @@
 namespace libscratchcpp
 {
 
+class Block;
+class Asset;
+
 class Scratch3Reader : public IProjectReader
 {
     public:
@@ -22,9 +25,24 @@ class Scratch3Reader : public IProjectReader
         const std::vector<std::string> &extensions() override;
 
     private:
+        friend class Scratch3SaxHandler;
+
         void read();
-        std::unique_ptr<ZipReader> m_zipReader;
-        nlohmann::json m_json = "";
+        bool parse(const std::string &data, std::shared_ptr<ZipReader> zipReader = nullptr);
+        std::shared_ptr<Block> readBlock(const std::string &id, nlohmann::json &blockInfo);
+        std::shared_ptr<Target> readTarget(nlohmann::json &jsonTarget, const std::vector<std::shared_ptr<Block>> &blocks);
+        void readExtensions(const nlohmann::json &extensions);
+        void setAssetDataLoader(Asset *asset);
+        void setError(const char *what);
+
+        std::shared_ptr<ZipReader> m_zipReader; // shared with the asset data loaders
+        bool m_parsed = false;
+        bool m_jsonValid = false;
+        nlohmann::json m_meta;
+        const char *m_step = "";
+        bool m_error = false;
+        const char *m_errorStep = "";
+        std::string m_errorWhat;
         std::vector<std::shared_ptr<Target>> m_targets;
         std::vector<std::shared_ptr<Broadcast>> m_broadcasts;
         std::vector<std::string> m_extensions;
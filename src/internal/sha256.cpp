@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <cstring>
+
+#include "sha256.h"
+
+using namespace libscratchcpp;
+
+static const uint32_t CONSTANTS[64] = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be,
+                                        0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa,
+                                        0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85,
+                                        0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+                                        0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+                                        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+static uint32_t rotateRight(uint32_t x, uint32_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static void processChunk(const unsigned char *chunk, uint32_t *state)
+{
+    uint32_t words[64];
+
+    for (int i = 0; i < 16; i++)
+        words[i] = (uint32_t(chunk[i * 4]) << 24) | (uint32_t(chunk[i * 4 + 1]) << 16) | (uint32_t(chunk[i * 4 + 2]) << 8) | uint32_t(chunk[i * 4 + 3]);
+
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotateRight(words[i - 15], 7) ^ rotateRight(words[i - 15], 18) ^ (words[i - 15] >> 3);
+        uint32_t s1 = rotateRight(words[i - 2], 17) ^ rotateRight(words[i - 2], 19) ^ (words[i - 2] >> 10);
+        words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + ch + CONSTANTS[i] + words[i];
+        uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+std::string Sha256::hex(const std::string &data)
+{
+    uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    size_t size = data.size();
+    size_t i;
+
+    for (i = 0; i + 64 <= size; i += 64)
+        processChunk(bytes + i, state);
+
+    // Pad the last chunk with 0x80, zeros and the big-endian length in bits
+    unsigned char tail[128] = { 0 };
+    size_t remaining = size - i;
+    std::memcpy(tail, bytes + i, remaining);
+    tail[remaining] = 0x80;
+    size_t tailSize = remaining < 56 ? 64 : 128;
+    uint64_t bitCount = uint64_t(size) * 8;
+
+    for (int j = 0; j < 8; j++)
+        tail[tailSize - 1 - j] = (bitCount >> (j * 8)) & 0xff;
+
+    for (size_t j = 0; j < tailSize; j += 64)
+        processChunk(tail + j, state);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string ret;
+    ret.reserve(64);
+
+    for (uint32_t word : state) {
+        for (int j = 3; j >= 0; j--) {
+            unsigned char byte = (word >> (j * 8)) & 0xff;
+            ret.push_back(digits[byte >> 4]);
+            ret.push_back(digits[byte & 0xf]);
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+namespace libscratchcpp
+{
+
+// SHA-256 hash (FIPS 180-4), used as the key of project cache files.
+class Sha256
+{
+    public:
+        static std::string hex(const std::string &data);
+};
+
+} // namespace libscratchcpp
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+
+#include "workstealingpool.h"
+
+using namespace libscratchcpp;
+
+static thread_local bool insideWorker = false;
+
+// Uses one thread per core if threadCount is 0
+WorkStealingPool::WorkStealingPool(unsigned int threadCount) :
+    m_threadCount(threadCount == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threadCount)
+{
+    for (unsigned int i = 0; i < m_threadCount; i++)
+        m_queues.push_back(std::make_unique<Queue>());
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    m_mutex.lock();
+    m_stop = true;
+    m_mutex.unlock();
+    m_startCondition.notify_all();
+
+    for (auto &thread : m_threads)
+        thread.join();
+}
+
+unsigned int WorkStealingPool::threadCount() const
+{
+    return m_threadCount;
+}
+
+// Runs the tasks on the worker threads and blocks until all of them finish.
+// The calling thread is used as the first worker. Workers which run out of tasks steal them from the other queues.
+void WorkStealingPool::run(const std::vector<Task> &tasks)
+{
+    if (tasks.empty())
+        return;
+
+    // No new tasks are added while the workers are running, so a worker can exit once all queues are empty
+    for (size_t i = 0; i < tasks.size(); i++)
+        m_queues[i % m_threadCount]->tasks.push_back(tasks[i]);
+
+    if (m_threadCount == 1 || tasks.size() == 1) {
+        // Only the calling thread is used, so it doesn't count as a worker thread (the tasks may start other pools)
+        Task task;
+
+        while (pop(0, task))
+            task();
+
+        return;
+    }
+
+    // The threads are started on the first run and then reused
+    if (m_threads.empty()) {
+        for (unsigned int i = 1; i < m_threadCount; i++)
+            m_threads.push_back(std::thread(&WorkStealingPool::threadMain, this, i));
+    }
+
+    m_mutex.lock();
+    m_activeWorkers = m_threadCount - 1;
+    m_generation++;
+    m_mutex.unlock();
+    m_startCondition.notify_all();
+
+    worker(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]() { return m_activeWorkers == 0; });
+}
+
+// Returns true if the current thread is running tasks of a pool along with other threads.
+bool WorkStealingPool::isWorkerThread()
+{
+    return insideWorker;
+}
+
+void WorkStealingPool::threadMain(unsigned int index)
+{
+    unsigned long generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+
+            if (m_stop)
+                return;
+
+            generation = m_generation;
+        }
+
+        worker(index);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (--m_activeWorkers == 0)
+            m_doneCondition.notify_one();
+    }
+}
+
+void WorkStealingPool::worker(unsigned int index)
+{
+    Task task;
+    bool wasInsideWorker = insideWorker;
+    insideWorker = true;
+
+    while (pop(index, task) || steal(index, task))
+        task();
+
+    insideWorker = wasInsideWorker;
+}
+
+bool WorkStealingPool::pop(unsigned int index, Task &task)
+{
+    Queue *queue = m_queues[index].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->tasks.empty())
+        return false;
+
+    // Take the oldest task from the own queue
+    task = std::move(queue->tasks.front());
+    queue->tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned int index, Task &task)
+{
+    for (unsigned int i = 1; i < m_threadCount; i++) {
+        Queue *queue = m_queues[(index + i) % m_threadCount].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+
+        if (!queue->tasks.empty()) {
+            // Take the newest task from the other queue
+            task = std::move(queue->tasks.back());
+            queue->tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
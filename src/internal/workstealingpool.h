@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace libscratchcpp
+{
+
+class WorkStealingPool
+{
+    public:
+        using Task = std::function<void()>;
+
+        WorkStealingPool(unsigned int threadCount = 0);
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        ~WorkStealingPool();
+
+        unsigned int threadCount() const;
+
+        void run(const std::vector<Task> &tasks);
+
+        static bool isWorkerThread();
+
+    private:
+        struct Queue
+        {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+        };
+
+        void threadMain(unsigned int index);
+        void worker(unsigned int index);
+        bool pop(unsigned int index, Task &task);
+        bool steal(unsigned int index, Task &task);
+
+        unsigned int m_threadCount = 1;
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_startCondition;
+        std::condition_variable m_doneCondition;
+        unsigned long m_generation = 0;
+        unsigned int m_activeWorkers = 0;
+        bool m_stop = false;
+};
+
+} // namespace libscratchcpp
@@ -1,9 +1,28 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "zipreader.h"
 
 using namespace libscratchcpp;
 
+static unsigned int read16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int read32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
 ZipReader::ZipReader(const std::string &fileName) :
     m_fileName(fileName)
 {
@@ -21,29 +40,58 @@ ZipReader::~ZipReader()
 
 bool ZipReader::open()
 {
-    m_zip = zip_open(m_fileName.c_str(), 0, 'r');
-    return m_zip;
+    if (!map())
+        return false;
+
+    m_zip = zip_stream_open(m_mapping.get(), m_mappingSize, 0, 'r');
+
+    if (!m_zip) {
+        close();
+        return false;
+    }
+
+    m_handles.push_back(m_zip);
+    readEntries();
+    return true;
 }
 
+// Closes the archive. If other threads are reading files, this waits until they finish.
 void ZipReader::close()
 {
-    if (m_zip)
-        zip_close(m_zip);
+    std::unique_lock<std::mutex> lock(m_handlesMutex);
+    m_handleReleased.wait(lock, [this]() { return m_usedHandles == 0; });
 
+    for (struct zip_t *handle : m_handles)
+        zip_stream_close(handle);
+
+    m_handles.clear();
     m_zip = nullptr;
+
+    // Data returned by fileData() keeps the mapping alive
+    m_mapping.reset();
+    m_mappingSize = 0;
+    m_entries.clear();
 }
 
 size_t ZipReader::readFile(const std::string &fileName, void **buf)
 {
     if (!m_zip) {
-        buf = nullptr;
+        *buf = nullptr;
+        return 0;
+    }
+
+    struct zip_t *zip = acquireHandle();
+
+    if (!zip) {
+        *buf = nullptr;
         return 0;
     }
 
     size_t bufsize = 0;
-    zip_entry_open(m_zip, fileName.c_str());
-    zip_entry_read(m_zip, buf, &bufsize);
-    zip_entry_close(m_zip);
+    zip_entry_open(zip, fileName.c_str());
+    zip_entry_read(zip, buf, &bufsize);
+    zip_entry_close(zip);
+    releaseHandle(zip);
 
     return bufsize;
 }
@@ -62,3 +110,190 @@ std::string ZipReader::readFileToString(const std::string &fileName)
 
     return "";
 }
+
+// Returns the uncompressed size of the given file without reading it.
+size_t ZipReader::fileSize(const std::string &fileName) const
+{
+    auto it = m_entries.find(fileName);
+
+    if (it == m_entries.cend())
+        return 0;
+
+    return it->second.size;
+}
+
+// Returns the content of the given file. Stored (uncompressed) files aren't copied,
+// the returned pointer points to the mapped archive and keeps it alive.
+std::shared_ptr<const void> ZipReader::fileData(const std::string &fileName)
+{
+    auto it = m_entries.find(fileName);
+
+    if (it != m_entries.cend()) {
+        const void *data = storedData(it->second);
+
+        if (data)
+            return std::shared_ptr<const void>(m_mapping, data);
+    }
+
+    void *buf = nullptr;
+    readFile(fileName, &buf);
+
+    if (!buf)
+        return nullptr;
+
+    return std::shared_ptr<const void>(buf, free);
+}
+
+// Returns an unused zip handle, opens a new one if all of them are used by other threads.
+// The handle must be released using releaseHandle() (close() waits until all handles are released).
+struct zip_t *ZipReader::acquireHandle()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_handlesMutex);
+        m_usedHandles++;
+
+        if (!m_handles.empty()) {
+            struct zip_t *handle = m_handles.back();
+            m_handles.pop_back();
+            return handle;
+        }
+    }
+
+    // All handles share the mapped archive
+    struct zip_t *handle = zip_stream_open(m_mapping.get(), m_mappingSize, 0, 'r');
+
+    if (!handle) {
+        {
+            std::lock_guard<std::mutex> lock(m_handlesMutex);
+            m_usedHandles--;
+        }
+
+        m_handleReleased.notify_all();
+    }
+
+    return handle;
+}
+
+void ZipReader::releaseHandle(struct zip_t *handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_handlesMutex);
+        m_handles.push_back(handle);
+        m_usedHandles--;
+    }
+
+    m_handleReleased.notify_all();
+}
+
+// Maps the archive into memory.
+bool ZipReader::map()
+{
+#ifdef _WIN32
+    std::ifstream file(m_fileName, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        return false;
+
+    std::streamoff size = file.tellg();
+
+    if (size <= 0)
+        return false;
+
+    char *buf = new char[size];
+    file.seekg(0);
+
+    if (!file.read(buf, size)) {
+        delete[] buf;
+        return false;
+    }
+
+    m_mappingSize = size;
+    m_mapping = std::shared_ptr<const char>(buf, std::default_delete<char[]>());
+#else
+    int fd = ::open(m_fileName.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = st.st_size;
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+        return false;
+
+    m_mappingSize = size;
+    m_mapping = std::shared_ptr<const char>(static_cast<const char *>(addr), [size](const char *p) { munmap(const_cast<char *>(p), size); });
+#endif
+
+    return true;
+}
+
+// Reads the central directory to find the compression method and offset of each file.
+void ZipReader::readEntries()
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(m_mapping.get());
+    const size_t eocdSize = 22;
+
+    if (m_mappingSize < eocdSize)
+        return;
+
+    // Find the end of central directory record (it's followed by a comment of up to 65535 bytes)
+    size_t min = m_mappingSize > eocdSize + 65535 ? m_mappingSize - eocdSize - 65535 : 0;
+    size_t eocd = m_mappingSize - eocdSize;
+
+    while (read32(data + eocd) != 0x06054b50) {
+        if (eocd == min)
+            return;
+
+        eocd--;
+    }
+
+    unsigned int count = read16(data + eocd + 10);
+    size_t offset = read32(data + eocd + 16);
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (offset + 46 > m_mappingSize || read32(data + offset) != 0x02014b50)
+            return;
+
+        const unsigned char *header = data + offset;
+        unsigned int nameLength = read16(header + 28);
+        unsigned int extraLength = read16(header + 30);
+        unsigned int commentLength = read16(header + 32);
+
+        if (offset + 46 + nameLength > m_mappingSize)
+            return;
+
+        Entry entry;
+        entry.method = read16(header + 10);
+        entry.size = read32(header + 24);
+        entry.localHeaderOffset = read32(header + 42);
+        m_entries[std::string(reinterpret_cast<const char *>(header + 46), nameLength)] = entry;
+
+        offset += 46 + nameLength + extraLength + commentLength;
+    }
+}
+
+// Returns a pointer to the data of a stored file in the mapped archive, or nullptr if the file is compressed.
+const void *ZipReader::storedData(const Entry &entry) const
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(m_mapping.get());
+
+    if (entry.method != 0 || entry.localHeaderOffset + 30 > m_mappingSize || read32(data + entry.localHeaderOffset) != 0x04034b50)
+        return nullptr;
+
+    const unsigned char *header = data + entry.localHeaderOffset;
+    size_t dataOffset = entry.localHeaderOffset + 30 + read16(header + 26) + read16(header + 28);
+
+    if (dataOffset + entry.size > m_mappingSize)
+        return nullptr;
+
+    return data + dataOffset;
+}
@@ -3,6 +3,11 @@
 #pragma once
 
 #include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <vector>
 #include <zip.h>
 
 namespace libscratchcpp
@@ -22,9 +27,32 @@ class ZipReader
         size_t readFile(const std::string &fileName, void **buf);
         std::string readFileToString(const std::string &fileName);
 
+        size_t fileSize(const std::string &fileName) const;
+        std::shared_ptr<const void> fileData(const std::string &fileName);
+
     private:
+        struct Entry
+        {
+                unsigned int method;
+                size_t size;
+                size_t localHeaderOffset;
+        };
+
+        bool map();
+        void readEntries();
+        struct zip_t *acquireHandle();
+        void releaseHandle(struct zip_t *handle);
+        const void *storedData(const Entry &entry) const;
+
         std::string m_fileName;
         struct zip_t *m_zip = nullptr;
+        std::shared_ptr<const char> m_mapping; // the whole archive
+        size_t m_mappingSize = 0;
+        std::unordered_map<std::string, Entry> m_entries;
+        std::vector<struct zip_t *> m_handles; // unused handles, zip_t isn't thread safe so each reading thread gets its own
+        unsigned int m_usedHandles = 0;
+        std::mutex m_handlesMutex;
+        std::condition_variable m_handleReleased;
 };
 
 } // namespace libscratchcpp
@@ -99,6 +99,42 @@ std::shared_ptr<IEngine> Project::engine() const
     return impl->engine;
 }
 
+/*! Returns true if asset data is extracted while loading the project. */
+bool Project::assetPreloadingEnabled() const
+{
+    return impl->assetPreloadingEnabled;
+}
+
+/*!
+ * Sets whether asset data should be extracted while loading the project (disabled by default).
+ * If enabled, the assets of a project file are extracted in parallel during load().
+ * Otherwise each asset is extracted on first access (see Asset::data()).
+ * \note Asset::processData() is called from worker threads if this is enabled.
+ */
+void Project::setAssetPreloadingEnabled(bool enabled)
+{
+    impl->assetPreloadingEnabled = enabled;
+}
+
+/*! Returns the directory where loaded projects are cached. */
+const std::string &Project::cacheDirectory() const
+{
+    return impl->cacheDirectory;
+}
+
+/*!
+ * Sets the directory where loaded projects are cached (caching is disabled if it's empty, which is the default).\n
+ * When a project file is loaded, its parsed content and compiled scripts are stored in a binary file in this directory.
+ * Loading the same project again (even in another process) reads the binary file instead of parsing project.json and compiling the scripts.\n
+ * Assets of online projects are stored in this directory too, so they're downloaded only once.
+ * \note The directory must exist. For online projects, only the assets are cached (the project itself can change).
+ * Scripts which call block functions that aren't registered using IEngine#addFunction() are compiled on every load.
+ */
+void Project::setCacheDirectory(const std::string &directory)
+{
+    impl->cacheDirectory = directory;
+}
+
 /*!
  * Sets the function which will be called when the asset download progress changes.
  * \note The first parameter is the number of downloaded assets and the latter is the number of all assets to download.
@@ -9,6 +9,10 @@
 #include "internal/projectdownloaderfactory.h"
 #include "internal/projectdownloader.h"
 #include "internal/projecturl.h"
+#include "internal/workstealingpool.h"
+#include "internal/assetstore.h"
+#include "internal/projectcache.h"
+#include "internal/zipreader.h"
 #include "engine/internal/engine.h"
 
 using namespace libscratchcpp;
@@ -54,6 +58,7 @@ bool ProjectPrivate::load()
 
     // Load from URL
     ProjectUrl url(fileName);
+    std::string json; // project.json of cached projects
 
     if (url.isProjectUrl()) {
         // Download JSON
@@ -69,7 +74,7 @@ bool ProjectPrivate::load()
 
         // Get asset file names
         std::vector<std::string> assetNames;
-        std::unordered_map<std::string, Asset *> assets;
+        std::unordered_map<std::string, std::vector<Asset *>> assets;
         const auto &targets = reader->targets();
 
         for (auto target : targets) {
@@ -77,25 +82,27 @@ bool ProjectPrivate::load()
             const auto &sounds = target->sounds();
 
             for (auto costume : costumes) {
-                auto it = std::find(assetNames.begin(), assetNames.end(), costume->fileName());
-                if (it == assetNames.end()) {
+                auto &list = assets[costume->fileName()];
+
+                if (list.empty())
                     assetNames.push_back(costume->fileName());
-                    assets[assetNames.back()] = costume.get();
-                } else
-                    assets[*it] = costume.get();
+
+                list.push_back(costume.get());
             }
 
             for (auto sound : sounds) {
-                auto it = std::find(assetNames.begin(), assetNames.end(), sound->fileName());
-                if (it == assetNames.end()) {
+                auto &list = assets[sound->fileName()];
+
+                if (list.empty())
                     assetNames.push_back(sound->fileName());
-                    assets[assetNames.back()] = sound.get();
-                } else
-                    assets[*it] = sound.get();
+
+                list.push_back(sound.get());
             }
         }
 
         // Download assets
+        downloader->setCacheDirectory(cacheDirectory);
+
         if (!downloader->downloadAssets(assetNames)) {
             std::cerr << "Failed to download the project assets." << std::endl;
             return false;
@@ -104,13 +111,34 @@ bool ProjectPrivate::load()
         const auto &assetData = downloader->assets();
         assert(assetData.size() == assetNames.size());
 
-        // Load asset data
-        for (size_t i = 0; i < assets.size(); i++) {
+        // Load asset data (assets with the same file share the data, also with other projects)
+        for (size_t i = 0; i < assetNames.size(); i++) {
             const std::string &data = assetData[i];
-            assets[assetNames[i]]->setData(data.size(), static_cast<void *>(const_cast<char *>(data.c_str())));
+
+            auto dataPtr = AssetStore::instance()->data(assetNames[i], [&data]() {
+                auto buffer = std::make_shared<const std::string>(data);
+                return std::shared_ptr<const void>(buffer, buffer->data());
+            });
+
+            for (Asset *asset : assets[assetNames[i]])
+                asset->setDataLoader(data.size(), [dataPtr]() { return dataPtr; });
         }
 
     } else {
+        // Load from cache
+        std::shared_ptr<ZipReader> zipReader;
+
+        if (!cacheDirectory.empty()) {
+            zipReader = std::make_shared<ZipReader>(fileName);
+
+            if (zipReader->open()) {
+                json = zipReader->readFileToString("project.json");
+
+                if (loadFromCache(json, zipReader))
+                    return true;
+            }
+        }
+
         // Load from file
         reader->setFileName(fileName);
         if (!reader->isValid()) {
@@ -122,16 +150,97 @@ bool ProjectPrivate::load()
         bool ret = reader->load();
         if (!ret)
             return false;
+
+        if (assetPreloadingEnabled)
+            preloadAssets(reader->targets());
     }
 
-    engine->clear();
-    engine->setTargets(reader->targets());
-    engine->setBroadcasts(reader->broadcasts());
-    engine->setExtensions(reader->extensions());
-    engine->compile();
+    setupEngine(reader->targets(), reader->broadcasts(), reader->extensions());
+    auto compiledEngine = std::dynamic_pointer_cast<Engine>(engine);
+
+    if (json.empty() || !compiledEngine) {
+        engine->compile();
+        return true;
+    }
+
+    // Save to cache with the compiled scripts (the engine only normalizes the layer orders of the targets, which doesn't change them again)
+    // If the scripts can't be stored, only the targets are cached
+    CompiledProject compiledProject;
+    compiledEngine->compile(compiledProject);
+    ProjectCache cache(cacheDirectory);
+    cache.save(json, reader->targets(), reader->broadcasts(), reader->extensions(), compiledProject);
+    return true;
+}
+
+// Loads the project from the cache directory, returns false if it isn't cached.
+bool ProjectPrivate::loadFromCache(const std::string &json, std::shared_ptr<ZipReader> zipReader)
+{
+    ProjectCache cache(cacheDirectory);
+
+    if (!cache.load(json))
+        return false;
+
+    // Asset data is still read from the project file
+    for (auto target : cache.targets()) {
+        std::vector<Asset *> assets;
+
+        for (auto costume : target->costumes())
+            assets.push_back(costume.get());
+
+        for (auto sound : target->sounds())
+            assets.push_back(sound.get());
+
+        for (Asset *asset : assets) {
+            std::string assetFileName = asset->fileName();
+            asset->setDataLoader(zipReader->fileSize(assetFileName), [zipReader, assetFileName]() { return zipReader->fileData(assetFileName); });
+        }
+    }
+
+    if (assetPreloadingEnabled)
+        preloadAssets(cache.targets());
+
+    setupEngine(cache.targets(), cache.broadcasts(), cache.extensions());
+
+    // Compile the scripts if they aren't cached
+    auto compiledEngine = std::dynamic_pointer_cast<Engine>(engine);
+
+    if (!compiledEngine || !compiledEngine->loadCompiledProject(cache.compiledProject()))
+        engine->compile();
+
     return true;
 }
 
+void ProjectPrivate::setupEngine(
+    const std::vector<std::shared_ptr<Target>> &targets,
+    const std::vector<std::shared_ptr<Broadcast>> &broadcasts,
+    const std::vector<std::string> &extensions)
+{
+    engine->clear();
+    engine->setTargets(targets);
+    engine->setBroadcasts(broadcasts);
+    engine->setExtensions(extensions);
+}
+
+// Loads the data of all assets in parallel.
+void ProjectPrivate::preloadAssets(const std::vector<std::shared_ptr<Target>> &targets)
+{
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (auto target : targets) {
+        const auto &costumes = target->costumes();
+        const auto &sounds = target->sounds();
+
+        for (auto costume : costumes)
+            tasks.push_back([costume]() { costume->data(); });
+
+        for (auto sound : sounds)
+            tasks.push_back([sound]() { sound->data(); });
+    }
+
+    WorkStealingPool pool;
+    pool.run(tasks);
+}
+
 void ProjectPrivate::start()
 {
     engine->start();
@@ -4,11 +4,16 @@
 
 #include <scratchcpp/project.h>
 #include <string>
+#include <vector>
+#include <memory>
 
 namespace libscratchcpp
 {
 
 class IEngine;
+class Target;
+class Broadcast;
+class ZipReader;
 class IProjectDownloaderFactory;
 class IProjectDownloader;
 
@@ -25,6 +30,13 @@ struct ProjectPrivate
         void run();
         void runEventLoop();
 
+        bool loadFromCache(const std::string &json, std::shared_ptr<ZipReader> zipReader);
+        void setupEngine(
+            const std::vector<std::shared_ptr<Target>> &targets,
+            const std::vector<std::shared_ptr<Broadcast>> &broadcasts,
+            const std::vector<std::string> &extensions);
+        void preloadAssets(const std::vector<std::shared_ptr<Target>> &targets);
+
         void detectScratchVersion();
         void setScratchVersion(ScratchVersion version);
 
@@ -33,6 +45,8 @@ struct ProjectPrivate
         ScratchVersion scratchVersion = ScratchVersion::Invalid;
         std::string fileName;
         std::shared_ptr<IEngine> engine = nullptr;
+        bool assetPreloadingEnabled = false;
+        std::string cacheDirectory;
 
         static IProjectDownloaderFactory *downloaderFactory;
         std::shared_ptr<IProjectDownloader> downloader;
@@ -77,3 +77,15 @@ double Rect::height() const
 {
     return std::abs(impl->top - impl->bottom);
 }
+
+/*! Returns true if the rectangle intersects the given rectangle (touching edges count as an intersection). */
+bool Rect::intersects(const Rect &rect) const
+{
+    return impl->left <= rect.impl->right && rect.impl->left <= impl->right && impl->top >= rect.impl->bottom && rect.impl->top >= impl->bottom;
+}
+
+/*! Returns true if the given point is inside the rectangle (or on its edge). */
+bool Rect::contains(double x, double y) const
+{
+    return x >= impl->left && x <= impl->right && y >= impl->bottom && y <= impl->top;
+}
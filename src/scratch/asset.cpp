@@ -3,6 +3,7 @@
 #include <scratchcpp/asset.h>
 
 #include "asset_p.h"
+#include "internal/assetstore.h"
 
 using namespace libscratchcpp;
 
@@ -39,9 +40,33 @@ const std::string &Asset::dataFormat() const
     return impl->dataFormat;
 }
 
-/*! Returns the asset data. */
+/*!
+ * Returns the asset data.
+ * \note If a data loader is set, the data is loaded on first access (this can be called from multiple threads).
+ * Assets with the same ID share the loaded data, even if they belong to different projects.
+ */
 const void *Asset::data() const
 {
+    const void *data = impl->data;
+
+    if (data || !impl->dataLoader)
+        return data;
+
+    std::lock_guard<std::mutex> lock(impl->dataMutex);
+
+    if (!impl->data) {
+        if (id().empty())
+            impl->loadedData = impl->dataLoader();
+        else
+            impl->loadedData = AssetStore::instance()->data(impl->fileName, impl->dataLoader);
+
+        // Other threads get the data after it's processed
+        if (impl->loadedData)
+            const_cast<Asset *>(this)->processData(impl->dataSize, impl->loadedData.get());
+
+        impl->data = impl->loadedData.get();
+    }
+
     return impl->data;
 }
 
@@ -54,7 +79,45 @@ unsigned int Asset::dataSize() const
 /*! Sets the asset data. */
 void Asset::setData(unsigned int size, void *data)
 {
+    std::lock_guard<std::mutex> lock(impl->dataMutex);
+    impl->dataLoader = nullptr;
+    impl->loadedData.reset();
     impl->dataSize = size;
     impl->data = data;
     processData(size, data);
 }
+
+/*!
+ * Sets a function which loads the asset data when it's accessed for the first time.
+ * \param[in] size The size of the data (known before the data is loaded).
+ * \param[in] loader The function which returns the data. The returned pointer keeps the data alive.
+ */
+void Asset::setDataLoader(unsigned int size, const DataLoader &loader)
+{
+    std::lock_guard<std::mutex> lock(impl->dataMutex);
+    impl->loadedData.reset();
+    impl->data = nullptr;
+    impl->dataSize = size;
+    impl->dataLoader = loader;
+}
+
+/*! Returns true if the asset data is in memory (it was set or loaded by the data loader). */
+bool Asset::isDataLoaded() const
+{
+    return impl->data != nullptr;
+}
+
+/*!
+ * Releases data loaded by the data loader. It'll be loaded again on next access.
+ * \note This has no effect on data set using setData().
+ */
+void Asset::releaseData()
+{
+    std::lock_guard<std::mutex> lock(impl->dataMutex);
+
+    if (!impl->dataLoader)
+        return;
+
+    impl->loadedData.reset();
+    impl->data = nullptr;
+}
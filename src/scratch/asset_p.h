@@ -2,7 +2,10 @@
 
 #pragma once
 
+#include <scratchcpp/asset.h>
 #include <string>
+#include <atomic>
+#include <mutex>
 
 namespace libscratchcpp
 {
@@ -17,8 +20,11 @@ struct AssetPrivate
         std::string name;
         std::string dataFormat;
         std::string fileName;
-        const void *data = nullptr;
+        mutable std::atomic<const void *> data = nullptr; // mutable because of lazy loading in Asset::data()
         unsigned int dataSize = 0;
+        Asset::DataLoader dataLoader;
+        mutable std::shared_ptr<const void> loadedData; // data returned by dataLoader
+        mutable std::mutex dataMutex;                   // locked while the data is being loaded
 };
 
 } // namespace libscratchcpp
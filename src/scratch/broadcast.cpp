@@ -3,6 +3,7 @@
 #include <scratchcpp/broadcast.h>
 
 #include "broadcast_p.h"
+#include "internal/nameindex.h"
 
 using namespace libscratchcpp;
 
@@ -23,4 +24,5 @@ const std::string &Broadcast::name() const
 void Broadcast::setName(const std::string &newName)
 {
     impl->name = newName;
+    NameIndexGroup::invalidateOwner(*this);
 }
@@ -4,6 +4,7 @@
 #include <scratchcpp/scratchconfiguration.h>
 
 #include "costume_p.h"
+#include "engine/internal/alphamask.h"
 
 using namespace libscratchcpp;
 
@@ -53,6 +54,26 @@ void Costume::setRotationCenterY(int newRotationCenterY)
     impl->rotationCenterY = newRotationCenterY;
 }
 
+/*!
+ * Returns the width of the costume image (in pixels, without bitmapResolution applied).
+ * \note The size is read from the PNG, JPEG or SVG header when the data is available, otherwise 0 is returned.
+ */
+double Costume::width() const
+{
+    readImageSize();
+    return impl->width;
+}
+
+/*!
+ * Returns the height of the costume image.
+ * \see width()
+ */
+double Costume::height() const
+{
+    readImageSize();
+    return impl->height;
+}
+
 /*!
  * Returns the Broadcast linked with this costume.
  * \note This is used by the "switch backdrop to and wait" block.
@@ -61,3 +82,39 @@ Broadcast *Costume::broadcast()
 {
     return &impl->broadcast;
 }
+
+/*! Overrides Asset#processData(). */
+void Costume::processData(unsigned int size, const void *data)
+{
+    impl->readImageSize(dataFormat(), static_cast<const char *>(data), size);
+    impl->alphaMaskRead = false; // decode the mask of the new image next time
+}
+
+void Costume::readImageSize() const
+{
+    if (impl->imageSizeRead)
+        return;
+
+    std::lock_guard<std::mutex> lock(impl->imageSizeMutex);
+
+    if (!impl->imageSizeRead) {
+        data(); // calls processData() if the data isn't loaded yet
+        impl->imageSizeRead = true;
+    }
+}
+
+// Returns the opacity mask of the image (nullptr if the image is opaque or if it can't be decoded)
+const AlphaMask *Costume::alphaMask() const
+{
+    if (impl->alphaMaskRead)
+        return impl->alphaMask.get();
+
+    std::lock_guard<std::mutex> lock(impl->alphaMaskMutex);
+
+    if (!impl->alphaMaskRead) {
+        impl->alphaMask = AlphaMask::fromCostume(this);
+        impl->alphaMaskRead = true;
+    }
+
+    return impl->alphaMask.get();
+}
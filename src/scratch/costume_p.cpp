@@ -1,5 +1,11 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <string_view>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+
 #include "costume_p.h"
 
 using namespace libscratchcpp;
@@ -8,3 +14,186 @@ CostumePrivate::CostumePrivate() :
     broadcast("", "")
 {
 }
+
+static uint32_t readUInt32BE(const unsigned char *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+static uint16_t readUInt16BE(const unsigned char *data)
+{
+    return (uint16_t(data[0]) << 8) | uint16_t(data[1]);
+}
+
+// Reads the size from the IHDR chunk, which must be the first chunk of the file
+static bool readPngSize(const unsigned char *data, unsigned int size, double *width, double *height)
+{
+    static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    if (size < 24 || memcmp(data, signature, sizeof(signature)) != 0 || memcmp(data + 12, "IHDR", 4) != 0)
+        return false;
+
+    *width = readUInt32BE(data + 16);
+    *height = readUInt32BE(data + 20);
+    return true;
+}
+
+// Reads the size from the first SOFn (start of frame) segment
+static bool readJpegSize(const unsigned char *data, unsigned int size, double *width, double *height)
+{
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+        return false;
+
+    unsigned int pos = 2;
+
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF)
+            return false;
+
+        unsigned char marker = data[pos + 1];
+
+        if (marker == 0xFF) {
+            pos++; // padding
+            continue;
+        }
+
+        unsigned int length = readUInt16BE(data + pos + 2);
+
+        // SOF0 - SOF15 except DHT (C4), JPG (C8) and DAC (CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (pos + 9 > size)
+                return false;
+
+            *height = readUInt16BE(data + pos + 5);
+            *width = readUInt16BE(data + pos + 7);
+            return true;
+        }
+
+        if (marker == 0xDA || marker == 0xD9)
+            return false; // start of scan or end of image
+
+        pos += 2 + length;
+    }
+
+    return false;
+}
+
+// Returns the value of the given attribute in the tag, or an empty string if it isn't set
+static std::string svgAttribute(const std::string &tag, const std::string &name)
+{
+    size_t pos = 0;
+
+    while ((pos = tag.find(name, pos)) != std::string::npos) {
+        // The name must not be a part of another attribute name (e.g. "stroke-width")
+        bool start = pos > 0 && (std::isspace(static_cast<unsigned char>(tag[pos - 1])));
+        size_t i = pos + name.size();
+        pos = i;
+
+        if (!start)
+            continue;
+
+        while (i < tag.size() && std::isspace(static_cast<unsigned char>(tag[i])))
+            i++;
+
+        if (i >= tag.size() || tag[i] != '=')
+            continue;
+
+        i++;
+
+        while (i < tag.size() && std::isspace(static_cast<unsigned char>(tag[i])))
+            i++;
+
+        if (i >= tag.size() || (tag[i] != '"' && tag[i] != '\''))
+            continue;
+
+        size_t end = tag.find(tag[i], i + 1);
+
+        if (end == std::string::npos)
+            return "";
+
+        return tag.substr(i + 1, end - i - 1);
+    }
+
+    return "";
+}
+
+// Parses a length in user units or pixels (relative units such as percentages can't be used)
+static bool parseSvgLength(const std::string &str, double *value)
+{
+    const char *begin = str.c_str();
+    char *end = nullptr;
+    double v = std::strtod(begin, &end);
+
+    if (end == begin)
+        return false;
+
+    while (*end && std::isspace(static_cast<unsigned char>(*end)))
+        end++;
+
+    if (*end != '\0' && strcmp(end, "px") != 0)
+        return false;
+
+    *value = v;
+    return true;
+}
+
+// Reads the size from the viewBox attribute of the root element, or from its width and height attributes
+static bool readSvgSize(const char *data, unsigned int size, double *width, double *height)
+{
+    std::string_view str(data, size);
+    size_t start = str.find("<svg");
+
+    if (start == std::string_view::npos)
+        return false;
+
+    size_t end = str.find('>', start);
+
+    if (end == std::string_view::npos)
+        return false;
+
+    std::string tag(str.substr(start, end - start));
+    std::string viewBox = svgAttribute(tag, "viewBox");
+
+    if (!viewBox.empty()) {
+        for (char &ch : viewBox) {
+            if (ch == ',')
+                ch = ' ';
+        }
+
+        double values[4];
+        const char *p = viewBox.c_str();
+        int i;
+
+        for (i = 0; i < 4; i++) {
+            char *next = nullptr;
+            values[i] = std::strtod(p, &next);
+
+            if (next == p)
+                break;
+
+            p = next;
+        }
+
+        if (i == 4 && values[2] > 0 && values[3] > 0) {
+            *width = values[2];
+            *height = values[3];
+            return true;
+        }
+    }
+
+    return parseSvgLength(svgAttribute(tag, "width"), width) && parseSvgLength(svgAttribute(tag, "height"), height);
+}
+
+// Reads the size of the image from the file header (the image isn't decoded)
+void CostumePrivate::readImageSize(const std::string &format, const char *data, unsigned int size)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    double w = 0, h = 0;
+
+    if (!data || !(readPngSize(bytes, size, &w, &h) || readJpegSize(bytes, size, &w, &h) || (format == "svg" && readSvgSize(data, size, &w, &h))))
+        w = h = 0;
+
+    width = w;
+    height = h;
+    imageSizeRead = true;
+}
@@ -4,20 +4,34 @@
 
 #include <scratchcpp/broadcast.h>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
 
 namespace libscratchcpp
 {
 
+class AlphaMask;
+
 struct CostumePrivate
 {
         CostumePrivate();
         CostumePrivate(const CostumePrivate &) = delete;
 
+        void readImageSize(const std::string &format, const char *data, unsigned int size);
+
         double oldBitmapResolution = 1;
         double bitmapResolution = 1;
         int rotationCenterX = 0;
         int rotationCenterY = 0;
         Broadcast broadcast;
+        double width = 0;
+        double height = 0;
+        mutable std::atomic<bool> imageSizeRead = false; // mutable because of lazy loading in Costume::width()
+        mutable std::mutex imageSizeMutex; // clones with the same costume can run in parallel
+        mutable std::shared_ptr<AlphaMask> alphaMask; // decoded by the first touching check and shared by all clones
+        mutable std::atomic<bool> alphaMaskRead = false;
+        mutable std::mutex alphaMaskMutex;
 };
 
 } // namespace libscratchcpp
@@ -3,6 +3,7 @@
 #include <scratchcpp/entity.h>
 
 #include "entity_p.h"
+#include "internal/nameindex.h"
 
 using namespace libscratchcpp;
 
@@ -22,4 +23,5 @@ const std::string &Entity::id() const
 void Entity::setId(const std::string &newId)
 {
     impl->id = newId;
+    NameIndexGroup::invalidateOwner(*this);
 }
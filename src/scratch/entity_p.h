@@ -3,15 +3,19 @@
 #pragma once
 
 #include <string>
+#include <memory>
 
 namespace libscratchcpp
 {
 
+class NameIndexGroup;
+
 struct EntityPrivate
 {
         EntityPrivate(const std::string &id);
 
         std::string id;
+        std::shared_ptr<NameIndexGroup> indexGroup; // the indices of the owner (if the entity is indexed)
 };
 
 } // namespace libscratchcpp
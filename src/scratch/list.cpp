@@ -4,6 +4,7 @@
 #include <algorithm>
 
 #include "list_p.h"
+#include "internal/nameindex.h"
 
 using namespace libscratchcpp;
 
@@ -15,7 +16,7 @@ List::List(const std::string &id, const std::string &name) :
 }
 
 /*! Returns the name of the list. */
-const std::string &List::name()
+const std::string &List::name() const
 {
     return impl->name;
 }
@@ -24,6 +25,7 @@ const std::string &List::name()
 void List::setName(const std::string &name)
 {
     impl->name = name;
+    NameIndexGroup::invalidateOwner(*this);
 }
 
 /*! Returns the sprite or stage this list belongs to. */
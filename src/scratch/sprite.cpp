@@ -35,47 +35,60 @@ std::shared_ptr<Sprite> Sprite::clone()
     IEngine *eng = engine();
 
     if (eng && (eng->cloneLimit() == -1 || eng->cloneCount() < eng->cloneLimit())) {
-        std::shared_ptr<Sprite> clone = std::make_shared<Sprite>();
+        Sprite *root = impl->cloneSprite ? impl->cloneSprite : this;
+        const auto &vars = variables();
+        const auto &l = lists();
 
-        if (impl->cloneSprite == nullptr) {
-            clone->impl->cloneSprite = this;
-            impl->clones.push_back(clone);
-        } else {
-            clone->impl->cloneSprite = impl->cloneSprite;
-            impl->cloneSprite->impl->clones.push_back(clone);
-        }
+        // Reuse a deleted clone if possible
+        std::shared_ptr<Sprite> clone = eng->takeClone(root);
+        bool reused = clone && clone->impl->hasSameData(this);
+
+        if (reused) {
+            clone->impl->iface = nullptr;
+            clone->impl->cloneDeleted = false;
+            clone->Target::clearGraphicsEffects();
+        } else
+            clone = std::make_shared<Sprite>();
+
+        clone->impl->cloneSprite = root;
+        root->impl->clones.push_back(clone);
 
         // Copy data
         clone->setName(name());
 
-        const auto &vars = variables();
-
-        for (auto var : vars)
-            clone->addVariable(var->clone());
+        if (reused) {
+            for (size_t i = 0; i < vars.size(); i++)
+                clone->variableAt(i)->setValue(vars[i]->value());
 
-        const auto &l = lists();
+            for (size_t i = 0; i < l.size(); i++) {
+                auto list = clone->listAt(i);
+                list->assign(l[i]->begin(), l[i]->end());
+            }
+        } else {
+            for (auto var : vars)
+                clone->addVariable(var->clone());
 
-        for (auto list : l)
-            clone->addList(list->clone());
+            for (auto list : l)
+                clone->addList(list->clone());
+        }
 
         clone->setCostumeIndex(costumeIndex());
         clone->setLayerOrder(layerOrder());
         clone->setVolume(volume());
 
-        clone->impl->visible = impl->visible;
-        clone->impl->x = impl->x;
-        clone->impl->y = impl->y;
-        clone->impl->size = impl->size;
-        clone->impl->direction = impl->direction;
-        clone->impl->draggable = impl->draggable;
-        clone->impl->rotationStyle = impl->rotationStyle;
+        clone->impl->setVisible(impl->visible());
+        clone->impl->setPosition(impl->x(), impl->y());
+        clone->impl->setSize(impl->size());
+        clone->impl->setDirection(impl->direction());
+        clone->impl->setDraggable(impl->draggable());
+        clone->impl->setRotationStyle(impl->rotationStyle());
 
         clone->setEngine(engine());
 
         // Call "when I start as clone" scripts
         eng->initClone(clone);
 
-        if (impl->visible)
+        if (impl->visible())
             eng->requestRedraw();
 
         if (impl->iface)
@@ -106,6 +119,7 @@ void Sprite::deleteClone()
 
         assert(impl->cloneSprite);
         impl->cloneDeleted = true;
+        impl->changes.clear();
         impl->cloneSprite->impl->removeClone(this);
     }
 }
@@ -135,81 +149,82 @@ const std::vector<std::shared_ptr<Sprite>> &Sprite::clones() const
 /*! Returns true if the sprite is visible. */
 bool Sprite::visible() const
 {
-    return impl->visible;
+    return impl->visible();
 }
 
 /*! Sets the visibility of the sprite. */
 void Sprite::setVisible(bool newVisible)
 {
-    impl->visible = newVisible;
+    impl->setVisible(newVisible);
 
-    if (impl->visible) {
+    if (newVisible) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
-        impl->iface->onVisibleChanged(impl->visible);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::Visible))
+        impl->iface->onVisibleChanged(newVisible);
 }
 
 /*! Returns the X position of the sprite. */
 double Sprite::x() const
 {
-    return impl->x;
+    return impl->x();
 }
 
 /*! Sets the X position of the sprite. */
 void Sprite::setX(double newX)
 {
-    setXY(newX, impl->y);
+    setXY(newX, impl->y());
 
-    if (impl->iface)
-        impl->iface->onXChanged(impl->x);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::X))
+        impl->iface->onXChanged(impl->x());
 }
 
 /*! Returns the Y position of the sprite. */
 double Sprite::y() const
 {
-    return impl->y;
+    return impl->y();
 }
 
 /*! Sets the Y position of the sprite. */
 void Sprite::setY(double newY)
 {
-    setXY(impl->x, newY);
+    setXY(impl->x(), newY);
 
-    if (impl->iface)
-        impl->iface->onYChanged(impl->y);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::Y))
+        impl->iface->onYChanged(impl->y());
 }
 
 /*! Returns the size. */
 double Sprite::size() const
 {
-    return impl->size;
+    return impl->size();
 }
 
 /*! Sets the size. */
 void Sprite::setSize(double newSize)
 {
-    impl->size = newSize;
+    impl->setSize(newSize);
+    impl->invalidateBounds();
 
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
-        impl->iface->onSizeChanged(impl->size);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::Size))
+        impl->iface->onSizeChanged(newSize);
 }
 
 /*! Overrides Target#setCostumeIndex(). */
 void Sprite::setCostumeIndex(int newCostumeIndex)
 {
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
@@ -217,61 +232,65 @@ void Sprite::setCostumeIndex(int newCostumeIndex)
     }
 
     Target::setCostumeIndex(newCostumeIndex);
+    impl->costumeChanged();
+    impl->invalidateBounds();
     auto costume = costumeAt(newCostumeIndex);
 
-    if (costume && impl->iface)
+    if (costume && impl->iface && !impl->recordChange(SpriteChanges::Property::Costume))
         impl->iface->onCostumeChanged(costume.get());
 }
 
 /*! Returns the direction. */
 double Sprite::direction() const
 {
-    return impl->direction;
+    return impl->direction();
 }
 
 /*! Sets the direction. */
 void Sprite::setDirection(double newDirection)
 {
     if (newDirection >= -180 && newDirection <= 180)
-        impl->direction = newDirection;
+        impl->setDirection(newDirection);
     else if (newDirection < -180)
-        impl->direction = std::fmod(newDirection - 180, 360) + 180;
+        impl->setDirection(std::fmod(newDirection - 180, 360) + 180);
     else
-        impl->direction = std::fmod(newDirection + 180, 360) - 180;
+        impl->setDirection(std::fmod(newDirection + 180, 360) - 180);
 
-    if (impl->visible) {
+    impl->invalidateBounds();
+
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
-        impl->iface->onDirectionChanged(impl->direction);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::Direction))
+        impl->iface->onDirectionChanged(impl->direction());
 }
 
 /*! Returns true if the sprite is draggable. */
 bool Sprite::draggable() const
 {
-    return impl->draggable;
+    return impl->draggable();
 }
 
 /*! Toggles whether the sprite is draggable. */
 void Sprite::setDraggable(bool newDraggable)
 {
-    impl->draggable = newDraggable;
+    impl->setDraggable(newDraggable);
 }
 
 /*! Returns the rotation style. */
 Sprite::RotationStyle Sprite::rotationStyle() const
 {
-    return impl->rotationStyle;
+    return impl->rotationStyle();
 }
 
 /*! Returns the rotation style as a string. */
 std::string Sprite::rotationStyleStr() const
 {
-    switch (impl->rotationStyle) {
+    switch (impl->rotationStyle()) {
         case RotationStyle::AllAround:
             return "all around";
         case RotationStyle::LeftRight:
@@ -285,17 +304,18 @@ std::string Sprite::rotationStyleStr() const
 /*! Sets the rotation style. */
 void Sprite::setRotationStyle(RotationStyle newRotationStyle)
 {
-    impl->rotationStyle = newRotationStyle;
+    impl->setRotationStyle(newRotationStyle);
+    impl->invalidateBounds();
 
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
-        impl->iface->onRotationStyleChanged(impl->rotationStyle);
+    if (impl->iface && !impl->recordChange(SpriteChanges::Property::RotationStyle))
+        impl->iface->onRotationStyleChanged(newRotationStyle);
 }
 
 /*! \copydoc setRotationStyle() */
@@ -315,9 +335,18 @@ void Sprite::setRotationStyle(const char *newRotationStyle)
     setRotationStyle(std::string(newRotationStyle));
 }
 
-/*! Returns the bounding rectangle of the sprite. */
+/*!
+ * Returns the bounding rectangle of the sprite.
+ * \note The rectangle is computed from the size of the costume image if it's known (see Costume#width()),
+ * otherwise it's provided by the sprite interface.
+ */
 Rect Sprite::boundingRect() const
 {
+    double left, top, right, bottom;
+
+    if (impl->getCostumeBounds(&left, &top, &right, &bottom))
+        return Rect(left, top, right, bottom);
+
     if (!impl->iface)
         return Rect();
 
@@ -345,10 +374,12 @@ void Sprite::keepInFence(double newX, double newY, double *fencedX, double *fenc
     Rect bounds = boundingRect();
 
     // Adjust the known bounds to the target position
-    bounds.setLeft(bounds.left() + newX - impl->x);
-    bounds.setRight(bounds.right() + newX - impl->x);
-    bounds.setTop(bounds.top() + newY - impl->y);
-    bounds.setBottom(bounds.bottom() + newY - impl->y);
+    double x = impl->x();
+    double y = impl->y();
+    bounds.setLeft(bounds.left() + newX - x);
+    bounds.setRight(bounds.right() + newX - x);
+    bounds.setTop(bounds.top() + newY - y);
+    bounds.setBottom(bounds.bottom() + newY - y);
 
     // Find how far we need to move the target position
     double dx = 0;
@@ -371,19 +402,81 @@ void Sprite::keepInFence(double newX, double newY, double *fencedX, double *fenc
     *fencedY = newY + dy;
 }
 
+/*! Returns true if the sprite touches the given sprite or any of its visible clones. */
+bool Sprite::touchingSprite(const Sprite *sprite) const
+{
+    if (!sprite)
+        return false;
+
+    IEngine *eng = engine();
+
+    if (eng)
+        return eng->touchingSprite(this, sprite);
+
+    // Without an engine, check the bounding rectangles directly
+    Rect bounds = boundingRect();
+
+    if (bounds.width() == 0 && bounds.height() == 0)
+        return false; // the bounds are unknown
+
+    const Sprite *root = sprite->isClone() ? sprite->cloneSprite() : sprite;
+    std::vector<const Sprite *> candidates = { root };
+
+    for (auto clone : root->clones())
+        candidates.push_back(clone.get());
+
+    for (const Sprite *candidate : candidates) {
+        if (candidate == this || !candidate->visible())
+            continue;
+
+        Rect candidateBounds = candidate->boundingRect();
+
+        if ((candidateBounds.width() != 0 || candidateBounds.height() != 0) && bounds.intersects(candidateBounds))
+            return true;
+    }
+
+    return false;
+}
+
+/*! Returns true if the sprite touches the edge of the stage. */
+bool Sprite::touchingEdge() const
+{
+    IEngine *eng = engine();
+
+    if (!eng)
+        return false;
+
+    Rect bounds = boundingRect();
+    double stageWidth = eng->stageWidth();
+    double stageHeight = eng->stageHeight();
+
+    return bounds.left() < -stageWidth / 2 || bounds.right() > stageWidth / 2 || bounds.top() > stageHeight / 2 || bounds.bottom() < -stageHeight / 2;
+}
+
+/*! Returns true if the given point (e. g. the mouse pointer) is inside the bounding rectangle of the sprite. */
+bool Sprite::touchingPoint(double x, double y) const
+{
+    Rect bounds = boundingRect();
+
+    if (bounds.width() == 0 && bounds.height() == 0)
+        return false; // the bounds are unknown
+
+    return bounds.contains(x, y);
+}
+
 /*! Overrides Target#setGraphicsEffectValue(). */
 void Sprite::setGraphicsEffectValue(IGraphicsEffect *effect, double value)
 {
     Target::setGraphicsEffectValue(effect, value);
 
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
+    if (impl->iface && !impl->recordGraphicsEffectChange(effect, value))
         impl->iface->onGraphicsEffectChanged(effect, value);
 }
 
@@ -392,14 +485,14 @@ void Sprite::clearGraphicsEffects()
 {
     Target::clearGraphicsEffects();
 
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
             eng->requestRedraw();
     }
 
-    if (impl->iface)
+    if (impl->iface && !impl->recordGraphicsEffectsCleared())
         impl->iface->onGraphicsEffectsCleared();
 }
 
@@ -408,17 +501,27 @@ Target *Sprite::dataSource() const
     return impl->cloneSprite;
 }
 
+// Returns the variables and lists of this clone used by the given script of the original sprite
+CloneScriptData &Sprite::scriptData(const Script *script)
+{
+    return impl->scriptData[script];
+}
+
 void Sprite::setXY(double x, double y)
 {
     IEngine *eng = engine();
 
-    if (eng && !eng->spriteFencingEnabled()) {
-        impl->x = x;
-        impl->y = y;
-    } else
-        impl->getFencedPosition(x, y, &impl->x, &impl->y);
+    if (eng && !eng->spriteFencingEnabled())
+        impl->setPosition(x, y);
+    else {
+        double fencedX, fencedY;
+        impl->getFencedPosition(x, y, &fencedX, &fencedY);
+        impl->setPosition(fencedX, fencedY);
+    }
+
+    impl->invalidateBounds();
 
-    if (impl->visible) {
+    if (impl->visible()) {
         IEngine *eng = engine();
 
         if (eng)
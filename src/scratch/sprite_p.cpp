@@ -4,7 +4,10 @@
 #include <scratchcpp/rect.h>
 #include <scratchcpp/costume.h>
 #include <scratchcpp/iengine.h>
+#include <scratchcpp/variable.h>
+#include <scratchcpp/list.h>
 #include <cmath>
+#include <limits>
 
 #include "sprite_p.h"
 
@@ -14,10 +17,18 @@ static const double pi = std::acos(-1); // TODO: Use std::numbers::pi in C++20
 static const double FENCE_WIDTH = 15;
 
 SpritePrivate::SpritePrivate(Sprite *sprite) :
-    sprite(sprite)
+    sprite(sprite),
+    changes(sprite)
 {
 }
 
+SpritePrivate::~SpritePrivate()
+{
+    // Sprites which are destroyed while still in a transform store free their slot
+    if (transforms)
+        transforms->release(transformHandle);
+}
+
 void SpritePrivate::removeClone(Sprite *clone)
 {
     int index = 0;
@@ -31,6 +42,30 @@ void SpritePrivate::removeClone(Sprite *clone)
     }
 }
 
+// Returns true if the sprite has variables and lists with the same IDs as the other sprite (deleted clones can be reused then).
+bool SpritePrivate::hasSameData(Sprite *other) const
+{
+    const auto &variables = sprite->variables();
+    const auto &otherVariables = other->variables();
+    const auto &lists = sprite->lists();
+    const auto &otherLists = other->lists();
+
+    if (variables.size() != otherVariables.size() || lists.size() != otherLists.size())
+        return false;
+
+    for (size_t i = 0; i < variables.size(); i++) {
+        if (variables[i]->id() != otherVariables[i]->id())
+            return false;
+    }
+
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (lists[i]->id() != otherLists[i]->id())
+            return false;
+    }
+
+    return true;
+}
+
 void SpritePrivate::getFencedPosition(double x, double y, double *outX, double *outY) const
 {
     assert(outX);
@@ -43,12 +78,9 @@ void SpritePrivate::getFencedPosition(double x, double y, double *outX, double *
     }
 
     // https://github.com/scratchfoundation/scratch-render/blob/0b51e5a66ae1c8102fe881107145d7ef3d71a1ab/src/RenderWebGL.js#L1526
-    double dx = x - this->x;
-    double dy = y - this->y;
-    Rect rect;
-
-    if (iface)
-        rect = iface->boundingRect();
+    double dx = x - this->x();
+    double dy = y - this->y();
+    Rect rect = sprite->boundingRect();
 
     double inset = std::floor(std::min(rect.width(), rect.height()) / 2);
 
@@ -56,20 +88,229 @@ void SpritePrivate::getFencedPosition(double x, double y, double *outX, double *
     double sx = xRight - std::min(FENCE_WIDTH, inset);
 
     if (rect.right() + dx < -sx) {
-        x = std::ceil(this->x - (sx + rect.right()));
+        x = std::ceil(this->x() - (sx + rect.right()));
     } else if (rect.left() + dx > sx) {
-        x = std::floor(this->x + (sx - rect.left()));
+        x = std::floor(this->x() + (sx - rect.left()));
     }
 
     double yTop = static_cast<double>(sprite->engine()->stageHeight()) / 2;
     double sy = yTop - std::min(FENCE_WIDTH, inset);
 
     if (rect.top() + dy < -sy) {
-        y = std::ceil(this->y - (sy + rect.top()));
+        y = std::ceil(this->y() - (sy + rect.top()));
     } else if (rect.bottom() + dy > sy) {
-        y = std::floor(this->y + (sy - rect.bottom()));
+        y = std::floor(this->y() + (sy - rect.bottom()));
     }
 
     *outX = x;
     *outY = y;
 }
+
+// Notifies the engine that the bounding rectangle might have changed (used by touching checks)
+void SpritePrivate::invalidateBounds()
+{
+    IEngine *eng = sprite->engine();
+
+    if (eng)
+        eng->invalidateSpriteBounds(sprite);
+}
+
+// Computes the bounding rectangle from the size of the costume image, so that the sprite handler doesn't have to be used
+bool SpritePrivate::getCostumeBounds(double *left, double *top, double *right, double *bottom) const
+{
+    auto costume = sprite->currentCostume();
+
+    if (!costume)
+        return false;
+
+    BoundsCache &cache = boundsCache;
+    double size = this->size();
+    double direction = this->direction();
+    Sprite::RotationStyle rotationStyle = this->rotationStyle();
+
+    if (cache.costume != costume.get() || cache.size != size || cache.direction != direction || cache.rotationStyle != rotationStyle) {
+        double width = costume->width();
+        double height = costume->height();
+
+        if (width <= 0 || height <= 0)
+            return false;
+
+        // See https://github.com/scratchfoundation/scratch-render/blob/0b51e5a66ae1c8102fe881107145d7ef3d71a1ab/src/Drawable.js#L443-L505
+        double resolution = costume->bitmapResolution() > 0 ? costume->bitmapResolution() : 1;
+        double scale = size / 100 / resolution;
+        double centerX = costume->rotationCenterX();
+        double centerY = costume->rotationCenterY();
+
+        // Corners relative to the rotation center (the y-axis points up)
+        double xs[4] = { -centerX, width - centerX, width - centerX, -centerX };
+        double ys[4] = { centerY, centerY, centerY - height, centerY - height };
+
+        double angle = 0;
+        bool mirror = false;
+
+        switch (rotationStyle) {
+            case Sprite::RotationStyle::AllAround:
+                angle = (90 - direction) * pi / 180;
+                break;
+
+            case Sprite::RotationStyle::LeftRight:
+                mirror = direction < 0;
+                break;
+
+            case Sprite::RotationStyle::DoNotRotate:
+                break;
+        }
+
+        double c = std::cos(angle);
+        double s = std::sin(angle);
+        cache.left = cache.bottom = std::numeric_limits<double>::infinity();
+        cache.right = cache.top = -std::numeric_limits<double>::infinity();
+
+        for (int i = 0; i < 4; i++) {
+            double px = (mirror ? -xs[i] : xs[i]) * scale;
+            double py = ys[i] * scale;
+            double rx = px * c - py * s;
+            double ry = px * s + py * c;
+
+            cache.left = std::min(cache.left, rx);
+            cache.right = std::max(cache.right, rx);
+            cache.bottom = std::min(cache.bottom, ry);
+            cache.top = std::max(cache.top, ry);
+        }
+
+        cache.costume = costume.get();
+        cache.size = size;
+        cache.direction = direction;
+        cache.rotationStyle = rotationStyle;
+    }
+
+    double x = this->x();
+    double y = this->y();
+    *left = cache.left + x;
+    *top = cache.top + y;
+    *right = cache.right + x;
+    *bottom = cache.bottom + y;
+    return true;
+}
+
+Sprite::RotationStyle SpritePrivate::rotationStyle() const
+{
+    if (transforms)
+        return static_cast<Sprite::RotationStyle>((transforms->flags[transformHandle] & TransformStore::ROTATION_STYLE_MASK) >> TransformStore::ROTATION_STYLE_SHIFT);
+
+    return local.rotationStyle;
+}
+
+void SpritePrivate::setVisible(bool visible)
+{
+    if (transforms) {
+        uint8_t &flags = transforms->flags[transformHandle];
+        flags = visible ? (flags | TransformStore::Visible) : (flags & ~TransformStore::Visible);
+        transforms->dirty[transformHandle] |= TransformStore::VisibilityDirty;
+    } else
+        local.visible = visible;
+}
+
+void SpritePrivate::setPosition(double x, double y)
+{
+    if (transforms) {
+        transforms->x[transformHandle] = x;
+        transforms->y[transformHandle] = y;
+        transforms->dirty[transformHandle] |= TransformStore::PositionDirty;
+    } else {
+        local.x = x;
+        local.y = y;
+    }
+}
+
+void SpritePrivate::setSize(double size)
+{
+    if (transforms) {
+        transforms->size[transformHandle] = size;
+        transforms->dirty[transformHandle] |= TransformStore::SizeDirty;
+    } else
+        local.size = size;
+}
+
+void SpritePrivate::setDirection(double direction)
+{
+    if (transforms) {
+        transforms->direction[transformHandle] = direction;
+        transforms->dirty[transformHandle] |= TransformStore::DirectionDirty;
+    } else
+        local.direction = direction;
+}
+
+void SpritePrivate::setDraggable(bool draggable)
+{
+    if (transforms) {
+        uint8_t &flags = transforms->flags[transformHandle];
+        flags = draggable ? (flags | TransformStore::Draggable) : (flags & ~TransformStore::Draggable);
+    } else
+        local.draggable = draggable;
+}
+
+void SpritePrivate::setRotationStyle(Sprite::RotationStyle rotationStyle)
+{
+    if (transforms) {
+        uint8_t &flags = transforms->flags[transformHandle];
+        flags = (flags & ~TransformStore::ROTATION_STYLE_MASK) | (static_cast<uint8_t>(rotationStyle) << TransformStore::ROTATION_STYLE_SHIFT);
+        transforms->dirty[transformHandle] |= TransformStore::RotationStyleDirty;
+    } else
+        local.rotationStyle = rotationStyle;
+}
+
+// Updates the costume in the transform store (the costume index itself belongs to the target)
+void SpritePrivate::costumeChanged()
+{
+    if (transforms) {
+        transforms->costume[transformHandle] = sprite->costumeIndex();
+        transforms->dirty[transformHandle] |= TransformStore::CostumeDirty;
+    }
+}
+
+// Records the change for the next batch if batched notifications are enabled (returns false if the sprite handler should be notified now)
+bool SpritePrivate::recordChange(SpriteChanges::Property property)
+{
+    IEngine *eng = sprite->engine();
+
+    if (!eng || !eng->batchedSpriteNotificationsEnabled())
+        return false;
+
+    changes.setChanged(property);
+    return true;
+}
+
+bool SpritePrivate::recordGraphicsEffectChange(IGraphicsEffect *effect, double value)
+{
+    IEngine *eng = sprite->engine();
+
+    if (!eng || !eng->batchedSpriteNotificationsEnabled())
+        return false;
+
+    changes.setGraphicsEffectValue(effect, value);
+    return true;
+}
+
+bool SpritePrivate::recordGraphicsEffectsCleared()
+{
+    IEngine *eng = sprite->engine();
+
+    if (!eng || !eng->batchedSpriteNotificationsEnabled())
+        return false;
+
+    changes.setGraphicsEffectsCleared();
+    return true;
+}
+
+// Sends the recorded changes to the sprite handler
+void SpritePrivate::flushChanges()
+{
+    if (changes.empty())
+        return;
+
+    if (iface)
+        iface->onChanged(changes);
+
+    changes.clear();
+}
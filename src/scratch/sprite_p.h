@@ -3,34 +3,93 @@
 #pragma once
 
 #include <scratchcpp/sprite.h>
+#include <scratchcpp/spritechanges.h>
 #include <unordered_map>
 
+#include "../engine/internal/transformstore.h"
+#include "../engine/script_p.h"
+
 namespace libscratchcpp
 {
 
 class Rect;
+class Costume;
 
 struct SpritePrivate
 {
         SpritePrivate(Sprite *sprite);
         SpritePrivate(const SpritePrivate &) = delete;
+        ~SpritePrivate();
 
         void removeClone(Sprite *clone);
+        bool hasSameData(Sprite *other) const;
 
         void getFencedPosition(double inX, double inY, double *outX, double *outY) const;
+        void invalidateBounds();
+        bool getCostumeBounds(double *left, double *top, double *right, double *bottom) const;
+
+        // Transform accessors (the transform is in the transform store of the engine if the sprite has been attached to it)
+        bool visible() const { return transforms ? (transforms->flags[transformHandle] & TransformStore::Visible) : local.visible; }
+        double x() const { return transforms ? transforms->x[transformHandle] : local.x; }
+        double y() const { return transforms ? transforms->y[transformHandle] : local.y; }
+        double size() const { return transforms ? transforms->size[transformHandle] : local.size; }
+        double direction() const { return transforms ? transforms->direction[transformHandle] : local.direction; }
+        bool draggable() const { return transforms ? (transforms->flags[transformHandle] & TransformStore::Draggable) : local.draggable; }
+        Sprite::RotationStyle rotationStyle() const;
+
+        void setVisible(bool visible);
+        void setPosition(double x, double y);
+        void setSize(double size);
+        void setDirection(double direction);
+        void setDraggable(bool draggable);
+        void setRotationStyle(Sprite::RotationStyle rotationStyle);
+        void costumeChanged();
+
+        bool recordChange(SpriteChanges::Property property);
+        bool recordGraphicsEffectChange(IGraphicsEffect *effect, double value);
+        bool recordGraphicsEffectsCleared();
+        void flushChanges();
 
         Sprite *sprite = nullptr;
         ISpriteHandler *iface = nullptr;
         Sprite *cloneSprite = nullptr;
         std::vector<std::shared_ptr<Sprite>> clones;
         bool cloneDeleted = false;
-        bool visible = true;
-        double x = 0;
-        double y = 0;
-        double size = 100;
-        double direction = 90;
-        bool draggable = false;
-        Sprite::RotationStyle rotationStyle = Sprite::RotationStyle::AllAround;
+        SpriteChanges changes; // changes since the last redraw (if batched notifications are enabled)
+
+        // Used while the sprite isn't in a transform store
+        struct Transform
+        {
+                bool visible = true;
+                double x = 0;
+                double y = 0;
+                double size = 100;
+                double direction = 90;
+                bool draggable = false;
+                Sprite::RotationStyle rotationStyle = Sprite::RotationStyle::AllAround;
+        };
+
+        Transform local;
+        TransformStore *transforms = nullptr; // set while the sprite is in the transform store of an engine
+        unsigned int transformHandle = 0;
+
+        // Costume bounds relative to the sprite position (only the position changes in most frames)
+        struct BoundsCache
+        {
+                const Costume *costume = nullptr;
+                double size = 0;
+                double direction = 0;
+                Sprite::RotationStyle rotationStyle = Sprite::RotationStyle::AllAround;
+                double left = 0;
+                double top = 0;
+                double right = 0;
+                double bottom = 0;
+        };
+
+        mutable BoundsCache boundsCache;
+
+        // Resolved on the first start of each script in the clone (reused clones keep them because they have the same variables and lists)
+        std::unordered_map<const Script *, CloneScriptData> scriptData;
 };
 
 } // namespace libscratchcpp
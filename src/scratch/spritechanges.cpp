@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/spritechanges.h>
+
+#include "spritechanges_p.h"
+
+using namespace libscratchcpp;
+
+/*! Constructs SpriteChanges. */
+SpriteChanges::SpriteChanges(Sprite *sprite) :
+    impl(spimpl::make_impl<SpriteChangesPrivate>(sprite))
+{
+}
+
+/*! Returns the sprite which changed. */
+Sprite *SpriteChanges::sprite() const
+{
+    return impl->sprite;
+}
+
+/*! Returns true if nothing has changed. */
+bool SpriteChanges::empty() const
+{
+    return impl->properties == 0 && !impl->graphicsEffectsCleared && impl->graphicsEffects.empty();
+}
+
+/*! Removes all changes. */
+void SpriteChanges::clear()
+{
+    impl->properties = 0;
+    impl->graphicsEffectsCleared = false;
+    impl->graphicsEffects.clear();
+}
+
+/*! Returns true if the given property has changed. */
+bool SpriteChanges::changed(Property property) const
+{
+    return impl->properties & static_cast<int>(property);
+}
+
+/*! Marks the given property as changed. */
+void SpriteChanges::setChanged(Property property)
+{
+    impl->properties |= static_cast<int>(property);
+}
+
+/*! Returns true if all graphics effects have been cleared (before the changes in graphicsEffects()). */
+bool SpriteChanges::graphicsEffectsCleared() const
+{
+    return impl->graphicsEffectsCleared;
+}
+
+/*! Marks all graphics effects as cleared. This removes the graphics effect changes made before. */
+void SpriteChanges::setGraphicsEffectsCleared()
+{
+    impl->graphicsEffectsCleared = true;
+    impl->graphicsEffects.clear();
+}
+
+/*! Returns the last values of the graphics effects which have changed. */
+const std::unordered_map<IGraphicsEffect *, double> &SpriteChanges::graphicsEffects() const
+{
+    return impl->graphicsEffects;
+}
+
+/*! Records a change of the given graphics effect. */
+void SpriteChanges::setGraphicsEffectValue(IGraphicsEffect *effect, double value)
+{
+    impl->graphicsEffects[effect] = value;
+}
@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "spritechanges_p.h"
+
+using namespace libscratchcpp;
+
+SpriteChangesPrivate::SpriteChangesPrivate(Sprite *sprite) :
+    sprite(sprite)
+{
+}
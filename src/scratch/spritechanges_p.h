@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <scratchcpp/spritechanges.h>
+
+namespace libscratchcpp
+{
+
+struct SpriteChangesPrivate
+{
+        SpriteChangesPrivate(Sprite *sprite);
+
+        Sprite *sprite = nullptr;
+        int properties = 0;
+        bool graphicsEffectsCleared = false;
+        std::unordered_map<IGraphicsEffect *, double> graphicsEffects;
+};
+
+} // namespace libscratchcpp
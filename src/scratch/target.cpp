@@ -8,6 +8,7 @@
 #include <scratchcpp/iengine.h>
 
 #include "target_p.h"
+#include "../engine/internal/layerlist.h"
 
 using namespace libscratchcpp;
 
@@ -17,6 +18,12 @@ Target::Target() :
 {
 }
 
+/*! Destroys target. */
+Target::~Target()
+{
+    LayerList::detach(this);
+}
+
 /*! Returns the name of the target. */
 const std::string &Target::name() const
 {
@@ -27,6 +34,9 @@ const std::string &Target::name() const
 void Target::setName(const std::string &name)
 {
     impl->name = name;
+
+    // Targets are indexed by name in the engine
+    NameIndexGroup::invalidateOwner(*this);
 }
 
 /*! Returns the list of variables. */
@@ -44,6 +54,9 @@ int Target::addVariable(std::shared_ptr<Variable> variable)
         return it - impl->variables.begin();
 
     impl->variables.push_back(variable);
+    impl->variableNames.invalidate();
+    impl->variableIds.invalidate();
+    impl->indexGroup->adopt(*variable);
     variable->setTarget(this);
 
     return impl->variables.size() - 1;
@@ -61,25 +74,28 @@ std::shared_ptr<Variable> Target::variableAt(int index) const
 /*! Returns the index of the variable with the given name. */
 int Target::findVariable(const std::string &variableName) const
 {
-    int i = 0;
-    for (auto var : impl->variables) {
-        if (var->name() == variableName)
-            return i;
-        i++;
+    // Clones have the same variables as the sprite they were created from, so they can use its index
+    if (Target *source = dataSource()) {
+        int index = source->findVariable(variableName);
+
+        if (index >= 0 && index < impl->variables.size() && impl->variables[index]->name() == variableName)
+            return index;
     }
-    return -1;
+
+    return impl->variableNames.find(impl->variables, variableName);
 }
 
 /*! Returns the index of the variable with the given ID. */
 int Target::findVariableById(const std::string &id) const
 {
-    int i = 0;
-    for (auto var : impl->variables) {
-        if (var->id() == id)
-            return i;
-        i++;
+    if (Target *source = dataSource()) {
+        int index = source->findVariableById(id);
+
+        if (index >= 0 && index < impl->variables.size() && impl->variables[index]->id() == id)
+            return index;
     }
-    return -1;
+
+    return impl->variableIds.find(impl->variables, id);
 }
 
 /*! Returns the list of Scratch lists. */
@@ -97,6 +113,9 @@ int Target::addList(std::shared_ptr<List> list)
         return it - impl->lists.begin();
 
     impl->lists.push_back(list);
+    impl->listNames.invalidate();
+    impl->listIds.invalidate();
+    impl->indexGroup->adopt(*list);
     list->setTarget(this);
 
     return impl->lists.size() - 1;
@@ -114,25 +133,28 @@ std::shared_ptr<List> Target::listAt(int index) const
 /*! Returns the index of the list with the given name. */
 int Target::findList(const std::string &listName) const
 {
-    int i = 0;
-    for (auto list : impl->lists) {
-        if (list->name() == listName)
-            return i;
-        i++;
+    // Clones have the same lists as the sprite they were created from, so they can use its index
+    if (Target *source = dataSource()) {
+        int index = source->findList(listName);
+
+        if (index >= 0 && index < impl->lists.size() && impl->lists[index]->name() == listName)
+            return index;
     }
-    return -1;
+
+    return impl->listNames.find(impl->lists, listName);
 }
 
 /*! Returns the index of the list with the given ID. */
 int Target::findListById(const std::string &id) const
 {
-    int i = 0;
-    for (auto list : impl->lists) {
-        if (list->id() == id)
-            return i;
-        i++;
+    if (Target *source = dataSource()) {
+        int index = source->findListById(id);
+
+        if (index >= 0 && index < impl->lists.size() && impl->lists[index]->id() == id)
+            return index;
     }
-    return -1;
+
+    return impl->listIds.find(impl->lists, id);
 }
 
 /*! Returns the list of blocks. */
@@ -159,6 +181,25 @@ int Target::addBlock(std::shared_ptr<Block> block)
     return impl->blocks.size() - 1;
 }
 
+/*!
+ * Removes the given block and returns true if it was found.
+ * \note Blocks which reference the removed block (e. g. its parent) aren't changed.
+ * \see IEngine::recompile()
+ */
+bool Target::removeBlock(std::shared_ptr<Block> block)
+{
+    if (Target *source = dataSource())
+        return source->removeBlock(block);
+
+    auto it = std::find(impl->blocks.begin(), impl->blocks.end(), block);
+
+    if (it == impl->blocks.end())
+        return false;
+
+    impl->blocks.erase(it);
+    return true;
+}
+
 /*! Returns the block at index. */
 std::shared_ptr<Block> Target::blockAt(int index) const
 {
@@ -299,6 +340,7 @@ int Target::addCostume(std::shared_ptr<Costume> costume)
         return it - impl->costumes.begin();
 
     impl->costumes.push_back(costume);
+    impl->costumeNames.invalidate();
     return impl->costumes.size() - 1;
 }
 
@@ -320,13 +362,7 @@ int Target::findCostume(const std::string &costumeName) const
     if (Target *source = dataSource())
         return source->findCostume(costumeName);
 
-    int i = 0;
-    for (auto costume : impl->costumes) {
-        if (costume->name() == costumeName)
-            return i;
-        i++;
-    }
-    return -1;
+    return impl->costumeNames.find(impl->costumes, costumeName);
 }
 
 /*! Returns the list of sounds. */
@@ -350,6 +386,7 @@ int Target::addSound(std::shared_ptr<Sound> sound)
         return it - impl->sounds.begin();
 
     impl->sounds.push_back(sound);
+    impl->soundNames.invalidate();
     return impl->sounds.size() - 1;
 }
 
@@ -371,22 +408,22 @@ int Target::findSound(const std::string &soundName) const
     if (Target *source = dataSource())
         return source->findSound(soundName);
 
-    int i = 0;
-    for (auto sound : impl->sounds) {
-        if (sound->name() == soundName)
-            return i;
-        i++;
-    }
-    return -1;
+    return impl->soundNames.find(impl->sounds, soundName);
 }
 
 /*! Returns the layer number. */
 int Target::layerOrder() const
 {
+    if (impl->layerNode)
+        return LayerList::nodeIndex(impl->layerNode);
+
     return impl->layerOrder;
 }
 
-/*! Sets the layer number. */
+/*!
+ * Sets the layer number.
+ * \note The layer of a target which belongs to an engine is managed by the engine, use IEngine layer functions to move it.
+ */
 void Target::setLayerOrder(int newLayerOrder)
 {
     impl->layerOrder = newLayerOrder;
@@ -9,6 +9,8 @@
 #include <scratchcpp/costume.h>
 #include <scratchcpp/sound.h>
 
+#include "internal/nameindex.h"
+
 namespace libscratchcpp
 {
 
@@ -18,6 +20,7 @@ class List;
 class Block;
 class Comment;
 class IGraphicsEffect;
+struct LayerNode;
 
 struct TargetPrivate
 {
@@ -26,14 +29,22 @@ struct TargetPrivate
 
         IEngine *engine = nullptr;
         std::string name;
+        std::shared_ptr<NameIndexGroup> indexGroup = std::make_shared<NameIndexGroup>(); // the parent is the group of the engine
         std::vector<std::shared_ptr<Variable>> variables;
+        NameIndex<Variable> variableNames{ *indexGroup };
+        NameIndex<Variable, IdKey> variableIds{ *indexGroup };
         std::vector<std::shared_ptr<List>> lists;
+        NameIndex<List> listNames{ *indexGroup };
+        NameIndex<List, IdKey> listIds{ *indexGroup };
         std::vector<std::shared_ptr<Block>> blocks;
         std::vector<std::shared_ptr<Comment>> comments;
         int costumeIndex = -1;
         std::vector<std::shared_ptr<Costume>> costumes;
+        NameIndex<Costume> costumeNames{ *indexGroup };
         std::vector<std::shared_ptr<Sound>> sounds;
+        NameIndex<Sound> soundNames{ *indexGroup };
         int layerOrder = 0;
+        LayerNode *layerNode = nullptr; // set while the target is in the layer list of an engine
         double volume = 100;
         std::unordered_map<IGraphicsEffect *, double> graphicsEffects;
 };
@@ -23,30 +23,67 @@ IExtension *ScratchConfiguration::getExtension(const std::string &name)
     return impl->getExtension(name);
 }
 
-/*! Registers the given graphics effect. */
+/*!
+ * Registers the given graphics effect.
+ * \note If there's already an effect with the same name, it's replaced and gets the index of the original effect.
+ */
 void ScratchConfiguration::registerGraphicsEffect(std::shared_ptr<IGraphicsEffect> effect)
 {
     if (!effect)
         return;
 
-    impl->graphicsEffects[effect->name()] = effect;
+    std::string name = effect->name();
+    auto it = impl->graphicsEffectIndices.find(name);
+
+    if (it == impl->graphicsEffectIndices.cend()) {
+        impl->graphicsEffectIndices[name] = impl->graphicsEffects.size();
+        impl->graphicsEffects.push_back(effect);
+    } else
+        impl->graphicsEffects[it->second] = effect;
 }
 
 /*! Removes the given graphics effect. */
 void ScratchConfiguration::removeGraphicsEffect(const std::string &name)
 {
-    impl->graphicsEffects.erase(name);
+    auto it = impl->graphicsEffectIndices.find(name);
+
+    if (it != impl->graphicsEffectIndices.cend())
+        impl->graphicsEffects[it->second] = nullptr;
 }
 
 /*! Returns the graphics effect with the given name, or nullptr if it isn't registered. */
 IGraphicsEffect *ScratchConfiguration::getGraphicsEffect(const std::string &name)
 {
-    auto it = impl->graphicsEffects.find(name);
+    return graphicsEffectAt(findGraphicsEffect(name));
+}
 
-    if (it == impl->graphicsEffects.cend())
-        return nullptr;
+/*!
+ * Returns the index of the graphics effect with the given name, or -1 if it isn't registered.
+ * \note The index of an effect doesn't change when other effects are registered or removed, so it can be used in compiled code.
+ */
+int ScratchConfiguration::findGraphicsEffect(const std::string &name)
+{
+    auto it = impl->graphicsEffectIndices.find(name);
+
+    if (it == impl->graphicsEffectIndices.cend() || !impl->graphicsEffects[it->second])
+        return -1;
     else
-        return it->second.get();
+        return it->second;
+}
+
+/*! Returns the graphics effect at the given index, or nullptr if it isn't registered. */
+IGraphicsEffect *ScratchConfiguration::graphicsEffectAt(int index)
+{
+    if (index < 0 || index >= impl->graphicsEffects.size())
+        return nullptr;
+
+    return impl->graphicsEffects[index].get();
+}
+
+/*! Returns the number of graphics effect indices (including the indices of removed effects). */
+int ScratchConfiguration::graphicsEffectCount()
+{
+    return impl->graphicsEffects.size();
 }
 
 const std::vector<std::shared_ptr<IExtension>> ScratchConfiguration::getExtensions()
@@ -23,7 +23,8 @@ struct ScratchConfigurationPrivate
 
         std::vector<std::shared_ptr<IExtension>> extensions = { std::make_shared<StandardBlocks>() };
         std::unordered_map<std::string, std::shared_ptr<IImageFormatFactory>> imageFormats;
-        std::unordered_map<std::string, std::shared_ptr<IGraphicsEffect>> graphicsEffects;
+        std::vector<std::shared_ptr<IGraphicsEffect>> graphicsEffects; // removed effects are kept as nullptr, so the indices don't change
+        std::unordered_map<std::string, int> graphicsEffectIndices;
 };
 
 } // namespace libscratchcpp
@@ -0,0 +1,92 @@
+#include <scratchcpp/costume.h>
+#include <engine/internal/alphamask.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(AlphaMaskTest, Levels)
+{
+    std::vector<unsigned char> alpha(70 * 3, 0);
+    alpha[0] = 255;
+    alpha[70 + 65] = 1;
+    alpha[2 * 70 + 69] = 128;
+
+    AlphaMask mask(70, 3, alpha);
+    ASSERT_EQ(mask.levelCount(), 4);
+
+    ASSERT_EQ(mask.width(), 70);
+    ASSERT_EQ(mask.height(), 3);
+    ASSERT_EQ(mask.width(1), 35);
+    ASSERT_EQ(mask.height(1), 2);
+    ASSERT_EQ(mask.width(2), 18);
+    ASSERT_EQ(mask.height(2), 1);
+    ASSERT_EQ(mask.width(3), 9);
+    ASSERT_EQ(mask.height(3), 1);
+
+    int count = 0;
+
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 70; x++)
+            count += mask.opaque(0, x, y);
+    }
+
+    ASSERT_EQ(count, 3);
+    ASSERT_TRUE(mask.opaque(0, 0, 0));
+    ASSERT_TRUE(mask.opaque(0, 65, 1));
+    ASSERT_TRUE(mask.opaque(0, 69, 2));
+    ASSERT_FALSE(mask.opaque(0, 64, 1));
+    ASSERT_FALSE(mask.opaque(0, -1, 0));
+    ASSERT_FALSE(mask.opaque(0, 70, 2));
+    ASSERT_FALSE(mask.opaque(0, 0, 3));
+
+    // A pixel of a lower level is opaque if any of the pixels it covers is opaque
+    ASSERT_TRUE(mask.opaque(1, 0, 0));
+    ASSERT_TRUE(mask.opaque(1, 32, 0));
+    ASSERT_TRUE(mask.opaque(1, 34, 1));
+    ASSERT_FALSE(mask.opaque(1, 33, 0));
+    ASSERT_FALSE(mask.opaque(1, 0, 1));
+
+    ASSERT_TRUE(mask.opaque(2, 0, 0));
+    ASSERT_TRUE(mask.opaque(2, 16, 0));
+    ASSERT_TRUE(mask.opaque(2, 17, 0));
+    ASSERT_FALSE(mask.opaque(2, 1, 0));
+
+    ASSERT_TRUE(mask.opaque(3, 0, 0));
+    ASSERT_TRUE(mask.opaque(3, 8, 0));
+    ASSERT_FALSE(mask.opaque(3, 4, 0));
+}
+
+TEST(AlphaMaskTest, SinglePixel)
+{
+    AlphaMask mask(1, 1, { 255 });
+    ASSERT_EQ(mask.levelCount(), 1);
+    ASSERT_TRUE(mask.opaque(0, 0, 0));
+}
+
+TEST(AlphaMaskTest, FromCostume)
+{
+    ASSERT_EQ(AlphaMask::fromCostume(nullptr), nullptr);
+
+    Costume costume("costume1", "", "png");
+    ASSERT_EQ(AlphaMask::fromCostume(&costume), nullptr);
+
+    std::string data = readFileStr("image2.png");
+    costume.setData(data.size(), data.data());
+    auto mask = AlphaMask::fromCostume(&costume);
+    ASSERT_TRUE(mask);
+    ASSERT_EQ(mask->width(), 4);
+    ASSERT_EQ(mask->height(), 6);
+
+    ASSERT_FALSE(mask->opaque(0, 0, 1));
+    ASSERT_TRUE(mask->opaque(0, 1, 1));
+    ASSERT_FALSE(mask->opaque(0, 2, 2));
+    ASSERT_TRUE(mask->opaque(0, 3, 2));
+    ASSERT_FALSE(mask->opaque(0, 1, 4));
+
+    // Opaque images don't need a mask
+    Costume jpeg("costume2", "", "jpg");
+    data = readFileStr("image1.jpg");
+    jpeg.setData(data.size(), data.data());
+    ASSERT_EQ(AlphaMask::fromCostume(&jpeg), nullptr);
+}
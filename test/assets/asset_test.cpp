@@ -1,4 +1,6 @@
 #include <scratchcpp/asset.h>
+#include <thread>
+#include <atomic>
 
 #include "../common.h"
 #include "testasset.h"
@@ -35,3 +37,97 @@ TEST(AssetTest, Data)
     ASSERT_EQ(asset.processedData, data);
     ASSERT_EQ(asset.callCount, 1);
 }
+
+TEST(AssetTest, DataLoader)
+{
+    TestAsset asset;
+    static char data[5] = "abcd";
+    int loadCount = 0;
+
+    asset.setDataLoader(5, [&loadCount]() {
+        loadCount++;
+        return std::shared_ptr<const void>(data, [](const void *) {});
+    });
+
+    ASSERT_EQ(asset.dataSize(), 5);
+    ASSERT_FALSE(asset.isDataLoaded());
+    ASSERT_EQ(loadCount, 0);
+    ASSERT_EQ(asset.callCount, 0);
+
+    ASSERT_EQ(asset.data(), data);
+    ASSERT_TRUE(asset.isDataLoaded());
+    ASSERT_EQ(loadCount, 1);
+    ASSERT_EQ(asset.size, 5);
+    ASSERT_EQ(asset.processedData, data);
+    ASSERT_EQ(asset.callCount, 1);
+
+    ASSERT_EQ(asset.data(), data);
+    ASSERT_EQ(loadCount, 1);
+
+    asset.releaseData();
+    ASSERT_FALSE(asset.isDataLoaded());
+    ASSERT_EQ(asset.data(), data);
+    ASSERT_EQ(loadCount, 2);
+    ASSERT_EQ(asset.callCount, 2);
+
+    // Data set by setData() can't be released
+    static char data2[3] = "ab";
+    asset.setData(3, data2);
+    asset.releaseData();
+    ASSERT_TRUE(asset.isDataLoaded());
+    ASSERT_EQ(asset.data(), data2);
+    ASSERT_EQ(loadCount, 2);
+}
+
+TEST(AssetTest, SharedData)
+{
+    Asset asset1("costume1", "abc", "svg");
+    Asset asset2("costume2", "abc", "svg");
+    Asset asset3("costume3", "def", "svg");
+    int loadCount = 0;
+
+    auto loader = [&loadCount]() {
+        loadCount++;
+        return std::make_shared<const int>(loadCount);
+    };
+
+    asset1.setDataLoader(sizeof(int), loader);
+    asset2.setDataLoader(sizeof(int), loader);
+    asset3.setDataLoader(sizeof(int), loader);
+
+    ASSERT_TRUE(asset1.data());
+    ASSERT_EQ(asset2.data(), asset1.data());
+    ASSERT_EQ(loadCount, 1);
+
+    ASSERT_NE(asset3.data(), asset1.data());
+    ASSERT_EQ(loadCount, 2);
+}
+
+TEST(AssetTest, ConcurrentDataLoader)
+{
+    // The data is loaded and processed only once, even if it's accessed from multiple threads at the same time
+    TestAsset asset;
+    static char data[5] = "abcd";
+    std::atomic<int> loadCount = 0;
+
+    asset.setDataLoader(5, [&loadCount]() {
+        loadCount++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return std::shared_ptr<const void>(data, [](const void *) {});
+    });
+
+    std::vector<std::thread> threads;
+    const void *results[8] = { nullptr };
+
+    for (int i = 0; i < 8; i++)
+        threads.push_back(std::thread([&asset, &results, i]() { results[i] = asset.data(); }));
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (int i = 0; i < 8; i++)
+        ASSERT_EQ(results[i], data);
+
+    ASSERT_EQ(loadCount, 1);
+    ASSERT_EQ(asset.callCount, 1);
+}
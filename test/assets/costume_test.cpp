@@ -48,6 +48,77 @@ TEST_F(CostumeTest, RotationCenterY)
     ASSERT_EQ(costume.rotationCenterY(), 180);
 }
 
+TEST_F(CostumeTest, ImageSize)
+{
+    {
+        Costume costume("costume1", "a", "png");
+        ASSERT_EQ(costume.width(), 0);
+        ASSERT_EQ(costume.height(), 0);
+
+        std::string data = readFileStr("image1.png");
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 6);
+        ASSERT_EQ(costume.height(), 3);
+
+        data = readFileStr("image2.png");
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 4);
+        ASSERT_EQ(costume.height(), 6);
+    }
+
+    {
+        Costume costume("costume1", "a", "jpg");
+        std::string data = readFileStr("image1.jpg");
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 6);
+        ASSERT_EQ(costume.height(), 3);
+
+        data = readFileStr("image2.jpg");
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 4);
+        ASSERT_EQ(costume.height(), 6);
+    }
+
+    {
+        Costume costume("costume1", "a", "svg");
+        std::string data = "<?xml version=\"1.0\"?><svg xmlns=\"http://www.w3.org/2000/svg\" stroke-width=\"2\" width=\"120\" height=\"80px\" viewBox=\"0, 0, 95.5, 40\"></svg>";
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 95.5);
+        ASSERT_EQ(costume.height(), 40);
+
+        data = "<svg version=\"1.1\" width=\"120\" height = '80px'><rect width=\"5\" height=\"5\"/></svg>";
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 120);
+        ASSERT_EQ(costume.height(), 80);
+
+        data = "<svg width=\"100%\" height=\"100%\"></svg>";
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 0);
+        ASSERT_EQ(costume.height(), 0);
+
+        data = "invalid";
+        costume.setData(data.size(), data.data());
+        ASSERT_EQ(costume.width(), 0);
+        ASSERT_EQ(costume.height(), 0);
+    }
+
+    {
+        // The data is loaded when the size is read
+        Costume costume("costume1", "", "png");
+        auto data = std::make_shared<std::string>(readFileStr("image2.png"));
+        int loadCount = 0;
+
+        costume.setDataLoader(data->size(), [data, &loadCount]() {
+            loadCount++;
+            return std::shared_ptr<const void>(data, data->data());
+        });
+
+        ASSERT_EQ(costume.width(), 4);
+        ASSERT_EQ(costume.height(), 6);
+        ASSERT_EQ(loadCount, 1);
+    }
+}
+
 TEST_F(CostumeTest, Broadcast)
 {
     Costume costume("costume1", "a", "svg");
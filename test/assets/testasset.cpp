@@ -7,7 +7,7 @@ TestAsset::TestAsset() :
 {
 }
 
-void TestAsset::processData(unsigned int size, void *data)
+void TestAsset::processData(unsigned int size, const void *data)
 {
     this->size = size;
     processedData = data;
@@ -10,12 +10,12 @@ class TestAsset : public Asset
     public:
         TestAsset();
 
-        void *processedData = nullptr;
+        const void *processedData = nullptr;
         unsigned int size = 0;
         unsigned int callCount = 0;
 
     protected:
-        void processData(unsigned int size, void *data) override;
+        void processData(unsigned int size, const void *data) override;
 };
 
 } // namespace libscratchcpp
@@ -0,0 +1,53 @@
+#include <internal/assetstore.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(AssetStoreTest, Instance)
+{
+    ASSERT_TRUE(AssetStore::instance());
+    ASSERT_EQ(AssetStore::instance(), AssetStore::instance());
+}
+
+TEST(AssetStoreTest, Data)
+{
+    AssetStore store;
+    int loadCount = 0;
+    auto loader = [&loadCount]() {
+        loadCount++;
+        return std::make_shared<const int>(5);
+    };
+
+    ASSERT_EQ(store.find("a.png"), nullptr);
+
+    auto data1 = store.data("a.png", loader);
+    ASSERT_TRUE(data1);
+    ASSERT_EQ(*static_cast<const int *>(data1.get()), 5);
+    ASSERT_EQ(loadCount, 1);
+    ASSERT_EQ(store.find("a.png"), data1);
+
+    // Identical assets share the data
+    auto data2 = store.data("a.png", loader);
+    ASSERT_EQ(data2, data1);
+    ASSERT_EQ(loadCount, 1);
+
+    auto data3 = store.data("b.png", loader);
+    ASSERT_NE(data3, data1);
+    ASSERT_EQ(loadCount, 2);
+    ASSERT_EQ(store.size(), 2);
+
+    // The data is freed when it isn't used
+    data1.reset();
+    ASSERT_TRUE(store.find("a.png"));
+    data2.reset();
+    ASSERT_EQ(store.find("a.png"), nullptr);
+    ASSERT_EQ(store.size(), 1);
+
+    store.data("a.png", loader);
+    ASSERT_EQ(loadCount, 3);
+
+    // Failed loads aren't stored
+    ASSERT_EQ(store.data("c.png", []() { return nullptr; }), nullptr);
+    ASSERT_EQ(store.find("c.png"), nullptr);
+}
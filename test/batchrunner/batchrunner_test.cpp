@@ -0,0 +1,127 @@
+#include <scratchcpp/batchrunner.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(BatchRunnerTest, Projects)
+{
+    BatchRunner runner;
+    ASSERT_TRUE(runner.projects().empty());
+
+    runner.addProject("a.sb3");
+    runner.addProject("b.sb3");
+    ASSERT_EQ(runner.projects(), std::vector<std::string>({ "a.sb3", "b.sb3" }));
+
+    runner.clearProjects();
+    ASSERT_TRUE(runner.projects().empty());
+}
+
+TEST(BatchRunnerTest, ThreadCount)
+{
+    BatchRunner runner;
+    ASSERT_EQ(runner.threadCount(), 0);
+
+    runner.setThreadCount(4);
+    ASSERT_EQ(runner.threadCount(), 4);
+}
+
+TEST(BatchRunnerTest, FrameLimit)
+{
+    BatchRunner runner;
+    ASSERT_EQ(runner.frameLimit(), 0);
+
+    runner.setFrameLimit(100);
+    ASSERT_EQ(runner.frameLimit(), 100);
+}
+
+TEST(BatchRunnerTest, TimeLimit)
+{
+    BatchRunner runner;
+    ASSERT_EQ(runner.timeLimit(), 0);
+
+    runner.setTimeLimit(2.5);
+    ASSERT_EQ(runner.timeLimit(), 2.5);
+}
+
+TEST(BatchRunnerTest, Run)
+{
+    BatchRunner runner;
+    ASSERT_TRUE(runner.run().empty());
+
+    runner.setThreadCount(3);
+    runner.addProject("clones.sb3");
+    runner.addProject("invalid.sb3");
+    runner.addProject("2_frames.sb3");
+    runner.addProject("clones.sb3");
+
+    // The engines don't print anything (the output of parallel projects would be interleaved)
+    testing::internal::CaptureStdout();
+    auto results = runner.run();
+    ASSERT_TRUE(testing::internal::GetCapturedStdout().empty());
+    ASSERT_EQ(results.size(), 4);
+
+    ASSERT_EQ(results[0].fileName(), "clones.sb3");
+    ASSERT_TRUE(results[0].loaded());
+    ASSERT_GT(results[0].frames(), 0);
+    ASSERT_GE(results[0].loadTime(), 0);
+    ASSERT_GE(results[0].runTime(), 0);
+    ASSERT_EQ(results[0].variableValue("Stage", "clone5").toInt(), 110);
+    ASSERT_TRUE(results[0].variableValue("Stage", "delete_passed").toBool());
+
+    ASSERT_EQ(results[1].fileName(), "invalid.sb3");
+    ASSERT_FALSE(results[1].loaded());
+    ASSERT_EQ(results[1].frames(), 0);
+    ASSERT_TRUE(results[1].variables().empty());
+
+    ASSERT_EQ(results[2].fileName(), "2_frames.sb3");
+    ASSERT_TRUE(results[2].loaded());
+    ASSERT_EQ(results[2].frames(), 3); // the scripts finish in the 3rd frame
+
+    ASSERT_EQ(results[3].fileName(), "clones.sb3");
+    ASSERT_EQ(results[3].frames(), results[0].frames());
+    ASSERT_EQ(results[3].variables().size(), results[0].variables().size());
+}
+
+TEST(BatchRunnerTest, Limits)
+{
+    BatchRunner runner;
+    runner.addProject("2_frames.sb3");
+    runner.setFrameLimit(1);
+
+    auto results = runner.run();
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].frames(), 1);
+}
+
+TEST(BatchRunnerTest, Result)
+{
+    BatchResult result("test.sb3");
+    ASSERT_EQ(result.fileName(), "test.sb3");
+    ASSERT_FALSE(result.loaded());
+    ASSERT_EQ(result.frames(), 0);
+    ASSERT_EQ(result.loadTime(), 0);
+    ASSERT_EQ(result.runTime(), 0);
+    ASSERT_TRUE(result.variables().empty());
+
+    result.setFileName("a.sb3");
+    result.setLoaded(true);
+    result.setFrames(30);
+    result.setLoadTime(0.5);
+    result.setRunTime(1.25);
+    result.setVariables({ { "Stage", { { "a", 5 }, { "b", "test" } } } });
+
+    ASSERT_EQ(result.fileName(), "a.sb3");
+    ASSERT_TRUE(result.loaded());
+    ASSERT_EQ(result.frames(), 30);
+    ASSERT_EQ(result.loadTime(), 0.5);
+    ASSERT_EQ(result.runTime(), 1.25);
+    ASSERT_EQ(result.variables().size(), 1);
+    ASSERT_EQ(result.variableValue("Stage", "a").toInt(), 5);
+    ASSERT_EQ(result.variableValue("Stage", "b").toString(), "test");
+    ASSERT_EQ(result.variableValue("Stage", "c"), Value());
+    ASSERT_EQ(result.variableValue("Sprite1", "a"), Value());
+
+    BatchResult copy = result;
+    ASSERT_EQ(copy.frames(), 30);
+}
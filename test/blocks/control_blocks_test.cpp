@@ -26,8 +26,12 @@ class ControlBlocksTest : public testing::Test
         {
             m_section = std::make_unique<ControlBlocks>();
             m_section->registerBlocks(&m_engine);
+            EXPECT_CALL(m_engineMock, findSection("Control")).WillRepeatedly(Return(2));
+            EXPECT_CALL(m_engineMock, sectionAt(2)).WillRepeatedly(Return(m_section.get()));
         }
 
+        ControlBlocks *section() const { return static_cast<ControlBlocks *>(m_section.get()); }
+
         // For any control block
         std::shared_ptr<Block> createControlBlock(const std::string &id, const std::string &opcode) const { return std::make_shared<Block>(id, opcode); }
 
@@ -180,6 +184,17 @@ TEST_F(ControlBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "this script", ControlBlocks::StopThisScript));
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "other scripts in sprite", ControlBlocks::StopOtherScriptsInSprite));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::stopAll));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::stopOtherScriptsInSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::startWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::wait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::waitUntil));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::createCloneOfMyself));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::createCloneByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::createClone));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &ControlBlocks::deleteThisClone));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -729,18 +744,17 @@ TEST_F(ControlBlocksTest, Wait)
     ControlBlocks::compileWait(&compiler);
     compiler.end();
 
-    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_HALT }));
-    ASSERT_EQ(compiler.constValues().size(), 1);
-    ASSERT_EQ(compiler.constValues()[0], 5);
+    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 2, vm::OP_EXEC, 1, vm::OP_HALT }));
+    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 5, 2, 2 })); // the section index is added to both calls
     ASSERT_TRUE(compiler.variables().empty());
     ASSERT_TRUE(compiler.lists().empty());
 }
 
 TEST_F(ControlBlocksTest, WaitImpl)
 {
-    static unsigned int bytecode[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_HALT };
+    static unsigned int bytecode[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 1, vm::OP_EXEC, 1, vm::OP_HALT };
     static BlockFunc functions[] = { &ControlBlocks::startWait, &ControlBlocks::wait };
-    static Value constValues[] = { 5.5 };
+    static Value constValues[] = { 5.5, 2 };
 
     VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setFunctions(functions);
@@ -748,23 +762,23 @@ TEST_F(ControlBlocksTest, WaitImpl)
     vm.setBytecode(bytecode);
 
     ClockMock clock;
-    ControlBlocks::clock = &clock;
+    EXPECT_CALL(m_engineMock, clock()).WillRepeatedly(Return(&clock));
 
     std::chrono::steady_clock::time_point startTime(std::chrono::milliseconds(1000));
     EXPECT_CALL(clock, currentSteadyTime()).Times(2).WillRepeatedly(Return(startTime));
     EXPECT_CALL(m_engineMock, requestRedraw());
     vm.run();
 
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(ControlBlocks::m_timeMap.find(&vm) != ControlBlocks::m_timeMap.cend());
+    ASSERT_EQ(vm.registerCount(), 1); // the section index is kept until the wait ends
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
     ASSERT_FALSE(vm.atEnd());
 
     std::chrono::steady_clock::time_point time1(std::chrono::milliseconds(6450));
     EXPECT_CALL(clock, currentSteadyTime()).WillOnce(Return(time1));
     vm.run();
 
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(ControlBlocks::m_timeMap.find(&vm) != ControlBlocks::m_timeMap.cend());
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
     ASSERT_FALSE(vm.atEnd());
 
     std::chrono::steady_clock::time_point time2(std::chrono::milliseconds(6500));
@@ -772,16 +786,14 @@ TEST_F(ControlBlocksTest, WaitImpl)
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(ControlBlocks::m_timeMap.find(&vm) == ControlBlocks::m_timeMap.cend());
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) == section()->m_timeMap.cend());
     ASSERT_FALSE(vm.atEnd());
 
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(ControlBlocks::m_timeMap.find(&vm) == ControlBlocks::m_timeMap.cend());
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) == section()->m_timeMap.cend());
     ASSERT_TRUE(vm.atEnd());
-
-    ControlBlocks::clock = Clock::instance().get();
 }
 
 TEST_F(ControlBlocksTest, WaitUntil)
@@ -879,7 +891,7 @@ TEST_F(ControlBlocksTest, CreateCloneOf)
     ControlBlocks::compileCreateClone(&compiler);
     compiler.end();
 
-    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_NULL, vm::OP_EXEC, 2, vm::OP_HALT }));
+    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_NULL, vm::OP_EXEC_CACHED, 2, 0, vm::OP_HALT }));
     ASSERT_EQ(compiler.constValues().size(), 1);
     ASSERT_EQ(compiler.constValues()[0].toDouble(), 4);
     ASSERT_TRUE(compiler.variables().empty());
@@ -890,8 +902,8 @@ TEST_F(ControlBlocksTest, CreateCloneOfImpl)
 {
     static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_HALT };
     static unsigned int bytecode2[] = { vm::OP_START, vm::OP_EXEC, 1, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC, 2, vm::OP_HALT };
-    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_EXEC, 2, vm::OP_HALT };
+    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC_CACHED, 2, 0, vm::OP_HALT };
+    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_EXEC_CACHED, 2, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &ControlBlocks::createCloneByIndex, &ControlBlocks::createCloneOfMyself, &ControlBlocks::createClone };
     static Value constValues[] = { 4, "Sprite1", "_myself_" };
 
@@ -98,6 +98,14 @@ TEST_F(EventBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addField(m_section.get(), "BACKDROP", EventBlocks::BACKDROP));
     EXPECT_CALL(m_engineMock, addField(m_section.get(), "KEY_OPTION", EventBlocks::KEY_OPTION));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::broadcastByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::broadcast));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::broadcastByIndexAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::checkBroadcastByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::broadcastAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &EventBlocks::checkBroadcast));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -150,6 +150,55 @@ TEST_F(LooksBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "forward", LooksBlocks::Forward));
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "backward", LooksBlocks::Backward));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::show));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::hide));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::changeEffectBy));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::setEffectTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::clearGraphicEffects));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::changeSizeBy));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::setSizeTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::size));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::nextCostume));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::previousCostume));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchCostumeToByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchCostumeTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::nextBackdrop));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::previousBackdrop));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::randomBackdrop));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchBackdropToByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchBackdropTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::nextBackdropAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::previousBackdropAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::randomBackdropAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchBackdropToByIndexAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::switchBackdropToAndWait));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::checkBackdropScripts));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::goToFront));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::goToBack));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::goForwardLayers));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::goBackwardLayers));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::costumeNumber));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::costumeName));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::backdropNumber));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &LooksBlocks::backdropName));
+
+    // Target-local functions
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::show));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::hide));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::changeEffectBy));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::setEffectTo));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::clearGraphicEffects));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::changeSizeBy));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::setSizeTo));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::size));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::switchCostumeToByIndex));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::switchCostumeTo));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::nextCostume));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::previousCostume));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::costumeNumber));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&LooksBlocks::costumeName));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -249,274 +298,110 @@ TEST_F(LooksBlocksTest, ChangeEffectBy)
 
     // change [color] effect by 154.152
     auto block3 = std::make_shared<Block>("c", "looks_changeeffectby");
-    addDropdownField(block3, "EFFECT", LooksBlocks::EFFECT, "color", LooksBlocks::ColorEffect);
+    addDropdownField(block3, "EFFECT", LooksBlocks::EFFECT, "COLOR", LooksBlocks::ColorEffect);
     addValueInput(block3, "CHANGE", LooksBlocks::CHANGE, 154.152);
 
-    // change [fisheye] effect by -124.054
+    // change [custom3] effect by -124.054 (effects which aren't registered are ignored)
     auto block4 = std::make_shared<Block>("d", "looks_changeeffectby");
-    addDropdownField(block4, "EFFECT", LooksBlocks::EFFECT, "fisheye", LooksBlocks::FisheyeEffect);
+    addDropdownField(block4, "EFFECT", LooksBlocks::EFFECT, "custom3", static_cast<LooksBlocks::FieldValues>(-1));
     addValueInput(block4, "CHANGE", LooksBlocks::CHANGE, -124.054);
 
-    // change [whirl] effect by 45.858
-    auto block5 = std::make_shared<Block>("e", "looks_changeeffectby");
-    addDropdownField(block5, "EFFECT", LooksBlocks::EFFECT, "whirl", LooksBlocks::WhirlEffect);
-    addValueInput(block5, "CHANGE", LooksBlocks::CHANGE, 45.858);
-
-    // change [pixelate] effect by -0.15
-    auto block6 = std::make_shared<Block>("f", "looks_changeeffectby");
-    addDropdownField(block6, "EFFECT", LooksBlocks::EFFECT, "pixelate", LooksBlocks::PixelateEffect);
-    addValueInput(block6, "CHANGE", LooksBlocks::CHANGE, -0.15);
-
-    // change [mosaic] effect by 0.84
-    auto block7 = std::make_shared<Block>("g", "looks_changeeffectby");
-    addDropdownField(block7, "EFFECT", LooksBlocks::EFFECT, "mosaic", LooksBlocks::MosaicEffect);
-    addValueInput(block7, "CHANGE", LooksBlocks::CHANGE, 0.84);
-
-    // change [brightness] effect by 40.87
-    auto block8 = std::make_shared<Block>("h", "looks_changeeffectby");
-    addDropdownField(block8, "EFFECT", LooksBlocks::EFFECT, "brightness", LooksBlocks::BrightnessEffect);
-    addValueInput(block8, "CHANGE", LooksBlocks::CHANGE, 40.87);
-
-    // change [ghost] effect by 50.04
-    auto block9 = std::make_shared<Block>("i", "looks_changeeffectby");
-    addDropdownField(block9, "EFFECT", LooksBlocks::EFFECT, "ghost", LooksBlocks::GhostEffect);
-    addValueInput(block9, "CHANGE", LooksBlocks::CHANGE, 50.04);
-
     auto effect1 = std::make_shared<GraphicsEffectMock>();
     auto effect2 = std::make_shared<GraphicsEffectMock>();
+    auto colorEffect = std::make_shared<GraphicsEffectMock>();
     EXPECT_CALL(*effect1, name()).WillOnce(Return("custom1"));
     ScratchConfiguration::registerGraphicsEffect(effect1);
     EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
     ScratchConfiguration::registerGraphicsEffect(effect2);
+    EXPECT_CALL(*colorEffect, name()).WillOnce(Return("color"));
+    ScratchConfiguration::registerGraphicsEffect(colorEffect);
 
     compiler.init();
-    LooksBlocks::m_customGraphicsEffects.clear();
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeEffectBy)).Times(3).WillRepeatedly(Return(0));
+    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeEffectBy)).Times(4).WillRepeatedly(Return(0));
     compiler.setBlock(block1);
     LooksBlocks::compileChangeEffectBy(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
 
     compiler.setBlock(block1);
     LooksBlocks::compileChangeEffectBy(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
 
     compiler.setBlock(block2);
     LooksBlocks::compileChangeEffectBy(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(1), effect2.get());
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeColorEffectBy)).WillOnce(Return(1));
     compiler.setBlock(block3);
     LooksBlocks::compileChangeEffectBy(&compiler);
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeFisheyeEffectBy)).WillOnce(Return(2));
     compiler.setBlock(block4);
     LooksBlocks::compileChangeEffectBy(&compiler);
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeWhirlEffectBy)).WillOnce(Return(3));
-    compiler.setBlock(block5);
-    LooksBlocks::compileChangeEffectBy(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changePixelateEffectBy)).WillOnce(Return(4));
-    compiler.setBlock(block6);
-    LooksBlocks::compileChangeEffectBy(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeMosaicEffectBy)).WillOnce(Return(5));
-    compiler.setBlock(block7);
-    LooksBlocks::compileChangeEffectBy(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeBrightnessEffectBy)).WillOnce(Return(6));
-    compiler.setBlock(block8);
-    LooksBlocks::compileChangeEffectBy(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::changeGhostEffectBy)).WillOnce(Return(7));
-    compiler.setBlock(block9);
-    LooksBlocks::compileChangeEffectBy(&compiler);
-
     compiler.end();
 
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(1), effect2.get());
-
     ASSERT_EQ(
         compiler.bytecode(),
         std::vector<unsigned int>(
-            { vm::OP_START,
-              vm::OP_CONST,
-              0,
-              vm::OP_CONST,
-              1,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              2,
-              vm::OP_CONST,
-              1,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              3,
-              vm::OP_CONST,
-              4,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              5,
-              vm::OP_EXEC,
-              1,
-              vm::OP_CONST,
-              6,
-              vm::OP_EXEC,
-              2,
-              vm::OP_CONST,
-              7,
-              vm::OP_EXEC,
-              3,
-              vm::OP_CONST,
-              8,
-              vm::OP_EXEC,
-              4,
-              vm::OP_CONST,
-              9,
-              vm::OP_EXEC,
-              5,
-              vm::OP_CONST,
-              10,
-              vm::OP_EXEC,
-              6,
-              vm::OP_CONST,
-              11,
-              vm::OP_EXEC,
-              7,
-              vm::OP_HALT }));
-    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 0, 12.5, 0, 1, -78.15, 154.152, -124.054, 45.858, -0.15, 0.84, 40.87, 50.04 }));
+            { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 2, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 3, vm::OP_CONST, 4, vm::OP_EXEC, 0,
+              vm::OP_CONST, 5, vm::OP_CONST, 6, vm::OP_EXEC, 0, vm::OP_HALT }));
+
+    // The effects are resolved to their indices at compile time
+    int index1 = ScratchConfiguration::findGraphicsEffect("custom1");
+    int index2 = ScratchConfiguration::findGraphicsEffect("custom2");
+    int colorIndex = ScratchConfiguration::findGraphicsEffect("color");
+    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ index1, 12.5, index1, index2, -78.15, colorIndex, 154.152 }));
 
     ScratchConfiguration::removeGraphicsEffect("custom1");
     ScratchConfiguration::removeGraphicsEffect("custom2");
-}
-
-static void initEffects()
-{
-    LooksBlocks::m_colorEffect = ScratchConfiguration::getGraphicsEffect("color");
-    LooksBlocks::m_fisheyeEffect = ScratchConfiguration::getGraphicsEffect("fisheye");
-    LooksBlocks::m_whirlEffect = ScratchConfiguration::getGraphicsEffect("whirl");
-    LooksBlocks::m_pixelateEffect = ScratchConfiguration::getGraphicsEffect("pixelate");
-    LooksBlocks::m_mosaicEffect = ScratchConfiguration::getGraphicsEffect("mosaic");
-    LooksBlocks::m_brightnessEffect = ScratchConfiguration::getGraphicsEffect("brightness");
-    LooksBlocks::m_ghostEffect = ScratchConfiguration::getGraphicsEffect("ghost");
+    ScratchConfiguration::removeGraphicsEffect("color");
 }
 
 TEST_F(LooksBlocksTest, ChangeEffectByImpl)
 {
     static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_HALT };
     static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 4, vm::OP_EXEC, 1, vm::OP_HALT };
-    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 5, vm::OP_EXEC, 2, vm::OP_HALT };
-    static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 6, vm::OP_EXEC, 3, vm::OP_HALT };
-    static unsigned int bytecode6[] = { vm::OP_START, vm::OP_CONST, 7, vm::OP_EXEC, 4, vm::OP_HALT };
-    static unsigned int bytecode7[] = { vm::OP_START, vm::OP_CONST, 8, vm::OP_EXEC, 5, vm::OP_HALT };
-    static unsigned int bytecode8[] = { vm::OP_START, vm::OP_CONST, 9, vm::OP_EXEC, 6, vm::OP_HALT };
-    static unsigned int bytecode9[] = { vm::OP_START, vm::OP_CONST, 10, vm::OP_EXEC, 7, vm::OP_HALT };
-    static BlockFunc functions[] = {
-        &LooksBlocks::changeEffectBy,         &LooksBlocks::changeColorEffectBy,  &LooksBlocks::changeFisheyeEffectBy,    &LooksBlocks::changeWhirlEffectBy,
-        &LooksBlocks::changePixelateEffectBy, &LooksBlocks::changeMosaicEffectBy, &LooksBlocks::changeBrightnessEffectBy, &LooksBlocks::changeGhostEffectBy
-    };
-    static Value constValues[] = { 0, 55.15, 1, -40.54, 1.2, 2.3, -3.4, -4.5, 0.5, -8.54, 0.01 };
+    static BlockFunc functions[] = { &LooksBlocks::changeEffectBy };
 
-    GraphicsEffectMock effect1, effect2;
+    auto effect1 = std::make_shared<GraphicsEffectMock>();
+    auto effect2 = std::make_shared<GraphicsEffectMock>();
+    EXPECT_CALL(*effect1, name()).WillOnce(Return("custom1"));
+    ScratchConfiguration::registerGraphicsEffect(effect1);
+    EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
+    ScratchConfiguration::registerGraphicsEffect(effect2);
+    Value constValues[] = { ScratchConfiguration::findGraphicsEffect("custom1"), 55.15, ScratchConfiguration::findGraphicsEffect("custom2"), -40.54 };
+    ScratchConfiguration::removeGraphicsEffect("custom2");
 
     Sprite sprite;
-    sprite.setGraphicsEffectValue(&effect1, 12.5);
-    sprite.setGraphicsEffectValue(&effect2, -100.48);
+    sprite.setGraphicsEffectValue(effect1.get(), 12.5);
+    sprite.setGraphicsEffectValue(effect2.get(), -100.48);
 
     // custom1
-    VirtualMachine vm(&sprite, nullptr, nullptr);
-    LooksBlocks::m_customGraphicsEffects.clear();
-    LooksBlocks::m_customGraphicsEffects.push_back(&effect1);
+    VirtualMachine vm(&sprite, &m_engineMock, nullptr);
     vm.setBytecode(bytecode1);
     vm.setFunctions(functions);
     vm.setConstValues(constValues);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(&effect1), 67.65);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect1.get()), 67.65);
 
-    // custom2
-    LooksBlocks::m_customGraphicsEffects.push_back(&effect2);
+    // custom2 (effects which were removed are ignored)
     vm.reset();
     vm.setBytecode(bytecode2);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(&effect2), -141.02);
-
-    // Initialize graphics effects
-    initEffects();
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("color"), 12.4);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("fisheye"), -8.45);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("whirl"), 50.15);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("pixelate"), -45.21);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("mosaic"), 0.2);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("brightness"), -0.01);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("ghost"), 45.78);
-
-    // TODO: Uncomment commented lines (#283, #284, #285, #286, #287, #288, #289)
-    // color
-    /*vm.reset();
-    vm.setBytecode(bytecode3);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("color")), 13.6);
-
-    // fisheye
-    vm.reset();
-    vm.setBytecode(bytecode4);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("fisheye")), -6.15);
-
-    // whirl
-    vm.reset();
-    vm.setBytecode(bytecode5);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("whirl")), 46.75);
-
-    // pixelate
-    vm.reset();
-    vm.setBytecode(bytecode6);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("pixelate")), -49.71);
-
-    // mosaic
-    vm.reset();
-    vm.setBytecode(bytecode7);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("mosaic")), 0.7);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect2.get()), -100.48);
 
-    // brightness
+    // custom2 (the index doesn't change when the effect is registered again)
+    EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
+    ScratchConfiguration::registerGraphicsEffect(effect2);
     vm.reset();
-    vm.setBytecode(bytecode8);
+    vm.setBytecode(bytecode2);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("brightness")), -8.55);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect2.get()), -141.02);
 
-    // ghost
-    vm.reset();
-    vm.setBytecode(bytecode9);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("ghost")), 45.79);*/
+    ScratchConfiguration::removeGraphicsEffect("custom1");
+    ScratchConfiguration::removeGraphicsEffect("custom2");
 }
 
 TEST_F(LooksBlocksTest, SetEffectTo)
@@ -535,263 +420,110 @@ TEST_F(LooksBlocksTest, SetEffectTo)
 
     // set [color] effect to 154.152
     auto block3 = std::make_shared<Block>("c", "looks_seteffectto");
-    addDropdownField(block3, "EFFECT", LooksBlocks::EFFECT, "color", LooksBlocks::ColorEffect);
+    addDropdownField(block3, "EFFECT", LooksBlocks::EFFECT, "COLOR", LooksBlocks::ColorEffect);
     addValueInput(block3, "CHANGE", LooksBlocks::CHANGE, 154.152);
 
-    // set [fisheye] effect to -124.054
+    // set [custom3] effect to -124.054 (effects which aren't registered are ignored)
     auto block4 = std::make_shared<Block>("d", "looks_seteffectto");
-    addDropdownField(block4, "EFFECT", LooksBlocks::EFFECT, "fisheye", LooksBlocks::FisheyeEffect);
+    addDropdownField(block4, "EFFECT", LooksBlocks::EFFECT, "custom3", static_cast<LooksBlocks::FieldValues>(-1));
     addValueInput(block4, "CHANGE", LooksBlocks::CHANGE, -124.054);
 
-    // set [whirl] effect to 45.858
-    auto block5 = std::make_shared<Block>("e", "looks_seteffectto");
-    addDropdownField(block5, "EFFECT", LooksBlocks::EFFECT, "whirl", LooksBlocks::WhirlEffect);
-    addValueInput(block5, "CHANGE", LooksBlocks::CHANGE, 45.858);
-
-    // set [pixelate] effect to -0.15
-    auto block6 = std::make_shared<Block>("f", "looks_seteffectto");
-    addDropdownField(block6, "EFFECT", LooksBlocks::EFFECT, "pixelate", LooksBlocks::PixelateEffect);
-    addValueInput(block6, "CHANGE", LooksBlocks::CHANGE, -0.15);
-
-    // set [mosaic] effect to 0.84
-    auto block7 = std::make_shared<Block>("g", "looks_seteffectto");
-    addDropdownField(block7, "EFFECT", LooksBlocks::EFFECT, "mosaic", LooksBlocks::MosaicEffect);
-    addValueInput(block7, "CHANGE", LooksBlocks::CHANGE, 0.84);
-
-    // set [brightness] effect to 40.87
-    auto block8 = std::make_shared<Block>("h", "looks_seteffectto");
-    addDropdownField(block8, "EFFECT", LooksBlocks::EFFECT, "brightness", LooksBlocks::BrightnessEffect);
-    addValueInput(block8, "CHANGE", LooksBlocks::CHANGE, 40.87);
-
-    // set [ghost] effect to 50.04
-    auto block9 = std::make_shared<Block>("i", "looks_seteffectto");
-    addDropdownField(block9, "EFFECT", LooksBlocks::EFFECT, "ghost", LooksBlocks::GhostEffect);
-    addValueInput(block9, "CHANGE", LooksBlocks::CHANGE, 50.04);
-
     auto effect1 = std::make_shared<GraphicsEffectMock>();
     auto effect2 = std::make_shared<GraphicsEffectMock>();
+    auto colorEffect = std::make_shared<GraphicsEffectMock>();
     EXPECT_CALL(*effect1, name()).WillOnce(Return("custom1"));
     ScratchConfiguration::registerGraphicsEffect(effect1);
     EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
     ScratchConfiguration::registerGraphicsEffect(effect2);
+    EXPECT_CALL(*colorEffect, name()).WillOnce(Return("color"));
+    ScratchConfiguration::registerGraphicsEffect(colorEffect);
 
     compiler.init();
-    LooksBlocks::m_customGraphicsEffects.clear();
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setEffectTo)).Times(3).WillRepeatedly(Return(0));
+    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setEffectTo)).Times(4).WillRepeatedly(Return(0));
     compiler.setBlock(block1);
     LooksBlocks::compileSetEffectTo(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
 
     compiler.setBlock(block1);
     LooksBlocks::compileSetEffectTo(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
 
     compiler.setBlock(block2);
     LooksBlocks::compileSetEffectTo(&compiler);
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(1), effect2.get());
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setColorEffectTo)).WillOnce(Return(1));
     compiler.setBlock(block3);
     LooksBlocks::compileSetEffectTo(&compiler);
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setFisheyeEffectTo)).WillOnce(Return(2));
     compiler.setBlock(block4);
     LooksBlocks::compileSetEffectTo(&compiler);
 
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setWhirlEffectTo)).WillOnce(Return(3));
-    compiler.setBlock(block5);
-    LooksBlocks::compileSetEffectTo(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setPixelateEffectTo)).WillOnce(Return(4));
-    compiler.setBlock(block6);
-    LooksBlocks::compileSetEffectTo(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setMosaicEffectTo)).WillOnce(Return(5));
-    compiler.setBlock(block7);
-    LooksBlocks::compileSetEffectTo(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setBrightnessEffectTo)).WillOnce(Return(6));
-    compiler.setBlock(block8);
-    LooksBlocks::compileSetEffectTo(&compiler);
-
-    EXPECT_CALL(m_engineMock, functionIndex(&LooksBlocks::setGhostEffectTo)).WillOnce(Return(7));
-    compiler.setBlock(block9);
-    LooksBlocks::compileSetEffectTo(&compiler);
-
     compiler.end();
 
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(0), effect1.get());
-    ASSERT_EQ(LooksBlocks::m_customGraphicsEffects.at(1), effect2.get());
-
     ASSERT_EQ(
         compiler.bytecode(),
         std::vector<unsigned int>(
-            { vm::OP_START,
-              vm::OP_CONST,
-              0,
-              vm::OP_CONST,
-              1,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              2,
-              vm::OP_CONST,
-              1,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              3,
-              vm::OP_CONST,
-              4,
-              vm::OP_EXEC,
-              0,
-              vm::OP_CONST,
-              5,
-              vm::OP_EXEC,
-              1,
-              vm::OP_CONST,
-              6,
-              vm::OP_EXEC,
-              2,
-              vm::OP_CONST,
-              7,
-              vm::OP_EXEC,
-              3,
-              vm::OP_CONST,
-              8,
-              vm::OP_EXEC,
-              4,
-              vm::OP_CONST,
-              9,
-              vm::OP_EXEC,
-              5,
-              vm::OP_CONST,
-              10,
-              vm::OP_EXEC,
-              6,
-              vm::OP_CONST,
-              11,
-              vm::OP_EXEC,
-              7,
-              vm::OP_HALT }));
-    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 0, 12.5, 0, 1, -78.15, 154.152, -124.054, 45.858, -0.15, 0.84, 40.87, 50.04 }));
+            { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 2, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_CONST, 3, vm::OP_CONST, 4, vm::OP_EXEC, 0,
+              vm::OP_CONST, 5, vm::OP_CONST, 6, vm::OP_EXEC, 0, vm::OP_HALT }));
+
+    // The effects are resolved to their indices at compile time
+    int index1 = ScratchConfiguration::findGraphicsEffect("custom1");
+    int index2 = ScratchConfiguration::findGraphicsEffect("custom2");
+    int colorIndex = ScratchConfiguration::findGraphicsEffect("color");
+    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ index1, 12.5, index1, index2, -78.15, colorIndex, 154.152 }));
 
     ScratchConfiguration::removeGraphicsEffect("custom1");
     ScratchConfiguration::removeGraphicsEffect("custom2");
+    ScratchConfiguration::removeGraphicsEffect("color");
 }
 
 TEST_F(LooksBlocksTest, SetEffectToImpl)
 {
     static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_HALT };
     static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 4, vm::OP_EXEC, 1, vm::OP_HALT };
-    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 5, vm::OP_EXEC, 2, vm::OP_HALT };
-    static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 6, vm::OP_EXEC, 3, vm::OP_HALT };
-    static unsigned int bytecode6[] = { vm::OP_START, vm::OP_CONST, 7, vm::OP_EXEC, 4, vm::OP_HALT };
-    static unsigned int bytecode7[] = { vm::OP_START, vm::OP_CONST, 8, vm::OP_EXEC, 5, vm::OP_HALT };
-    static unsigned int bytecode8[] = { vm::OP_START, vm::OP_CONST, 9, vm::OP_EXEC, 6, vm::OP_HALT };
-    static unsigned int bytecode9[] = { vm::OP_START, vm::OP_CONST, 10, vm::OP_EXEC, 7, vm::OP_HALT };
-    static BlockFunc functions[] = {
-        &LooksBlocks::setEffectTo,         &LooksBlocks::setColorEffectTo,  &LooksBlocks::setFisheyeEffectTo,    &LooksBlocks::setWhirlEffectTo,
-        &LooksBlocks::setPixelateEffectTo, &LooksBlocks::setMosaicEffectTo, &LooksBlocks::setBrightnessEffectTo, &LooksBlocks::setGhostEffectTo
-    };
-    static Value constValues[] = { 0, 55.15, 1, -40.54, 1.2, 2.3, -3.4, -4.5, 0.5, -8.54, 0.01 };
+    static BlockFunc functions[] = { &LooksBlocks::setEffectTo };
 
-    GraphicsEffectMock effect1, effect2;
+    auto effect1 = std::make_shared<GraphicsEffectMock>();
+    auto effect2 = std::make_shared<GraphicsEffectMock>();
+    EXPECT_CALL(*effect1, name()).WillOnce(Return("custom1"));
+    ScratchConfiguration::registerGraphicsEffect(effect1);
+    EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
+    ScratchConfiguration::registerGraphicsEffect(effect2);
+    Value constValues[] = { ScratchConfiguration::findGraphicsEffect("custom1"), 55.15, ScratchConfiguration::findGraphicsEffect("custom2"), -40.54 };
+    ScratchConfiguration::removeGraphicsEffect("custom2");
 
     Sprite sprite;
-    sprite.setGraphicsEffectValue(&effect1, 12.5);
-    sprite.setGraphicsEffectValue(&effect2, -100.48);
+    sprite.setGraphicsEffectValue(effect1.get(), 12.5);
+    sprite.setGraphicsEffectValue(effect2.get(), -100.48);
 
     // custom1
-    VirtualMachine vm(&sprite, nullptr, nullptr);
-    LooksBlocks::m_customGraphicsEffects.clear();
-    LooksBlocks::m_customGraphicsEffects.push_back(&effect1);
+    VirtualMachine vm(&sprite, &m_engineMock, nullptr);
     vm.setBytecode(bytecode1);
     vm.setFunctions(functions);
     vm.setConstValues(constValues);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(&effect1), 55.15);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect1.get()), 55.15);
 
-    // custom2
-    LooksBlocks::m_customGraphicsEffects.push_back(&effect2);
+    // custom2 (effects which were removed are ignored)
     vm.reset();
     vm.setBytecode(bytecode2);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(&effect2), -40.54);
-
-    // Initialize graphics effects
-    initEffects();
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("color"), 12.4);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("fisheye"), -8.45);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("whirl"), 50.15);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("pixelate"), -45.21);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("mosaic"), 0.2);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("brightness"), -0.01);
-    sprite.setGraphicsEffectValue(ScratchConfiguration::getGraphicsEffect("ghost"), 45.78);
-
-    // TODO: Uncomment commented lines (#283, #284, #285, #286, #287, #288, #289)
-    // color
-    /*vm.reset();
-    vm.setBytecode(bytecode3);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("color")), 1.2);
-
-    // fisheye
-    vm.reset();
-    vm.setBytecode(bytecode4);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("fisheye")), 2.3);
-
-    // whirl
-    vm.reset();
-    vm.setBytecode(bytecode5);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("whirl")), -3.4);
-
-    // pixelate
-    vm.reset();
-    vm.setBytecode(bytecode6);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("pixelate")), -4.5);
-
-    // mosaic
-    vm.reset();
-    vm.setBytecode(bytecode7);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("mosaic")), 0.5);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect2.get()), -100.48);
 
-    // brightness
+    // custom2 (the index doesn't change when the effect is registered again)
+    EXPECT_CALL(*effect2, name()).WillOnce(Return("custom2"));
+    ScratchConfiguration::registerGraphicsEffect(effect2);
     vm.reset();
-    vm.setBytecode(bytecode8);
+    vm.setBytecode(bytecode2);
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("brightness")), -8.54);
+    ASSERT_EQ(sprite.graphicsEffectValue(effect2.get()), -40.54);
 
-    // ghost
-    vm.reset();
-    vm.setBytecode(bytecode9);
-    vm.run();
-
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_EQ(sprite.graphicsEffectValue(ScratchConfiguration::getGraphicsEffect("ghost")), 0.01);*/
+    ScratchConfiguration::removeGraphicsEffect("custom1");
+    ScratchConfiguration::removeGraphicsEffect("custom2");
 }
 
 TEST_F(LooksBlocksTest, ClearGraphicEffects)
@@ -2489,7 +2221,7 @@ TEST_F(LooksBlocksTest, RandomBackdrop)
     vm.setFunctions(functions);
 
     RandomGeneratorMock rng;
-    LooksBlocks::rng = &rng;
+    EXPECT_CALL(m_engineMock, randomGenerator()).WillRepeatedly(Return(&rng));
 
     EXPECT_CALL(rng, randint).Times(0);
     EXPECT_CALL(m_engineMock, stage()).Times(2).WillRepeatedly(Return(&stage));
@@ -2520,8 +2252,6 @@ TEST_F(LooksBlocksTest, RandomBackdrop)
 
     ASSERT_EQ(vm.registerCount(), 0);
     ASSERT_EQ(stage.costumeIndex(), 2);
-
-    LooksBlocks::rng = RandomGenerator::instance().get();
 }
 
 TEST_F(LooksBlocksTest, RandomBackdropAndWait)
@@ -2538,7 +2268,7 @@ TEST_F(LooksBlocksTest, RandomBackdropAndWait)
     vm.setFunctions(functions);
 
     RandomGeneratorMock rng;
-    LooksBlocks::rng = &rng;
+    EXPECT_CALL(m_engineMock, randomGenerator()).WillRepeatedly(Return(&rng));
 
     EXPECT_CALL(rng, randint).Times(0);
     EXPECT_CALL(m_engineMock, stage()).Times(3).WillRepeatedly(Return(&stage));
@@ -2581,8 +2311,6 @@ TEST_F(LooksBlocksTest, RandomBackdropAndWait)
     ASSERT_EQ(vm.registerCount(), 0);
     ASSERT_EQ(stage.costumeIndex(), 2);
     ASSERT_TRUE(vm.atEnd());
-
-    LooksBlocks::rng = RandomGenerator::instance().get();
 }
 
 TEST_F(LooksBlocksTest, GoToFrontBack)
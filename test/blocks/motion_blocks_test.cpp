@@ -28,8 +28,12 @@ class MotionBlocksTest : public testing::Test
         {
             m_section = std::make_unique<MotionBlocks>();
             m_section->registerBlocks(&m_engine);
+            EXPECT_CALL(m_engineMock, findSection("Motion")).WillRepeatedly(Return(1));
+            EXPECT_CALL(m_engineMock, sectionAt(1)).WillRepeatedly(Return(m_section.get()));
         }
 
+        MotionBlocks *section() const { return static_cast<MotionBlocks *>(m_section.get()); }
+
         // For any motion block
         std::shared_ptr<Block> createMotionBlock(const std::string &id, const std::string &opcode) const { return std::make_shared<Block>(id, opcode); }
 
@@ -144,6 +148,56 @@ TEST_F(MotionBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "don't rotate", MotionBlocks::DoNotRotate));
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "all around", MotionBlocks::AllAround));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::moveSteps));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::turnRight));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::turnLeft));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::pointInDirection));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::pointTowardsMousePointer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::pointTowardsRandomPosition));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::pointTowardsByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::pointTowards));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::goToXY));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::goToMousePointer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::goToRandomPosition));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::goToByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::goTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::startGlideSecsTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::glideSecsTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::startGlideToMousePointer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::startGlideToRandomPosition));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::startGlideToByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::startGlideTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::changeXBy));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::setX));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::changeYBy));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::setY));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::ifOnEdgeBounce));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::setLeftRightRotationStyle));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::setDoNotRotateRotationStyle));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::setAllAroundRotationStyle));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::xPosition));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::yPosition));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &MotionBlocks::direction));
+
+    // Target-local functions
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::moveSteps));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::turnRight));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::turnLeft));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::pointInDirection));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::goToXY));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::changeXBy));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::setX));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::changeYBy));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::setY));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::ifOnEdgeBounce));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::setLeftRightRotationStyle));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::setDoNotRotateRotationStyle));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::setAllAroundRotationStyle));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::xPosition));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::yPosition));
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&MotionBlocks::direction));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -372,7 +426,7 @@ TEST_F(MotionBlocksTest, PointTowardsImpl)
     vm.setConstValues(constValues);
 
     RandomGeneratorMock rng;
-    MotionBlocks::rng = &rng;
+    EXPECT_CALL(m_engineMock, randomGenerator()).WillRepeatedly(Return(&rng));
 
     static const std::vector<std::pair<double, double>> positions = { { -45.12, -123.48 }, { 125.23, -3.21 }, { 30.15, -100.025 }, { 70.1, -100.025 }, { 150.9, -100.025 } };
     static const std::vector<double> results = { -101.51, 29.66, -90, 90, 90 };
@@ -478,7 +532,6 @@ TEST_F(MotionBlocksTest, PointTowardsImpl)
         ASSERT_EQ(std::round(sprite.direction() * 100) / 100, intPosResults[i]);
     }
 
-    MotionBlocks::rng = RandomGenerator::instance().get();
 }
 
 TEST_F(MotionBlocksTest, GoToXY)
@@ -590,7 +643,7 @@ TEST_F(MotionBlocksTest, GoToImpl)
     vm.setConstValues(constValues);
 
     RandomGeneratorMock rng;
-    MotionBlocks::rng = &rng;
+    EXPECT_CALL(m_engineMock, randomGenerator()).WillRepeatedly(Return(&rng));
 
     // go to (join "_mouse_" "")
     EXPECT_CALL(m_engineMock, mouseX()).WillOnce(Return(70.56));
@@ -660,8 +713,6 @@ TEST_F(MotionBlocksTest, GoToImpl)
     ASSERT_EQ(vm.registerCount(), 0);
     ASSERT_EQ(sprite.x(), 220);
     ASSERT_EQ(sprite.y(), -16);
-
-    MotionBlocks::rng = RandomGenerator::instance().get();
 }
 
 TEST_F(MotionBlocksTest, GlideSecsToXY)
@@ -682,15 +733,17 @@ TEST_F(MotionBlocksTest, GlideSecsToXY)
     MotionBlocks::compileGlideSecsToXY(&compiler);
     compiler.end();
 
-    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_HALT }));
-    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 2.5, 95.2, -175.9 }));
+    ASSERT_EQ(
+        compiler.bytecode(),
+        std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_CONST, 4, vm::OP_EXEC, 1, vm::OP_HALT }));
+    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 2.5, 95.2, -175.9, 1, 1 })); // the section index is added to both calls
 }
 
 TEST_F(MotionBlocksTest, GlideSecsToXYImpl)
 {
-    static unsigned int bytecode[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_HALT };
+    static unsigned int bytecode[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_CONST, 3, vm::OP_EXEC, 1, vm::OP_HALT };
     static BlockFunc functions[] = { &MotionBlocks::startGlideSecsTo, &MotionBlocks::glideSecsTo };
-    static Value constValues[] = { 2.5, 95.2, -175.9 };
+    static Value constValues[] = { 2.5, 95.2, -175.9, 1 };
 
     static const double startX = 100.32;
     static const double startY = -50.12;
@@ -705,15 +758,15 @@ TEST_F(MotionBlocksTest, GlideSecsToXYImpl)
     vm.setConstValues(constValues);
 
     ClockMock clock;
-    MotionBlocks::clock = &clock;
+    EXPECT_CALL(m_engineMock, clock()).WillRepeatedly(Return(&clock));
 
     std::chrono::steady_clock::time_point startTime(std::chrono::milliseconds(1000));
     EXPECT_CALL(clock, currentSteadyTime()).Times(2).WillRepeatedly(Return(startTime));
     vm.run();
 
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) != MotionBlocks::m_timeMap.cend());
-    ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) != MotionBlocks::m_glideMap.cend());
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
+    ASSERT_TRUE(section()->m_glideMap.find(&vm) != section()->m_glideMap.cend());
     ASSERT_FALSE(vm.atEnd());
     ASSERT_EQ(sprite.x(), startX);
     ASSERT_EQ(sprite.y(), startY);
@@ -722,9 +775,9 @@ TEST_F(MotionBlocksTest, GlideSecsToXYImpl)
     EXPECT_CALL(clock, currentSteadyTime()).WillOnce(Return(time1));
     vm.run();
 
-    ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) != MotionBlocks::m_timeMap.cend());
-    ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) != MotionBlocks::m_glideMap.cend());
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
+    ASSERT_TRUE(section()->m_glideMap.find(&vm) != section()->m_glideMap.cend());
     ASSERT_FALSE(vm.atEnd());
     ASSERT_EQ(std::round(sprite.x() * 100) / 100, 95.29);
     ASSERT_EQ(std::round(sprite.y() * 100) / 100, -173.69);
@@ -734,13 +787,11 @@ TEST_F(MotionBlocksTest, GlideSecsToXYImpl)
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 0);
-    ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) == MotionBlocks::m_timeMap.cend());
-    ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) == MotionBlocks::m_glideMap.cend());
+    ASSERT_TRUE(section()->m_timeMap.find(&vm) == section()->m_timeMap.cend());
+    ASSERT_TRUE(section()->m_glideMap.find(&vm) == section()->m_glideMap.cend());
     ASSERT_TRUE(vm.atEnd());
     ASSERT_EQ(std::round(sprite.x() * 100) / 100, 95.2);
     ASSERT_EQ(std::round(sprite.y() * 100) / 100, -175.9);
-
-    MotionBlocks::clock = Clock::instance().get();
 }
 
 TEST_F(MotionBlocksTest, GlideTo)
@@ -798,45 +849,61 @@ TEST_F(MotionBlocksTest, GlideTo)
             { vm::OP_START,
               vm::OP_CONST,
               0,
+              vm::OP_CONST,
+              1,
               vm::OP_EXEC,
               0,
+              vm::OP_CONST,
+              2,
               vm::OP_EXEC,
               4,
               vm::OP_CONST,
-              1,
+              3,
+              vm::OP_CONST,
+              4,
               vm::OP_EXEC,
               1,
+              vm::OP_CONST,
+              5,
               vm::OP_EXEC,
               4,
               vm::OP_CONST,
-              2,
+              6,
               vm::OP_CONST,
-              3,
+              7,
+              vm::OP_CONST,
+              8,
               vm::OP_EXEC,
               2,
+              vm::OP_CONST,
+              9,
               vm::OP_EXEC,
               4,
               vm::OP_CONST,
-              4,
+              10,
               vm::OP_NULL,
+              vm::OP_CONST,
+              11,
               vm::OP_EXEC,
               3,
+              vm::OP_CONST,
+              12,
               vm::OP_EXEC,
               4,
               vm::OP_HALT }));
-    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 3.25, 2.5, 3.25, 5, 6.5 }));
+    ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 3.25, 1, 1, 2.5, 1, 1, 3.25, 5, 1, 1, 6.5, 1, 1 }));
 }
 
 TEST_F(MotionBlocksTest, GlideToImpl)
 {
-    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_EXEC, 4, vm::OP_HALT };
-    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 2, vm::OP_EXEC, 1, vm::OP_EXEC, 4, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 2, vm::OP_EXEC, 4, vm::OP_HALT };
-    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 3, vm::OP_EXEC, 4, vm::OP_HALT };
+    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 1, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_CONST, 3, vm::OP_EXEC, 4, vm::OP_HALT };
+    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 2, vm::OP_CONST, 3, vm::OP_EXEC, 1, vm::OP_CONST, 3, vm::OP_EXEC, 4, vm::OP_HALT };
+    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 3, vm::OP_EXEC, 2, vm::OP_CONST, 3, vm::OP_EXEC, 4, vm::OP_HALT };
+    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 3, vm::OP_EXEC, 3, vm::OP_CONST, 3, vm::OP_EXEC, 4, vm::OP_HALT };
     static unsigned int *scripts[] = { bytecode1, bytecode2, bytecode3, bytecode4 };
     static BlockFunc functions
         [] = { &MotionBlocks::startGlideTo, &MotionBlocks::startGlideToByIndex, &MotionBlocks::startGlideToMousePointer, &MotionBlocks::startGlideToRandomPosition, &MotionBlocks::glideSecsTo };
-    static Value constValues[] = { 2.5, "Sprite2", 3 };
+    static Value constValues[] = { 2.5, "Sprite2", 3, 1 };
 
     static const double startX = 100.32;
     static const double startY = -50.12;
@@ -854,8 +921,8 @@ TEST_F(MotionBlocksTest, GlideToImpl)
 
     ClockMock clock;
     RandomGeneratorMock rng;
-    MotionBlocks::clock = &clock;
-    MotionBlocks::rng = &rng;
+    EXPECT_CALL(m_engineMock, clock()).WillRepeatedly(Return(&clock));
+    EXPECT_CALL(m_engineMock, randomGenerator()).WillRepeatedly(Return(&rng));
     int i = 0;
 
     for (auto script : scripts) {
@@ -890,9 +957,9 @@ TEST_F(MotionBlocksTest, GlideToImpl)
         EXPECT_CALL(clock, currentSteadyTime()).Times(2).WillRepeatedly(Return(startTime));
         vm.run();
 
-        ASSERT_EQ(vm.registerCount(), 0);
-        ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) != MotionBlocks::m_timeMap.cend());
-        ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) != MotionBlocks::m_glideMap.cend());
+        ASSERT_EQ(vm.registerCount(), 1);
+        ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
+        ASSERT_TRUE(section()->m_glideMap.find(&vm) != section()->m_glideMap.cend());
         ASSERT_FALSE(vm.atEnd());
         ASSERT_EQ(sprite.x(), startX);
         ASSERT_EQ(sprite.y(), startY);
@@ -901,9 +968,9 @@ TEST_F(MotionBlocksTest, GlideToImpl)
         EXPECT_CALL(clock, currentSteadyTime()).WillOnce(Return(time1));
         vm.run();
 
-        ASSERT_EQ(vm.registerCount(), 0);
-        ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) != MotionBlocks::m_timeMap.cend());
-        ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) != MotionBlocks::m_glideMap.cend());
+        ASSERT_EQ(vm.registerCount(), 1);
+        ASSERT_TRUE(section()->m_timeMap.find(&vm) != section()->m_timeMap.cend());
+        ASSERT_TRUE(section()->m_glideMap.find(&vm) != section()->m_glideMap.cend());
         ASSERT_FALSE(vm.atEnd());
 
         if (i == 3) {
@@ -919,8 +986,8 @@ TEST_F(MotionBlocksTest, GlideToImpl)
         vm.run();
 
         ASSERT_EQ(vm.registerCount(), 0);
-        ASSERT_TRUE(MotionBlocks::m_timeMap.find(&vm) == MotionBlocks::m_timeMap.cend());
-        ASSERT_TRUE(MotionBlocks::m_glideMap.find(&vm) == MotionBlocks::m_glideMap.cend());
+        ASSERT_TRUE(section()->m_timeMap.find(&vm) == section()->m_timeMap.cend());
+        ASSERT_TRUE(section()->m_glideMap.find(&vm) == section()->m_glideMap.cend());
         ASSERT_TRUE(vm.atEnd());
 
         if (i == 3) {
@@ -933,9 +1000,6 @@ TEST_F(MotionBlocksTest, GlideToImpl)
 
         i++;
     }
-
-    MotionBlocks::clock = Clock::instance().get();
-    MotionBlocks::rng = RandomGenerator::instance().get();
 }
 
 TEST_F(MotionBlocksTest, ChangeXBy)
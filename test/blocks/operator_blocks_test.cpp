@@ -126,6 +126,18 @@ TEST_F(OperatorBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "e ^", OperatorBlocks::Eexp)).Times(1);
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "10 ^", OperatorBlocks::Op_10exp)).Times(1);
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &OperatorBlocks::op_ln));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &OperatorBlocks::op_log));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &OperatorBlocks::op_eexp));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &OperatorBlocks::op_10exp));
+
+    // Target-local functions
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&OperatorBlocks::op_ln)).Times(1);
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&OperatorBlocks::op_log)).Times(1);
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&OperatorBlocks::op_eexp)).Times(1);
+    EXPECT_CALL(m_engineMock, addTargetLocalFunction(&OperatorBlocks::op_10exp)).Times(1);
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -6,9 +6,11 @@
 #include <scratchcpp/stage.h>
 #include <scratchcpp/costume.h>
 #include <scratchcpp/variable.h>
+#include <scratchcpp/rect.h>
 #include <enginemock.h>
 #include <timermock.h>
 #include <clockmock.h>
+#include <spritehandlermock.h>
 
 #include "../common.h"
 #include "blocks/sensingblocks.h"
@@ -105,6 +107,7 @@ TEST_F(SensingBlocksTest, CategoryVisible)
 TEST_F(SensingBlocksTest, RegisterBlocks)
 {
     // Blocks
+    EXPECT_CALL(m_engineMock, addCompileFunction(m_section.get(), "sensing_touchingobject", &SensingBlocks::compileTouchingObject));
     EXPECT_CALL(m_engineMock, addCompileFunction(m_section.get(), "sensing_distanceto", &SensingBlocks::compileDistanceTo));
     EXPECT_CALL(m_engineMock, addCompileFunction(m_section.get(), "sensing_keypressed", &SensingBlocks::compileKeyPressed));
     EXPECT_CALL(m_engineMock, addCompileFunction(m_section.get(), "sensing_mousedown", &SensingBlocks::compileMouseDown));
@@ -118,6 +121,7 @@ TEST_F(SensingBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addCompileFunction(m_section.get(), "sensing_dayssince2000", &SensingBlocks::compileDaysSince2000));
 
     // Inputs
+    EXPECT_CALL(m_engineMock, addInput(m_section.get(), "TOUCHINGOBJECTMENU", SensingBlocks::TOUCHINGOBJECTMENU));
     EXPECT_CALL(m_engineMock, addInput(m_section.get(), "DISTANCETOMENU", SensingBlocks::DISTANCETOMENU));
     EXPECT_CALL(m_engineMock, addInput(m_section.get(), "KEY_OPTION", SensingBlocks::KEY_OPTION));
     EXPECT_CALL(m_engineMock, addInput(m_section.get(), "OBJECT", SensingBlocks::OBJECT));
@@ -148,9 +152,200 @@ TEST_F(SensingBlocksTest, RegisterBlocks)
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "backdrop #", SensingBlocks::BackdropNumber));
     EXPECT_CALL(m_engineMock, addFieldValue(m_section.get(), "backdrop name", SensingBlocks::BackdropName));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::touchingMousePointer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::touchingEdge));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::touchingObjectByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::touchingObject));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::distanceToMousePointer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::distanceToByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::distanceTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::keyPressed));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::mouseDown));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::mouseX));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::mouseY));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::setDraggableMode));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::setNotDraggableMode));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::timer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::resetTimer));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::xPositionOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::yPositionOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::directionOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::costumeNumberOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::costumeNameOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::sizeOfSpriteByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::volumeOfTargetByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::backdropNumberOfStageByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::backdropNameOfStageByIndex));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::xPositionOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::yPositionOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::directionOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::costumeNumberOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::costumeNameOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::sizeOfSprite));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::volumeOfTarget));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::backdropNumberOfStage));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::backdropNameOfStage));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::variableOfTarget));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentYear));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentMonth));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentDate));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentDayOfWeek));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentHour));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentMinute));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::currentSecond));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SensingBlocks::daysSince2000));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
+TEST_F(SensingBlocksTest, TouchingObject)
+{
+    Compiler compiler(&m_engineMock);
+
+    // touching (Sprite2)?
+    auto block1 = std::make_shared<Block>("a", "sensing_touchingobject");
+    addDropdownInput(block1, "TOUCHINGOBJECTMENU", SensingBlocks::TOUCHINGOBJECTMENU, "Sprite2");
+
+    // touching (mouse-pointer)?
+    auto block2 = std::make_shared<Block>("b", "sensing_touchingobject");
+    addDropdownInput(block2, "TOUCHINGOBJECTMENU", SensingBlocks::TOUCHINGOBJECTMENU, "_mouse_");
+
+    // touching (edge)?
+    auto block3 = std::make_shared<Block>("c", "sensing_touchingobject");
+    addDropdownInput(block3, "TOUCHINGOBJECTMENU", SensingBlocks::TOUCHINGOBJECTMENU, "_edge_");
+
+    // touching (null block)?
+    auto block4 = std::make_shared<Block>("d", "sensing_touchingobject");
+    addDropdownInput(block4, "TOUCHINGOBJECTMENU", SensingBlocks::TOUCHINGOBJECTMENU, "", createNullBlock("e"));
+
+    compiler.init();
+
+    EXPECT_CALL(m_engineMock, findTarget("Sprite2")).WillOnce(Return(5));
+    EXPECT_CALL(m_engineMock, functionIndex(&SensingBlocks::touchingObjectByIndex)).WillOnce(Return(0));
+    compiler.setBlock(block1);
+    SensingBlocks::compileTouchingObject(&compiler);
+
+    EXPECT_CALL(m_engineMock, functionIndex(&SensingBlocks::touchingMousePointer)).WillOnce(Return(1));
+    compiler.setBlock(block2);
+    SensingBlocks::compileTouchingObject(&compiler);
+
+    EXPECT_CALL(m_engineMock, functionIndex(&SensingBlocks::touchingEdge)).WillOnce(Return(2));
+    compiler.setBlock(block3);
+    SensingBlocks::compileTouchingObject(&compiler);
+
+    EXPECT_CALL(m_engineMock, functionIndex(&SensingBlocks::touchingObject)).WillOnce(Return(3));
+    compiler.setBlock(block4);
+    SensingBlocks::compileTouchingObject(&compiler);
+
+    compiler.end();
+
+    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_EXEC, 2, vm::OP_NULL, vm::OP_EXEC, 3, vm::OP_HALT }));
+    ASSERT_EQ(compiler.constValues().size(), 1);
+    ASSERT_EQ(compiler.constValues()[0].toDouble(), 5);
+}
+
+TEST_F(SensingBlocksTest, TouchingObjectImpl)
+{
+    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_HALT };
+    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_HALT };
+    static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 4, vm::OP_EXEC, 1, vm::OP_HALT };
+    static unsigned int bytecode6[] = { vm::OP_START, vm::OP_CONST, 5, vm::OP_EXEC, 1, vm::OP_HALT };
+    static unsigned int bytecode7[] = { vm::OP_START, vm::OP_EXEC, 2, vm::OP_HALT };
+    static unsigned int bytecode8[] = { vm::OP_START, vm::OP_EXEC, 3, vm::OP_HALT };
+    static BlockFunc functions[] = { &SensingBlocks::touchingObject, &SensingBlocks::touchingObjectByIndex, &SensingBlocks::touchingMousePointer, &SensingBlocks::touchingEdge };
+    static Value constValues[] = { "Sprite2", "_mouse_", "_edge_", "", 1, -1 };
+
+    Sprite sprite1;
+    SpriteHandlerMock handler1;
+    EXPECT_CALL(handler1, init);
+    sprite1.setInterface(&handler1);
+    sprite1.setEngine(&m_engineMock);
+
+    Sprite sprite2;
+
+    VirtualMachine vm(&sprite1, &m_engineMock, nullptr);
+    vm.setFunctions(functions);
+    vm.setConstValues(constValues);
+
+    EXPECT_CALL(m_engineMock, findTarget("Sprite2")).WillOnce(Return(3));
+    EXPECT_CALL(m_engineMock, targetAt(3)).WillOnce(Return(&sprite2));
+    EXPECT_CALL(m_engineMock, touchingSprite(&sprite1, &sprite2)).WillOnce(Return(true));
+    vm.setBytecode(bytecode1);
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, mouseX()).WillOnce(Return(-20));
+    EXPECT_CALL(m_engineMock, mouseY()).WillOnce(Return(50));
+    EXPECT_CALL(handler1, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    vm.setBytecode(bytecode2);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, stageWidth()).WillOnce(Return(480));
+    EXPECT_CALL(m_engineMock, stageHeight()).WillOnce(Return(360));
+    EXPECT_CALL(handler1, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    vm.setBytecode(bytecode3);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_FALSE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, findTarget("")).WillOnce(Return(-1));
+    EXPECT_CALL(m_engineMock, targetAt(-1)).WillOnce(Return(nullptr));
+    vm.setBytecode(bytecode4);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_FALSE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, targetAt(1)).WillOnce(Return(&sprite2));
+    EXPECT_CALL(m_engineMock, touchingSprite(&sprite1, &sprite2)).WillOnce(Return(false));
+    vm.setBytecode(bytecode5);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_FALSE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, targetAt(-1)).WillOnce(Return(nullptr));
+    vm.setBytecode(bytecode6);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_FALSE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, mouseX()).WillOnce(Return(21));
+    EXPECT_CALL(m_engineMock, mouseY()).WillOnce(Return(50));
+    EXPECT_CALL(handler1, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    vm.setBytecode(bytecode7);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_FALSE(vm.getInput(0, 1)->toBool());
+
+    EXPECT_CALL(m_engineMock, stageWidth()).WillOnce(Return(480));
+    EXPECT_CALL(m_engineMock, stageHeight()).WillOnce(Return(360));
+    EXPECT_CALL(handler1, boundingRect()).WillOnce(Return(Rect(200, 10, 241, -10)));
+    vm.setBytecode(bytecode8);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_TRUE(vm.getInput(0, 1)->toBool());
+}
+
 TEST_F(SensingBlocksTest, DistanceTo)
 {
     Compiler compiler(&m_engineMock);
@@ -184,16 +379,16 @@ TEST_F(SensingBlocksTest, DistanceTo)
 
     compiler.end();
 
-    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_NULL, vm::OP_EXEC, 2, vm::OP_HALT }));
+    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_EXEC, 1, vm::OP_NULL, vm::OP_EXEC_CACHED, 2, 0, vm::OP_HALT }));
     ASSERT_EQ(compiler.constValues().size(), 1);
     ASSERT_EQ(compiler.constValues()[0].toDouble(), 5);
 }
 
 TEST_F(SensingBlocksTest, DistanceToImpl)
 {
-    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_HALT };
+    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 2, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
     static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 3, vm::OP_EXEC, 1, vm::OP_HALT };
     static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 4, vm::OP_EXEC, 1, vm::OP_HALT };
     static unsigned int bytecode6[] = { vm::OP_START, vm::OP_CONST, 5, vm::OP_EXEC, 1, vm::OP_HALT };
@@ -865,8 +1060,9 @@ TEST_F(SensingBlocksTest, Of)
               vm::OP_EXEC,
               0,
               vm::OP_NULL,
-              vm::OP_EXEC,
+              vm::OP_EXEC_CACHED,
               1,
+              0,
               vm::OP_CONST,
               1,
               vm::OP_EXEC,
@@ -939,8 +1135,9 @@ TEST_F(SensingBlocksTest, Of)
               vm::OP_CONST,
               10,
               vm::OP_NULL,
-              vm::OP_EXEC,
+              vm::OP_EXEC_CACHED,
               18,
+              1,
               vm::OP_NULL,
               vm::OP_HALT }));
     ASSERT_EQ(compiler.constValues(), std::vector<Value>({ 6, 6, 6, 6, 6, 6, 6, 0, 0, 0, "some variable" }));
@@ -949,15 +1146,16 @@ TEST_F(SensingBlocksTest, Of)
 
 TEST_F(SensingBlocksTest, XPositionOfSprite)
 {
-    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 0, vm::OP_HALT };
+    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
     static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_EXEC, 1, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::xPositionOfSprite, &SensingBlocks::xPositionOfSpriteByIndex };
     static Value constValues[] = { "Sprite2", 6 };
 
     Sprite sprite;
     sprite.setX(-168.088);
+    Stage stage; // the inline caches are only used if the VM has a target
 
-    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
+    VirtualMachine vm(&stage, &m_engineMock, nullptr);
     vm.setFunctions(functions);
     vm.setConstValues(constValues);
 
@@ -969,6 +1167,17 @@ TEST_F(SensingBlocksTest, XPositionOfSprite)
     ASSERT_EQ(vm.registerCount(), 1);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), -168.088);
 
+    // The target is resolved only once (it's stored in the inline cache)
+    EXPECT_CALL(m_engineMock, findTarget).Times(0);
+    EXPECT_CALL(m_engineMock, targetAt).Times(0);
+    sprite.setX(12.5);
+    vm.reset();
+    vm.run();
+
+    ASSERT_EQ(vm.registerCount(), 1);
+    ASSERT_EQ(vm.getInput(0, 1)->toDouble(), 12.5);
+
+    sprite.setX(-168.088);
     EXPECT_CALL(m_engineMock, targetAt(6)).WillOnce(Return(&sprite));
     vm.reset();
     vm.setBytecode(bytecode2);
@@ -1192,11 +1401,11 @@ TEST_F(SensingBlocksTest, VolumeOfTarget)
 
 TEST_F(SensingBlocksTest, VariableOfTarget)
 {
-    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_CONST, 3, vm::OP_EXEC, 0, vm::OP_HALT };
-    static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 4, vm::OP_EXEC, 0, vm::OP_HALT };
+    static unsigned int bytecode1[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 2, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode2[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_CONST, 2, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode3[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 3, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode4[] = { vm::OP_START, vm::OP_CONST, 1, vm::OP_CONST, 3, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
+    static unsigned int bytecode5[] = { vm::OP_START, vm::OP_CONST, 0, vm::OP_CONST, 4, vm::OP_EXEC_CACHED, 0, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::variableOfTarget };
     static Value constValues[] = { "variable", "invalid variable", "Sprite2", "_stage_", "test" };
 
@@ -1391,14 +1600,18 @@ TEST_F(SensingBlocksTest, CurrentYear)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentYear };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_year + 1900);
 }
@@ -1408,14 +1621,18 @@ TEST_F(SensingBlocksTest, CurrentMonth)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentMonth };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_mon + 1);
 }
@@ -1425,14 +1642,18 @@ TEST_F(SensingBlocksTest, CurrentDate)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentDate };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_mday);
 }
@@ -1442,14 +1663,18 @@ TEST_F(SensingBlocksTest, CurrentDayOfWeek)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentDayOfWeek };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_wday + 1);
 }
@@ -1459,14 +1684,18 @@ TEST_F(SensingBlocksTest, CurrentHour)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentHour };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_hour);
 }
@@ -1476,14 +1705,18 @@ TEST_F(SensingBlocksTest, CurrentMinute)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentMinute };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_min);
 }
@@ -1493,14 +1726,18 @@ TEST_F(SensingBlocksTest, CurrentSecond)
     static unsigned int bytecode[] = { vm::OP_START, vm::OP_EXEC, 0, vm::OP_HALT };
     static BlockFunc functions[] = { &SensingBlocks::currentSecond };
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &m_engineMock, nullptr);
     vm.setBytecode(bytecode);
     vm.setFunctions(functions);
+
+    std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
+    EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
     vm.run();
 
     ASSERT_EQ(vm.registerCount(), 1);
 
-    time_t now = time(0);
+    time_t now = std::chrono::system_clock::to_time_t(time);
     tm *ltm = localtime(&now);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), ltm->tm_sec);
 }
@@ -1531,18 +1768,9 @@ TEST_F(SensingBlocksTest, DaysSince2000Impl)
     vm.setBytecode(bytecode);
 
     std::chrono::system_clock::time_point time(std::chrono::milliseconds(1011243120562)); // Jan 17 2002 04:52:00
+    EXPECT_CALL(m_engineMock, clock()).WillOnce(Return(&m_clockMock));
     EXPECT_CALL(m_clockMock, currentSystemTime()).WillOnce(Return(time));
-
-    vm.run(); // Test with the default clock - shouldn't crash (see #210)
-
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    ASSERT_EQ(vm.registerCount(), 1);
-    ASSERT_EQ(std::round(vm.getInput(0, 1)->toDouble() * 100) / 100, std::round((ms / 86400000.0 - 10957) * 100) / 100);
-
-    SensingBlocks::clock = &m_clockMock;
-    vm.reset();
     vm.run();
-    SensingBlocks::clock = nullptr;
 
     ASSERT_EQ(vm.registerCount(), 1);
     ASSERT_EQ(vm.getInput(0, 1)->toDouble(), 747.20278428240817);
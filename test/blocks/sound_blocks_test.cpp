@@ -101,6 +101,11 @@ TEST_F(SoundBlocksTest, RegisterBlocks)
     // Inputs
     EXPECT_CALL(m_engineMock, addInput(m_section.get(), "VOLUME", SoundBlocks::VOLUME));
 
+    // Functions
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SoundBlocks::changeVolumeBy));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SoundBlocks::setVolumeTo));
+    EXPECT_CALL(m_engineMock, addFunction(m_section.get(), &SoundBlocks::volume));
+
     m_section->registerBlocks(&m_engineMock);
 }
 
@@ -430,6 +430,20 @@ TEST_F(CompilerTest, AddFunctionCall)
     ASSERT_EQ(engine.functionIndex(&testFunction2), 1);
 }
 
+TEST_F(CompilerTest, AddFunctionCallWithInlineCache)
+{
+    INIT_COMPILER(engine, compiler);
+    compiler.addInstruction(vm::OP_START);
+    compiler.addFunctionCallWithInlineCache(&testFunction1);
+    compiler.addFunctionCall(&testFunction2);
+    compiler.addFunctionCallWithInlineCache(&testFunction1);
+    compiler.addFunctionCallWithInlineCache(&testFunction2);
+    compiler.addInstruction(vm::OP_HALT);
+
+    // Every call gets its own cache slot
+    ASSERT_EQ(compiler.bytecode(), std::vector<unsigned int>({ vm::OP_START, vm::OP_EXEC_CACHED, 0, 0, vm::OP_EXEC, 1, vm::OP_EXEC_CACHED, 0, 1, vm::OP_EXEC_CACHED, 1, 2, vm::OP_HALT }));
+}
+
 TEST_F(CompilerTest, Warp)
 {
     INIT_COMPILER(engine, compiler);
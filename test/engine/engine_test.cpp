@@ -4,20 +4,35 @@
 #include <scratchcpp/sprite.h>
 #include <scratchcpp/stage.h>
 #include <scratchcpp/variable.h>
+#include <scratchcpp/costume.h>
 #include <scratchcpp/list.h>
 #include <scratchcpp/keyevent.h>
+#include <scratchcpp/script.h>
+#include <scratchcpp/compiler.h>
+#include <scratchcpp/input.h>
+#include <scratchcpp/inputvalue.h>
+#include <scratchcpp/field.h>
+#include <scratchcpp/rect.h>
+#include <scratchcpp/scratchconfiguration.h>
 #include <timermock.h>
 #include <clockmock.h>
+#include <spritehandlermock.h>
+#include <graphicseffectmock.h>
 #include <thread>
+#include <atomic>
+#include <chrono>
 
 #include "../common.h"
 #include "testsection.h"
 #include "engine/internal/engine.h"
 #include "engine/internal/clock.h"
+#include "engine/internal/irandomgenerator.h"
 
 using namespace libscratchcpp;
 
 using ::testing::Return;
+using ::testing::SaveArg;
+using ::testing::_;
 
 // NOTE: resolveIds() and compile() are tested in load_project_test
 
@@ -80,6 +95,148 @@ TEST(EngineTest, EventLoop)
     th.join(); // should return immediately
 }
 
+TEST(EngineTest, InputEvents)
+{
+    Engine engine;
+    std::atomic<double> mouseX = 0;
+    std::atomic<bool> mousePressed = false;
+
+    // The redraw handler is called by the event loop thread
+    engine.setRedrawHandler([&engine, &mouseX, &mousePressed]() {
+        mouseX = engine.mouseX();
+        mousePressed = engine.mousePressed();
+    });
+
+    std::thread th([&engine]() { engine.runEventLoop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // These are queued and processed by the event loop
+    engine.setMouseX(12.5);
+    engine.setMousePressed(true);
+    engine.setKeyState("a", true);
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (!(mouseX == 12.5 && mousePressed) && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    engine.setMouseY(-8.25);
+    engine.stopEventLoop();
+    th.join();
+
+    ASSERT_EQ(mouseX, 12.5);
+    ASSERT_TRUE(mousePressed);
+    ASSERT_TRUE(engine.keyPressed("a"));
+    ASSERT_EQ(engine.mouseY(), -8.25); // events posted after the last frame are processed too
+
+    // Without a running event loop, the events are processed immediately
+    engine.setMouseX(-5);
+    ASSERT_EQ(engine.mouseX(), -5);
+}
+
+TEST(EngineTest, InputEventsWhileStopping)
+{
+    Engine engine;
+
+    for (int i = 1; i <= 100; i++) {
+        std::thread th([&engine]() { engine.runEventLoop(); });
+
+        // The event might be posted while the event loop is stopping, it must not be lost
+        std::this_thread::sleep_for(std::chrono::microseconds(i * 10));
+        engine.stopEventLoop();
+        engine.setMouseX(i);
+        engine.setMouseY(-i);
+        th.join();
+
+        ASSERT_EQ(engine.mouseX(), i);
+        ASSERT_EQ(engine.mouseY(), -i);
+    }
+}
+
+TEST(EngineTest, InputEventsWhileStarting)
+{
+    Engine engine;
+
+    for (int i = 1; i <= 100; i++) {
+        std::atomic<bool> running = false;
+        engine.setRedrawHandler([&running]() { running = true; });
+        std::thread th([&engine]() { engine.runEventLoop(); });
+
+        // The event might be posted while the event loop is starting, it must not be handled by both threads
+        std::this_thread::sleep_for(std::chrono::microseconds(i * 10));
+        engine.setMouseX(i);
+        engine.setMouseY(-i);
+
+        while (!running)
+            std::this_thread::yield();
+
+        engine.stopEventLoop();
+        th.join();
+
+        ASSERT_EQ(engine.mouseX(), i);
+        ASSERT_EQ(engine.mouseY(), -i);
+    }
+}
+
+TEST(EngineTest, ParallelExecutionInEventLoop)
+{
+    // The thread pool must not be destroyed while the event loop uses it
+    Engine engine;
+    engine.setExtensions({});
+    engine.setLoggingEnabled(false);
+    engine.setFixedTimestepEnabled(true);
+    engine.setParallelExecutionEnabled(true);
+    std::vector<std::shared_ptr<Target>> targets = { std::make_shared<Stage>() };
+    std::vector<std::shared_ptr<Variable>> variables;
+
+    for (int i = 0; i < 8; i++) {
+        // when flag clicked, forever { change [v] by 1 }
+        std::string id = std::to_string(i);
+        auto sprite = std::make_shared<Sprite>();
+        sprite->setName("Sprite" + id);
+        auto var = std::make_shared<Variable>("v" + id, "v");
+        sprite->addVariable(var);
+        variables.push_back(var);
+
+        auto hat = std::make_shared<Block>("hat" + id, "event_whenflagclicked");
+        auto forever = std::make_shared<Block>("forever" + id, "control_forever");
+        auto change = std::make_shared<Block>("change" + id, "data_changevariableby");
+        hat->setNextId(forever->id());
+        forever->setParentId(hat->id());
+        auto substack = std::make_shared<Input>("SUBSTACK", Input::Type::NoShadow);
+        substack->setValueBlockId(change->id());
+        forever->addInput(substack);
+        change->setParentId(forever->id());
+        change->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+        auto value = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+        value->primaryValue()->setValue(1);
+        change->addInput(value);
+        sprite->addBlock(hat);
+        sprite->addBlock(forever);
+        sprite->addBlock(change);
+        targets.push_back(sprite);
+    }
+
+    engine.setTargets(targets);
+    engine.compile();
+
+    std::thread th([&engine]() { engine.runEventLoop(); });
+    engine.start();
+
+    for (int i = 0; i < 100; i++) {
+        engine.setParallelExecutionEnabled(i % 2 == 1);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    engine.stopEventLoop();
+    th.join();
+
+    ASSERT_TRUE(engine.parallelExecutionEnabled());
+
+    for (auto var : variables)
+        ASSERT_GT(var->value().toInt(), 0);
+}
+
 TEST(EngineTest, Fps)
 {
     Engine engine;
@@ -102,9 +259,14 @@ TEST(EngineTest, FpsProject)
     std::chrono::steady_clock::time_point time2(std::chrono::milliseconds(75));
     std::chrono::steady_clock::time_point time3(std::chrono::milliseconds(83));
     std::chrono::steady_clock::time_point time4(std::chrono::milliseconds(116));
+    // The wait block reads the engine clock too
     EXPECT_CALL(clock, currentSteadyTime())
         .WillOnce(Return(time1))
         .WillOnce(Return(time1))
+        .WillOnce(Return(time1))
+        .WillOnce(Return(time1))
+        .WillOnce(Return(time2))
+        .WillOnce(Return(time2))
         .WillOnce(Return(time2))
         .WillOnce(Return(time2))
         .WillOnce(Return(time3))
@@ -126,6 +288,10 @@ TEST(EngineTest, FpsProject)
     EXPECT_CALL(clock, currentSteadyTime())
         .WillOnce(Return(time5))
         .WillOnce(Return(time5))
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time6))
+        .WillOnce(Return(time6))
         .WillOnce(Return(time6))
         .WillOnce(Return(time6))
         .WillOnce(Return(time7))
@@ -138,11 +304,940 @@ TEST(EngineTest, FpsProject)
     p.run();
 
     engine->setTurboModeEnabled(true);
-    EXPECT_CALL(clock, currentSteadyTime()).WillOnce(Return(time5)).WillOnce(Return(time5)).WillOnce(Return(time6)).WillOnce(Return(time6)).WillOnce(Return(time7)).WillOnce(Return(time8));
+    EXPECT_CALL(clock, currentSteadyTime())
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time5))
+        .WillOnce(Return(time6))
+        .WillOnce(Return(time6))
+        .WillOnce(Return(time6))
+        .WillOnce(Return(time6))
+        .WillOnce(Return(time7))
+        .WillOnce(Return(time8));
     EXPECT_CALL(clock, sleep).Times(0);
     p.run();
 }
 
+TEST(EngineTest, FixedTimestep)
+{
+    Engine engine;
+    ASSERT_FALSE(engine.fixedTimestepEnabled());
+
+    engine.setFixedTimestepEnabled(true);
+    ASSERT_TRUE(engine.fixedTimestepEnabled());
+    ASSERT_TRUE(engine.clock());
+    ASSERT_NE(engine.clock(), Clock::instance().get());
+    ASSERT_EQ(engine.timer()->value(), 0);
+
+    RedrawMock redrawMock;
+    auto handler = std::bind(&RedrawMock::redraw, &redrawMock);
+    engine.setRedrawHandler(std::function<void()>(handler));
+    EXPECT_CALL(redrawMock, redraw()).Times(15);
+    engine.step(15);
+    ASSERT_EQ(engine.timer()->value(), 0.5);
+
+    EXPECT_CALL(redrawMock, redraw()).Times(15);
+    engine.step(15);
+    ASSERT_EQ(engine.timer()->value(), 1);
+
+    engine.setFps(10);
+    EXPECT_CALL(redrawMock, redraw()).Times(5);
+    engine.step(5);
+    ASSERT_EQ(engine.timer()->value(), 1.5);
+
+    engine.setFixedTimestepEnabled(false);
+    ASSERT_FALSE(engine.fixedTimestepEnabled());
+    ASSERT_EQ(engine.clock(), Clock::instance().get());
+}
+
+TEST(EngineTest, FixedTimestepProject)
+{
+    Project p("2_frames.sb3");
+    ASSERT_TRUE(p.load());
+
+    Engine *engine = dynamic_cast<Engine *>(p.engine().get());
+    engine->setFixedTimestepEnabled(true);
+
+    RedrawMock redrawMock;
+    auto handler = std::bind(&RedrawMock::redraw, &redrawMock);
+    engine->setRedrawHandler(std::function<void()>(handler));
+    EXPECT_CALL(redrawMock, redraw()).Times(2);
+    p.run();
+    ASSERT_EQ(engine->timer()->value(), 0.066); // 2 frames
+}
+
+TEST(EngineTest, RandomSeed)
+{
+    Engine engine1;
+    Engine engine2;
+    ASSERT_TRUE(engine1.randomGenerator());
+    ASSERT_NE(engine1.randomGenerator(), engine2.randomGenerator());
+
+    engine1.setRandomSeed(12345);
+    engine2.setRandomSeed(12345);
+
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(engine1.randomGenerator()->randint(-1000, 1000), engine2.randomGenerator()->randint(-1000, 1000));
+}
+
+TEST(EngineTest, ParallelExecutionEnabled)
+{
+    Engine engine;
+    ASSERT_FALSE(engine.parallelExecutionEnabled());
+
+    engine.setParallelExecutionEnabled(true);
+    ASSERT_TRUE(engine.parallelExecutionEnabled());
+
+    engine.setParallelExecutionEnabled(false);
+    ASSERT_FALSE(engine.parallelExecutionEnabled());
+}
+
+TEST(EngineTest, TargetLocalScripts)
+{
+    Project p("parallel_execution.sb3");
+    ASSERT_TRUE(p.load());
+
+    auto engine = p.engine();
+    const auto &scripts = engine->scripts();
+    ASSERT_EQ(scripts.size(), 3);
+
+    for (const auto &[block, script] : scripts) {
+        if (block->id() == "hatA")
+            ASSERT_TRUE(script->isTargetLocal()); // only uses motion blocks and a local variable
+        else
+            ASSERT_FALSE(script->isTargetLocal()); // creates clones or uses a global list
+    }
+}
+
+TEST(EngineTest, TargetLocalScriptsAfterStop)
+{
+    Engine engine;
+    engine.setExtensions({});
+    auto stage = std::make_shared<Stage>();
+    auto globalVar = std::make_shared<Variable>("g", "global", 0);
+    stage->addVariable(globalVar);
+    auto sprite = std::make_shared<Sprite>();
+    auto localVar = std::make_shared<Variable>("l", "local", 0);
+    sprite->addVariable(localVar);
+
+    // when flag clicked, if <> then { stop this script }, change var by 1
+    auto addScript = [&sprite](const std::string &prefix, std::shared_ptr<Variable> var) {
+        auto hat = std::make_shared<Block>(prefix + "hat", "event_whenflagclicked");
+        auto ifBlock = std::make_shared<Block>(prefix + "if", "control_if");
+        auto stopBlock = std::make_shared<Block>(prefix + "stop", "control_stop");
+        auto changeBlock = std::make_shared<Block>(prefix + "change", "data_changevariableby");
+        hat->setNextId(prefix + "if");
+        ifBlock->setParentId(prefix + "hat");
+        ifBlock->setNextId(prefix + "change");
+        auto substack = std::make_shared<Input>("SUBSTACK", Input::Type::NoShadow);
+        substack->setValueBlockId(prefix + "stop");
+        ifBlock->addInput(substack);
+        stopBlock->setParentId(prefix + "if");
+        stopBlock->addField(std::make_shared<Field>("STOP_OPTION", "this script"));
+        changeBlock->setParentId(prefix + "if");
+        changeBlock->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+        auto input = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+        input->primaryValue()->setValue(1);
+        changeBlock->addInput(input);
+        sprite->addBlock(hat);
+        sprite->addBlock(ifBlock);
+        sprite->addBlock(stopBlock);
+        sprite->addBlock(changeBlock);
+        return hat;
+    };
+
+    auto localHat = addScript("a", localVar);
+    auto globalHat = addScript("b", globalVar);
+
+    engine.setLoggingEnabled(false);
+    engine.setTargets({ stage, sprite });
+    engine.compile();
+
+    const auto &scripts = engine.scripts();
+    ASSERT_EQ(scripts.size(), 2);
+    ASSERT_TRUE(scripts.at(localHat)->isTargetLocal());
+    ASSERT_FALSE(scripts.at(globalHat)->isTargetLocal()); // the stage variable is written after "stop this script"
+}
+
+TEST(EngineTest, ParallelExecution)
+{
+    std::vector<std::vector<std::string>> results;
+
+    for (bool parallel : { false, true }) {
+        Project p("parallel_execution.sb3");
+        ASSERT_TRUE(p.load());
+
+        auto engine = p.engine();
+        engine->setFixedTimestepEnabled(true);
+        engine->setParallelExecutionEnabled(parallel);
+        p.run();
+
+        Stage *stage = engine->stage();
+        ASSERT_LIST(stage, "results");
+        auto list = GET_LIST(stage, "results");
+        ASSERT_EQ(list->size(), 10);
+        std::vector<std::string> values;
+
+        for (const Value &value : *list)
+            values.push_back(value.toString());
+
+        results.push_back(values);
+    }
+
+    // The order must be the same as in the sequential mode
+    ASSERT_EQ(results[0], results[1]);
+
+    std::vector<std::string> sorted = results[1];
+    std::sort(sorted.begin(), sorted.end());
+
+    for (int i = 0; i < 10; i++)
+        ASSERT_EQ(sorted[i], std::to_string(40 + i) + ",30");
+}
+
+TEST(EngineTest, ParallelEngines)
+{
+    // Engines don't share any state, so multiple projects can run in parallel
+    static const int count = 4;
+    std::vector<std::thread> threads;
+    bool results[count] = { false };
+
+    for (int i = 0; i < count; i++) {
+        threads.push_back(std::thread([i, &results]() {
+            Project p("clones.sb3");
+
+            if (!p.load())
+                return;
+
+            p.engine()->setFixedTimestepEnabled(true);
+            p.engine()->setRandomSeed(i);
+            p.run();
+
+            Stage *stage = p.engine()->stage();
+            auto clone5 = stage->variableAt(stage->findVariable("clone5"));
+            auto deletePassed = stage->variableAt(stage->findVariable("delete_passed"));
+            results[i] = (clone5->value().toInt() == 110) && deletePassed->value().toBool();
+        }));
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (int i = 0; i < count; i++)
+        ASSERT_TRUE(results[i]);
+}
+
+TEST(EngineTest, ParallelEnginesWithParallelExecution)
+{
+    // Engines compile and run their scripts on their own thread pools, renames in one engine don't affect the others
+    static const int count = 4;
+    std::vector<std::thread> threads;
+    bool results[count] = { false };
+
+    for (int i = 0; i < count; i++) {
+        threads.push_back(std::thread([i, &results]() {
+            Engine engine;
+            engine.setExtensions({});
+            engine.setLoggingEnabled(false);
+            engine.setFixedTimestepEnabled(true);
+            engine.setParallelExecutionEnabled(true);
+            std::vector<std::shared_ptr<Target>> targets = { std::make_shared<Stage>() };
+            std::vector<std::shared_ptr<Variable>> variables;
+
+            for (int j = 0; j < 8; j++) {
+                // when flag clicked, repeat (50) { change [v] by 1 }
+                std::string id = std::to_string(j);
+                auto sprite = std::make_shared<Sprite>();
+                sprite->setName("Sprite" + id);
+                auto var = std::make_shared<Variable>("v" + id, "v");
+                sprite->addVariable(var);
+                variables.push_back(var);
+
+                auto hat = std::make_shared<Block>("hat" + id, "event_whenflagclicked");
+                auto repeat = std::make_shared<Block>("repeat" + id, "control_repeat");
+                auto change = std::make_shared<Block>("change" + id, "data_changevariableby");
+                hat->setNextId(repeat->id());
+                repeat->setParentId(hat->id());
+                auto times = std::make_shared<Input>("TIMES", Input::Type::Shadow);
+                times->primaryValue()->setValue(50);
+                repeat->addInput(times);
+                auto substack = std::make_shared<Input>("SUBSTACK", Input::Type::NoShadow);
+                substack->setValueBlockId(change->id());
+                repeat->addInput(substack);
+                change->setParentId(repeat->id());
+                change->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+                auto value = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+                value->primaryValue()->setValue(1);
+                change->addInput(value);
+                sprite->addBlock(hat);
+                sprite->addBlock(repeat);
+                sprite->addBlock(change);
+                targets.push_back(sprite);
+            }
+
+            engine.setTargets(targets);
+            engine.compile();
+            engine.run();
+
+            bool ok = true;
+
+            for (auto var : variables)
+                ok = ok && var->value().toInt() == 50;
+
+            for (int j = 0; j < 8; j++) {
+                targets[j + 1]->setName("Renamed" + std::to_string(j));
+                ok = ok && engine.findTarget("Renamed" + std::to_string(j)) == j + 1 && engine.findTarget("Sprite" + std::to_string(j)) == -1;
+            }
+
+            results[i] = ok;
+        }));
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (int i = 0; i < count; i++)
+        ASSERT_TRUE(results[i]);
+}
+
+TEST(EngineTest, DeterministicCompilation)
+{
+    // Targets are compiled in parallel, but the result must always be the same
+    std::vector<std::vector<unsigned int>> bytecodes[2];
+
+    for (int i = 0; i < 2; i++) {
+        Project p("load_test.sb3");
+        ASSERT_TRUE(p.load());
+
+        auto engine = p.engine();
+        const auto &scripts = engine->scripts();
+
+        for (auto target : engine->targets()) {
+            for (auto block : target->blocks()) {
+                auto it = scripts.find(block);
+
+                if (it != scripts.cend())
+                    bytecodes[i].push_back(it->second->bytecodeVector());
+            }
+        }
+    }
+
+    ASSERT_FALSE(bytecodes[0].empty());
+    ASSERT_EQ(bytecodes[0], bytecodes[1]);
+}
+
+TEST(EngineTest, DeterministicCompilationWithEffects)
+{
+    // Custom graphics effects and warnings mustn't depend on the order in which the targets are compiled
+    auto effect1 = std::make_shared<GraphicsEffectMock>();
+    auto effect2 = std::make_shared<GraphicsEffectMock>();
+    EXPECT_CALL(*effect1, name()).WillRepeatedly(Return("custom1"));
+    EXPECT_CALL(*effect2, name()).WillRepeatedly(Return("custom2"));
+    ScratchConfiguration::registerGraphicsEffect(effect1);
+    ScratchConfiguration::registerGraphicsEffect(effect2);
+
+    struct Result
+    {
+            std::vector<std::vector<unsigned int>> bytecodes;
+            std::vector<std::pair<double, double>> effectValues;
+            std::string output;
+    };
+
+    auto compile = [&effect1, &effect2](bool parallel) {
+        Engine engine;
+        engine.setExtensions({});
+        engine.setParallelCompilationEnabled(parallel);
+        auto stage = std::make_shared<Stage>();
+        stage->setName("Stage");
+        std::vector<std::shared_ptr<Target>> targets = { stage };
+
+        for (int i = 0; i < 16; i++) {
+            // when flag clicked, change [custom1/custom2] effect by i, change [custom2/custom1] effect by -i, unsupported block
+            auto sprite = std::make_shared<Sprite>();
+            sprite->setName("Sprite" + std::to_string(i));
+            std::string id = std::to_string(i);
+            auto hat = std::make_shared<Block>("hat" + id, "event_whenflagclicked");
+            auto change = std::make_shared<Block>("change" + id, "looks_changeeffectby");
+            auto change2 = std::make_shared<Block>("change2" + id, "looks_changeeffectby");
+            auto unsupported = std::make_shared<Block>("unsupported" + id, "test_unsupported" + id);
+            hat->setNextId(change->id());
+            change->setParentId(hat->id());
+            change->setNextId(change2->id());
+            change2->setParentId(change->id());
+            change2->setNextId(unsupported->id());
+            unsupported->setParentId(change2->id());
+            change->addField(std::make_shared<Field>("EFFECT", i % 2 == 0 ? "custom1" : "custom2"));
+            change2->addField(std::make_shared<Field>("EFFECT", i % 2 == 0 ? "custom2" : "custom1"));
+            auto changeInput = std::make_shared<Input>("CHANGE", Input::Type::Shadow);
+            changeInput->primaryValue()->setValue(i);
+            change->addInput(changeInput);
+            auto change2Input = std::make_shared<Input>("CHANGE", Input::Type::Shadow);
+            change2Input->primaryValue()->setValue(-i);
+            change2->addInput(change2Input);
+            sprite->addBlock(hat);
+            sprite->addBlock(change);
+            sprite->addBlock(change2);
+            sprite->addBlock(unsupported);
+            targets.push_back(sprite);
+        }
+
+        engine.setTargets(targets);
+        Result result;
+        testing::internal::CaptureStdout();
+        engine.compile();
+        result.output = testing::internal::GetCapturedStdout();
+        engine.setLoggingEnabled(false);
+
+        for (auto target : engine.targets()) {
+            for (auto block : target->blocks()) {
+                auto it = engine.scripts().find(block);
+
+                if (it != engine.scripts().cend())
+                    result.bytecodes.push_back(it->second->bytecodeVector());
+            }
+        }
+
+        engine.start();
+        engine.step();
+
+        for (auto target : engine.targets())
+            result.effectValues.push_back({ target->graphicsEffectValue(effect1.get()), target->graphicsEffectValue(effect2.get()) });
+
+        return result;
+    };
+
+    Result sequential = compile(false);
+    ASSERT_EQ(sequential.bytecodes.size(), 16);
+    ASSERT_EQ(sequential.effectValues[4], std::make_pair(-3.0, 3.0)); // Sprite3
+    ASSERT_EQ(sequential.effectValues[5], std::make_pair(4.0, -4.0)); // Sprite4
+
+    std::string expectedOutput = "Processing target Stage...\n";
+
+    for (int i = 0; i < 16; i++)
+        expectedOutput += "Processing target Sprite" + std::to_string(i) + "...\n";
+
+    expectedOutput += "Compiling scripts in target Stage...\n";
+
+    for (int i = 0; i < 16; i++)
+        expectedOutput += "Compiling scripts in target Sprite" + std::to_string(i) + "...\nwarning: unsupported block: test_unsupported" + std::to_string(i) + "\n";
+
+    ASSERT_EQ(sequential.output, expectedOutput);
+
+    for (int i = 0; i < 10; i++) {
+        Result parallel = compile(true);
+        ASSERT_EQ(parallel.bytecodes, sequential.bytecodes);
+        ASSERT_EQ(parallel.effectValues, sequential.effectValues);
+        ASSERT_EQ(parallel.output, sequential.output);
+    }
+
+    ScratchConfiguration::removeGraphicsEffect("custom1");
+    ScratchConfiguration::removeGraphicsEffect("custom2");
+}
+
+TEST(EngineTest, InlineCacheSlots)
+{
+    Engine engine;
+    engine.setExtensions({});
+    engine.setParallelCompilationEnabled(true);
+    auto stage = std::make_shared<Stage>();
+    std::vector<std::shared_ptr<Target>> targets = { stage };
+    std::vector<std::pair<std::shared_ptr<Variable>, std::shared_ptr<Variable>>> variables;
+
+    // when flag clicked, set [distance] to (distance to (join [Spr] [ite...])), set [x] to ([x position] of (join [Spr] [ite...]))
+    // The set blocks are swapped in every other sprite, so the local function tables are different
+    for (int i = 0; i < 4; i++) {
+        auto sprite = std::make_shared<Sprite>();
+        sprite->setName("Sprite" + std::to_string(i));
+        sprite->setX(i * 3);
+        sprite->setY(i * 4);
+        auto distanceVar = std::make_shared<Variable>("d" + std::to_string(i), "distance");
+        auto xVar = std::make_shared<Variable>("x" + std::to_string(i), "x");
+        sprite->addVariable(distanceVar);
+        sprite->addVariable(xVar);
+        variables.push_back({ distanceVar, xVar });
+
+        std::string id = std::to_string(i);
+        std::string otherName = "ite" + std::to_string((i + 1) % 4);
+
+        auto join = [&sprite, &otherName](const std::string &id, const std::string &parentId) {
+            auto block = std::make_shared<Block>(id, "operator_join");
+            block->setParentId(parentId);
+            auto str1 = std::make_shared<Input>("STRING1", Input::Type::Shadow);
+            str1->primaryValue()->setValue("Spr");
+            block->addInput(str1);
+            auto str2 = std::make_shared<Input>("STRING2", Input::Type::Shadow);
+            str2->primaryValue()->setValue(otherName);
+            block->addInput(str2);
+            sprite->addBlock(block);
+            return block;
+        };
+
+        auto setVar = [&sprite](const std::string &id, std::shared_ptr<Variable> var, std::shared_ptr<Block> reporter) {
+            auto block = std::make_shared<Block>(id, "data_setvariableto");
+            block->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+            auto value = std::make_shared<Input>("VALUE", Input::Type::NoShadow);
+            value->setValueBlockId(reporter->id());
+            block->addInput(value);
+            reporter->setParentId(id);
+            sprite->addBlock(block);
+            return block;
+        };
+
+        auto distance = std::make_shared<Block>("distance" + id, "sensing_distanceto");
+        auto distanceMenu = std::make_shared<Input>("DISTANCETOMENU", Input::Type::ObscuredShadow);
+        distanceMenu->setValueBlockId(join("join1" + id, distance->id())->id());
+        distance->addInput(distanceMenu);
+        sprite->addBlock(distance);
+
+        auto xPosition = std::make_shared<Block>("xposition" + id, "sensing_of");
+        xPosition->addField(std::make_shared<Field>("PROPERTY", "x position"));
+        auto object = std::make_shared<Input>("OBJECT", Input::Type::ObscuredShadow);
+        object->setValueBlockId(join("join2" + id, xPosition->id())->id());
+        xPosition->addInput(object);
+        sprite->addBlock(xPosition);
+
+        auto hat = std::make_shared<Block>("hat" + id, "event_whenflagclicked");
+        auto set1 = setVar("set1" + id, distanceVar, distance);
+        auto set2 = setVar("set2" + id, xVar, xPosition);
+        auto first = (i % 2 == 0) ? set1 : set2;
+        auto second = (i % 2 == 0) ? set2 : set1;
+        hat->setNextId(first->id());
+        first->setParentId(hat->id());
+        first->setNextId(second->id());
+        second->setParentId(first->id());
+        sprite->addBlock(hat);
+
+        targets.push_back(sprite);
+    }
+
+    engine.setLoggingEnabled(false);
+    engine.setTargets(targets);
+    engine.compile();
+    ASSERT_EQ(engine.scripts().size(), 4);
+    engine.start();
+    engine.run();
+
+    for (int i = 0; i < 4; i++) {
+        int other = (i + 1) % 4;
+        ASSERT_EQ(variables[i].first->value().toDouble(), std::sqrt(std::pow((other - i) * 3, 2) + std::pow((other - i) * 4, 2)));
+        ASSERT_EQ(variables[i].second->value().toDouble(), other * 3);
+    }
+}
+
+// Creates a project with a script for each kind of hat and a custom block, which sets the variables of the stage to 1, 2, ...
+static void createCompiledProjectTest(Engine &engine)
+{
+    auto stage = std::make_shared<Stage>();
+    stage->setName("Stage");
+    stage->addCostume(std::make_shared<Costume>("backdrop1", "b1", "svg"));
+    stage->addCostume(std::make_shared<Costume>("backdrop2", "b2", "svg"));
+
+    for (int i = 1; i <= 5; i++)
+        stage->addVariable(std::make_shared<Variable>("v" + std::to_string(i), "var" + std::to_string(i)));
+
+    stage->addList(std::make_shared<List>("l", "list"));
+
+    auto sprite = std::make_shared<Sprite>();
+    sprite->setName("Sprite1");
+    sprite->addVariable(std::make_shared<Variable>("local", "local"));
+
+    auto addBlock = [&sprite](const std::string &id, const std::string &opcode, std::shared_ptr<Block> parent) {
+        auto block = std::make_shared<Block>(id, opcode);
+
+        if (parent) {
+            parent->setNextId(id);
+            block->setParentId(parent->id());
+        }
+
+        sprite->addBlock(block);
+        return block;
+    };
+
+    auto setVar = [&addBlock, &stage](const std::string &id, int var, std::shared_ptr<Block> parent) {
+        auto block = addBlock(id, "data_setvariableto", parent);
+        auto variable = stage->variableAt(var - 1);
+        block->addField(std::make_shared<Field>("VARIABLE", variable->name(), variable->id()));
+        auto input = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+        input->primaryValue()->setValue(var);
+        block->addInput(input);
+        return block;
+    };
+
+    // when flag clicked, set [var1] to 1, add [item] to [list], (custom block), broadcast [message]
+    auto flag = addBlock("flag", "event_whenflagclicked", nullptr);
+    auto set1 = setVar("set1", 1, flag);
+    auto add = addBlock("add", "data_addtolist", set1);
+    add->addField(std::make_shared<Field>("LIST", "list", "l"));
+    auto item = std::make_shared<Input>("ITEM", Input::Type::Shadow);
+    item->primaryValue()->setValue("item");
+    add->addInput(item);
+    auto call = addBlock("call", "procedures_call", add);
+    call->mutationPrototype()->setProcCode("custom");
+    auto broadcast = addBlock("broadcast", "event_broadcast", call);
+    auto broadcastInput = std::make_shared<Input>("BROADCAST_INPUT", Input::Type::Shadow);
+    broadcastInput->primaryValue()->setValue("message");
+    broadcast->addInput(broadcastInput);
+
+    // when I receive [message], set [var2] to 2
+    auto received = addBlock("received", "event_whenbroadcastreceived", nullptr);
+    received->addField(std::make_shared<Field>("BROADCAST_OPTION", "message", "m"));
+    setVar("set2", 2, received);
+
+    // when [space] key pressed, set [var3] to 3, switch backdrop to [backdrop2]
+    auto key = addBlock("key", "event_whenkeypressed", nullptr);
+    key->addField(std::make_shared<Field>("KEY_OPTION", "space"));
+    auto set3 = setVar("set3", 3, key);
+    auto switchBackdrop = addBlock("switch", "looks_switchbackdropto", set3);
+    auto menu = std::make_shared<Block>("menu", "looks_backdrops");
+    menu->setParentId(switchBackdrop->id());
+    menu->setShadow(true);
+    menu->addField(std::make_shared<Field>("BACKDROP", "backdrop2"));
+    sprite->addBlock(menu);
+    auto backdropInput = std::make_shared<Input>("BACKDROP", Input::Type::Shadow);
+    backdropInput->setValueBlockId(menu->id());
+    switchBackdrop->addInput(backdropInput);
+
+    // when backdrop switches to [backdrop2], set [var4] to 4
+    auto backdrop = addBlock("backdrop", "event_whenbackdropswitchesto", nullptr);
+    backdrop->addField(std::make_shared<Field>("BACKDROP", "backdrop2"));
+    setVar("set4", 4, backdrop);
+
+    // define (custom), set [var5] to 5
+    auto definition = addBlock("definition", "procedures_definition", nullptr);
+    auto prototype = std::make_shared<Block>("prototype", "procedures_prototype");
+    prototype->setParentId(definition->id());
+    prototype->mutationPrototype()->setProcCode("custom");
+    sprite->addBlock(prototype);
+    auto customBlock = std::make_shared<Input>("custom_block", Input::Type::Shadow);
+    customBlock->setValueBlockId(prototype->id());
+    definition->addInput(customBlock);
+    setVar("set5", 5, definition);
+
+    engine.setExtensions({});
+    engine.setLoggingEnabled(false);
+    engine.setTargets({ stage, sprite });
+    engine.setBroadcasts({ std::make_shared<Broadcast>("m", "message") });
+}
+
+static std::vector<std::vector<unsigned int>> compiledProjectBytecodes(Engine &engine)
+{
+    std::vector<std::vector<unsigned int>> ret;
+
+    for (auto target : engine.targets()) {
+        for (auto block : target->blocks()) {
+            auto it = engine.scripts().find(block);
+
+            if (it != engine.scripts().cend())
+                ret.push_back(it->second->bytecodeVector());
+        }
+    }
+
+    return ret;
+}
+
+static void runCompiledProjectTest(Engine &engine)
+{
+    Stage *stage = engine.stage();
+    engine.run();
+    ASSERT_EQ(stage->variableAt(0)->value().toInt(), 1);
+    ASSERT_EQ(stage->variableAt(1)->value().toInt(), 2);
+    ASSERT_EQ(stage->variableAt(2)->value().toInt(), 0);
+    ASSERT_EQ(stage->variableAt(3)->value().toInt(), 0);
+    ASSERT_EQ(stage->variableAt(4)->value().toInt(), 5);
+    ASSERT_EQ(stage->listAt(0)->toString(), "item");
+
+    engine.setKeyState("space", true);
+    engine.run();
+    ASSERT_EQ(stage->variableAt(2)->value().toInt(), 3);
+    ASSERT_EQ(stage->variableAt(3)->value().toInt(), 4);
+}
+
+TEST(EngineTest, CompiledProject)
+{
+    Engine engine1;
+    createCompiledProjectTest(engine1);
+    CompiledProject compiledProject;
+    ASSERT_TRUE(engine1.compile(compiledProject));
+    ASSERT_EQ(compiledProject.targets.size(), 2);
+    ASSERT_TRUE(compiledProject.targets[0].scripts.empty());
+    ASSERT_EQ(compiledProject.targets[1].scripts.size(), 5);
+    ASSERT_EQ(compiledProject.targets[1].procedureCodes, std::vector<std::string>({ "custom" }));
+    ASSERT_EQ(compiledProject.targets[1].hats.size(), 3);
+
+    // Entities are stored by index
+    const auto &variables = compiledProject.targets[1].variables;
+    ASSERT_FALSE(variables.empty());
+
+    for (const auto &variable : variables)
+        ASSERT_EQ(variable.target, 0);
+
+    ASSERT_EQ(compiledProject.targets[1].lists.size(), 1);
+    ASSERT_EQ(compiledProject.targets[1].lists[0].target, 0);
+    ASSERT_EQ(compiledProject.targets[1].lists[0].index, 0);
+
+    // Functions are stored by section and order of registration
+    const auto &sections = compiledProject.sections;
+    ASSERT_FALSE(compiledProject.targets[1].functions.empty());
+
+    for (const auto &function : compiledProject.targets[1].functions)
+        ASSERT_NE(std::find(sections.begin(), sections.end(), function.section), sections.end());
+
+    auto bytecodes = compiledProjectBytecodes(engine1);
+    runCompiledProjectTest(engine1);
+
+    // Loading the compiled project gives the same scripts
+    Engine engine2;
+    createCompiledProjectTest(engine2);
+    ASSERT_TRUE(engine2.loadCompiledProject(compiledProject));
+    ASSERT_EQ(compiledProjectBytecodes(engine2), bytecodes);
+    runCompiledProjectTest(engine2);
+}
+
+TEST(EngineTest, InvalidCompiledProject)
+{
+    Engine engine1;
+    createCompiledProjectTest(engine1);
+    CompiledProject compiledProject;
+    ASSERT_TRUE(engine1.compile(compiledProject));
+
+    auto load = [](const CompiledProject &compiledProject) {
+        Engine engine;
+        createCompiledProjectTest(engine);
+        testing::internal::CaptureStderr();
+        bool ret = engine.loadCompiledProject(compiledProject);
+        testing::internal::GetCapturedStderr();
+
+        if (!ret)
+            EXPECT_TRUE(engine.scripts().empty());
+
+        return ret;
+    };
+
+    ASSERT_TRUE(load(compiledProject));
+
+    // Sections and graphics effects must be registered in the same order (their indices are stored in the bytecode)
+    CompiledProject invalid = compiledProject;
+    std::swap(invalid.sections[0], invalid.sections[1]);
+    ASSERT_FALSE(load(invalid));
+
+    invalid = compiledProject;
+    invalid.graphicsEffects.push_back("test");
+    ASSERT_FALSE(load(invalid));
+
+    // Targets
+    invalid = compiledProject;
+    invalid.targets.pop_back();
+    ASSERT_FALSE(load(invalid));
+
+    // Scripts
+    invalid = compiledProject;
+    invalid.targets[1].scripts[0].blockId = "set1";
+    ASSERT_FALSE(load(invalid));
+
+    invalid = compiledProject;
+    invalid.targets[1].scripts[0].bytecode.pop_back();
+    ASSERT_FALSE(load(invalid));
+
+    invalid = compiledProject;
+    invalid.targets[1].constValues.clear();
+    ASSERT_FALSE(load(invalid));
+
+    // Functions
+    invalid = compiledProject;
+    invalid.targets[1].functions[0].index = 100;
+    ASSERT_FALSE(load(invalid));
+
+    invalid = compiledProject;
+    invalid.targets[1].functions[0].section = "Test";
+    ASSERT_FALSE(load(invalid));
+
+    // Variables
+    invalid = compiledProject;
+    invalid.targets[1].variables[0].index = 100;
+    ASSERT_FALSE(load(invalid));
+
+    // Hats
+    invalid = compiledProject;
+    invalid.targets[1].hats[0].blockId = "set1";
+    ASSERT_FALSE(load(invalid));
+
+    invalid = compiledProject;
+
+    for (auto &hat : invalid.targets[1].hats) {
+        hat.broadcast = -1;
+        hat.backdrop = -1;
+    }
+
+    ASSERT_FALSE(load(invalid));
+}
+
+unsigned int unregisteredFunction(VirtualMachine *)
+{
+    return 0;
+}
+
+void compileUnregisteredFunction(Compiler *compiler)
+{
+    compiler->addFunctionCall(&unregisteredFunction);
+}
+
+TEST(EngineTest, CompiledProjectWithUnregisteredFunction)
+{
+    // Scripts which call functions that aren't registered using addFunction() can't be stored
+    Engine engine;
+    createCompiledProjectTest(engine);
+    auto section = std::make_shared<TestSection>();
+    engine.registerSection(section);
+    engine.addCompileFunction(section.get(), "test_block", &compileUnregisteredFunction);
+
+    auto sprite = engine.targetAt(1);
+    auto block = std::make_shared<Block>("test", "test_block");
+    block->setParentId("set1");
+    block->setNextId("add");
+    sprite->blockAt(sprite->findBlock("set1"))->setNextId("test");
+    sprite->blockAt(sprite->findBlock("add"))->setParentId("test");
+    sprite->addBlock(block);
+    engine.setTargets(engine.targets());
+
+    CompiledProject compiledProject;
+    ASSERT_FALSE(engine.compile(compiledProject));
+    ASSERT_TRUE(compiledProject.targets.empty());
+
+    // The scripts are compiled anyway
+    ASSERT_EQ(engine.scripts().size(), 5);
+    runCompiledProjectTest(engine);
+}
+
+TEST(EngineTest, Recompile)
+{
+    Project p("default_project.sb3");
+    ASSERT_TRUE(p.load());
+
+    auto engine = p.engine();
+    Stage *stage = engine->stage();
+    ASSERT_TRUE(stage);
+    ASSERT_EQ(stage->variables().size(), 1);
+    auto var = stage->variableAt(0);
+    ASSERT_TRUE(engine->scripts().empty());
+
+    // Add a script
+    auto hat = std::make_shared<Block>("hat", "event_whenflagclicked");
+    auto setBlock = std::make_shared<Block>("set", "data_setvariableto");
+    hat->setNextId("set");
+    setBlock->setParentId("hat");
+    setBlock->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+    auto input = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+    input->primaryValue()->setValue(5);
+    setBlock->addInput(input);
+    stage->addBlock(hat);
+    stage->addBlock(setBlock);
+
+    engine->recompile(stage, { hat, setBlock });
+    ASSERT_EQ(engine->scripts().size(), 1);
+    auto script = engine->scripts().at(hat).get();
+    p.run();
+    ASSERT_EQ(var->value().toInt(), 5);
+
+    // Change a block
+    input->primaryValue()->setValue(10);
+    engine->recompile(stage, { setBlock });
+    ASSERT_EQ(engine->scripts().size(), 1);
+    ASSERT_EQ(engine->scripts().at(hat).get(), script);
+    p.run();
+    ASSERT_EQ(var->value().toInt(), 10);
+
+    // Remove a block
+    var->setValue(0);
+    ASSERT_TRUE(stage->removeBlock(setBlock));
+    hat->setNextId("");
+    engine->recompile(stage, { hat }, { setBlock });
+    ASSERT_EQ(engine->scripts().size(), 1);
+    ASSERT_EQ(hat->next(), nullptr);
+    p.run();
+    ASSERT_EQ(var->value().toInt(), 0);
+
+    // Remove the script
+    ASSERT_TRUE(stage->removeBlock(hat));
+    engine->recompile(stage, {}, { hat });
+    ASSERT_TRUE(engine->scripts().empty());
+    p.run();
+    ASSERT_EQ(var->value().toInt(), 0);
+}
+
+TEST(EngineTest, RecompileRunningScript)
+{
+    Engine engine;
+    engine.setExtensions({});
+    auto stage = std::make_shared<Stage>();
+    auto var = std::make_shared<Variable>("v", "var", 0);
+    stage->addVariable(var);
+
+    // when flag clicked, forever { change var by 1 }
+    auto hat = std::make_shared<Block>("hat", "event_whenflagclicked");
+    auto forever = std::make_shared<Block>("forever", "control_forever");
+    auto changeBlock = std::make_shared<Block>("change", "data_changevariableby");
+    hat->setNextId("forever");
+    forever->setParentId("hat");
+    auto substack = std::make_shared<Input>("SUBSTACK", Input::Type::NoShadow);
+    substack->setValueBlockId("change");
+    forever->addInput(substack);
+    changeBlock->setParentId("forever");
+    changeBlock->addField(std::make_shared<Field>("VARIABLE", var->name(), var->id()));
+    auto input = std::make_shared<Input>("VALUE", Input::Type::Shadow);
+    input->primaryValue()->setValue(1);
+    changeBlock->addInput(input);
+    stage->addBlock(hat);
+    stage->addBlock(forever);
+    stage->addBlock(changeBlock);
+
+    engine.setTargets({ stage });
+    engine.compile();
+    engine.setLoggingEnabled(false);
+
+    engine.start();
+    engine.step(1);
+    int value = var->value().toInt();
+    ASSERT_GT(value, 0);
+
+    // The running script uses the old bytecode, so it's stopped right away
+    input->primaryValue()->setValue(1000);
+    engine.recompile(stage.get(), { changeBlock });
+    engine.step(2);
+    ASSERT_EQ(var->value().toInt(), value);
+
+    // Scripts which haven't run yet are stopped too
+    engine.start();
+    input->primaryValue()->setValue(-1000);
+    engine.recompile(stage.get(), { changeBlock });
+    engine.step(2);
+    ASSERT_EQ(var->value().toInt(), value);
+
+    // The recompiled script runs
+    engine.start();
+    engine.step(1);
+    value = var->value().toInt();
+    ASSERT_LT(value, 0);
+
+    // Removed scripts are deleted and stopped right away
+    ASSERT_TRUE(stage->removeBlock(hat));
+    engine.recompile(stage.get(), {}, { hat });
+    ASSERT_TRUE(engine.scripts().empty());
+    engine.step(2);
+    ASSERT_EQ(var->value().toInt(), value);
+}
+
+TEST(EngineTest, LoggingEnabled)
+{
+    Engine engine;
+    ASSERT_TRUE(engine.loggingEnabled());
+
+    engine.setLoggingEnabled(false);
+    ASSERT_FALSE(engine.loggingEnabled());
+
+    engine.setLoggingEnabled(true);
+    ASSERT_TRUE(engine.loggingEnabled());
+}
+
 TEST(EngineTest, TurboModeEnabled)
 {
     Engine engine;
@@ -549,6 +1644,100 @@ TEST(EngineTest, SpriteFencingEnabled)
     ASSERT_TRUE(engine.spriteFencingEnabled());
 }
 
+TEST(EngineTest, BatchedSpriteNotifications)
+{
+    Engine engine;
+    ASSERT_FALSE(engine.batchedSpriteNotificationsEnabled());
+
+    auto stage = std::make_shared<Stage>();
+    auto sprite = std::make_shared<Sprite>();
+    engine.setTargets({ stage, sprite });
+    engine.setSpriteFencingEnabled(false);
+    SpriteHandlerMock handler;
+    EXPECT_CALL(handler, init(sprite.get()));
+    sprite->setInterface(&handler);
+
+    engine.setBatchedSpriteNotificationsEnabled(true);
+    ASSERT_TRUE(engine.batchedSpriteNotificationsEnabled());
+
+    EXPECT_CALL(handler, onXChanged).Times(0);
+    EXPECT_CALL(handler, onDirectionChanged).Times(0);
+    sprite->setX(1);
+    sprite->setX(2);
+    sprite->setDirection(45);
+
+    // The changes are sent once, right before the redraw handler
+    SpriteChanges changes;
+    bool redrawn = false;
+    engine.setRedrawHandler([&redrawn]() { redrawn = true; });
+    EXPECT_CALL(handler, onChanged(_)).WillOnce([&changes, &redrawn](const SpriteChanges &c) {
+        ASSERT_FALSE(redrawn);
+        changes = c;
+    });
+    engine.step(1);
+    ASSERT_TRUE(redrawn);
+    ASSERT_EQ(changes.sprite(), sprite.get());
+    ASSERT_TRUE(changes.changed(SpriteChanges::Property::X));
+    ASSERT_TRUE(changes.changed(SpriteChanges::Property::Direction));
+    ASSERT_FALSE(changes.changed(SpriteChanges::Property::Y));
+
+    // Nothing has changed
+    EXPECT_CALL(handler, onChanged).Times(0);
+    engine.step(1);
+
+    // Disabling batched notifications sends the remaining changes
+    sprite->setY(3);
+    EXPECT_CALL(handler, onChanged(_)).WillOnce(SaveArg<0>(&changes));
+    engine.setBatchedSpriteNotificationsEnabled(false);
+    ASSERT_TRUE(changes.changed(SpriteChanges::Property::Y));
+    ASSERT_FALSE(changes.changed(SpriteChanges::Property::X));
+
+    EXPECT_CALL(handler, onYChanged(4));
+    sprite->setY(4);
+}
+
+TEST(EngineTest, SpriteTransformStore)
+{
+    Engine engine;
+    ASSERT_FALSE(engine.spriteTransformStoreEnabled());
+
+    auto stage = std::make_shared<Stage>();
+    auto sprite = std::make_shared<Sprite>();
+    sprite->setX(10);
+    sprite->setSize(50);
+    engine.setTargets({ stage, sprite });
+
+    engine.setSpriteTransformStoreEnabled(true);
+    ASSERT_TRUE(engine.spriteTransformStoreEnabled());
+    ASSERT_EQ(sprite->x(), 10);
+    ASSERT_EQ(sprite->size(), 50);
+    sprite->setDirection(-90);
+    sprite->setVisible(false);
+
+    auto clone = sprite->clone();
+    ASSERT_TRUE(clone);
+    ASSERT_EQ(clone->x(), 10);
+    ASSERT_EQ(clone->direction(), -90);
+    ASSERT_FALSE(clone->visible());
+    clone->setY(20);
+    ASSERT_EQ(clone->y(), 20);
+    ASSERT_EQ(sprite->y(), 0);
+
+    engine.setSpriteTransformStoreEnabled(false);
+    ASSERT_FALSE(engine.spriteTransformStoreEnabled());
+    ASSERT_EQ(sprite->x(), 10);
+    ASSERT_EQ(sprite->direction(), -90);
+    ASSERT_FALSE(sprite->visible());
+    ASSERT_EQ(clone->y(), 20);
+
+    // Deleted clones leave the store
+    engine.setSpriteTransformStoreEnabled(true);
+    clone->setX(-5);
+    clone->deleteClone();
+    engine.setSpriteTransformStoreEnabled(false);
+    ASSERT_EQ(clone->x(), -5);
+}
+
 TEST(EngineTest, Timer)
 {
     Engine engine;
@@ -588,6 +1777,16 @@ TEST(EngineTest, Sections)
         ASSERT_EQ(engine.registeredSections()[0].get(), section2.get());
         ASSERT_EQ(engine.registeredSections()[1].get(), section1.get());
     }
+
+    int index = engine.findSection(section1->name());
+    ASSERT_EQ(engine.sectionAt(index), section1.get()); // the first section with the name is returned
+    ASSERT_EQ(engine.findSection("nonexistent"), -1);
+    ASSERT_EQ(engine.sectionAt(-1), nullptr);
+    ASSERT_EQ(engine.sectionAt(2), nullptr);
+
+    engine.clear();
+    ASSERT_EQ(engine.findSection(section1->name()), -1);
+    ASSERT_EQ(engine.sectionAt(index), nullptr);
 }
 
 unsigned int testFunction1(VirtualMachine *)
@@ -775,6 +1974,14 @@ TEST(EngineTest, Broadcasts)
     ASSERT_EQ(engine.findBroadcastById("a"), 0);
     ASSERT_EQ(engine.findBroadcastById("b"), 1);
     ASSERT_EQ(engine.findBroadcastById("c"), 2);
+
+    // Renamed broadcasts
+    b2->setName("message3");
+    b3->setId("e");
+    ASSERT_EQ(engine.findBroadcast("message2"), -1);
+    ASSERT_EQ(engine.findBroadcast("message3"), 1);
+    ASSERT_EQ(engine.findBroadcastById("c"), -1);
+    ASSERT_EQ(engine.findBroadcastById("e"), 2);
 }
 
 TEST(EngineTest, Targets)
@@ -817,6 +2024,25 @@ TEST(EngineTest, Targets)
     ASSERT_EQ(engine.findTarget("Stage"), 3);
     ASSERT_EQ(engine.findTarget("_stage_"), 2);
 
+    // Renamed targets
+    t2->setName("Sprite3");
+    ASSERT_EQ(engine.findTarget("Sprite2"), -1);
+    ASSERT_EQ(engine.findTarget("Sprite3"), 1);
+    t2->setName("Sprite2");
+
+    // Renaming a target of another engine doesn't invalidate the indices of this engine
+    Engine otherEngine;
+    auto t5 = std::make_shared<Target>();
+    otherEngine.setTargets({ t5 });
+    const NameIndexGroup *group = NameIndexGroup::root(t1.get());
+    unsigned int generation = group->generation();
+    unsigned int epoch = group->epoch();
+    t5->setName("Sprite1");
+    ASSERT_EQ(group->generation(), generation);
+    ASSERT_EQ(group->epoch(), epoch);
+    ASSERT_EQ(engine.findTarget("Sprite1"), 0);
+    ASSERT_EQ(otherEngine.findTarget("Sprite1"), 0);
+
     ASSERT_EQ(t1->engine(), &engine);
     ASSERT_EQ(t2->engine(), &engine);
     ASSERT_EQ(t3->engine(), &engine);
@@ -1145,6 +2371,168 @@ TEST(EngineTest, CloneLimit)
     ASSERT_EQ(engine->cloneCount(), 0);
 }
 
+static void checkLayerOrders(const std::vector<Sprite *> &sprites)
+{
+    std::vector<int> layers;
+
+    for (Sprite *sprite : sprites)
+        layers.push_back(sprite->layerOrder());
+
+    std::sort(layers.begin(), layers.end());
+
+    for (size_t i = 0; i < layers.size(); i++)
+        ASSERT_EQ(layers[i], i + 1);
+}
+
+TEST(EngineTest, SpawnClones)
+{
+    Engine engine;
+    auto stage = std::make_shared<Stage>();
+    auto sprite1 = std::make_shared<Sprite>();
+    sprite1->setLayerOrder(1);
+    auto sprite2 = std::make_shared<Sprite>();
+    sprite2->setLayerOrder(2);
+
+    for (int i = 0; i < 10; i++) {
+        sprite1->addVariable(std::make_shared<Variable>("v" + std::to_string(i), "var" + std::to_string(i), i));
+        sprite1->addList(std::make_shared<List>("l" + std::to_string(i), "list" + std::to_string(i)));
+    }
+
+    engine.setTargets({ stage, sprite1, sprite2 });
+    engine.compile();
+    ASSERT_EQ(engine.cloneLimit(), 300);
+
+    std::vector<Sprite *> sprites = { sprite1.get(), sprite2.get() };
+    std::vector<std::shared_ptr<Sprite>> clones;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < 300; i++) {
+        // Create clones of clones too
+        Sprite *source = (i % 2 == 0 || clones.empty()) ? sprite1.get() : clones[i / 2].get();
+        auto clone = source->clone();
+        ASSERT_TRUE(clone);
+        clones.push_back(clone);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Spawned 300 clones in " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " us" << std::endl;
+
+    ASSERT_EQ(engine.cloneCount(), 300);
+    ASSERT_EQ(sprite1->clone(), nullptr);
+
+    for (auto clone : clones) {
+        sprites.push_back(clone.get());
+        ASSERT_EQ(clone->cloneSprite(), sprite1.get());
+        ASSERT_LT(clone->layerOrder(), sprite1->layerOrder());
+
+        // Every clone has its own copy of the variables and lists at the same indexes
+        for (int i = 0; i < 10; i++) {
+            ASSERT_EQ(clone->variableAt(i)->id(), sprite1->variableAt(i)->id());
+            ASSERT_NE(clone->variableAt(i), sprite1->variableAt(i));
+            ASSERT_EQ(clone->listAt(i)->id(), sprite1->listAt(i)->id());
+            ASSERT_NE(clone->listAt(i), sprite1->listAt(i));
+        }
+    }
+
+    checkLayerOrders(sprites);
+    ASSERT_EQ(sprite1->layerOrder(), 301);
+    ASSERT_EQ(sprite2->layerOrder(), 302);
+
+    // A new clone is placed right behind the sprite it was created from
+    clones[0]->deleteClone();
+    clones[0] = clones[10]->clone();
+    sprites[2] = clones[0].get();
+    ASSERT_EQ(clones[0]->layerOrder(), clones[10]->layerOrder() - 1);
+    checkLayerOrders(sprites);
+
+    for (int i = 0; i < 150; i++)
+        clones[i * 2]->deleteClone();
+
+    sprites = { sprite1.get(), sprite2.get() };
+
+    for (int i = 0; i < 150; i++)
+        sprites.push_back(clones[i * 2 + 1].get());
+
+    ASSERT_EQ(engine.cloneCount(), 150);
+    checkLayerOrders(sprites);
+}
+
+TEST(EngineTest, ClonePool)
+{
+    Engine engine;
+    ASSERT_EQ(engine.clonePoolLimit(), 300);
+    engine.setClonePoolLimit(-5);
+    ASSERT_EQ(engine.clonePoolLimit(), 0);
+    engine.setClonePoolLimit(2);
+    ASSERT_EQ(engine.clonePoolLimit(), 2);
+
+    auto stage = std::make_shared<Stage>();
+    auto sprite = std::make_shared<Sprite>();
+    auto var = std::make_shared<Variable>("v", "var", 5);
+    sprite->addVariable(var);
+    auto list = std::make_shared<List>("l", "list");
+    list->push_back(1);
+    list->push_back(2);
+    sprite->addList(list);
+    engine.setTargets({ stage, sprite });
+    engine.compile();
+
+    auto clone1 = sprite->clone();
+    auto clone2 = sprite->clone();
+    auto clone3 = sprite->clone();
+    ASSERT_EQ(engine.clonePoolHits(), 0);
+    ASSERT_EQ(engine.clonePoolMisses(), 3);
+
+    Sprite *clone1Ptr = clone1.get();
+    clone1->variableAt(0)->setValue("test");
+    clone1->listAt(0)->push_back(3);
+    clone1->setGraphicsEffectValue(reinterpret_cast<IGraphicsEffect *>(1), 50);
+    clone1->deleteClone();
+    clone2->deleteClone();
+    clone3->deleteClone(); // the pool is full
+    clone1.reset();
+    clone2.reset();
+    clone3.reset();
+    ASSERT_EQ(engine.cloneCount(), 0);
+
+    // A deleted clone is reused and gets the data of the sprite it's created from
+    var->setValue(10);
+    auto clone4 = sprite->clone();
+    auto clone5 = sprite->clone();
+    ASSERT_EQ(engine.clonePoolHits(), 2);
+    ASSERT_EQ(engine.clonePoolMisses(), 3);
+    ASSERT_TRUE(clone4->isClone());
+    ASSERT_EQ(clone5.get(), clone1Ptr);
+    ASSERT_EQ(clone5->cloneSprite(), sprite.get());
+    ASSERT_EQ(clone5->variables().size(), 1);
+    ASSERT_EQ(clone5->variableAt(0)->value().toInt(), 10);
+    ASSERT_NE(clone5->variableAt(0), var);
+    ASSERT_EQ(clone5->lists().size(), 1);
+    ASSERT_EQ(clone5->listAt(0)->size(), 2);
+    ASSERT_EQ((*clone5->listAt(0))[1].toInt(), 2);
+    ASSERT_NE(clone5->listAt(0), list);
+    ASSERT_EQ(clone5->graphicsEffectValue(reinterpret_cast<IGraphicsEffect *>(1)), 0);
+    ASSERT_EQ(sprite->clones().size(), 2);
+    ASSERT_EQ(engine.cloneCount(), 2);
+
+    // Clones which are still referenced aren't reused
+    clone4->deleteClone();
+    auto clone6 = sprite->clone();
+    ASSERT_NE(clone6, clone4);
+    ASSERT_EQ(engine.clonePoolHits(), 2);
+    ASSERT_EQ(engine.clonePoolMisses(), 4);
+
+    // Disabled pool
+    engine.setClonePoolLimit(0);
+    clone5->deleteClone();
+    clone5.reset();
+    auto clone7 = sprite->clone();
+    ASSERT_TRUE(clone7);
+    ASSERT_EQ(engine.clonePoolHits(), 2);
+    ASSERT_EQ(engine.clonePoolMisses(), 5);
+}
+
 TEST(EngineTest, BackdropBroadcasts)
 {
     // TODO: Set "infinite" FPS (#254)
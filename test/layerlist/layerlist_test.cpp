@@ -0,0 +1,108 @@
+#include <scratchcpp/sprite.h>
+
+#include "engine/internal/layerlist.h"
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(LayerListTest, InsertRemove)
+{
+    LayerList list;
+    ASSERT_TRUE(list.empty());
+    ASSERT_EQ(list.size(), 0);
+    ASSERT_EQ(list.at(0), nullptr);
+
+    Sprite s1, s2, s3, s4;
+    list.append(&s1);
+    list.append(&s2);
+    list.insert(1, &s3);
+    list.insert(100, &s4);
+
+    ASSERT_FALSE(list.empty());
+    ASSERT_EQ(list.size(), 4);
+    ASSERT_EQ(list.at(0), &s1);
+    ASSERT_EQ(list.at(1), &s3);
+    ASSERT_EQ(list.at(2), &s2);
+    ASSERT_EQ(list.at(3), &s4);
+    ASSERT_EQ(list.at(4), nullptr);
+
+    ASSERT_EQ(list.indexOf(&s1), 0);
+    ASSERT_EQ(list.indexOf(&s3), 1);
+    ASSERT_EQ(list.indexOf(&s2), 2);
+    ASSERT_EQ(list.indexOf(&s4), 3);
+    ASSERT_EQ(s2.layerOrder(), 2);
+
+    ASSERT_TRUE(list.remove(&s3));
+    ASSERT_FALSE(list.remove(&s3));
+    ASSERT_FALSE(list.contains(&s3));
+    ASSERT_EQ(list.indexOf(&s3), -1);
+    ASSERT_EQ(s3.layerOrder(), 1); // the last layer is kept
+    ASSERT_EQ(list.size(), 3);
+    ASSERT_EQ(s2.layerOrder(), 1);
+    ASSERT_EQ(s4.layerOrder(), 2);
+
+    list.clear();
+    ASSERT_TRUE(list.empty());
+    ASSERT_EQ(s1.layerOrder(), 0);
+    ASSERT_EQ(s2.layerOrder(), 1);
+    ASSERT_EQ(s4.layerOrder(), 2);
+
+    s1.setLayerOrder(5);
+    ASSERT_EQ(s1.layerOrder(), 5);
+}
+
+TEST(LayerListTest, Move)
+{
+    LayerList list;
+    std::vector<std::shared_ptr<Sprite>> sprites;
+
+    for (int i = 0; i < 100; i++) {
+        sprites.push_back(std::make_shared<Sprite>());
+        list.append(sprites.back().get());
+    }
+
+    ASSERT_TRUE(list.move(sprites[10].get(), 99));
+    ASSERT_EQ(sprites[10]->layerOrder(), 99);
+    ASSERT_EQ(sprites[11]->layerOrder(), 10);
+    ASSERT_EQ(sprites[99]->layerOrder(), 98);
+
+    ASSERT_TRUE(list.move(sprites[50].get(), 0));
+    ASSERT_EQ(list.at(0), sprites[50].get());
+    ASSERT_EQ(sprites[0]->layerOrder(), 1);
+
+    for (size_t i = 0; i < list.size(); i++)
+        ASSERT_EQ(list.at(i)->layerOrder(), i);
+
+    Sprite other;
+    ASSERT_FALSE(list.move(&other, 0));
+    ASSERT_FALSE(list.move(nullptr, 0));
+}
+
+TEST(LayerListTest, DestroyTarget)
+{
+    LayerList list;
+    auto s1 = std::make_shared<Sprite>();
+    auto s2 = std::make_shared<Sprite>();
+    auto s3 = std::make_shared<Sprite>();
+    list.append(s1.get());
+    list.append(s2.get());
+    list.append(s3.get());
+
+    s2.reset();
+    ASSERT_EQ(list.size(), 2);
+    ASSERT_EQ(list.at(1), s3.get());
+    ASSERT_EQ(s3->layerOrder(), 1);
+}
+
+TEST(LayerListTest, MultipleLists)
+{
+    LayerList list1, list2;
+    Sprite sprite;
+    list1.append(&sprite);
+
+    ASSERT_TRUE(list1.contains(&sprite));
+    ASSERT_FALSE(list2.contains(&sprite));
+    ASSERT_EQ(list2.indexOf(&sprite), -1);
+    ASSERT_FALSE(list2.remove(&sprite));
+    ASSERT_EQ(list1.size(), 1);
+}
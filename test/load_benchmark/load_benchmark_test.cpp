@@ -0,0 +1,307 @@
+#include <scratchcpp/stage.h>
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/block.h>
+#include <scratchcpp/field.h>
+#include <scratchcpp/input.h>
+#include <scratchcpp/inputvalue.h>
+#include <scratchcpp/variable.h>
+#include <scratchcpp/costume.h>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+#include "../common.h"
+#include "engine/internal/engine.h"
+#include "internal/scratch3reader.h"
+#include "internal/projectcache.h"
+#include "projectgenerator.h"
+#include "loadbenchmark.h"
+
+using namespace libscratchcpp;
+
+static const int TARGET_COUNT = 10;
+static const int BLOCKS_PER_TARGET = 10000;
+static const int SCRIPT_LENGTH = 100;
+
+// Returns project.json of a project with BLOCKS_PER_TARGET blocks in each target
+static std::string projectJson()
+{
+    std::string json = "{\"targets\":[";
+
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        std::string prefix = "t" + std::to_string(i) + "_";
+
+        if (i > 0)
+            json += ",";
+
+        json += "{\"isStage\":" + std::string(i == 0 ? "true" : "false") + ",\"name\":\"" + (i == 0 ? "Stage" : "Sprite" + std::to_string(i)) + "\",";
+        json += "\"variables\":{\"" + prefix + "var\":[\"var\",0]},\"lists\":{},\"broadcasts\":{},\"blocks\":{";
+
+        for (int j = 0; j < BLOCKS_PER_TARGET; j++) {
+            std::string id = prefix + std::to_string(j);
+            std::string next = ((j + 1) % SCRIPT_LENGTH == 0) ? "null" : "\"" + prefix + std::to_string(j + 1) + "\"";
+            std::string parent = (j % SCRIPT_LENGTH == 0) ? "null" : "\"" + prefix + std::to_string(j - 1) + "\"";
+
+            if (j > 0)
+                json += ",";
+
+            json += "\"" + id + "\":{\"opcode\":\"data_setvariableto\",\"next\":" + next + ",\"parent\":" + parent;
+            json += ",\"inputs\":{\"VALUE\":[1,[10,\"" + std::to_string(j) + "\"]]},\"fields\":{\"VARIABLE\":[\"var\",\"" + prefix + "var\"]}";
+            json += ",\"shadow\":false,\"topLevel\":" + std::string(j % SCRIPT_LENGTH == 0 ? "true" : "false") + "}";
+        }
+
+        json += "},\"comments\":{},\"currentCostume\":0,\"costumes\":[],\"sounds\":[],\"volume\":100,\"layerOrder\":" + std::to_string(i);
+
+        if (i == 0)
+            json += ",\"tempo\":60}";
+        else
+            json += ",\"visible\":true,\"x\":0,\"y\":0,\"size\":100,\"direction\":90,\"draggable\":false,\"rotationStyle\":\"all around\"}";
+    }
+
+    json += "],\"monitors\":[],\"extensions\":[],\"meta\":{\"semver\":\"3.0.0\"}}";
+    return json;
+}
+
+// Creates a target with BLOCKS_PER_TARGET blocks split into scripts of SCRIPT_LENGTH blocks
+static void fillTarget(Target *target, int index)
+{
+    std::string prefix = "t" + std::to_string(index) + "_";
+    auto var = std::make_shared<Variable>(prefix + "var", "var");
+    target->addVariable(var);
+
+    for (int i = 0; i < BLOCKS_PER_TARGET; i++) {
+        auto block = std::make_shared<Block>(prefix + std::to_string(i), "data_setvariableto");
+
+        if (i % SCRIPT_LENGTH != 0)
+            block->setParentId(prefix + std::to_string(i - 1));
+
+        if ((i + 1) % SCRIPT_LENGTH != 0)
+            block->setNextId(prefix + std::to_string(i + 1));
+
+        block->addField(std::make_shared<Field>("VARIABLE", "var", var->id()));
+        target->addBlock(block);
+    }
+}
+
+TEST(LoadBenchmarkTest, ResolveIds100kBlocks)
+{
+    std::vector<std::shared_ptr<Target>> targets;
+    targets.push_back(std::make_shared<Stage>());
+
+    for (int i = 1; i < TARGET_COUNT; i++)
+        targets.push_back(std::make_shared<Sprite>());
+
+    for (int i = 0; i < TARGET_COUNT; i++)
+        fillTarget(targets[i].get(), i);
+
+    Engine engine;
+    auto start = std::chrono::steady_clock::now();
+    engine.setTargets(targets);
+    engine.compile();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Linked " << TARGET_COUNT * BLOCKS_PER_TARGET << " blocks in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // Check links of the last target
+    Target *target = targets.back().get();
+    auto var = target->variableAt(0);
+    const auto &blocks = target->blocks();
+    ASSERT_EQ(blocks.size(), BLOCKS_PER_TARGET);
+
+    for (int i = 0; i < BLOCKS_PER_TARGET; i++) {
+        const auto &block = blocks[i];
+        ASSERT_EQ(block->parent(), (i % SCRIPT_LENGTH == 0) ? nullptr : blocks[i - 1]);
+        ASSERT_EQ(block->next(), ((i + 1) % SCRIPT_LENGTH == 0) ? nullptr : blocks[i + 1]);
+        ASSERT_EQ(block->fieldAt(0)->valuePtr(), var);
+    }
+}
+
+TEST(LoadBenchmarkTest, Read100kBlocks)
+{
+    std::string json = projectJson();
+    Scratch3Reader reader;
+
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(reader.loadData(json));
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Read " << json.size() / 1024 << " KiB of project.json in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+
+    ASSERT_TRUE(reader.isValid());
+    const auto &targets = reader.targets();
+    ASSERT_EQ(targets.size(), TARGET_COUNT);
+
+    for (auto target : targets) {
+        ASSERT_EQ(target->blocks().size(), BLOCKS_PER_TARGET);
+        ASSERT_EQ(target->variables().size(), 1);
+    }
+
+    auto block = targets.back()->blockAt(BLOCKS_PER_TARGET - 1);
+    ASSERT_EQ(block->nextId(), "");
+    ASSERT_EQ(block->parentId(), "t" + std::to_string(TARGET_COUNT - 1) + "_" + std::to_string(BLOCKS_PER_TARGET - 2));
+    ASSERT_EQ(block->inputAt(0)->primaryValue()->value().toInt(), BLOCKS_PER_TARGET - 1);
+    ASSERT_EQ(block->fieldAt(0)->valueId(), "t" + std::to_string(TARGET_COUNT - 1) + "_var");
+}
+
+TEST(LoadBenchmarkTest, ColdWarmStartup100kBlocks)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "libscratchcpp_load_benchmark_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string json = projectJson();
+
+    // Cold: parse project.json, compile and write the cache
+    auto start = std::chrono::steady_clock::now();
+    Scratch3Reader reader;
+    ASSERT_TRUE(reader.loadData(json));
+    Engine coldEngine;
+    coldEngine.setTargets(reader.targets());
+    CompiledProject compiledProject;
+    ASSERT_TRUE(coldEngine.compile(compiledProject));
+    ProjectCache(dir.string()).save(json, reader.targets(), reader.broadcasts(), reader.extensions(), compiledProject);
+    auto end = std::chrono::steady_clock::now();
+    auto coldTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    // Warm: read the cache and load the compiled scripts
+    start = std::chrono::steady_clock::now();
+    ProjectCache cache(dir.string());
+    ASSERT_TRUE(cache.load(json));
+    Engine warmEngine;
+    warmEngine.setTargets(cache.targets());
+    ASSERT_TRUE(warmEngine.loadCompiledProject(cache.compiledProject()));
+    end = std::chrono::steady_clock::now();
+    auto warmTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << "Cold startup: " << coldTime << " ms, warm startup: " << warmTime << " ms" << std::endl;
+
+    ASSERT_EQ(cache.targets().size(), TARGET_COUNT);
+    auto block = cache.targets().back()->blockAt(BLOCKS_PER_TARGET - 2);
+    ASSERT_EQ(block->next(), cache.targets().back()->blockAt(BLOCKS_PER_TARGET - 1));
+    ASSERT_EQ(block->fieldAt(0)->valuePtr(), cache.targets().back()->variableAt(0));
+    ASSERT_EQ(warmEngine.scripts().size(), coldEngine.scripts().size());
+
+    std::filesystem::remove_all(dir);
+}
+
+static void checkThresholds(const std::string &name, const LoadBenchmark &benchmark)
+{
+    for (const auto &stage : benchmark.stages()) {
+        double limit = LoadBenchmark::threshold(name, stage.name);
+
+        if (limit > 0)
+            EXPECT_LE(stage.time, limit) << name << ": " << stage.name;
+    }
+
+    double limit = LoadBenchmark::threshold(name, "total");
+
+    if (limit > 0)
+        EXPECT_LE(benchmark.totalTime(), limit) << name << ": total";
+
+    limit = LoadBenchmark::threshold(name, "rssGrowth");
+
+    if (limit > 0 && benchmark.rssGrowth() > 0)
+        EXPECT_LE(benchmark.rssGrowth() / 1024.0, limit) << name << ": RSS growth";
+}
+
+static void benchmarkGenerated(const std::string &name, const ProjectGenerator::Settings &settings)
+{
+    ProjectGenerator generator(settings);
+    std::filesystem::path file = std::filesystem::temp_directory_path() / ("libscratchcpp_load_benchmark_" + name + ".sb3");
+    ASSERT_TRUE(generator.save(file.string()));
+
+    LoadBenchmark benchmark(file.string());
+    ASSERT_TRUE(benchmark.run());
+    benchmark.print(name);
+    std::filesystem::remove(file);
+
+    // Check the loaded project
+    const auto &targets = benchmark.reader()->targets();
+    ASSERT_EQ(targets.size(), generator.targetCount());
+    ASSERT_EQ(targets[0]->lists().size(), settings.listCount);
+    ASSERT_EQ(benchmark.reader()->broadcasts().size(), settings.broadcastCount);
+    unsigned int blockCount = 0;
+    unsigned int assetCount = 0;
+
+    for (auto target : targets) {
+        blockCount += target->blocks().size();
+
+        for (auto costume : target->costumes()) {
+            ASSERT_TRUE(costume->isDataLoaded());
+            ASSERT_EQ(costume->dataSize(), settings.assetSize);
+            assetCount++;
+        }
+    }
+
+    ASSERT_EQ(blockCount, generator.blockCount());
+    ASSERT_EQ(assetCount, generator.assetCount());
+
+    unsigned int scriptsPerTarget = (settings.blocksPerTarget + settings.scriptLength - 1) / settings.scriptLength;
+    ASSERT_EQ(benchmark.engine()->scripts().size(), scriptsPerTarget * generator.targetCount());
+
+    checkThresholds(name, benchmark);
+}
+
+TEST(LoadBenchmarkTest, Generated)
+{
+    ProjectGenerator::Settings settings;
+    settings.blocksPerTarget = 2000;
+    settings.scriptLength = 50;
+    settings.nestingDepth = 2;
+    settings.listCount = 5;
+    settings.listLength = 100;
+    settings.broadcastCount = 10;
+    settings.assetSize = 16 * 1024;
+    benchmarkGenerated("generated", settings);
+}
+
+TEST(LoadBenchmarkTest, GeneratedDeepNesting)
+{
+    ProjectGenerator::Settings settings;
+    settings.spriteCount = 3;
+    settings.blocksPerTarget = 2000;
+    settings.scriptLength = 200;
+    settings.nestingDepth = 50;
+    benchmarkGenerated("generated_deep_nesting", settings);
+}
+
+TEST(LoadBenchmarkTest, GeneratedManySprites)
+{
+    ProjectGenerator::Settings settings;
+    settings.spriteCount = 300;
+    settings.blocksPerTarget = 50;
+    settings.scriptLength = 10;
+    settings.broadcastCount = 20;
+    benchmarkGenerated("generated_many_sprites", settings);
+}
+
+TEST(LoadBenchmarkTest, GeneratedLargeAssets)
+{
+    ProjectGenerator::Settings settings;
+    settings.blocksPerTarget = 100;
+    settings.costumesPerTarget = 4;
+    settings.assetSize = 512 * 1024;
+    benchmarkGenerated("generated_large_assets", settings);
+}
+
+// The test projects are used as real-world baselines
+TEST(LoadBenchmarkTest, TestProjects)
+{
+    std::vector<std::string> files;
+
+    for (const char *dir : { ".", "regtest_projects" }) {
+        for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".sb3")
+                files.push_back(entry.path().string());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    ASSERT_FALSE(files.empty());
+
+    for (const std::string &file : files) {
+        LoadBenchmark benchmark(file);
+        EXPECT_TRUE(benchmark.run()) << file;
+        benchmark.print(file);
+        checkThresholds("test_projects", benchmark);
+    }
+}
@@ -0,0 +1,194 @@
+#include <scratchcpp/target.h>
+#include <scratchcpp/costume.h>
+#include <scratchcpp/sound.h>
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "loadbenchmark.h"
+#include "engine/internal/engine.h"
+#include "internal/scratch3reader.h"
+#include "internal/zipreader.h"
+
+using namespace libscratchcpp;
+
+static const char *THRESHOLDS_FILE = "load_benchmark/thresholds.json";
+static const char *THRESHOLD_SCALE_VAR = "LIBSCRATCHCPP_BENCHMARK_THRESHOLD_SCALE";
+
+// Returns the current resident set size of the process in KiB (0 if it isn't supported).
+static long currentRss()
+{
+#ifdef __linux__
+    std::ifstream file("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+
+    if (!(file >> size >> resident))
+        return 0;
+
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return 0;
+#endif
+}
+
+LoadBenchmark::LoadBenchmark(const std::string &fileName) :
+    m_fileName(fileName)
+{
+}
+
+LoadBenchmark::~LoadBenchmark()
+{
+}
+
+// Runs all stages, returns false if any of them fails.
+bool LoadBenchmark::run()
+{
+    m_stages.clear();
+    m_zipReader = std::make_shared<ZipReader>(m_fileName);
+    m_reader = std::make_unique<Scratch3Reader>();
+    m_engine = std::make_unique<Engine>();
+    m_engine->setLoggingEnabled(false); // don't measure console output
+    m_rssBaseline = currentRss();
+    m_rssGrowth = 0;
+    std::string json;
+
+    bool ret = measure("unzip", [this, &json]() {
+        if (!m_zipReader->open())
+            return false;
+
+        json = m_zipReader->readFileToString("project.json");
+        return !json.empty();
+    });
+
+    ret = ret && measure("parse", [this, &json]() { return m_reader->loadData(json); });
+
+    ret = ret && measure("assets", [this]() {
+        for (auto target : m_reader->targets()) {
+            std::vector<Asset *> assets;
+
+            for (auto costume : target->costumes())
+                assets.push_back(costume.get());
+
+            for (auto sound : target->sounds())
+                assets.push_back(sound.get());
+
+            for (Asset *asset : assets) {
+                auto zipReader = m_zipReader;
+                std::string fileName = asset->fileName();
+                asset->setDataLoader(zipReader->fileSize(fileName), [zipReader, fileName]() { return zipReader->fileData(fileName); });
+                asset->data();
+            }
+        }
+
+        return true;
+    });
+
+    ret = ret && measure("setTargets", [this]() {
+        m_engine->setTargets(m_reader->targets());
+        m_engine->setBroadcasts(m_reader->broadcasts());
+        m_engine->setExtensions(m_reader->extensions());
+        return true;
+    });
+
+    ret = ret && measure("resolveIds", [this]() {
+        m_engine->resolveIds();
+        return true;
+    });
+
+    // Note: compile() resolves the IDs again
+    ret = ret && measure("compile", [this]() {
+        m_engine->compile();
+        return true;
+    });
+
+    return ret;
+}
+
+const std::vector<LoadBenchmark::Stage> &LoadBenchmark::stages() const
+{
+    return m_stages;
+}
+
+double LoadBenchmark::totalTime() const
+{
+    double ret = 0;
+
+    for (const Stage &stage : m_stages)
+        ret += stage.time;
+
+    return ret;
+}
+
+// Returns the maximum growth of the resident set size (in KiB) since run() was called, measured after each stage.
+// Unlike the peak RSS of the process, it doesn't depend on what ran before. Returns 0 if it isn't supported.
+long LoadBenchmark::rssGrowth() const
+{
+    return m_rssGrowth;
+}
+
+Scratch3Reader *LoadBenchmark::reader() const
+{
+    return m_reader.get();
+}
+
+Engine *LoadBenchmark::engine() const
+{
+    return m_engine.get();
+}
+
+void LoadBenchmark::print(const std::string &name) const
+{
+    std::cout << "[" << name << "]";
+
+    for (const Stage &stage : m_stages)
+        std::cout << " " << stage.name << ": " << stage.time << " ms,";
+
+    std::cout << " total: " << totalTime() << " ms, RSS growth: " << rssGrowth() / 1024 << " MiB" << std::endl;
+}
+
+// Returns the maximum time (in ms) of the given stage of the given benchmark, or the maximum RSS growth (in MiB)
+// if the stage is "rssGrowth". The thresholds are multiplied by the scale in the thresholds file, which can be
+// overridden by the LIBSCRATCHCPP_BENCHMARK_THRESHOLD_SCALE environment variable. Returns 0 if there isn't any threshold.
+double LoadBenchmark::threshold(const std::string &benchmark, const std::string &stage)
+{
+    static const nlohmann::json thresholds = []() {
+        std::ifstream file(THRESHOLDS_FILE);
+
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << THRESHOLDS_FILE << std::endl;
+            return nlohmann::json::object();
+        }
+
+        return nlohmann::json::parse(file, nullptr, false);
+    }();
+
+    if (!thresholds.is_object() || !thresholds.contains(benchmark) || !thresholds[benchmark].contains(stage))
+        return 0;
+
+    double scale = thresholds.value("scale", 1.0);
+    const char *scaleVar = std::getenv(THRESHOLD_SCALE_VAR);
+
+    if (scaleVar)
+        scale = std::atof(scaleVar);
+
+    return thresholds[benchmark][stage].get<double>() * scale;
+}
+
+bool LoadBenchmark::measure(const std::string &stage, const std::function<bool()> &f)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool ret = f();
+    auto end = std::chrono::steady_clock::now();
+
+    m_stages.push_back({ stage, std::chrono::duration<double, std::milli>(end - start).count() });
+    m_rssGrowth = std::max(m_rssGrowth, currentRss() - m_rssBaseline);
+    return ret;
+}
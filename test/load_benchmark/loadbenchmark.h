@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace libscratchcpp
+{
+
+class ZipReader;
+class Scratch3Reader;
+class Engine;
+
+// Loads an .sb3 file stage by stage (like Project::load() does) and measures the time of each stage
+class LoadBenchmark
+{
+    public:
+        struct Stage
+        {
+                std::string name;
+                double time = 0; // ms
+        };
+
+        LoadBenchmark(const std::string &fileName);
+        LoadBenchmark(const LoadBenchmark &) = delete;
+        ~LoadBenchmark();
+
+        bool run();
+
+        const std::vector<Stage> &stages() const;
+        double totalTime() const;
+        long rssGrowth() const;
+
+        Scratch3Reader *reader() const;
+        Engine *engine() const;
+
+        void print(const std::string &name) const;
+
+        static double threshold(const std::string &benchmark, const std::string &stage);
+
+    private:
+        bool measure(const std::string &stage, const std::function<bool()> &f);
+
+        std::string m_fileName;
+        std::vector<Stage> m_stages;
+        long m_rssBaseline = 0;
+        long m_rssGrowth = 0;
+        std::shared_ptr<ZipReader> m_zipReader;
+        std::unique_ptr<Scratch3Reader> m_reader;
+        std::unique_ptr<Engine> m_engine;
+};
+
+} // namespace libscratchcpp
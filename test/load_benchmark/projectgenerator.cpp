@@ -0,0 +1,328 @@
+#include <fstream>
+#include <algorithm>
+
+#include "projectgenerator.h"
+
+using namespace libscratchcpp;
+
+static unsigned long long mix(unsigned long long x)
+{
+    // splitmix64
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static std::string quoted(const std::string &str)
+{
+    return "\"" + str + "\"";
+}
+
+ProjectGenerator::ProjectGenerator(const Settings &settings) :
+    m_settings(settings)
+{
+}
+
+const ProjectGenerator::Settings &ProjectGenerator::settings() const
+{
+    return m_settings;
+}
+
+unsigned int ProjectGenerator::targetCount() const
+{
+    return m_settings.spriteCount + 1;
+}
+
+unsigned int ProjectGenerator::blockCount() const
+{
+    return targetCount() * m_settings.blocksPerTarget;
+}
+
+unsigned int ProjectGenerator::assetCount() const
+{
+    return targetCount() * m_settings.costumesPerTarget;
+}
+
+// Returns the project.json of the project.
+std::string ProjectGenerator::json() const
+{
+    std::string json = "{\"targets\":[";
+
+    for (unsigned int i = 0; i < targetCount(); i++) {
+        if (i > 0)
+            json += ",";
+
+        json += targetJson(i);
+    }
+
+    json += "],\"monitors\":[],\"extensions\":[],\"meta\":{\"semver\":\"3.0.0\",\"vm\":\"0.2.0\",\"agent\":\"\"}}";
+    return json;
+}
+
+// Saves the project to the given .sb3 file. Files in the archive are stored without compression.
+bool ProjectGenerator::save(const std::string &fileName) const
+{
+    std::vector<File> files;
+    files.push_back({ "project.json", json() });
+
+    for (unsigned int i = 0; i < targetCount(); i++) {
+        for (unsigned int j = 0; j < m_settings.costumesPerTarget; j++)
+            files.push_back({ assetId(i, j) + ".png", assetData(i, j) });
+    }
+
+    return writeZip(fileName, files);
+}
+
+std::string ProjectGenerator::targetJson(unsigned int index) const
+{
+    bool isStage = (index == 0);
+    std::string prefix = "t" + std::to_string(index) + "_";
+    std::string json = "{\"isStage\":" + std::string(isStage ? "true" : "false") + ",\"name\":" + quoted(isStage ? "Stage" : "Sprite" + std::to_string(index)) + ",";
+    json += "\"variables\":{" + quoted(prefix + "var") + ":[\"var\",0]}";
+
+    // Lists and broadcasts are global
+    json += ",\"lists\":{";
+
+    for (unsigned int i = 0; isStage && i < m_settings.listCount; i++) {
+        if (i > 0)
+            json += ",";
+
+        json += quoted("list" + std::to_string(i)) + ":[" + quoted("list" + std::to_string(i)) + ",[";
+
+        for (unsigned int j = 0; j < m_settings.listLength; j++)
+            json += (j > 0 ? "," : "") + std::to_string(j);
+
+        json += "]]";
+    }
+
+    json += "},\"broadcasts\":{";
+
+    for (unsigned int i = 0; isStage && i < m_settings.broadcastCount; i++)
+        json += (i > 0 ? "," : "") + quoted("broadcast" + std::to_string(i)) + ":" + quoted("message" + std::to_string(i));
+
+    // Blocks
+    std::string blocks;
+    unsigned int nextId = 0;
+    unsigned int script = 0;
+
+    while (nextId < m_settings.blocksPerTarget) {
+        unsigned int length = std::min(m_settings.scriptLength, m_settings.blocksPerTarget - nextId);
+        addScript(blocks, prefix, script++, length, nextId);
+    }
+
+    json += "},\"blocks\":{" + (blocks.empty() ? "" : blocks.substr(1)) + "},\"comments\":{},\"currentCostume\":0,\"costumes\":[";
+
+    // Costumes
+    for (unsigned int i = 0; i < m_settings.costumesPerTarget; i++) {
+        std::string id = assetId(index, i);
+
+        if (i > 0)
+            json += ",";
+
+        json += "{\"name\":" + quoted("costume" + std::to_string(i)) + ",\"bitmapResolution\":1,\"dataFormat\":\"png\",\"assetId\":" + quoted(id);
+        json += ",\"md5ext\":" + quoted(id + ".png") + ",\"rotationCenterX\":0,\"rotationCenterY\":0}";
+    }
+
+    json += "],\"sounds\":[],\"volume\":100,\"layerOrder\":" + std::to_string(index);
+
+    if (isStage)
+        json += ",\"tempo\":60}";
+    else
+        json += ",\"visible\":true,\"x\":0,\"y\":0,\"size\":100,\"direction\":90,\"draggable\":false,\"rotationStyle\":\"all around\"}";
+
+    return json;
+}
+
+// Adds a script with the given number of blocks. Every other script is started by a broadcast if there are any.
+void ProjectGenerator::addScript(std::string &blocks, const std::string &prefix, unsigned int script, unsigned int length, unsigned int &nextId) const
+{
+    std::string id = prefix + std::to_string(nextId++);
+    std::string next = (length > 1) ? quoted(prefix + std::to_string(nextId)) : "null";
+    blocks += "," + quoted(id) + ":{";
+
+    if (m_settings.broadcastCount > 0 && script % 2 == 1) {
+        std::string broadcast = std::to_string((script / 2) % m_settings.broadcastCount);
+        blocks += "\"opcode\":\"event_whenbroadcastreceived\",\"inputs\":{},\"fields\":{\"BROADCAST_OPTION\":[" + quoted("message" + broadcast) + "," + quoted("broadcast" + broadcast) + "]}";
+    } else
+        blocks += "\"opcode\":\"event_whenflagclicked\",\"inputs\":{},\"fields\":{}";
+
+    blocks += ",\"next\":" + next + ",\"parent\":null,\"shadow\":false,\"topLevel\":true,\"x\":0,\"y\":0}";
+
+    if (length > 1)
+        addStack(blocks, prefix, length - 1, m_settings.nestingDepth, id, nextId);
+}
+
+// Adds a stack of blocks with the given number of blocks and nesting depth, returns the ID of the first block.
+std::string ProjectGenerator::addStack(std::string &blocks, const std::string &prefix, unsigned int length, unsigned int depth, const std::string &parent, unsigned int &nextId) const
+{
+    std::string first = prefix + std::to_string(nextId);
+
+    if (depth > 0) {
+        // The rest of the blocks are in the substack
+        nextId++;
+        blocks += "," + quoted(first) + ":{\"opcode\":\"control_repeat\",\"next\":null,\"parent\":" + quoted(parent) + ",\"inputs\":{\"TIMES\":[1,[6,\"10\"]]";
+
+        if (length > 1)
+            blocks += ",\"SUBSTACK\":[2," + quoted(prefix + std::to_string(nextId)) + "]";
+
+        blocks += "},\"fields\":{},\"shadow\":false,\"topLevel\":false}";
+
+        if (length > 1)
+            addStack(blocks, prefix, length - 1, depth - 1, first, nextId);
+
+        return first;
+    }
+
+    unsigned int variants = 1 + (m_settings.listCount > 0) + (m_settings.broadcastCount > 0);
+
+    for (unsigned int i = 0; i < length; i++) {
+        unsigned int index = nextId++;
+        std::string id = prefix + std::to_string(index);
+        std::string next = (i + 1 < length) ? quoted(prefix + std::to_string(index + 1)) : "null";
+        std::string parentId = (i == 0) ? parent : prefix + std::to_string(index - 1);
+        unsigned int variant = i % variants;
+
+        blocks += "," + quoted(id) + ":{";
+
+        if (variant == 0)
+            blocks += "\"opcode\":\"data_setvariableto\",\"inputs\":{\"VALUE\":[1,[10," + quoted(std::to_string(i)) + "]]},\"fields\":{\"VARIABLE\":[\"var\"," + quoted(prefix + "var") + "]}";
+        else if (variant == 1 && m_settings.listCount > 0) {
+            std::string list = "list" + std::to_string(index % m_settings.listCount);
+            blocks += "\"opcode\":\"data_addtolist\",\"inputs\":{\"ITEM\":[1,[10," + quoted(std::to_string(i)) + "]]},\"fields\":{\"LIST\":[" + quoted(list) + "," + quoted(list) + "]}";
+        } else {
+            std::string broadcast = std::to_string(index % m_settings.broadcastCount);
+            blocks += "\"opcode\":\"event_broadcast\",\"inputs\":{\"BROADCAST_INPUT\":[1,[11," + quoted("message" + broadcast) + "," + quoted("broadcast" + broadcast) + "]]},\"fields\":{}";
+        }
+
+        blocks += ",\"next\":" + next + ",\"parent\":" + quoted(parentId) + ",\"shadow\":false,\"topLevel\":false}";
+    }
+
+    return first;
+}
+
+// Returns an md5-like asset ID which is unique for every costume.
+std::string ProjectGenerator::assetId(unsigned int target, unsigned int costume) const
+{
+    static const char *digits = "0123456789abcdef";
+    unsigned long long seed = (static_cast<unsigned long long>(target) << 32) | costume;
+    unsigned long long parts[] = { mix(seed), mix(seed ^ 0xffffffffffffffffULL) };
+    std::string id;
+
+    for (unsigned long long part : parts) {
+        for (int i = 0; i < 16; i++)
+            id += digits[(part >> (i * 4)) & 0xf];
+    }
+
+    return id;
+}
+
+// Returns pseudo-random (incompressible) data of a costume.
+std::string ProjectGenerator::assetData(unsigned int target, unsigned int costume) const
+{
+    std::string data(m_settings.assetSize, '\0');
+    unsigned long long state = mix((static_cast<unsigned long long>(target) << 32) | costume);
+
+    for (size_t i = 0; i < data.size(); i++) {
+        state = mix(state);
+        data[i] = static_cast<char>(state & 0xff);
+    }
+
+    return data;
+}
+
+static unsigned int crc32(const std::string &data)
+{
+    static unsigned int table[256] = { 0 };
+
+    if (table[1] == 0) {
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int c = i;
+
+            for (int j = 0; j < 8; j++)
+                c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+
+            table[i] = c;
+        }
+    }
+
+    unsigned int crc = 0xffffffff;
+
+    for (unsigned char c : data)
+        crc = table[(crc ^ c) & 0xff] ^ (crc >> 8);
+
+    return crc ^ 0xffffffff;
+}
+
+static void write16(std::string &out, unsigned int value)
+{
+    out += static_cast<char>(value & 0xff);
+    out += static_cast<char>((value >> 8) & 0xff);
+}
+
+static void write32(std::string &out, unsigned int value)
+{
+    write16(out, value & 0xffff);
+    write16(out, value >> 16);
+}
+
+// Writes a zip archive with stored (uncompressed) files.
+bool ProjectGenerator::writeZip(const std::string &fileName, const std::vector<File> &files)
+{
+    std::ofstream stream(fileName, std::ios::binary);
+
+    if (!stream.is_open())
+        return false;
+
+    std::string centralDirectory;
+    size_t offset = 0;
+
+    for (const File &file : files) {
+        unsigned int crc = crc32(file.data);
+        std::string header;
+
+        // Local file header
+        write32(header, 0x04034b50);
+        write16(header, 20);   // version needed to extract
+        write16(header, 0);    // flags
+        write16(header, 0);    // method (stored)
+        write16(header, 0);    // modification time
+        write16(header, 0x21); // modification date (1980-01-01)
+        write32(header, crc);
+        write32(header, file.data.size()); // compressed size
+        write32(header, file.data.size()); // uncompressed size
+        write16(header, file.name.size());
+        write16(header, 0); // extra field length
+        header += file.name;
+
+        // Central directory record
+        write32(centralDirectory, 0x02014b50);
+        write16(centralDirectory, 20);            // version made by
+        centralDirectory += header.substr(4, 26); // same as in the local header
+        write16(centralDirectory, 0);             // comment length
+        write16(centralDirectory, 0);             // disk number
+        write16(centralDirectory, 0);             // internal attributes
+        write32(centralDirectory, 0);             // external attributes
+        write32(centralDirectory, offset);
+        centralDirectory += file.name;
+
+        stream.write(header.data(), header.size());
+        stream.write(file.data.data(), file.data.size());
+        offset += header.size() + file.data.size();
+    }
+
+    // End of central directory record
+    std::string end;
+    write32(end, 0x06054b50);
+    write16(end, 0); // disk number
+    write16(end, 0); // disk with the central directory
+    write16(end, files.size());
+    write16(end, files.size());
+    write32(end, centralDirectory.size());
+    write32(end, offset);
+    write16(end, 0); // comment length
+
+    stream.write(centralDirectory.data(), centralDirectory.size());
+    stream.write(end.data(), end.size());
+    return stream.good();
+}
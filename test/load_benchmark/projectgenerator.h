@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace libscratchcpp
+{
+
+// Generates synthetic Scratch 3 projects for the load benchmarks
+class ProjectGenerator
+{
+    public:
+        struct Settings
+        {
+                unsigned int spriteCount = 9;        // the stage is added to these
+                unsigned int blocksPerTarget = 1000; // including hats
+                unsigned int scriptLength = 100;     // blocks per script, including the hat
+                unsigned int nestingDepth = 0;       // nested repeat blocks in each script
+                unsigned int listCount = 0;          // global lists
+                unsigned int listLength = 0;         // items per list
+                unsigned int broadcastCount = 0;     // every other script is started by a broadcast
+                unsigned int costumesPerTarget = 1;
+                unsigned int assetSize = 1024;       // bytes per costume
+        };
+
+        ProjectGenerator(const Settings &settings);
+
+        const Settings &settings() const;
+
+        unsigned int targetCount() const;
+        unsigned int blockCount() const;
+        unsigned int assetCount() const;
+
+        std::string json() const;
+        bool save(const std::string &fileName) const;
+
+    private:
+        struct File
+        {
+                std::string name;
+                std::string data;
+        };
+
+        std::string targetJson(unsigned int index) const;
+        void addScript(std::string &blocks, const std::string &prefix, unsigned int script, unsigned int length, unsigned int &nextId) const;
+        std::string addStack(std::string &blocks, const std::string &prefix, unsigned int length, unsigned int depth, const std::string &parent, unsigned int &nextId) const;
+        std::string assetId(unsigned int target, unsigned int costume) const;
+        std::string assetData(unsigned int target, unsigned int costume) const;
+
+        static bool writeZip(const std::string &fileName, const std::vector<File> &files);
+
+        Settings m_settings;
+};
+
+} // namespace libscratchcpp
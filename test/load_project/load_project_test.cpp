@@ -12,10 +12,14 @@
 #include <scratchcpp/sprite.h>
 #include <scratchcpp/inputvalue.h>
 #include <scratchcpp/comment.h>
+#include <scratchcpp/script.h>
 #include <projectdownloaderfactorymock.h>
 #include <projectdownloadermock.h>
+#include <filesystem>
 
 #include "project_p.h"
+#include "internal/scratch3reader.h"
+#include "internal/zipreader.h"
 #include "../common.h"
 
 using namespace libscratchcpp;
@@ -61,7 +65,9 @@ TEST(LoadProjectTest, EmptyProject)
         ASSERT_FALSE(backdrop->id().empty());
         ASSERT_EQ(backdrop->fileName(), backdrop->id() + ".svg");
         ASSERT_EQ(backdrop->dataFormat(), "svg");
+        ASSERT_FALSE(backdrop->isDataLoaded());
         ASSERT_TRUE(backdrop->data());
+        ASSERT_TRUE(backdrop->isDataLoaded());
         ASSERT_EQ(
             memcmp(
                 backdrop->data(),
@@ -482,6 +488,103 @@ TEST(LoadProjectTest, LoadTopLevelReporterProject)
     }
 }
 
+TEST(LoadProjectTest, AssetPreloading)
+{
+    int i = 0;
+    for (auto version : scratchVersions) {
+        Project p("load_test" + fileExtensions[i], version);
+        p.setAssetPreloadingEnabled(true);
+        ASSERT_TRUE(p.load());
+
+        auto engine = p.engine();
+        ASSERT_EQ(engine->targets().size(), 3);
+
+        for (auto target : engine->targets()) {
+            for (auto costume : target->costumes())
+                ASSERT_TRUE(costume->isDataLoaded());
+
+            for (auto sound : target->sounds())
+                ASSERT_TRUE(sound->isDataLoaded());
+        }
+
+        i++;
+    }
+}
+
+TEST(LoadProjectTest, SharedAssetData)
+{
+    Project p1("load_test.sb3");
+    Project p2("load_test.sb3");
+    ASSERT_TRUE(p1.load());
+    ASSERT_TRUE(p2.load());
+
+    auto costume1 = p1.engine()->targetAt(1)->costumeAt(0);
+    auto costume2 = p2.engine()->targetAt(1)->costumeAt(0);
+    ASSERT_TRUE(costume1->data());
+    ASSERT_EQ(costume2->data(), costume1->data());
+}
+
+TEST(LoadProjectTest, LoadDataAfterFile)
+{
+    ZipReader zip("load_test.sb3");
+    ASSERT_TRUE(zip.open());
+    std::string json = zip.readFileToString("project.json");
+
+    Scratch3Reader reader;
+    reader.setFileName("load_test.sb3");
+    ASSERT_TRUE(reader.load());
+    ASSERT_TRUE(reader.targets().at(1)->costumeAt(0)->data());
+
+    // Assets of projects loaded from JSON aren't loaded from the previous archive
+    ASSERT_TRUE(reader.loadData(json));
+    ASSERT_EQ(reader.targets().at(1)->costumeAt(0)->data(), nullptr);
+}
+
+TEST(LoadProjectTest, Cache)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "libscratchcpp_load_project_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // First load writes the cache, second load reads it (with the compiled scripts)
+    std::vector<std::vector<unsigned int>> bytecodes[2];
+
+    for (int i = 0; i < 2; i++) {
+        Project p("load_test.sb3");
+        p.setCacheDirectory(dir.string());
+        ASSERT_TRUE(p.load());
+        ASSERT_EQ(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()), 1);
+
+        auto engine = p.engine();
+        ASSERT_EQ(engine->targets().size(), 3);
+        ASSERT_EQ(engine->broadcasts().size(), 1);
+        ASSERT_EQ(engine->stage()->variables().size(), 2);
+
+        auto sprite = engine->targetAt(1);
+        ASSERT_EQ(sprite->name(), "Sprite1");
+        ASSERT_FALSE(sprite->blocks().empty());
+        ASSERT_TRUE(sprite->blockAt(0)->engine());
+
+        auto costume = sprite->costumeAt(0);
+        ASSERT_FALSE(costume->isDataLoaded());
+        ASSERT_TRUE(costume->data());
+
+        for (auto target : engine->targets()) {
+            for (auto block : target->blocks()) {
+                auto it = engine->scripts().find(block);
+
+                if (it != engine->scripts().cend())
+                    bytecodes[i].push_back(it->second->bytecodeVector());
+            }
+        }
+    }
+
+    ASSERT_FALSE(bytecodes[0].empty());
+    ASSERT_EQ(bytecodes[0], bytecodes[1]);
+
+    std::filesystem::remove_all(dir);
+}
+
 TEST(LoadProjectTest, ProjectTest)
 {
     int i = 0;
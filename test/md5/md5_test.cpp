@@ -0,0 +1,26 @@
+#include <internal/md5.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(Md5Test, Hex)
+{
+    // Test suite from RFC 1321
+    ASSERT_EQ(Md5::hex(""), "d41d8cd98f00b204e9800998ecf8427e");
+    ASSERT_EQ(Md5::hex("a"), "0cc175b9c0f1b6a831c399e269772661");
+    ASSERT_EQ(Md5::hex("abc"), "900150983cd24fb0d6963f7d28e17f72");
+    ASSERT_EQ(Md5::hex("message digest"), "f96b697d7cb7938d525a2f31aaf161d0");
+    ASSERT_EQ(Md5::hex("abcdefghijklmnopqrstuvwxyz"), "c3fcd3d76192e4007dfb496cca67e13b");
+    ASSERT_EQ(Md5::hex("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"), "d174ab98d277d9f5a5611c2c9f419d9f");
+    ASSERT_EQ(Md5::hex("12345678901234567890123456789012345678901234567890123456789012345678901234567890"), "57edf4a22be3c955ac49da2e2107b67a");
+
+    // Padding which doesn't fit in the last chunk
+    ASSERT_EQ(Md5::hex(std::string(56, 'a')), "3b0c8ac703f828b04c6c197006d17218");
+    ASSERT_EQ(Md5::hex(std::string(64, 'a')), "014842d480b571495a4a0363793f7367");
+}
+
+TEST(Md5Test, Asset)
+{
+    ASSERT_EQ(Md5::hex(readFileStr("image1.png")), "39cc9a7862c8d3f75fd95a42d7e8f18f");
+}
@@ -13,6 +13,7 @@ class EngineMock : public IEngine
     public:
         MOCK_METHOD(void, clear, (), (override));
         MOCK_METHOD(void, compile, (), (override));
+        MOCK_METHOD(void, recompile, (Target *, const std::vector<std::shared_ptr<Block>> &, const std::vector<std::shared_ptr<Block>> &), (override));
 
         MOCK_METHOD(void, start, (), (override));
         MOCK_METHOD(void, stop, (), (override));
@@ -27,10 +28,12 @@ class EngineMock : public IEngine
         MOCK_METHOD(void, run, (), (override));
         MOCK_METHOD(void, runEventLoop, (), (override));
         MOCK_METHOD(void, stopEventLoop, (), (override));
+        MOCK_METHOD(void, step, (unsigned int), (override));
 
         MOCK_METHOD(void, setRedrawHandler, (const std::function<void()> &), (override));
 
         MOCK_METHOD(bool, isRunning, (), (const, override));
+        MOCK_METHOD(bool, hasRunningScripts, (), (const, override));
 
         MOCK_METHOD(double, fps, (), (const, override));
         MOCK_METHOD(void, setFps, (double fps), (override));
@@ -38,6 +41,15 @@ class EngineMock : public IEngine
         MOCK_METHOD(bool, turboModeEnabled, (), (const, override));
         MOCK_METHOD(void, setTurboModeEnabled, (bool), (override));
 
+        MOCK_METHOD(bool, fixedTimestepEnabled, (), (const, override));
+        MOCK_METHOD(void, setFixedTimestepEnabled, (bool), (override));
+
+        MOCK_METHOD(bool, parallelExecutionEnabled, (), (const, override));
+        MOCK_METHOD(void, setParallelExecutionEnabled, (bool), (override));
+
+        MOCK_METHOD(bool, loggingEnabled, (), (const, override));
+        MOCK_METHOD(void, setLoggingEnabled, (bool), (override));
+
         MOCK_METHOD(bool, keyPressed, (const std::string &), (const, override));
         MOCK_METHOD(void, setKeyState, (const std::string &, bool), (override));
         MOCK_METHOD(void, setKeyState, (const KeyEvent &, bool), (override));
@@ -65,17 +77,36 @@ class EngineMock : public IEngine
 
         MOCK_METHOD(int, cloneCount, (), (const, override));
 
+        MOCK_METHOD(std::shared_ptr<Sprite>, takeClone, (Sprite *), (override));
+
+        MOCK_METHOD(int, clonePoolLimit, (), (const, override));
+        MOCK_METHOD(void, setClonePoolLimit, (int), (override));
+
+        MOCK_METHOD(unsigned int, clonePoolHits, (), (const, override));
+        MOCK_METHOD(unsigned int, clonePoolMisses, (), (const, override));
+
         MOCK_METHOD(bool, spriteFencingEnabled, (), (const, override));
         MOCK_METHOD(void, setSpriteFencingEnabled, (bool), (override));
 
+        MOCK_METHOD(bool, spriteTransformStoreEnabled, (), (const, override));
+        MOCK_METHOD(void, setSpriteTransformStoreEnabled, (bool), (override));
+
+        MOCK_METHOD(bool, batchedSpriteNotificationsEnabled, (), (const, override));
+        MOCK_METHOD(void, setBatchedSpriteNotificationsEnabled, (bool), (override));
+
         MOCK_METHOD(bool, broadcastRunning, (unsigned int, VirtualMachine *), (override));
         MOCK_METHOD(bool, broadcastByPtrRunning, (Broadcast *, VirtualMachine *), (override));
 
         MOCK_METHOD(void, requestRedraw, (), (override));
 
         MOCK_METHOD(ITimer *, timer, (), (const, override));
+        MOCK_METHOD(IClock *, clock, (), (const, override));
+        MOCK_METHOD(IRandomGenerator *, randomGenerator, (), (const, override));
+        MOCK_METHOD(void, setRandomSeed, (unsigned int), (override));
 
         MOCK_METHOD(void, registerSection, (std::shared_ptr<IBlockSection>), (override));
+        MOCK_METHOD(int, findSection, (const std::string &), (const, override));
+        MOCK_METHOD(IBlockSection *, sectionAt, (int), (const, override));
         MOCK_METHOD(unsigned int, functionIndex, (BlockFunc), (override));
 
         MOCK_METHOD(void, addCompileFunction, (IBlockSection *, const std::string &, BlockComp), (override));
@@ -83,6 +114,8 @@ class EngineMock : public IEngine
         MOCK_METHOD(void, addInput, (IBlockSection *, const std::string &, int), (override));
         MOCK_METHOD(void, addField, (IBlockSection *, const std::string &, int), (override));
         MOCK_METHOD(void, addFieldValue, (IBlockSection *, const std::string &, int), (override));
+        MOCK_METHOD(void, addFunction, (IBlockSection *, BlockFunc), (override));
+        MOCK_METHOD(void, addTargetLocalFunction, (BlockFunc), (override));
 
         MOCK_METHOD(const std::vector<std::shared_ptr<Broadcast>> &, broadcasts, (), (const, override));
         MOCK_METHOD(void, setBroadcasts, (const std::vector<std::shared_ptr<Broadcast>> &), (override));
@@ -105,6 +138,9 @@ class EngineMock : public IEngine
         MOCK_METHOD(void, moveSpriteBackwardLayers, (Sprite * sprite, int layers), (override));
         MOCK_METHOD(void, moveSpriteBehindOther, (Sprite * sprite, Sprite *other), (override));
 
+        MOCK_METHOD(void, invalidateSpriteBounds, (const Sprite *), (override));
+        MOCK_METHOD(bool, touchingSprite, (const Sprite *, const Sprite *), (override));
+
         MOCK_METHOD(Stage *, stage, (), (const, override));
 
         MOCK_METHOD(std::vector<std::string> &, extensions, (), (const, override));
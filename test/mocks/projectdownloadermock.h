@@ -12,6 +12,8 @@ class ProjectDownloaderMock : public IProjectDownloader
         MOCK_METHOD(bool, downloadAssets, (const std::vector<std::string> &), (override));
         MOCK_METHOD(void, cancel, (), (override));
 
+        MOCK_METHOD(void, setCacheDirectory, (const std::string &), (override));
+
         MOCK_METHOD(void, setDownloadProgressCallback, (const std::function<void(unsigned int, unsigned int)> &), (override));
 
         MOCK_METHOD(const std::string &, json, (), (const, override));
@@ -24,5 +24,7 @@ class SpriteHandlerMock : public ISpriteHandler
         MOCK_METHOD(void, onGraphicsEffectChanged, (IGraphicsEffect *, double), (override));
         MOCK_METHOD(void, onGraphicsEffectsCleared, (), (override));
 
+        MOCK_METHOD(void, onChanged, (const SpriteChanges &), (override));
+
         MOCK_METHOD(Rect, boundingRect, (), (const, override));
 };
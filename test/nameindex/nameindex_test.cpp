@@ -0,0 +1,139 @@
+#include <scratchcpp/variable.h>
+#include <scratchcpp/sprite.h>
+#include <thread>
+
+#include "internal/nameindex.h"
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(NameIndexTest, Find)
+{
+    NameIndexGroup group;
+    NameIndex<Variable> names(group);
+    NameIndex<Variable, IdKey> ids(group);
+    std::vector<std::shared_ptr<Variable>> variables;
+    ASSERT_EQ(names.find(variables, "var1"), -1);
+
+    variables.push_back(std::make_shared<Variable>("a", "var1"));
+    variables.push_back(std::make_shared<Variable>("b", "var2"));
+    variables.push_back(std::make_shared<Variable>("c", "var1"));
+    names.invalidate();
+
+    ASSERT_EQ(names.find(variables, "var1"), 0); // the first variable with the name
+    ASSERT_EQ(names.find(variables, "var2"), 1);
+    ASSERT_EQ(names.find(variables, "var3"), -1);
+    ASSERT_EQ(ids.find(variables, "c"), 2);
+    ASSERT_EQ(ids.find(variables, "d"), -1);
+}
+
+TEST(NameIndexTest, Invalidate)
+{
+    auto group = std::make_shared<NameIndexGroup>();
+    NameIndex<Variable, IdKey> ids(*group);
+    std::vector<std::shared_ptr<Variable>> variables = { std::make_shared<Variable>("a", "var1") };
+    group->adopt(*variables[0]);
+    ASSERT_EQ(ids.find(variables, "a"), 0);
+
+    // The index isn't rebuilt until it's invalidated
+    variables.push_back(std::make_shared<Variable>("b", "var2"));
+    group->adopt(*variables[1]);
+    ASSERT_EQ(ids.find(variables, "b"), -1);
+    unsigned int epoch = group->epoch();
+    ids.invalidate();
+    ASSERT_NE(group->epoch(), epoch);
+    ASSERT_EQ(ids.find(variables, "b"), 1);
+
+    // Renaming an item invalidates the indices of its group
+    unsigned int generation = group->generation();
+    variables[0]->setId("c");
+    ASSERT_NE(group->generation(), generation);
+    ASSERT_EQ(ids.find(variables, "a"), -1);
+    ASSERT_EQ(ids.find(variables, "c"), 0);
+}
+
+TEST(NameIndexTest, Groups)
+{
+    // Renaming an item of one owner doesn't invalidate the indices of other owners
+    auto group1 = std::make_shared<NameIndexGroup>();
+    auto group2 = std::make_shared<NameIndexGroup>();
+    auto var1 = std::make_shared<Variable>("a", "var1");
+    auto var2 = std::make_shared<Variable>("b", "var2");
+    group1->adopt(*var1);
+    group2->adopt(*var2);
+    unsigned int generation1 = group1->generation();
+    unsigned int generation2 = group2->generation();
+    unsigned int epoch2 = group2->epoch();
+
+    var1->setId("c");
+    ASSERT_NE(group1->generation(), generation1);
+    ASSERT_EQ(group2->generation(), generation2);
+    ASSERT_EQ(group2->epoch(), epoch2);
+
+    // Items which don't belong to any owner don't invalidate anything
+    Variable var3("d", "var3");
+    generation1 = group1->generation();
+    var3.setId("e");
+    ASSERT_EQ(group1->generation(), generation1);
+    ASSERT_EQ(group2->generation(), generation2);
+
+    // Changes in a target change the epoch of the engine, but only renaming the target invalidates the indices of the engine
+    auto engineGroup = std::make_shared<NameIndexGroup>();
+    Sprite sprite;
+    engineGroup->adopt(sprite);
+    ASSERT_EQ(NameIndexGroup::root(&sprite), engineGroup.get());
+    unsigned int engineGeneration = engineGroup->generation();
+    unsigned int engineEpoch = engineGroup->epoch();
+
+    auto var4 = std::make_shared<Variable>("f", "var4");
+    sprite.addVariable(var4);
+    ASSERT_EQ(engineGroup->generation(), engineGeneration);
+    ASSERT_NE(engineGroup->epoch(), engineEpoch);
+
+    engineEpoch = engineGroup->epoch();
+    var4->setId("g");
+    ASSERT_EQ(engineGroup->generation(), engineGeneration);
+    ASSERT_NE(engineGroup->epoch(), engineEpoch);
+
+    sprite.setName("Sprite2");
+    ASSERT_NE(engineGroup->generation(), engineGeneration);
+
+    // A target without an engine is its own root
+    Sprite sprite2;
+    ASSERT_TRUE(NameIndexGroup::root(&sprite2));
+    ASSERT_NE(NameIndexGroup::root(&sprite2), engineGroup.get());
+    ASSERT_EQ(NameIndexGroup::root(nullptr), nullptr);
+}
+
+TEST(NameIndexTest, ConcurrentLookups)
+{
+    // The index can be rebuilt while other threads look up items
+    NameIndexGroup group;
+    NameIndex<Variable> names(group);
+    std::vector<std::shared_ptr<Variable>> variables;
+
+    for (int i = 0; i < 100; i++)
+        variables.push_back(std::make_shared<Variable>(std::to_string(i), "var" + std::to_string(i)));
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> ok = true;
+
+    for (int i = 0; i < 4; i++) {
+        threads.push_back(std::thread([&names, &variables, &ok]() {
+            for (int j = 0; j < 1000; j++) {
+                if (names.find(variables, "var" + std::to_string(j % 100)) != j % 100)
+                    ok = false;
+            }
+        }));
+    }
+
+    for (int i = 0; i < 100; i++) {
+        names.invalidate();
+        group.invalidate();
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_TRUE(ok);
+}
@@ -1,7 +1,9 @@
 #include <internal/projectdownloader.h>
+#include <internal/md5.h>
 #include <downloaderfactorymock.h>
 #include <downloadermock.h>
 #include <thread>
+#include <filesystem>
 
 #include "../common.h"
 
@@ -75,51 +77,153 @@ TEST_F(ProjectDownloaderTest, DownloadJson)
     ASSERT_EQ(m_downloader->downloadedAssetCount(), 0);
 }
 
-TEST_F(ProjectDownloaderTest, DownloadAssets)
+static const std::string assetPrefix = "https://assets.scratch.mit.edu/internalapi/asset/";
+static const std::string assetSuffix = "/get";
+static const std::vector<std::string> assetIds = { "abc", "def", "ghi", "jkl", "mno", "pqr", "stu", "vwx", "yzA", "BCD", "EFG", "HIJ", "KLM", "NOP", "QRS", "TUV", "WXY" };
+static const std::vector<std::string> assetData = { "a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8", "a9", "a10", "a11", "a12", "a13", "a14", "a15", "a16", "a17" };
+
+static unsigned int assetThreadCount()
 {
-    static const std::string assetPrefix = "https://assets.scratch.mit.edu/internalapi/asset/";
-    static const std::string assetSuffix = "/get";
-    static const std::vector<std::string> assetIds = { "abc", "def", "ghi", "jkl", "mno", "pqr", "stu", "vwx", "yzA", "BCD", "EFG", "HIJ", "KLM", "NOP", "QRS", "TUV", "WXY" };
-    static const std::vector<std::string> assetData = { "a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8", "a9", "a10", "a11", "a12", "a13", "a14", "a15", "a16", "a17" };
-    ASSERT_EQ(assetIds.size(), assetData.size());
-    std::vector<std::shared_ptr<DownloaderMock>> downloaders;
-    std::vector<unsigned int> downloaderTextIndexes;
     unsigned int threadCount = std::thread::hardware_concurrency();
-    threadCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(std::ceil(assetIds.size() / 5.0))));
+    return std::max(1u, std::min(threadCount, static_cast<unsigned int>(std::ceil(assetIds.size() / 5.0))));
+}
 
-    downloaders.reserve(threadCount);
-    downloaderTextIndexes.reserve(threadCount);
+// Creates downloaders which return the data of the last downloaded asset
+static std::vector<std::shared_ptr<DownloaderMock>>
+createAssetDownloaders(DownloaderFactoryMock *factory, std::vector<std::string> &urls, std::atomic<unsigned int> &downloadCount, const std::vector<std::string> &ids = assetIds)
+{
+    unsigned int threadCount = assetThreadCount();
+    std::vector<std::shared_ptr<DownloaderMock>> downloaders;
+    urls = std::vector<std::string>(threadCount);
 
     for (unsigned int i = 0; i < threadCount; i++) {
-        downloaders.push_back(std::make_shared<DownloaderMock>());
-        downloaderTextIndexes.push_back(0);
+        auto downloader = std::make_shared<DownloaderMock>();
+        downloaders.push_back(downloader);
+
+        EXPECT_CALL(*downloader, download(_)).WillRepeatedly(Invoke([i, &urls, &downloadCount](const std::string &url) {
+            urls[i] = url;
+            downloadCount++;
+            return true;
+        }));
+
+        EXPECT_CALL(*downloader, text()).WillRepeatedly(Invoke([i, &urls, &ids]() -> const std::string & {
+            for (size_t j = 0; j < ids.size(); j++) {
+                if (urls[i] == assetPrefix + ids[j] + assetSuffix)
+                    return assetData[j];
+            }
+
+            assert(false);
+            return assetData[0];
+        }));
     }
 
-    // Success
-    unsigned int count = 0;
-    EXPECT_CALL(*m_factory, create()).Times(threadCount);
-    ON_CALL(*m_factory, create()).WillByDefault(Invoke([&downloaders, &count]() {
-        assert(count < downloaders.size());
-        return downloaders[count++];
+    EXPECT_CALL(*factory, create()).Times(threadCount).WillRepeatedly(Invoke([downloaders]() {
+        static unsigned int count = 0;
+        return downloaders[count++ % downloaders.size()];
     }));
 
-    for (unsigned int i = 0; i < threadCount; i++)
-        downloaderTextIndexes[i] = 0;
-
-    for (unsigned int i = 0; i < threadCount; i++) {
-        auto downloader = downloaders[i];
-        unsigned int n = std::ceil(assetIds.size() / static_cast<double>(threadCount));
-        unsigned int repeatCount = std::min(n, static_cast<unsigned int>(assetIds.size()) - i * n);
-
-        for (unsigned int j = 0; j < repeatCount; j++) {
-            unsigned int index = i * n + j;
-            EXPECT_CALL(*downloader, download(assetPrefix + assetIds[index] + assetSuffix)).WillOnce(Return(true));
-        }
+    return downloaders;
+}
 
-        EXPECT_CALL(*downloader, text()).Times(repeatCount).WillRepeatedly(Invoke([i, n, &downloaderTextIndexes]() -> const std::string & { return assetData[i * n + downloaderTextIndexes[i]++]; }));
-    }
+TEST_F(ProjectDownloaderTest, DownloadAssets)
+{
+    ASSERT_EQ(assetIds.size(), assetData.size());
+    std::vector<std::string> urls;
+    std::atomic<unsigned int> downloadCount = 0;
+    auto downloaders = createAssetDownloaders(m_factory.get(), urls, downloadCount);
 
+    // Success (threads take assets from a shared queue, so every asset is downloaded exactly once)
     ASSERT_TRUE(m_downloader->downloadAssets(assetIds));
     ASSERT_EQ(m_downloader->assets(), assetData);
     ASSERT_EQ(m_downloader->downloadedAssetCount(), assetIds.size());
+    ASSERT_EQ(downloadCount, assetIds.size());
+}
+
+TEST_F(ProjectDownloaderTest, DownloadAssetsFailure)
+{
+    auto downloader = std::make_shared<DownloaderMock>();
+    EXPECT_CALL(*m_factory, create()).WillOnce(Return(downloader));
+    EXPECT_CALL(*downloader, download(assetPrefix + "abc" + assetSuffix)).WillOnce(Return(false));
+    ASSERT_FALSE(m_downloader->downloadAssets({ "abc" }));
+    ASSERT_EQ(m_downloader->downloadedAssetCount(), 0);
+}
+
+TEST_F(ProjectDownloaderTest, AssetCache)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "libscratchcpp_projectdownloader_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    m_downloader->setCacheDirectory(dir.string());
+
+    // Only assets which match their MD5 hash are cached
+    std::vector<std::string> ids;
+
+    for (const std::string &data : assetData)
+        ids.push_back(Md5::hex(data) + ".svg");
+
+    // First download stores the assets in the cache
+    {
+        std::vector<std::string> urls;
+        std::atomic<unsigned int> downloadCount = 0;
+        auto downloaders = createAssetDownloaders(m_factory.get(), urls, downloadCount, ids);
+
+        ASSERT_TRUE(m_downloader->downloadAssets(ids));
+        ASSERT_EQ(m_downloader->assets(), assetData);
+        ASSERT_EQ(downloadCount, ids.size());
+    }
+
+    for (const std::string &id : ids)
+        ASSERT_TRUE(std::filesystem::exists(dir / id));
+
+    // Second download doesn't use the network
+    {
+        std::vector<std::string> urls;
+        std::atomic<unsigned int> downloadCount = 0;
+        auto downloaders = createAssetDownloaders(m_factory.get(), urls, downloadCount, ids);
+
+        ASSERT_TRUE(m_downloader->downloadAssets(ids));
+        ASSERT_EQ(m_downloader->assets(), assetData);
+        ASSERT_EQ(m_downloader->downloadedAssetCount(), ids.size());
+        ASSERT_EQ(downloadCount, 0);
+    }
+
+    // Corrupted cache files are downloaded again
+    {
+        std::ofstream file(dir / ids[3], std::ios::binary);
+        file << "corrupted";
+    }
+
+    {
+        std::vector<std::string> urls;
+        std::atomic<unsigned int> downloadCount = 0;
+        auto downloaders = createAssetDownloaders(m_factory.get(), urls, downloadCount, ids);
+
+        ASSERT_TRUE(m_downloader->downloadAssets(ids));
+        ASSERT_EQ(m_downloader->assets(), assetData);
+        ASSERT_EQ(downloadCount, 1);
+        ASSERT_EQ(readFileStr((dir / ids[3]).string()), assetData[3]);
+    }
+
+    // Assets which don't match their ID aren't cached
+    {
+        std::vector<std::string> urls;
+        std::atomic<unsigned int> downloadCount = 0;
+        auto downloaders = createAssetDownloaders(m_factory.get(), urls, downloadCount);
+
+        ASSERT_TRUE(m_downloader->downloadAssets(assetIds));
+        ASSERT_EQ(m_downloader->assets(), assetData);
+        ASSERT_EQ(downloadCount, assetIds.size());
+    }
+
+    // Invalid asset IDs aren't cached
+    auto downloader = std::make_shared<DownloaderMock>();
+    static const std::string data = "test";
+    EXPECT_CALL(*m_factory, create()).WillOnce(Return(downloader));
+    EXPECT_CALL(*downloader, download(assetPrefix + "../abc" + assetSuffix)).WillOnce(Return(true));
+    EXPECT_CALL(*downloader, text()).WillOnce(ReturnRef(data));
+    ASSERT_TRUE(m_downloader->downloadAssets({ "../abc" }));
+    ASSERT_EQ(m_downloader->assets(), std::vector<std::string>({ data }));
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()), ids.size());
+
+    std::filesystem::remove_all(dir);
 }
@@ -0,0 +1,59 @@
+#include <internal/pngdecoder.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(PngDecoderTest, Rgba)
+{
+    std::string data = readFileStr("image2.png");
+    unsigned int width = 0, height = 0;
+    std::vector<unsigned char> alpha;
+
+    ASSERT_TRUE(PngDecoder::readAlpha(data.data(), data.size(), &width, &height, &alpha));
+    ASSERT_EQ(width, 4);
+    ASSERT_EQ(height, 6);
+    ASSERT_EQ(alpha, std::vector<unsigned char>({ 0, 0, 0, 0, 0, 255, 255, 255, 0, 255, 0, 149, 0, 255, 255, 255, 0, 0, 0, 0, 0, 0, 0, 0 }));
+
+    data = readFileStr("image1.png");
+    ASSERT_TRUE(PngDecoder::readAlpha(data.data(), data.size(), &width, &height, &alpha));
+    ASSERT_EQ(width, 6);
+    ASSERT_EQ(height, 3);
+    ASSERT_EQ(alpha, std::vector<unsigned char>(18, 255));
+}
+
+TEST(PngDecoderTest, Palette)
+{
+    // 3x2 image with 2-bit palette indices and a tRNS chunk, stored without compression
+    static const unsigned char data[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+                                          0x02, 0x03, 0x00, 0x00, 0x00, 0xE0, 0x1A, 0x8E, 0x89, 0x00, 0x00, 0x00, 0x0C, 0x50, 0x4C, 0x54, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00, 0x00, 0x35, 0xE9, 0x37, 0x96, 0x00, 0x00, 0x00, 0x03, 0x74, 0x52, 0x4E, 0x53, 0x00, 0x80, 0xFF, 0xEC, 0xF7, 0xB3, 0x18,
+                                          0x00, 0x00, 0x00, 0x0F, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x01, 0x04, 0x00, 0xFB, 0xFF, 0x00, 0x18, 0x00, 0xE4, 0x01, 0x30, 0x00, 0xFD, 0xC3,
+                                          0xF9, 0xE4, 0xC8, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82 };
+    unsigned int width = 0, height = 0;
+    std::vector<unsigned char> alpha;
+
+    ASSERT_TRUE(PngDecoder::readAlpha(data, sizeof(data), &width, &height, &alpha));
+    ASSERT_EQ(width, 3);
+    ASSERT_EQ(height, 2);
+    ASSERT_EQ(alpha, std::vector<unsigned char>({ 0, 128, 255, 255, 255, 128 }));
+}
+
+TEST(PngDecoderTest, Invalid)
+{
+    unsigned int width = 0, height = 0;
+    std::vector<unsigned char> alpha;
+
+    ASSERT_FALSE(PngDecoder::readAlpha(nullptr, 0, &width, &height, &alpha));
+
+    // JPEG images don't have an alpha channel
+    std::string data = readFileStr("image1.jpg");
+    ASSERT_FALSE(PngDecoder::readAlpha(data.data(), data.size(), &width, &height, &alpha));
+
+    // Truncated image
+    data = readFileStr("image2.png");
+    data.resize(data.size() - 30);
+    ASSERT_FALSE(PngDecoder::readAlpha(data.data(), data.size(), &width, &height, &alpha));
+    ASSERT_EQ(width, 0);
+    ASSERT_EQ(height, 0);
+}
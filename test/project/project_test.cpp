@@ -152,6 +152,30 @@ TEST_F(ProjectTest, ScratchVersion)
     ASSERT_EQ(p.scratchVersion(), ScratchVersion::Scratch3);
 }
 
+TEST_F(ProjectTest, AssetPreloading)
+{
+    Project p;
+    ASSERT_FALSE(p.assetPreloadingEnabled());
+
+    p.setAssetPreloadingEnabled(true);
+    ASSERT_TRUE(p.assetPreloadingEnabled());
+
+    p.setAssetPreloadingEnabled(false);
+    ASSERT_FALSE(p.assetPreloadingEnabled());
+}
+
+TEST_F(ProjectTest, CacheDirectory)
+{
+    Project p;
+    ASSERT_TRUE(p.cacheDirectory().empty());
+
+    p.setCacheDirectory("cache");
+    ASSERT_EQ(p.cacheDirectory(), "cache");
+
+    p.setCacheDirectory("");
+    ASSERT_TRUE(p.cacheDirectory().empty());
+}
+
 TEST(LoadProjectTest, DownloadProgressCallback)
 {
     ProjectDownloaderFactoryMock factory;
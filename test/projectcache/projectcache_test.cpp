@@ -0,0 +1,420 @@
+#include <scratchcpp/broadcast.h>
+#include <scratchcpp/input.h>
+#include <scratchcpp/inputvalue.h>
+#include <scratchcpp/field.h>
+#include <scratchcpp/block.h>
+#include <scratchcpp/blockprototype.h>
+#include <scratchcpp/variable.h>
+#include <scratchcpp/list.h>
+#include <scratchcpp/costume.h>
+#include <scratchcpp/comment.h>
+#include <scratchcpp/sound.h>
+#include <scratchcpp/stage.h>
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/virtualmachine.h>
+#include <internal/projectcache.h>
+#include <internal/scratch3reader.h>
+#include <internal/zipreader.h>
+#include <internal/sha256.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+class ProjectCacheTest : public testing::Test
+{
+    public:
+        void SetUp() override
+        {
+            // Tests may run in parallel, use a directory for each test
+            m_dir = std::filesystem::temp_directory_path() / ("libscratchcpp_projectcache_test_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+            std::filesystem::remove_all(m_dir);
+            std::filesystem::create_directories(m_dir);
+
+            ZipReader zip("load_test.sb3");
+            ASSERT_TRUE(zip.open());
+            m_json = zip.readFileToString("project.json");
+
+            m_reader.setFileName("load_test.sb3");
+            ASSERT_TRUE(m_reader.load());
+
+            m_compiledProject.sections = { "Motion", "Looks" };
+            m_compiledProject.graphicsEffects = { "color", "", "ghost" };
+            m_compiledProject.targets.resize(m_reader.targets().size());
+
+            CompiledTarget &target = m_compiledProject.targets.back();
+            target.functions = { { "Looks", 3 }, { "Motion", 0 } };
+            target.scripts = { { "a", { vm::OP_START, vm::OP_CONST, 0, vm::OP_EXEC, 1, vm::OP_HALT } }, { "b", { vm::OP_START, vm::OP_HALT } } };
+            target.procedureCodes = { "test %s" };
+            target.constValues = { 5.25, "test", true, Value(Value::SpecialValue::Infinity) };
+            target.variables = { { 0, 1 }, { -1, -1 } };
+            target.lists = { { 1, 0 } };
+            target.hats = { { HatType::Broadcast, "a", 2 }, { HatType::Broadcast, "b", -1, 1 }, { HatType::KeyPress, "c", -1, -1, "space" } };
+        }
+
+        void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+        static void checkInputValue(InputValue *value1, InputValue *value2)
+        {
+            ASSERT_EQ(value1->type(), value2->type());
+            ASSERT_EQ(value1->value(), value2->value());
+            ASSERT_EQ(value1->valueId(), value2->valueId());
+            ASSERT_EQ(value1->valueBlockId(), value2->valueBlockId());
+        }
+
+        static void checkBlock(Block *block1, Block *block2)
+        {
+            ASSERT_EQ(block1->id(), block2->id());
+            ASSERT_EQ(block1->isTopLevelReporter(), block2->isTopLevelReporter());
+
+            if (block1->isTopLevelReporter()) {
+                checkInputValue(block1->topLevelReporterInfo(), block2->topLevelReporterInfo());
+                return;
+            }
+
+            ASSERT_EQ(block1->opcode(), block2->opcode());
+            ASSERT_EQ(block1->nextId(), block2->nextId());
+            ASSERT_EQ(block1->parentId(), block2->parentId());
+            ASSERT_EQ(block1->shadow(), block2->shadow());
+            ASSERT_EQ(block1->commentId(), block2->commentId());
+            ASSERT_EQ(block1->mutationHasNext(), block2->mutationHasNext());
+            ASSERT_EQ(block1->mutationPrototype()->procCode(), block2->mutationPrototype()->procCode());
+            ASSERT_EQ(block1->mutationPrototype()->argumentIds(), block2->mutationPrototype()->argumentIds());
+            ASSERT_EQ(block1->mutationPrototype()->argumentNames(), block2->mutationPrototype()->argumentNames());
+            ASSERT_EQ(block1->mutationPrototype()->warp(), block2->mutationPrototype()->warp());
+
+            ASSERT_EQ(block1->inputs().size(), block2->inputs().size());
+
+            for (size_t i = 0; i < block1->inputs().size(); i++) {
+                auto input1 = block1->inputAt(i);
+                auto input2 = block2->inputAt(i);
+                ASSERT_EQ(input1->name(), input2->name());
+                ASSERT_EQ(input1->type(), input2->type());
+                checkInputValue(input1->primaryValue(), input2->primaryValue());
+                checkInputValue(input1->secondaryValue(), input2->secondaryValue());
+            }
+
+            ASSERT_EQ(block1->fields().size(), block2->fields().size());
+
+            for (size_t i = 0; i < block1->fields().size(); i++) {
+                auto field1 = block1->fieldAt(i);
+                auto field2 = block2->fieldAt(i);
+                ASSERT_EQ(field1->name(), field2->name());
+                ASSERT_EQ(field1->value(), field2->value());
+                ASSERT_EQ(field1->valueId(), field2->valueId());
+            }
+        }
+
+        static void checkCompiledTarget(const CompiledTarget &target1, const CompiledTarget &target2)
+        {
+            ASSERT_EQ(target1.functions.size(), target2.functions.size());
+
+            for (size_t i = 0; i < target1.functions.size(); i++) {
+                ASSERT_EQ(target1.functions[i].section, target2.functions[i].section);
+                ASSERT_EQ(target1.functions[i].index, target2.functions[i].index);
+            }
+
+            ASSERT_EQ(target1.scripts.size(), target2.scripts.size());
+
+            for (size_t i = 0; i < target1.scripts.size(); i++) {
+                ASSERT_EQ(target1.scripts[i].blockId, target2.scripts[i].blockId);
+                ASSERT_EQ(target1.scripts[i].bytecode, target2.scripts[i].bytecode);
+            }
+
+            ASSERT_EQ(target1.procedureCodes, target2.procedureCodes);
+
+            ASSERT_EQ(target1.constValues.size(), target2.constValues.size());
+
+            for (size_t i = 0; i < target1.constValues.size(); i++) {
+                ASSERT_EQ(target1.constValues[i], target2.constValues[i]);
+                ASSERT_EQ(target1.constValues[i].type(), target2.constValues[i].type());
+            }
+
+            ASSERT_EQ(target1.variables.size(), target2.variables.size());
+
+            for (size_t i = 0; i < target1.variables.size(); i++) {
+                ASSERT_EQ(target1.variables[i].target, target2.variables[i].target);
+                ASSERT_EQ(target1.variables[i].index, target2.variables[i].index);
+            }
+
+            ASSERT_EQ(target1.lists.size(), target2.lists.size());
+
+            for (size_t i = 0; i < target1.lists.size(); i++) {
+                ASSERT_EQ(target1.lists[i].target, target2.lists[i].target);
+                ASSERT_EQ(target1.lists[i].index, target2.lists[i].index);
+            }
+
+            ASSERT_EQ(target1.hats.size(), target2.hats.size());
+
+            for (size_t i = 0; i < target1.hats.size(); i++) {
+                ASSERT_EQ(target1.hats[i].type, target2.hats[i].type);
+                ASSERT_EQ(target1.hats[i].blockId, target2.hats[i].blockId);
+                ASSERT_EQ(target1.hats[i].broadcast, target2.hats[i].broadcast);
+                ASSERT_EQ(target1.hats[i].backdrop, target2.hats[i].backdrop);
+                ASSERT_EQ(target1.hats[i].keyName, target2.hats[i].keyName);
+            }
+        }
+
+        static void checkTarget(Target *target1, Target *target2)
+        {
+            ASSERT_EQ(target1->isStage(), target2->isStage());
+            ASSERT_EQ(target1->name(), target2->name());
+            ASSERT_EQ(target1->costumeIndex(), target2->costumeIndex());
+            ASSERT_EQ(target1->layerOrder(), target2->layerOrder());
+            ASSERT_EQ(target1->volume(), target2->volume());
+
+            ASSERT_EQ(target1->variables().size(), target2->variables().size());
+
+            for (size_t i = 0; i < target1->variables().size(); i++) {
+                auto variable1 = target1->variableAt(i);
+                auto variable2 = target2->variableAt(i);
+                ASSERT_EQ(variable1->id(), variable2->id());
+                ASSERT_EQ(variable1->name(), variable2->name());
+                ASSERT_EQ(variable1->value(), variable2->value());
+                ASSERT_EQ(variable1->value().type(), variable2->value().type());
+                ASSERT_EQ(variable1->isCloudVariable(), variable2->isCloudVariable());
+            }
+
+            ASSERT_EQ(target1->lists().size(), target2->lists().size());
+
+            for (size_t i = 0; i < target1->lists().size(); i++) {
+                auto list1 = target1->listAt(i);
+                auto list2 = target2->listAt(i);
+                ASSERT_EQ(list1->id(), list2->id());
+                ASSERT_EQ(list1->name(), list2->name());
+                ASSERT_EQ(*list1, *list2);
+            }
+
+            ASSERT_EQ(target1->blocks().size(), target2->blocks().size());
+
+            for (size_t i = 0; i < target1->blocks().size(); i++)
+                checkBlock(target1->blocks()[i].get(), target2->blocks()[i].get());
+
+            ASSERT_EQ(target1->comments().size(), target2->comments().size());
+
+            for (size_t i = 0; i < target1->comments().size(); i++) {
+                auto comment1 = target1->commentAt(i);
+                auto comment2 = target2->commentAt(i);
+                ASSERT_EQ(comment1->id(), comment2->id());
+                ASSERT_EQ(comment1->blockId(), comment2->blockId());
+                ASSERT_EQ(comment1->x(), comment2->x());
+                ASSERT_EQ(comment1->y(), comment2->y());
+                ASSERT_EQ(comment1->width(), comment2->width());
+                ASSERT_EQ(comment1->height(), comment2->height());
+                ASSERT_EQ(comment1->minimized(), comment2->minimized());
+                ASSERT_EQ(comment1->text(), comment2->text());
+            }
+
+            ASSERT_EQ(target1->costumes().size(), target2->costumes().size());
+
+            for (size_t i = 0; i < target1->costumes().size(); i++) {
+                auto costume1 = target1->costumeAt(i);
+                auto costume2 = target2->costumeAt(i);
+                ASSERT_EQ(costume1->name(), costume2->name());
+                ASSERT_EQ(costume1->id(), costume2->id());
+                ASSERT_EQ(costume1->dataFormat(), costume2->dataFormat());
+                ASSERT_EQ(costume1->bitmapResolution(), costume2->bitmapResolution());
+                ASSERT_EQ(costume1->rotationCenterX(), costume2->rotationCenterX());
+                ASSERT_EQ(costume1->rotationCenterY(), costume2->rotationCenterY());
+            }
+
+            ASSERT_EQ(target1->sounds().size(), target2->sounds().size());
+
+            for (size_t i = 0; i < target1->sounds().size(); i++) {
+                auto sound1 = target1->soundAt(i);
+                auto sound2 = target2->soundAt(i);
+                ASSERT_EQ(sound1->name(), sound2->name());
+                ASSERT_EQ(sound1->id(), sound2->id());
+                ASSERT_EQ(sound1->dataFormat(), sound2->dataFormat());
+                ASSERT_EQ(sound1->rate(), sound2->rate());
+                ASSERT_EQ(sound1->sampleCount(), sound2->sampleCount());
+            }
+
+            if (target1->isStage()) {
+                Stage *stage1 = static_cast<Stage *>(target1);
+                Stage *stage2 = static_cast<Stage *>(target2);
+                ASSERT_EQ(stage1->tempo(), stage2->tempo());
+                ASSERT_EQ(stage1->videoState(), stage2->videoState());
+                ASSERT_EQ(stage1->videoTransparency(), stage2->videoTransparency());
+                ASSERT_EQ(stage1->textToSpeechLanguage(), stage2->textToSpeechLanguage());
+            } else {
+                Sprite *sprite1 = static_cast<Sprite *>(target1);
+                Sprite *sprite2 = static_cast<Sprite *>(target2);
+                ASSERT_EQ(sprite1->visible(), sprite2->visible());
+                ASSERT_EQ(sprite1->x(), sprite2->x());
+                ASSERT_EQ(sprite1->y(), sprite2->y());
+                ASSERT_EQ(sprite1->size(), sprite2->size());
+                ASSERT_EQ(sprite1->direction(), sprite2->direction());
+                ASSERT_EQ(sprite1->draggable(), sprite2->draggable());
+                ASSERT_EQ(sprite1->rotationStyle(), sprite2->rotationStyle());
+            }
+        }
+
+        std::filesystem::path m_dir;
+        std::string m_json;
+        Scratch3Reader m_reader;
+        CompiledProject m_compiledProject;
+};
+
+TEST_F(ProjectCacheTest, Directory)
+{
+    ProjectCache cache(m_dir.string());
+    ASSERT_EQ(cache.directory(), m_dir.string());
+}
+
+TEST_F(ProjectCacheTest, FilePath)
+{
+    ProjectCache cache(m_dir.string());
+    ASSERT_EQ(cache.filePath(m_json), cache.filePath(m_json));
+    ASSERT_NE(cache.filePath(m_json), cache.filePath(m_json + " "));
+    ASSERT_EQ(cache.filePath(m_json).find(m_dir.string()), 0);
+    ASSERT_NE(cache.filePath(m_json).find(Sha256::hex(m_json)), std::string::npos);
+}
+
+TEST_F(ProjectCacheTest, LoadMissing)
+{
+    ProjectCache cache(m_dir.string());
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+    ASSERT_TRUE(cache.broadcasts().empty());
+    ASSERT_TRUE(cache.extensions().empty());
+}
+
+TEST_F(ProjectCacheTest, SaveLoad)
+{
+    ProjectCache cache(m_dir.string());
+    ASSERT_TRUE(cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+    ASSERT_TRUE(std::filesystem::exists(cache.filePath(m_json)));
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(m_dir), std::filesystem::directory_iterator()), 1); // no temporary files
+
+    ProjectCache loaded(m_dir.string());
+    ASSERT_TRUE(loaded.load(m_json));
+    ASSERT_FALSE(loaded.load(m_json + " "));
+    ASSERT_TRUE(loaded.load(m_json));
+
+    ASSERT_EQ(loaded.targets().size(), m_reader.targets().size());
+
+    for (size_t i = 0; i < loaded.targets().size(); i++)
+        checkTarget(m_reader.targets()[i].get(), loaded.targets()[i].get());
+
+    ASSERT_EQ(loaded.broadcasts().size(), m_reader.broadcasts().size());
+
+    for (size_t i = 0; i < loaded.broadcasts().size(); i++) {
+        ASSERT_EQ(loaded.broadcasts()[i]->id(), m_reader.broadcasts()[i]->id());
+        ASSERT_EQ(loaded.broadcasts()[i]->name(), m_reader.broadcasts()[i]->name());
+    }
+
+    ASSERT_EQ(loaded.extensions(), m_reader.extensions());
+
+    const CompiledProject &compiledProject = loaded.compiledProject();
+    ASSERT_EQ(compiledProject.sections, m_compiledProject.sections);
+    ASSERT_EQ(compiledProject.graphicsEffects, m_compiledProject.graphicsEffects);
+    ASSERT_EQ(compiledProject.targets.size(), m_compiledProject.targets.size());
+
+    for (size_t i = 0; i < compiledProject.targets.size(); i++)
+        checkCompiledTarget(compiledProject.targets[i], m_compiledProject.targets[i]);
+}
+
+TEST_F(ProjectCacheTest, SaveLoadWithoutCompiledScripts)
+{
+    // Targets are cached even if the scripts couldn't be stored
+    ProjectCache cache(m_dir.string());
+    m_compiledProject.targets.clear();
+    ASSERT_TRUE(cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+
+    ASSERT_TRUE(cache.load(m_json));
+    ASSERT_EQ(cache.targets().size(), m_reader.targets().size());
+    ASSERT_TRUE(cache.compiledProject().targets.empty());
+
+    // The number of compiled targets must match otherwise
+    m_compiledProject.targets.resize(m_reader.targets().size() + 1);
+    ASSERT_TRUE(cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+}
+
+TEST_F(ProjectCacheTest, InvalidFile)
+{
+    ProjectCache cache(m_dir.string());
+    ASSERT_TRUE(cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+
+    // Truncated file
+    std::string path = cache.filePath(m_json);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+
+    // Invalid header
+    std::ofstream file(path, std::ios::binary);
+    file << "invalid";
+    file.close();
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+}
+
+TEST_F(ProjectCacheTest, RenamedFile)
+{
+    // The key is stored in the file, so a cache file of another project isn't loaded
+    ProjectCache cache(m_dir.string());
+    std::string otherJson = m_json;
+    otherJson.back() = ' ';
+    ASSERT_TRUE(cache.save(otherJson, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+    std::filesystem::rename(cache.filePath(otherJson), cache.filePath(m_json));
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+    ASSERT_TRUE(cache.compiledProject().targets.empty());
+}
+
+TEST_F(ProjectCacheTest, InvalidStringLength)
+{
+    // Lengths which exceed the file size are rejected (without allocating them)
+    ProjectCache cache(m_dir.string());
+    std::string path = cache.filePath(m_json);
+    std::ofstream file(path, std::ios::binary);
+    uint32_t version = ProjectCache::FORMAT_VERSION;
+    uint32_t length = 0xFFFFFFFF;
+    file.write("SCPC", 4);
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char *>(&length), sizeof(length)); // key
+    file.write("0123456789abcdef", 16);
+    file.close();
+
+    ASSERT_FALSE(cache.load(m_json));
+    ASSERT_TRUE(cache.targets().empty());
+}
+
+TEST_F(ProjectCacheTest, ConcurrentSaves)
+{
+    // Each save uses its own temporary file
+    std::vector<std::thread> threads;
+    std::atomic<int> saved = 0;
+
+    for (int i = 0; i < 8; i++) {
+        threads.push_back(std::thread([this, &saved]() {
+            ProjectCache cache(m_dir.string());
+
+            if (cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject))
+                saved++;
+        }));
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(saved, 8);
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(m_dir), std::filesystem::directory_iterator()), 1);
+
+    ProjectCache cache(m_dir.string());
+    ASSERT_TRUE(cache.load(m_json));
+    ASSERT_EQ(cache.targets().size(), m_reader.targets().size());
+}
+
+TEST_F(ProjectCacheTest, MissingDirectory)
+{
+    ProjectCache cache((m_dir / "missing").string());
+    ASSERT_FALSE(cache.save(m_json, m_reader.targets(), m_reader.broadcasts(), m_reader.extensions(), m_compiledProject));
+}
@@ -6,19 +6,17 @@ using namespace libscratchcpp;
 
 TEST(RandomGeneratorTest, RandInt)
 {
-    auto rng = RandomGenerator::instance();
-    ASSERT_TRUE(rng);
-
+    RandomGenerator rng;
     long num;
 
     for (int i = 0; i < 25; i++) {
-        num = rng->randint(-2, 3);
+        num = rng.randint(-2, 3);
         ASSERT_GE(num, -2);
         ASSERT_LE(num, 3);
     }
 
     for (int i = 0; i < 25; i++) {
-        num = rng->randint(5, -3);
+        num = rng.randint(5, -3);
         ASSERT_GE(num, -3);
         ASSERT_LE(num, 5);
     }
@@ -26,20 +24,35 @@ TEST(RandomGeneratorTest, RandInt)
 
 TEST(RandomGeneratorTest, RandIntDouble)
 {
-    auto rng = RandomGenerator::instance();
-    ASSERT_TRUE(rng);
-
+    RandomGenerator rng;
     long num;
 
     for (int i = 0; i < 1000; i++) {
-        num = rng->randintDouble(-2.23, 3.875);
+        num = rng.randintDouble(-2.23, 3.875);
         ASSERT_GE(num, -2.23);
         ASSERT_LE(num, 3.875);
     }
 
     for (int i = 0; i < 1000; i++) {
-        num = rng->randintDouble(5.081, -2.903);
+        num = rng.randintDouble(5.081, -2.903);
         ASSERT_GE(num, -2.903);
         ASSERT_LE(num, 5.081);
     }
 }
+
+TEST(RandomGeneratorTest, Seed)
+{
+    RandomGenerator rng1(42);
+    RandomGenerator rng2(42);
+    std::vector<long> numbers;
+
+    for (int i = 0; i < 100; i++) {
+        numbers.push_back(rng1.randint(0, 1000000));
+        ASSERT_EQ(rng2.randint(0, 1000000), numbers.back());
+    }
+
+    rng1.setSeed(42);
+
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(rng1.randint(0, 1000000), numbers[i]);
+}
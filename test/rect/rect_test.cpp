@@ -77,3 +77,29 @@ TEST(RectTest, Height)
     rect.setBottom(-58.162);
     ASSERT_EQ(rect.height(), 35.272);
 }
+
+TEST(RectTest, Intersects)
+{
+    Rect rect(-50, 25, 50, -25);
+
+    ASSERT_TRUE(rect.intersects(rect));
+    ASSERT_TRUE(rect.intersects(Rect(0, 0, 100, -100)));
+    ASSERT_TRUE(rect.intersects(Rect(-10, 10, 10, -10)));
+    ASSERT_TRUE(Rect(-10, 10, 10, -10).intersects(rect));
+    ASSERT_TRUE(rect.intersects(Rect(50, 25, 60, 20))); // touching edges
+    ASSERT_FALSE(rect.intersects(Rect(50.1, 25, 60, 20)));
+    ASSERT_FALSE(rect.intersects(Rect(-100, 100, -60, 30)));
+    ASSERT_FALSE(rect.intersects(Rect(-10, -26, 10, -40)));
+}
+
+TEST(RectTest, Contains)
+{
+    Rect rect(-50, 25, 50, -25);
+
+    ASSERT_TRUE(rect.contains(0, 0));
+    ASSERT_TRUE(rect.contains(-50, 25));
+    ASSERT_TRUE(rect.contains(50, -25));
+    ASSERT_FALSE(rect.contains(50.1, 0));
+    ASSERT_FALSE(rect.contains(0, -25.1));
+    ASSERT_FALSE(rect.contains(-60, 30));
+}
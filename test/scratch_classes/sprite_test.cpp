@@ -96,6 +96,13 @@ TEST(SpriteTest, Clone)
         ASSERT_EQ(*clone->listAt(1), std::deque<Value>({ "test" }));
         ASSERT_EQ(clone->listAt(1)->target(), clone);
 
+        ASSERT_EQ(clone->findVariable("var2"), 1);
+        ASSERT_EQ(clone->findVariableById("a"), 0);
+        ASSERT_EQ(clone->findVariable("invalid"), -1);
+        ASSERT_EQ(clone->findList("list2"), 1);
+        ASSERT_EQ(clone->findListById("c"), 0);
+        ASSERT_EQ(clone->findListById("invalid"), -1);
+
         ASSERT_EQ(clone->costumeIndex(), 1);
         ASSERT_EQ(clone->layerOrder(), 5);
         ASSERT_EQ(clone->volume(), 50);
@@ -550,6 +557,196 @@ TEST(SpriteTest, KeepInFence)
     ASSERT_EQ(std::round(fencedY * 100) / 100, 150.9);
 }
 
+TEST(SpriteTest, CostumeBoundingRect)
+{
+    Sprite sprite;
+    SpriteHandlerMock handler;
+    EXPECT_CALL(handler, init);
+    sprite.setInterface(&handler);
+    EXPECT_CALL(handler, onXChanged).WillRepeatedly(Return());
+    EXPECT_CALL(handler, onYChanged).WillRepeatedly(Return());
+    EXPECT_CALL(handler, onSizeChanged).WillRepeatedly(Return());
+    EXPECT_CALL(handler, onDirectionChanged).WillRepeatedly(Return());
+    EXPECT_CALL(handler, onRotationStyleChanged).WillRepeatedly(Return());
+    EXPECT_CALL(handler, onCostumeChanged).WillRepeatedly(Return());
+
+    // PNG header of a 100x60 image
+    static const unsigned char png[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n', 0, 0, 0, 13, 'I', 'H', 'D', 'R', 0, 0, 0, 100, 0, 0, 0, 60, 8, 6, 0, 0, 0 };
+    auto costume = std::make_shared<Costume>("costume1", "", "png");
+    costume->setData(sizeof(png), const_cast<unsigned char *>(png));
+    costume->setBitmapResolution(2);
+    costume->setRotationCenterX(50);
+    costume->setRotationCenterY(30);
+
+    // The sprite interface isn't used when the costume size is known
+    auto unknownCostume = std::make_shared<Costume>("costume2", "", "png");
+    sprite.addCostume(unknownCostume);
+    sprite.addCostume(costume);
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(1, 2, 3, 4)));
+    Rect rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), 1);
+
+    sprite.setCostumeIndex(1);
+    sprite.setX(10);
+    sprite.setY(20);
+    EXPECT_CALL(handler, boundingRect()).Times(0);
+
+    rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), -15);
+    ASSERT_EQ(rect.top(), 35);
+    ASSERT_EQ(rect.right(), 35);
+    ASSERT_EQ(rect.bottom(), 5);
+
+    sprite.setSize(200);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), -40);
+    ASSERT_EQ(rect.top(), 50);
+    ASSERT_EQ(rect.right(), 60);
+    ASSERT_EQ(rect.bottom(), -10);
+
+    sprite.setSize(100);
+    sprite.setDirection(180);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(std::round(rect.left() * 100) / 100, -5);
+    ASSERT_EQ(std::round(rect.top() * 100) / 100, 45);
+    ASSERT_EQ(std::round(rect.right() * 100) / 100, 25);
+    ASSERT_EQ(std::round(rect.bottom() * 100) / 100, -5);
+
+    // Only the position changed, so the cached bounds are moved
+    sprite.setX(-10);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(std::round(rect.left() * 100) / 100, -25);
+    ASSERT_EQ(std::round(rect.right() * 100) / 100, 5);
+
+    sprite.setRotationStyle(Sprite::RotationStyle::DoNotRotate);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), -35);
+    ASSERT_EQ(rect.top(), 35);
+    ASSERT_EQ(rect.right(), 15);
+    ASSERT_EQ(rect.bottom(), 5);
+
+    costume->setRotationCenterX(20);
+    sprite.setRotationStyle(Sprite::RotationStyle::LeftRight);
+    sprite.setDirection(-90);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), -50);
+    ASSERT_EQ(rect.top(), 35);
+    ASSERT_EQ(rect.right(), 0);
+    ASSERT_EQ(rect.bottom(), 5);
+
+    sprite.setDirection(90);
+    rect = sprite.boundingRect();
+    ASSERT_EQ(rect.left(), -20);
+    ASSERT_EQ(rect.right(), 30);
+}
+
+TEST(SpriteTest, InvalidateBounds)
+{
+    Sprite sprite;
+    EngineMock engine;
+    sprite.setEngine(&engine);
+    EXPECT_CALL(engine, requestRedraw()).WillRepeatedly(Return());
+    EXPECT_CALL(engine, spriteFencingEnabled()).WillRepeatedly(Return(false));
+
+    EXPECT_CALL(engine, invalidateSpriteBounds(&sprite)).Times(6);
+    sprite.setX(10);
+    sprite.setY(-5);
+    sprite.setSize(50);
+    sprite.setDirection(-45);
+    sprite.setCostumeIndex(0);
+    sprite.setRotationStyle(Sprite::RotationStyle::LeftRight);
+
+    EXPECT_CALL(engine, invalidateSpriteBounds).Times(0);
+    sprite.setDraggable(true);
+    sprite.setVolume(50);
+}
+
+TEST(SpriteTest, TouchingSprite)
+{
+    Sprite sprite, other;
+    SpriteHandlerMock handler, otherHandler;
+    EXPECT_CALL(handler, init);
+    EXPECT_CALL(otherHandler, init);
+    sprite.setInterface(&handler);
+    other.setInterface(&otherHandler);
+
+    ASSERT_FALSE(sprite.touchingSprite(nullptr));
+
+    // Without an engine
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, 10, 10, -10)));
+    EXPECT_CALL(otherHandler, boundingRect()).WillOnce(Return(Rect(5, 20, 25, 5)));
+    ASSERT_TRUE(sprite.touchingSprite(&other));
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, 10, 10, -10)));
+    EXPECT_CALL(otherHandler, boundingRect()).WillOnce(Return(Rect(15, 20, 25, 5)));
+    ASSERT_FALSE(sprite.touchingSprite(&other));
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, 10, 10, -10)));
+    ASSERT_FALSE(sprite.touchingSprite(&sprite));
+
+    other.setVisible(false);
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, 10, 10, -10)));
+    ASSERT_FALSE(sprite.touchingSprite(&other));
+
+    // With an engine
+    EngineMock engine;
+    sprite.setEngine(&engine);
+    EXPECT_CALL(engine, touchingSprite(&sprite, &other)).WillOnce(Return(true));
+    ASSERT_TRUE(sprite.touchingSprite(&other));
+
+    EXPECT_CALL(engine, touchingSprite(&sprite, &other)).WillOnce(Return(false));
+    ASSERT_FALSE(sprite.touchingSprite(&other));
+}
+
+TEST(SpriteTest, TouchingEdge)
+{
+    Sprite sprite;
+    SpriteHandlerMock handler;
+    EXPECT_CALL(handler, init);
+    sprite.setInterface(&handler);
+    ASSERT_FALSE(sprite.touchingEdge());
+
+    EngineMock engine;
+    sprite.setEngine(&engine);
+    EXPECT_CALL(engine, stageWidth()).WillRepeatedly(Return(480));
+    EXPECT_CALL(engine, stageHeight()).WillRepeatedly(Return(360));
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    ASSERT_FALSE(sprite.touchingEdge());
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-240.5, 10, -200, -10)));
+    ASSERT_TRUE(sprite.touchingEdge());
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(200, 10, 241, -10)));
+    ASSERT_TRUE(sprite.touchingEdge());
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, 180.2, 10, 150)));
+    ASSERT_TRUE(sprite.touchingEdge());
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-10, -150, 10, -185)));
+    ASSERT_TRUE(sprite.touchingEdge());
+}
+
+TEST(SpriteTest, TouchingPoint)
+{
+    Sprite sprite;
+    ASSERT_FALSE(sprite.touchingPoint(0, 0)); // no bounds
+
+    SpriteHandlerMock handler;
+    EXPECT_CALL(handler, init);
+    sprite.setInterface(&handler);
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    ASSERT_TRUE(sprite.touchingPoint(-20, 50));
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    ASSERT_FALSE(sprite.touchingPoint(21, 50));
+
+    EXPECT_CALL(handler, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
+    ASSERT_FALSE(sprite.touchingPoint(0, -1));
+}
+
 TEST(SpriteTest, GraphicsEffects)
 {
     Sprite sprite;
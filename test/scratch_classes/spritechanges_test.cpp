@@ -0,0 +1,64 @@
+#include <scratchcpp/spritechanges.h>
+#include <scratchcpp/sprite.h>
+#include <graphicseffectmock.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(SpriteChangesTest, Constructors)
+{
+    SpriteChanges changes1;
+    ASSERT_EQ(changes1.sprite(), nullptr);
+    ASSERT_TRUE(changes1.empty());
+
+    Sprite sprite;
+    SpriteChanges changes2(&sprite);
+    ASSERT_EQ(changes2.sprite(), &sprite);
+    ASSERT_TRUE(changes2.empty());
+}
+
+TEST(SpriteChangesTest, Properties)
+{
+    SpriteChanges changes;
+    changes.setChanged(SpriteChanges::Property::X);
+    changes.setChanged(SpriteChanges::Property::Direction);
+    changes.setChanged(SpriteChanges::Property::X);
+    ASSERT_FALSE(changes.empty());
+
+    ASSERT_TRUE(changes.changed(SpriteChanges::Property::X));
+    ASSERT_TRUE(changes.changed(SpriteChanges::Property::Direction));
+    ASSERT_FALSE(changes.changed(SpriteChanges::Property::Y));
+    ASSERT_FALSE(changes.changed(SpriteChanges::Property::Costume));
+
+    changes.clear();
+    ASSERT_TRUE(changes.empty());
+    ASSERT_FALSE(changes.changed(SpriteChanges::Property::X));
+}
+
+TEST(SpriteChangesTest, GraphicsEffects)
+{
+    SpriteChanges changes;
+    GraphicsEffectMock effect1, effect2;
+    changes.setGraphicsEffectValue(&effect1, 10);
+    changes.setGraphicsEffectValue(&effect1, 20);
+    ASSERT_FALSE(changes.empty());
+    ASSERT_FALSE(changes.graphicsEffectsCleared());
+    ASSERT_EQ(changes.graphicsEffects().size(), 1);
+    ASSERT_EQ(changes.graphicsEffects().at(&effect1), 20);
+
+    // Clearing the effects removes the previous changes
+    changes.setGraphicsEffectsCleared();
+    ASSERT_TRUE(changes.graphicsEffectsCleared());
+    ASSERT_TRUE(changes.graphicsEffects().empty());
+    ASSERT_FALSE(changes.empty());
+
+    changes.setGraphicsEffectValue(&effect2, -5);
+    ASSERT_TRUE(changes.graphicsEffectsCleared());
+    ASSERT_EQ(changes.graphicsEffects().size(), 1);
+    ASSERT_EQ(changes.graphicsEffects().at(&effect2), -5);
+
+    changes.clear();
+    ASSERT_TRUE(changes.empty());
+    ASSERT_FALSE(changes.graphicsEffectsCleared());
+}
@@ -94,6 +94,14 @@ TEST(TargetTest, Lists)
     ASSERT_EQ(target.findListById("a"), 0);
     ASSERT_EQ(target.findListById("b"), 1);
     ASSERT_EQ(target.findListById("c"), 2);
+
+    // Renamed lists
+    l2->setName("list4");
+    l3->setId("e");
+    ASSERT_EQ(target.findList("list2"), -1);
+    ASSERT_EQ(target.findList("list4"), 1);
+    ASSERT_EQ(target.findListById("c"), -1);
+    ASSERT_EQ(target.findListById("e"), 2);
 }
 
 TEST(TargetTest, Blocks)
@@ -185,6 +193,35 @@ TEST(TargetTest, Blocks)
     ASSERT_EQ(source.greenFlagBlocks(), std::vector<std::shared_ptr<Block>>({ b1, b4 }));
 }
 
+TEST(TargetTest, RemoveBlock)
+{
+    auto b1 = std::make_shared<Block>("a", "event_whenflagclicked");
+    auto b2 = std::make_shared<Block>("b", "motion_gotoxy");
+
+    TargetMock target;
+    EXPECT_CALL(target, dataSource()).WillRepeatedly(Return(nullptr));
+
+    target.addBlock(b1);
+    target.addBlock(b2);
+
+    ASSERT_TRUE(target.removeBlock(b1));
+    ASSERT_EQ(target.blocks(), std::vector<std::shared_ptr<Block>>({ b2 }));
+    ASSERT_FALSE(target.removeBlock(b1));
+
+    ASSERT_TRUE(target.removeBlock(b2));
+    ASSERT_TRUE(target.blocks().empty());
+
+    // Test with custom data source
+    Target source;
+    source.addBlock(b1);
+
+    TargetMock target2;
+    EXPECT_CALL(target2, dataSource()).WillRepeatedly(Return(&source));
+
+    ASSERT_TRUE(target2.removeBlock(b1));
+    ASSERT_TRUE(source.blocks().empty());
+}
+
 TEST(TargetTest, Comments)
 {
     auto c1 = std::make_shared<Comment>("a");
@@ -60,3 +60,49 @@ TEST_F(ScratchConfigurationTest, GraphicsEffects)
     ScratchConfiguration::removeGraphicsEffect("effect1");
     ASSERT_EQ(ScratchConfiguration::getGraphicsEffect("effect1"), nullptr);
 }
+
+TEST_F(ScratchConfigurationTest, GraphicsEffectIndices)
+{
+    auto effect1 = std::make_shared<GraphicsEffectMock>();
+    auto effect2 = std::make_shared<GraphicsEffectMock>();
+    auto effect3 = std::make_shared<GraphicsEffectMock>();
+
+    EXPECT_CALL(*effect1, name()).WillOnce(Return("effect1"));
+    EXPECT_CALL(*effect2, name()).WillOnce(Return("effect2"));
+    ScratchConfiguration::registerGraphicsEffect(effect1);
+    ScratchConfiguration::registerGraphicsEffect(effect2);
+
+    int index1 = ScratchConfiguration::findGraphicsEffect("effect1");
+    int index2 = ScratchConfiguration::findGraphicsEffect("effect2");
+    ASSERT_NE(index1, -1);
+    ASSERT_NE(index2, -1);
+    ASSERT_NE(index1, index2);
+    ASSERT_EQ(ScratchConfiguration::findGraphicsEffect("effect3"), -1);
+
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(index1), effect1.get());
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(index2), effect2.get());
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(-1), nullptr);
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(1000), nullptr);
+    ASSERT_GT(ScratchConfiguration::graphicsEffectCount(), std::max(index1, index2));
+    int count = ScratchConfiguration::graphicsEffectCount();
+
+    // Removed effects keep their index
+    ScratchConfiguration::removeGraphicsEffect("effect1");
+    ASSERT_EQ(ScratchConfiguration::findGraphicsEffect("effect1"), -1);
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(index1), nullptr);
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(index2), effect2.get());
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectCount(), count);
+
+    EXPECT_CALL(*effect1, name()).WillOnce(Return("effect1"));
+    ScratchConfiguration::registerGraphicsEffect(effect1);
+    ASSERT_EQ(ScratchConfiguration::findGraphicsEffect("effect1"), index1);
+
+    // Effects which replace another effect get its index
+    EXPECT_CALL(*effect3, name()).WillOnce(Return("effect2"));
+    ScratchConfiguration::registerGraphicsEffect(effect3);
+    ASSERT_EQ(ScratchConfiguration::findGraphicsEffect("effect2"), index2);
+    ASSERT_EQ(ScratchConfiguration::graphicsEffectAt(index2), effect3.get());
+
+    ScratchConfiguration::removeGraphicsEffect("effect1");
+    ScratchConfiguration::removeGraphicsEffect("effect2");
+}
@@ -85,6 +85,7 @@ TEST_F(ScriptTest, Start)
     script3.setConstValues(constValues);
     script3.setVariables(variables);
     script3.setLists(lists);
+    ASSERT_EQ(script3.variables(), variables);
 
     vm = script3.start();
     ASSERT_TRUE(vm);
@@ -141,6 +142,18 @@ TEST_F(ScriptTest, Start)
     ASSERT_EQ(vm->lists()[0], lists[0]);
     ASSERT_EQ(vm->lists()[1], clone->listAt(clone->findListById("d")).get());
 
+    // The variables and lists of the clone are resolved only once
+    auto vm2 = script4.start(clone.get());
+    ASSERT_EQ(vm2->variables(), vm->variables());
+    ASSERT_EQ(vm2->lists(), vm->lists());
+
+    // ...until the script changes
+    script4.setVariables({ variables[1] });
+    script4.setLists({ lists[1] });
+    vm2 = script4.start(clone.get());
+    ASSERT_EQ(vm2->variables()[0], clone->variableAt(clone->findVariableById("b"))->valuePtr());
+    ASSERT_EQ(vm2->lists()[0], clone->listAt(clone->findListById("d")).get());
+
     EXPECT_CALL(m_engine, deinitClone(clone));
     clone->deleteClone();
 }
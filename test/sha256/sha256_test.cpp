@@ -0,0 +1,24 @@
+#include <internal/sha256.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(Sha256Test, Hex)
+{
+    // Examples from FIPS 180-4
+    ASSERT_EQ(Sha256::hex(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    ASSERT_EQ(Sha256::hex("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    ASSERT_EQ(Sha256::hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // Padding which doesn't fit in the last chunk
+    ASSERT_EQ(Sha256::hex(std::string(55, 'a')), "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+    ASSERT_EQ(Sha256::hex(std::string(56, 'a')), "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+    ASSERT_EQ(Sha256::hex(std::string(64, 'a')), "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+    ASSERT_EQ(Sha256::hex(std::string(1000, 'a')), "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3");
+}
+
+TEST(Sha256Test, File)
+{
+    ASSERT_EQ(Sha256::hex(readFileStr("image1.png")), "efa33f81fe7b3df777805dab4052d340a3592ffbb1bd72cbd08c6c43ff4ce8e2");
+}
@@ -0,0 +1,204 @@
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/rect.h>
+#include <scratchcpp/costume.h>
+#include <spritehandlermock.h>
+
+#include "engine/internal/spatialindex.h"
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+using ::testing::Return;
+using ::testing::Invoke;
+
+class SpatialIndexTest : public testing::Test
+{
+    public:
+        void SetUp() override
+        {
+            for (int i = 0; i < 3; i++) {
+                EXPECT_CALL(m_handlers[i], init);
+                m_sprites[i].setInterface(&m_handlers[i]);
+                EXPECT_CALL(m_handlers[i], boundingRect()).WillRepeatedly(Invoke([this, i]() { return m_rects[i]; }));
+            }
+        }
+
+        Sprite m_sprites[3];
+        SpriteHandlerMock m_handlers[3];
+        Rect m_rects[3];
+};
+
+TEST_F(SpatialIndexTest, AddRemove)
+{
+    SpatialIndex index;
+    ASSERT_FALSE(index.containsSprite(&m_sprites[0]));
+
+    index.addSprite(&m_sprites[0]);
+    index.addSprite(&m_sprites[1]);
+    ASSERT_TRUE(index.containsSprite(&m_sprites[0]));
+    ASSERT_TRUE(index.containsSprite(&m_sprites[1]));
+    ASSERT_FALSE(index.containsSprite(&m_sprites[2]));
+
+    index.removeSprite(&m_sprites[0]);
+    ASSERT_FALSE(index.containsSprite(&m_sprites[0]));
+    ASSERT_TRUE(index.containsSprite(&m_sprites[1]));
+
+    index.clear();
+    ASSERT_FALSE(index.containsSprite(&m_sprites[1]));
+}
+
+TEST_F(SpatialIndexTest, TouchingSprite)
+{
+    SpatialIndex index;
+    m_rects[0] = Rect(-10, 10, 10, -10);
+    m_rects[1] = Rect(5, 20, 25, 5);
+    m_rects[2] = Rect(100, 100, 150, 50);
+
+    for (int i = 0; i < 3; i++)
+        index.addSprite(&m_sprites[i]);
+
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[1], &m_sprites[0]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[0]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], nullptr));
+    ASSERT_FALSE(index.touchingSprite(nullptr, &m_sprites[0]));
+
+    // The bounds aren't read again until the sprite is invalidated
+    m_rects[2] = Rect(0, 0, 20, -20);
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+
+    index.invalidate(&m_sprites[2]);
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+
+    // Hidden sprites can't be touched
+    m_sprites[2].setVisible(false);
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[2], &m_sprites[0]));
+    m_sprites[2].setVisible(true);
+
+    // Sprites without bounds don't touch anything
+    m_rects[1] = Rect();
+    index.invalidate(&m_sprites[1]);
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[1], &m_sprites[0]));
+
+    index.removeSprite(&m_sprites[2]);
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+}
+
+TEST_F(SpatialIndexTest, LazyBounds)
+{
+    SpatialIndex index;
+    index.addSprite(&m_sprites[0]);
+    index.addSprite(&m_sprites[1]);
+
+    EXPECT_CALL(m_handlers[0], boundingRect()).WillOnce(Return(Rect(-10, 10, 10, -10)));
+    EXPECT_CALL(m_handlers[1], boundingRect()).WillOnce(Return(Rect(0, 10, 10, 0)));
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+
+    for (int i = 0; i < 10; i++)
+        index.invalidate(&m_sprites[1]);
+
+    EXPECT_CALL(m_handlers[0], boundingRect()).Times(0);
+    EXPECT_CALL(m_handlers[1], boundingRect()).WillOnce(Return(Rect(20, 10, 30, 0)));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+}
+
+TEST_F(SpatialIndexTest, LargeSprite)
+{
+    SpatialIndex index(10);
+    m_rects[0] = Rect(-500, 500, 500, -500);
+    m_rects[1] = Rect(300, -300, 310, -310);
+    m_rects[2] = Rect(-1000, 1000, -900, 900);
+
+    for (int i = 0; i < 3; i++)
+        index.addSprite(&m_sprites[i]);
+
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+    ASSERT_TRUE(index.touchingSprite(&m_sprites[1], &m_sprites[0]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[2]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[2], &m_sprites[0]));
+
+    m_rects[0] = Rect(-5, 5, 5, -5);
+    index.invalidate(&m_sprites[0]);
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[0], &m_sprites[1]));
+    ASSERT_FALSE(index.touchingSprite(&m_sprites[1], &m_sprites[0]));
+}
+
+TEST(SpatialIndexPixelTest, TouchingPixels)
+{
+    // The costume is 4x6 and only the pixels from (1, 1) to (3, 3) are opaque (except for (2, 2))
+    std::string data = readFileStr("image2.png");
+    auto costume = std::make_shared<Costume>("costume1", "", "png");
+    costume->setData(data.size(), data.data());
+
+    Sprite sprite1, sprite2;
+    sprite1.addCostume(costume);
+    sprite2.addCostume(costume);
+    sprite1.setCostumeIndex(0);
+    sprite2.setCostumeIndex(0);
+
+    SpatialIndex index;
+    index.addSprite(&sprite1);
+    index.addSprite(&sprite2);
+
+    // The bounding rectangles overlap, but the opaque pixels don't
+    sprite2.setX(3);
+    index.invalidate(&sprite2);
+    ASSERT_FALSE(index.touchingSprite(&sprite1, &sprite2));
+    ASSERT_FALSE(index.touchingSprite(&sprite2, &sprite1));
+
+    sprite2.setX(2);
+    index.invalidate(&sprite2);
+    ASSERT_TRUE(index.touchingSprite(&sprite1, &sprite2));
+    ASSERT_TRUE(index.touchingSprite(&sprite2, &sprite1));
+
+    sprite2.setX(0);
+    sprite2.setY(-3);
+    index.invalidate(&sprite2);
+    ASSERT_FALSE(index.touchingSprite(&sprite1, &sprite2));
+
+    sprite2.setY(-2);
+    index.invalidate(&sprite2);
+    ASSERT_TRUE(index.touchingSprite(&sprite1, &sprite2));
+
+    // Mirrored sprites
+    sprite2.setX(5);
+    sprite2.setY(0);
+    sprite2.setRotationStyle(Sprite::RotationStyle::LeftRight);
+    index.invalidate(&sprite2);
+    ASSERT_FALSE(index.touchingSprite(&sprite1, &sprite2));
+
+    sprite2.setDirection(-90);
+    index.invalidate(&sprite2);
+    ASSERT_TRUE(index.touchingSprite(&sprite1, &sprite2));
+
+    // The masks are aligned to 64 pixels, so sprites across a word boundary are compared word by word
+    sprite2.setDirection(90);
+
+    for (int x = 58; x <= 66; x++) {
+        sprite1.setX(x);
+        sprite2.setX(x + 3);
+        index.invalidate(&sprite1);
+        index.invalidate(&sprite2);
+        ASSERT_FALSE(index.touchingSprite(&sprite1, &sprite2));
+
+        sprite2.setX(x + 2);
+        index.invalidate(&sprite2);
+        ASSERT_TRUE(index.touchingSprite(&sprite1, &sprite2));
+        ASSERT_TRUE(index.touchingSprite(&sprite2, &sprite1));
+    }
+
+    // Sprites can only touch on the stage
+    sprite1.setX(300);
+    sprite2.setX(300);
+    sprite2.setDirection(90);
+    index.invalidate(&sprite1);
+    index.invalidate(&sprite2);
+    ASSERT_FALSE(index.touchingSprite(&sprite1, &sprite2));
+
+    index.setStageSize(1000, 800);
+    ASSERT_TRUE(index.touchingSprite(&sprite1, &sprite2));
+}
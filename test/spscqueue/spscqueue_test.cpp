@@ -0,0 +1,61 @@
+#include <thread>
+
+#include "engine/internal/spscqueue.h"
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(SpscQueueTest, PushPop)
+{
+    SpscQueue<int, 3> queue;
+    ASSERT_EQ(queue.capacity(), 3);
+    ASSERT_TRUE(queue.empty());
+
+    int value;
+    ASSERT_FALSE(queue.pop(value));
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_FALSE(queue.empty());
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3));
+    ASSERT_FALSE(queue.push(4)); // full
+
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(queue.push(4));
+
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 3);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 4);
+
+    ASSERT_FALSE(queue.pop(value));
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, Threads)
+{
+    static const int count = 100000;
+    SpscQueue<std::string, 16> queue;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < count; i++) {
+            while (!queue.push(std::to_string(i)))
+                std::this_thread::yield();
+        }
+    });
+
+    std::string value;
+
+    for (int i = 0; i < count; i++) {
+        while (!queue.pop(value))
+            std::this_thread::yield();
+
+        ASSERT_EQ(value, std::to_string(i));
+    }
+
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
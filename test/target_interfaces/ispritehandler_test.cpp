@@ -147,6 +147,34 @@ TEST_F(ISpriteHandlerTest, GraphicsEffects)
     m_sprite.clearGraphicsEffects();
 }
 
+TEST_F(ISpriteHandlerTest, BatchedChanges)
+{
+    GraphicsEffectMock effect;
+    EXPECT_CALL(m_engine, batchedSpriteNotificationsEnabled()).WillRepeatedly(Return(true));
+    EXPECT_CALL(m_engine, spriteFencingEnabled()).WillRepeatedly(Return(false));
+    EXPECT_CALL(m_engine, requestRedraw()).Times(4);
+    EXPECT_CALL(m_handler, onXChanged).Times(0);
+    EXPECT_CALL(m_handler, onSizeChanged).Times(0);
+    EXPECT_CALL(m_handler, onGraphicsEffectChanged).Times(0);
+    m_sprite.setX(5);
+    m_sprite.setX(10);
+    m_sprite.setSize(50);
+    m_sprite.setGraphicsEffectValue(&effect, 2.5);
+
+    // The default implementation calls the other methods with the current values
+    SpriteChanges changes(&m_sprite);
+    changes.setChanged(SpriteChanges::Property::X);
+    changes.setChanged(SpriteChanges::Property::Size);
+    changes.setGraphicsEffectsCleared();
+    changes.setGraphicsEffectValue(&effect, 2.5);
+
+    EXPECT_CALL(m_handler, onXChanged(10));
+    EXPECT_CALL(m_handler, onSizeChanged(50));
+    EXPECT_CALL(m_handler, onGraphicsEffectsCleared());
+    EXPECT_CALL(m_handler, onGraphicsEffectChanged(&effect, 2.5));
+    m_handler.ISpriteHandler::onChanged(changes);
+}
+
 TEST_F(ISpriteHandlerTest, BoundingRect)
 {
     EXPECT_CALL(m_handler, boundingRect()).WillOnce(Return(Rect(-44.6, 89.1, 20.5, -0.48)));
@@ -0,0 +1,133 @@
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/costume.h>
+
+#include "engine/internal/transformstore.h"
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(TransformStoreTest, AttachDetach)
+{
+    TransformStore store;
+    Sprite sprite;
+    sprite.addCostume(std::make_shared<Costume>("a", "a", "png"));
+    sprite.addCostume(std::make_shared<Costume>("b", "b", "png"));
+    sprite.setCostumeIndex(1);
+    sprite.setX(10);
+    sprite.setY(-20);
+    sprite.setSize(50);
+    sprite.setDirection(-45);
+    sprite.setVisible(false);
+    sprite.setDraggable(true);
+    sprite.setRotationStyle(Sprite::RotationStyle::LeftRight);
+
+    store.attach(&sprite);
+    ASSERT_EQ(store.sprites.size(), 1);
+    ASSERT_EQ(store.sprites[0], &sprite);
+    ASSERT_EQ(store.x[0], 10);
+    ASSERT_EQ(store.y[0], -20);
+    ASSERT_EQ(store.size[0], 50);
+    ASSERT_EQ(store.direction[0], -45);
+    ASSERT_EQ(store.costume[0], 1);
+    ASSERT_TRUE(store.flags[0] & TransformStore::Used);
+    ASSERT_FALSE(store.flags[0] & TransformStore::Visible);
+    ASSERT_TRUE(store.flags[0] & TransformStore::Draggable);
+
+    // The sprite reads and writes its transform in the store
+    ASSERT_EQ(sprite.x(), 10);
+    ASSERT_EQ(sprite.rotationStyle(), Sprite::RotationStyle::LeftRight);
+    store.clearDirty();
+    sprite.setX(5);
+    sprite.setY(6);
+    sprite.setSize(120);
+    sprite.setDirection(200);
+    sprite.setCostumeIndex(0);
+    sprite.setVisible(true);
+    sprite.setDraggable(false);
+    sprite.setRotationStyle(Sprite::RotationStyle::DoNotRotate);
+
+    ASSERT_EQ(store.x[0], 5);
+    ASSERT_EQ(store.y[0], 6);
+    ASSERT_EQ(store.size[0], 120);
+    ASSERT_EQ(store.direction[0], -160);
+    ASSERT_EQ(store.costume[0], 0);
+    ASSERT_TRUE(store.flags[0] & TransformStore::Visible);
+    ASSERT_FALSE(store.flags[0] & TransformStore::Draggable);
+    ASSERT_EQ(sprite.rotationStyle(), Sprite::RotationStyle::DoNotRotate);
+    ASSERT_EQ(
+        store.dirty[0],
+        TransformStore::PositionDirty | TransformStore::SizeDirty | TransformStore::DirectionDirty | TransformStore::CostumeDirty | TransformStore::VisibilityDirty |
+            TransformStore::RotationStyleDirty);
+
+    store.clearDirty();
+    sprite.setX(7);
+    ASSERT_EQ(store.dirty[0], TransformStore::PositionDirty);
+
+    // The transform is moved back to the sprite
+    store.detach(&sprite);
+    ASSERT_EQ(store.sprites[0], nullptr);
+    ASSERT_EQ(store.flags[0], 0);
+    store.x[0] = 0;
+
+    ASSERT_EQ(sprite.x(), 7);
+    ASSERT_EQ(sprite.y(), 6);
+    ASSERT_EQ(sprite.size(), 120);
+    ASSERT_EQ(sprite.direction(), -160);
+    ASSERT_TRUE(sprite.visible());
+    ASSERT_FALSE(sprite.draggable());
+    ASSERT_EQ(sprite.rotationStyle(), Sprite::RotationStyle::DoNotRotate);
+}
+
+TEST(TransformStoreTest, Handles)
+{
+    TransformStore store;
+    Sprite s1, s2, s3;
+    store.attach(&s1);
+    store.attach(&s2);
+    store.attach(&s2); // already attached
+    ASSERT_EQ(store.sprites.size(), 2);
+    s1.setX(1);
+    s2.setX(2);
+
+    // Free slots are reused, other handles don't change
+    store.detach(&s1);
+    store.attach(&s3);
+    ASSERT_EQ(store.sprites.size(), 2);
+    ASSERT_EQ(store.sprites[0], &s3);
+    ASSERT_EQ(store.sprites[1], &s2);
+    ASSERT_EQ(store.x[1], 2);
+
+    // Destroyed sprites free their slot
+    {
+        Sprite s4;
+        store.attach(&s4);
+        ASSERT_EQ(store.sprites.size(), 3);
+    }
+
+    ASSERT_EQ(store.sprites[2], nullptr);
+    Sprite s5;
+    store.attach(&s5);
+    ASSERT_EQ(store.sprites.size(), 3);
+    ASSERT_EQ(store.sprites[2], &s5);
+
+    store.clear();
+    ASSERT_TRUE(store.sprites.empty());
+    ASSERT_EQ(s2.x(), 2);
+    s2.setX(3);
+    ASSERT_EQ(s2.x(), 3);
+}
+
+TEST(TransformStoreTest, Destroy)
+{
+    Sprite sprite;
+
+    {
+        TransformStore store;
+        store.attach(&sprite);
+        sprite.setX(15);
+    }
+
+    ASSERT_EQ(sprite.x(), 15);
+    sprite.setX(16);
+    ASSERT_EQ(sprite.x(), 16);
+}
@@ -1,12 +1,14 @@
 #include <scratchcpp/virtualmachine.h>
 #include <scratchcpp/list.h>
 #include <scratchcpp/script.h>
+#include <scratchcpp/inlinecache.h>
+#include <scratchcpp/sprite.h>
+#include <scratchcpp/variable.h>
 #include <enginemock.h>
 #include <randomgeneratormock.h>
 
 #include "engine/virtualmachine_p.h"
 #include "engine/internal/engine.h"
-#include "engine/internal/randomgenerator.h"
 #include "../common.h"
 
 using namespace libscratchcpp;
@@ -414,11 +416,12 @@ TEST(VirtualMachineTest, OP_RANDOM)
     static unsigned int bytecode4[] = { OP_START, OP_CONST, 2, OP_CONST, 3, OP_RANDOM, OP_HALT };
     static Value constValues[] = { -45, 12, 6.05, -78.686 };
 
-    VirtualMachinePrivate vm(nullptr, nullptr, nullptr, nullptr);
-    vm.constValues = constValues;
-
     RandomGeneratorMock rng;
-    vm.rng = &rng;
+    EngineMock engine;
+    EXPECT_CALL(engine, randomGenerator()).WillRepeatedly(Return(&rng));
+
+    VirtualMachinePrivate vm(nullptr, nullptr, &engine, nullptr);
+    vm.constValues = constValues;
 
     EXPECT_CALL(rng, randint(-45, 12)).WillOnce(Return(-18));
     vm.bytecode = bytecode1;
@@ -968,9 +971,10 @@ TEST(VirtualMachineTest, OP_LIST_DEL)
     List *lists[] = { &list1 };
 
     RandomGeneratorMock rng;
-    VirtualMachinePrivate::rng = &rng;
+    EngineMock engine;
+    EXPECT_CALL(engine, randomGenerator()).WillRepeatedly(Return(&rng));
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &engine, nullptr);
     vm.setBytecode(bytecode);
     vm.setConstValues(constValues);
     vm.setLists(lists);
@@ -978,8 +982,6 @@ TEST(VirtualMachineTest, OP_LIST_DEL)
     EXPECT_CALL(rng, randint(1, 4)).WillOnce(Return(2));
     vm.run();
 
-    VirtualMachinePrivate::rng = RandomGenerator::instance().get();
-
     ASSERT_EQ(vm.registerCount(), 14);
     ASSERT_EQ(vm.getInput(0, 14)->toString(), "a b d e f g h");
     ASSERT_EQ(vm.getInput(1, 14)->toString(), "b d e f g h");
@@ -1040,9 +1042,10 @@ TEST(VirtualMachineTest, OP_LIST_INSERT)
     List *lists[] = { &list1 };
 
     RandomGeneratorMock rng;
-    VirtualMachinePrivate::rng = &rng;
+    EngineMock engine;
+    EXPECT_CALL(engine, randomGenerator()).WillRepeatedly(Return(&rng));
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &engine, nullptr);
     vm.setBytecode(bytecode);
     vm.setConstValues(constValues);
     vm.setLists(lists);
@@ -1050,8 +1053,6 @@ TEST(VirtualMachineTest, OP_LIST_INSERT)
     EXPECT_CALL(rng, randint(1, 12)).WillOnce(Return(5));
     vm.run();
 
-    VirtualMachinePrivate::rng = RandomGenerator::instance().get();
-
     ASSERT_EQ(vm.registerCount(), 13);
     ASSERT_EQ(vm.getInput(0, 13)->toString(), "a b new item c d e f g h");
     ASSERT_EQ(vm.getInput(1, 13)->toString(), "new item a b new item c d e f g h");
@@ -1093,9 +1094,10 @@ TEST(VirtualMachineTest, OP_LIST_REPLACE)
     List *lists[] = { &list1 };
 
     RandomGeneratorMock rng;
-    VirtualMachinePrivate::rng = &rng;
+    EngineMock engine;
+    EXPECT_CALL(engine, randomGenerator()).WillRepeatedly(Return(&rng));
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &engine, nullptr);
     vm.setBytecode(bytecode);
     vm.setConstValues(constValues);
     vm.setLists(lists);
@@ -1103,8 +1105,6 @@ TEST(VirtualMachineTest, OP_LIST_REPLACE)
     EXPECT_CALL(rng, randint(1, 8)).WillOnce(Return(7));
     vm.run();
 
-    VirtualMachinePrivate::rng = RandomGenerator::instance().get();
-
     ASSERT_EQ(vm.registerCount(), 13);
     ASSERT_EQ(vm.getInput(0, 13)->toString(), "a b new item d e f g h");
     ASSERT_EQ(vm.getInput(1, 13)->toString(), "new item b new item d e f g h");
@@ -1141,9 +1141,10 @@ TEST(VirtualMachineTest, OP_LIST_GET_ITEM)
     List *lists[] = { &list1 };
 
     RandomGeneratorMock rng;
-    VirtualMachinePrivate::rng = &rng;
+    EngineMock engine;
+    EXPECT_CALL(engine, randomGenerator()).WillRepeatedly(Return(&rng));
 
-    VirtualMachine vm;
+    VirtualMachine vm(nullptr, &engine, nullptr);
     vm.setBytecode(bytecode);
     vm.setConstValues(constValues);
     vm.setLists(lists);
@@ -1151,8 +1152,6 @@ TEST(VirtualMachineTest, OP_LIST_GET_ITEM)
     EXPECT_CALL(rng, randint(1, 8)).WillOnce(Return(1));
     vm.run();
 
-    VirtualMachinePrivate::rng = RandomGenerator::instance().get();
-
     ASSERT_EQ(vm.registerCount(), 13);
     ASSERT_EQ(vm.getInput(0, 13)->toString(), "c");
     ASSERT_EQ(vm.getInput(1, 13)->toString(), "a");
@@ -1437,6 +1436,177 @@ TEST(VirtualMachineTest, Functions)
     ASSERT_EQ(vm.functions(), functions);
 }
 
+static int inlineCacheLookups = 0;
+
+unsigned int testInlineCacheFunction(VirtualMachine *vm)
+{
+    std::string name = vm->getInput(0, 1)->toString();
+    InlineCache &cache = vm->inlineCache();
+
+    if (!cache.matches(name)) {
+        cache.store(name, vm->engine()->targetAt(vm->engine()->findTarget(name)));
+        inlineCacheLookups++;
+    }
+
+    vm->replaceReturnValue(cache.target() ? cache.target()->name() : "", 1);
+    return 0;
+}
+
+TEST(VirtualMachineTest, InlineCache)
+{
+    static unsigned int bytecode[] = { OP_START, OP_CONST, 0, OP_EXEC_CACHED, 0, 0, OP_CONST, 1, OP_EXEC_CACHED, 0, 1, OP_HALT };
+    static BlockFunc functions[] = { &testInlineCacheFunction };
+    static Value constValues[] = { "Sprite1", "Sprite2" };
+
+    EngineMock engineMock;
+    auto group = std::make_shared<NameIndexGroup>(); // the name indices of the engine
+    Sprite sprite, sprite1, sprite2;
+    sprite1.setName("Sprite1");
+    sprite2.setName("Sprite2");
+    group->adopt(sprite);
+    group->adopt(sprite1);
+    group->adopt(sprite2);
+    inlineCacheLookups = 0;
+
+    VirtualMachine vm(&sprite, &engineMock, nullptr);
+    vm.setBytecode(bytecode);
+    vm.setFunctions(functions);
+    vm.setConstValues(constValues);
+
+    // Each call site has its own cache
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).WillOnce(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).WillOnce(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).WillOnce(Return(2));
+    EXPECT_CALL(engineMock, targetAt(2)).WillOnce(Return(&sprite2));
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 2);
+    ASSERT_EQ(vm.registerCount(), 2);
+    ASSERT_EQ(vm.getInput(0, 2)->toString(), "Sprite1");
+    ASSERT_EQ(vm.getInput(1, 2)->toString(), "Sprite2");
+
+    // Cached resolutions are used next time
+    vm.reset();
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 2);
+    ASSERT_EQ(vm.getInput(0, 2)->toString(), "Sprite1");
+    ASSERT_EQ(vm.getInput(1, 2)->toString(), "Sprite2");
+
+    // Adding variables (or targets, costumes, etc.) invalidates the caches
+    sprite1.addVariable(std::make_shared<Variable>("", "var"));
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).WillOnce(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).WillOnce(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).WillOnce(Return(2));
+    EXPECT_CALL(engineMock, targetAt(2)).WillOnce(Return(&sprite2));
+    vm.reset();
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 4);
+
+    // So does renaming
+    sprite2.setName("Sprite3");
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).WillOnce(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).WillOnce(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).WillOnce(Return(-1));
+    EXPECT_CALL(engineMock, targetAt(-1)).WillOnce(Return(nullptr));
+    vm.reset();
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 6);
+    ASSERT_EQ(vm.getInput(0, 2)->toString(), "Sprite1");
+    ASSERT_EQ(vm.getInput(1, 2)->toString(), "");
+
+    // Changing the bytecode removes the caches
+    vm.setBytecode(bytecode);
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).WillOnce(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).WillOnce(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).WillOnce(Return(-1));
+    EXPECT_CALL(engineMock, targetAt(-1)).WillOnce(Return(nullptr));
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 8);
+
+    // Changes in other engines don't invalidate the caches
+    Sprite otherSprite;
+    std::make_shared<NameIndexGroup>()->adopt(otherSprite);
+    otherSprite.setName("Sprite1");
+    otherSprite.addVariable(std::make_shared<Variable>("", "var"));
+    vm.reset();
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 8);
+
+    // Without a target, the caches aren't used
+    VirtualMachine vm2(nullptr, &engineMock, nullptr);
+    vm2.setBytecode(bytecode);
+    vm2.setFunctions(functions);
+    vm2.setConstValues(constValues);
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).Times(2).WillRepeatedly(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).Times(2).WillRepeatedly(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).Times(2).WillRepeatedly(Return(-1));
+    EXPECT_CALL(engineMock, targetAt(-1)).Times(2).WillRepeatedly(Return(nullptr));
+    vm2.run();
+    vm2.reset();
+    vm2.run();
+    ASSERT_EQ(inlineCacheLookups, 12);
+
+    // Calls without a cache slot share one cache
+    static unsigned int bytecode2[] = { OP_START, OP_CONST, 0, OP_EXEC, 0, OP_CONST, 0, OP_EXEC, 0, OP_CONST, 1, OP_EXEC, 0, OP_HALT };
+    vm.setBytecode(bytecode2);
+    EXPECT_CALL(engineMock, findTarget("Sprite1")).Times(2).WillRepeatedly(Return(1));
+    EXPECT_CALL(engineMock, targetAt(1)).Times(2).WillRepeatedly(Return(&sprite1));
+    EXPECT_CALL(engineMock, findTarget("Sprite2")).Times(2).WillRepeatedly(Return(-1));
+    EXPECT_CALL(engineMock, targetAt(-1)).Times(2).WillRepeatedly(Return(nullptr));
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 14);
+    vm.reset();
+    vm.run();
+    ASSERT_EQ(inlineCacheLookups, 16);
+    ASSERT_EQ(vm.registerCount(), 3);
+    ASSERT_EQ(vm.getInput(0, 3)->toString(), "Sprite1");
+    ASSERT_EQ(vm.getInput(1, 3)->toString(), "Sprite1");
+    ASSERT_EQ(vm.getInput(2, 3)->toString(), "");
+}
+
+TEST(VirtualMachineTest, InlineCacheSlot)
+{
+    Sprite sprite;
+    VirtualMachine vm(&sprite, nullptr, nullptr);
+    InlineCache &cache = vm.inlineCache();
+    Variable variable("", "var");
+    ASSERT_FALSE(cache.matches(""));
+    ASSERT_EQ(cache.target(), nullptr);
+    ASSERT_EQ(cache.variable(), nullptr);
+
+    cache.store("Sprite1", &sprite);
+    ASSERT_TRUE(cache.matches("Sprite1"));
+    ASSERT_FALSE(cache.matches("Sprite2"));
+    ASSERT_FALSE(cache.matches("Sprite1", "Stage"));
+    ASSERT_EQ(cache.target(), &sprite);
+    ASSERT_EQ(cache.variable(), nullptr);
+
+    cache.store("var", "Sprite1", &sprite, &variable);
+    ASSERT_TRUE(cache.matches("var", "Sprite1"));
+    ASSERT_FALSE(cache.matches("var", "Sprite2"));
+    ASSERT_FALSE(cache.matches("var"));
+    ASSERT_EQ(cache.target(), &sprite);
+    ASSERT_EQ(cache.variable(), &variable);
+
+    // A resolution which was stored before renaming something isn't valid
+    auto list = std::make_shared<List>("", "list");
+    sprite.addList(list);
+    cache.store("var", "Sprite1", &sprite, &variable);
+    ASSERT_TRUE(cache.matches("var", "Sprite1"));
+    list->setName("test");
+    ASSERT_FALSE(cache.matches("var", "Sprite1"));
+
+    cache.store("Sprite1", nullptr);
+    ASSERT_TRUE(cache.matches("Sprite1"));
+    ASSERT_EQ(cache.target(), nullptr);
+    cache.clear();
+    ASSERT_FALSE(cache.matches("Sprite1"));
+
+    // A cache which doesn't belong to any VM is never valid
+    InlineCache standalone;
+    standalone.store("Sprite1", &sprite);
+    ASSERT_FALSE(standalone.matches("Sprite1"));
+}
+
 TEST(VirtualMachineTest, RunProcedures)
 {
     static unsigned int bytecode[] = {
@@ -0,0 +1,40 @@
+#include <engine/internal/virtualclock.h>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(VirtualClockTest, CurrentSteadyTime)
+{
+    VirtualClock clock;
+    ASSERT_EQ(clock.elapsedTime(), 0);
+    ASSERT_EQ(clock.currentSteadyTime(), std::chrono::steady_clock::time_point());
+
+    clock.advance(25.5);
+    ASSERT_EQ(clock.elapsedTime(), 25.5);
+    ASSERT_EQ(clock.currentSteadyTime(), std::chrono::steady_clock::time_point(std::chrono::microseconds(25500)));
+
+    for (int i = 0; i < 30; i++)
+        clock.advance(1000 / 30.0);
+
+    ASSERT_EQ(clock.currentSteadyTime(), std::chrono::steady_clock::time_point(std::chrono::microseconds(1025500)));
+}
+
+TEST(VirtualClockTest, CurrentSystemTime)
+{
+    VirtualClock clock;
+    auto startTime = clock.currentSystemTime();
+    ASSERT_EQ(std::chrono::duration_cast<std::chrono::seconds>(startTime.time_since_epoch()).count(), 946684800); // 2000-01-01
+
+    clock.advance(1500);
+    ASSERT_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(clock.currentSystemTime() - startTime).count(), 1500);
+}
+
+TEST(VirtualClockTest, Sleep)
+{
+    VirtualClock clock;
+    auto startTime = std::chrono::steady_clock::now();
+    clock.sleep(std::chrono::milliseconds(500));
+    ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count(), 100);
+    ASSERT_EQ(clock.elapsedTime(), 0);
+}
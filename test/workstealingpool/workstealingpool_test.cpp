@@ -0,0 +1,97 @@
+#include "internal/workstealingpool.h"
+#include <thread>
+#include <atomic>
+#include <set>
+
+#include "../common.h"
+
+using namespace libscratchcpp;
+
+TEST(WorkStealingPoolTest, ThreadCount)
+{
+    ASSERT_EQ(WorkStealingPool().threadCount(), std::max(std::thread::hardware_concurrency(), 1u));
+    ASSERT_EQ(WorkStealingPool(0).threadCount(), std::max(std::thread::hardware_concurrency(), 1u));
+    ASSERT_EQ(WorkStealingPool(1).threadCount(), 1);
+    ASSERT_EQ(WorkStealingPool(6).threadCount(), 6);
+}
+
+TEST(WorkStealingPoolTest, Run)
+{
+    WorkStealingPool pool(4);
+    pool.run({});
+
+    std::vector<int> results(100, 0);
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (int i = 0; i < results.size(); i++)
+        tasks.push_back([i, &results]() { results[i] = i * 2; });
+
+    pool.run(tasks);
+
+    for (int i = 0; i < results.size(); i++)
+        ASSERT_EQ(results[i], i * 2);
+
+    // The pool can be reused
+    std::atomic<int> count = 0;
+    tasks.clear();
+
+    for (int i = 0; i < 10; i++)
+        tasks.push_back([&count]() { count++; });
+
+    pool.run(tasks);
+    ASSERT_EQ(count, 10);
+}
+
+TEST(WorkStealingPoolTest, Steal)
+{
+    // The first task blocks its worker, so the other tasks in its queue must be stolen
+    WorkStealingPool pool(2);
+    std::atomic<int> finished = 0;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::vector<WorkStealingPool::Task> tasks;
+
+    tasks.push_back([&finished]() {
+        while (finished < 5)
+            std::this_thread::yield();
+    });
+
+    for (int i = 0; i < 5; i++) {
+        tasks.push_back([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            finished++;
+        });
+    }
+
+    pool.run(tasks);
+    ASSERT_EQ(finished, 5);
+    ASSERT_EQ(threads.size(), 1);
+}
+
+TEST(WorkStealingPoolTest, IsWorkerThread)
+{
+    ASSERT_FALSE(WorkStealingPool::isWorkerThread());
+
+    // Threads which run the tasks along with other threads are worker threads
+    WorkStealingPool pool(4);
+    std::atomic<int> workerTasks = 0;
+    std::vector<WorkStealingPool::Task> tasks;
+
+    for (int i = 0; i < 20; i++)
+        tasks.push_back([&workerTasks]() { workerTasks += WorkStealingPool::isWorkerThread(); });
+
+    pool.run(tasks);
+    ASSERT_EQ(workerTasks, 20);
+    ASSERT_FALSE(WorkStealingPool::isWorkerThread());
+
+    // A pool with one thread (or a single task) only uses the calling thread
+    WorkStealingPool singlePool(1);
+    workerTasks = 0;
+    singlePool.run(tasks);
+    ASSERT_EQ(workerTasks, 0);
+
+    workerTasks = 0;
+    pool.run({ tasks[0] });
+    ASSERT_EQ(workerTasks, 0);
+}
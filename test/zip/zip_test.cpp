@@ -1,4 +1,5 @@
 #include <internal/zipreader.h>
+#include <thread>
 #include "../common.h"
 
 using namespace libscratchcpp;
@@ -35,3 +36,51 @@ TEST(ZipTest, FileManager)
 {
     ASSERT_EQ(readSb3Json("file_manager.sb3"), readFileStr("file_manager.json"));
 }
+
+TEST(ZipTest, FileData)
+{
+    ZipReader reader("zip_test.zip");
+    ASSERT_TRUE(reader.open());
+
+    // Stored file
+    ASSERT_EQ(reader.fileSize("stored.txt"), 13);
+    auto data = reader.fileData("stored.txt");
+    ASSERT_TRUE(data);
+    ASSERT_EQ(std::string(static_cast<const char *>(data.get()), 13), "Hello, world!");
+
+    // Compressed file
+    std::string str;
+
+    for (int i = 0; i < 1000; i++)
+        str += "abc";
+
+    ASSERT_EQ(reader.fileSize("deflated.txt"), 3000);
+    data = reader.fileData("deflated.txt");
+    ASSERT_TRUE(data);
+    ASSERT_EQ(std::string(static_cast<const char *>(data.get()), 3000), str);
+
+    // The data outlives the reader
+    data = reader.fileData("stored.txt");
+    reader.close();
+    ASSERT_EQ(std::string(static_cast<const char *>(data.get()), 13), "Hello, world!");
+
+    ASSERT_EQ(reader.fileSize("stored.txt"), 0);
+}
+
+TEST(ZipTest, ConcurrentReads)
+{
+    ZipReader reader("default_project.sb3");
+    ASSERT_TRUE(reader.open());
+    std::string json = reader.readFileToString("project.json");
+    std::vector<std::thread> threads;
+    std::vector<std::string> results(8);
+
+    for (size_t i = 0; i < results.size(); i++)
+        threads.push_back(std::thread([&reader, &results, i]() { results[i] = reader.readFileToString("project.json"); }));
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (const std::string &result : results)
+        ASSERT_EQ(result, json);
+}
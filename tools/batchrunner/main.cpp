@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <scratchcpp/batchrunner.h>
+#include <iostream>
+#include <string>
+
+using namespace libscratchcpp;
+
+static void printUsage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [-j threads] [-f frames] [-t seconds] project.sb3..." << std::endl;
+    std::cerr << "  -j threads  number of worker threads (default: one per core)" << std::endl;
+    std::cerr << "  -f frames   maximum number of frames per project" << std::endl;
+    std::cerr << "  -t seconds  maximum run time per project" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    BatchRunner runner;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "-j" || arg == "-f" || arg == "-t") {
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                return 1;
+            }
+
+            std::string value = argv[++i];
+
+            try {
+                if (arg == "-j")
+                    runner.setThreadCount(std::stoul(value));
+                else if (arg == "-f")
+                    runner.setFrameLimit(std::stoul(value));
+                else
+                    runner.setTimeLimit(std::stod(value));
+            } catch (const std::exception &) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+        } else
+            runner.addProject(arg);
+    }
+
+    if (runner.projects().empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto results = runner.run();
+    int ret = 0;
+
+    for (const BatchResult &result : results) {
+        std::cout << result.fileName() << ":" << std::endl;
+
+        if (!result.loaded()) {
+            std::cout << "  failed to load" << std::endl;
+            ret = 1;
+            continue;
+        }
+
+        std::cout << "  frames: " << result.frames() << std::endl;
+        std::cout << "  load time: " << result.loadTime() << " s" << std::endl;
+        std::cout << "  run time: " << result.runTime() << " s" << std::endl;
+
+        for (const auto &[targetName, variables] : result.variables()) {
+            for (const auto &[name, value] : variables)
+                std::cout << "  " << targetName << "/" << name << " = " << value.toString() << std::endl;
+        }
+    }
+
+    return ret;
+}